@@ -34,6 +34,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <limits.h>
 #include <assert.h>
 #include "ndtypes.h"
@@ -41,6 +42,7 @@
 
 
 #if defined(_MSC_VER)
+  #include <windows.h>
   #pragma warning(disable : 4232)
 #else
   #include "config.h"
@@ -228,3 +230,197 @@ ndt_aligned_free(void *aligned)
     uintptr = *((uintptr_t *)aligned - 1);
     ndt_freefunc((void *)uintptr);
 }
+
+
+/******************************************************************************/
+/*                             Allocation classes                             */
+/******************************************************************************/
+
+/* Zero-initialized hooks select the global allocation functions. */
+static ndt_alloc_hooks_t class_hooks[NDT_ALLOC_NCLASSES];
+
+static struct {
+    ATOMIC_INT64 nalloc;
+    ATOMIC_INT64 nfree;
+    ATOMIC_INT64 nbytes;
+} class_stats[NDT_ALLOC_NCLASSES];
+
+/* Statistics are opt-in, since every update is an atomic operation. */
+static ATOMIC_INT64 stats_enabled = 0;
+
+static inline void
+stats_add(ATOMIC_INT64 *counter, int64_t n)
+{
+#ifdef _MSC_VER
+    if (stats_enabled) {
+        (void)InterlockedAddNoFence64(counter, n);
+    }
+#else
+    if (atomic_load_explicit(&stats_enabled, memory_order_relaxed)) {
+        (void)atomic_fetch_add_explicit(counter, n, memory_order_relaxed);
+    }
+#endif
+}
+
+int
+ndt_set_alloc_hooks(enum ndt_alloc_class cls, const ndt_alloc_hooks_t *hooks,
+                    ndt_context_t *ctx)
+{
+    if ((int)cls < 0 || cls >= NDT_ALLOC_NCLASSES) {
+        ndt_err_format(ctx, NDT_ValueError, "invalid allocation class");
+        return -1;
+    }
+
+    if (hooks == NULL) {
+        memset(&class_hooks[cls], 0, sizeof class_hooks[cls]);
+        return 0;
+    }
+
+    if (hooks->alloc == NULL || hooks->realloc == NULL || hooks->free == NULL) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "allocation hooks must define alloc, realloc and free");
+        return -1;
+    }
+
+    class_hooks[cls] = *hooks;
+    return 0;
+}
+
+void
+ndt_alloc_stats_enable(bool enable)
+{
+    stats_enabled = enable;
+}
+
+void
+ndt_alloc_stats(ndt_alloc_stats_t *stats, enum ndt_alloc_class cls)
+{
+    assert(0 <= (int)cls && cls < NDT_ALLOC_NCLASSES);
+
+    stats->nalloc = class_stats[cls].nalloc;
+    stats->nfree = class_stats[cls].nfree;
+    stats->nbytes = class_stats[cls].nbytes;
+}
+
+void
+ndt_alloc_stats_reset(void)
+{
+    for (int i = 0; i < NDT_ALLOC_NCLASSES; i++) {
+        class_stats[i].nalloc = 0;
+        class_stats[i].nfree = 0;
+        class_stats[i].nbytes = 0;
+    }
+}
+
+void *
+ndt_alloc_class(enum ndt_alloc_class cls, int64_t nmemb, int64_t size)
+{
+    const ndt_alloc_hooks_t *hooks = &class_hooks[cls];
+    bool overflow = 0;
+    size_t req;
+    void *ptr;
+
+    req = convert_req(nmemb, size, &overflow);
+    if (overflow) {
+        return NULL;
+    }
+
+    ptr = hooks->alloc ? hooks->alloc(req, hooks->arg) : ndt_mallocfunc(req);
+    if (ptr != NULL) {
+        stats_add(&class_stats[cls].nalloc, 1);
+        stats_add(&class_stats[cls].nbytes, (int64_t)req);
+    }
+
+    return ptr;
+}
+
+void *
+ndt_calloc_class(enum ndt_alloc_class cls, int64_t nmemb, int64_t size)
+{
+    const ndt_alloc_hooks_t *hooks = &class_hooks[cls];
+    bool overflow = 0;
+    size_t req;
+    void *ptr;
+
+    req = convert_req(nmemb, size, &overflow);
+    if (overflow) {
+        return NULL;
+    }
+
+    if (hooks->alloc) {
+        ptr = hooks->alloc(req, hooks->arg);
+        if (ptr != NULL) {
+            memset(ptr, 0, req);
+        }
+    }
+    else {
+        ptr = ndt_callocfunc(req, 1);
+    }
+
+    if (ptr != NULL) {
+        stats_add(&class_stats[cls].nalloc, 1);
+        stats_add(&class_stats[cls].nbytes, (int64_t)req);
+    }
+
+    return ptr;
+}
+
+void *
+ndt_realloc_class(enum ndt_alloc_class cls, void *ptr, int64_t nmemb, int64_t size)
+{
+    const ndt_alloc_hooks_t *hooks = &class_hooks[cls];
+    bool overflow = 0;
+    size_t req;
+    void *p;
+
+    req = convert_req(nmemb, size, &overflow);
+    if (overflow) {
+        return NULL;
+    }
+
+    p = hooks->realloc ? hooks->realloc(ptr, req, hooks->arg)
+                       : ndt_reallocfunc(ptr, req);
+    if (p != NULL) {
+        if (ptr == NULL) {
+            stats_add(&class_stats[cls].nalloc, 1);
+        }
+        stats_add(&class_stats[cls].nbytes, (int64_t)req);
+    }
+
+    return p;
+}
+
+void
+ndt_free_class(enum ndt_alloc_class cls, void *ptr)
+{
+    const ndt_alloc_hooks_t *hooks = &class_hooks[cls];
+
+    if (ptr == NULL) {
+        return;
+    }
+
+    stats_add(&class_stats[cls].nfree, 1);
+
+    if (hooks->free) {
+        hooks->free(ptr, hooks->arg);
+    }
+    else {
+        ndt_freefunc(ptr);
+    }
+}
+
+/*
+ * Slices that are passed to ndt_var_dim() must come from this function, since
+ * the type releases them with ndt_free_slices().
+ */
+ndt_slice_t *
+ndt_alloc_slices(int64_t nslices)
+{
+    return ndt_alloc_class(NDT_ALLOC_SLICES, nslices, sizeof(ndt_slice_t));
+}
+
+void
+ndt_free_slices(ndt_slice_t *slices)
+{
+    ndt_free_class(NDT_ALLOC_SLICES, slices);
+}
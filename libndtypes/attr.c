@@ -54,8 +54,6 @@ ndt_attr_del(ndt_attr_t *attr)
         return;
     }
 
-    ndt_free(attr->name);
-
     switch (attr->tag) {
     case AttrValue:
         ndt_free(attr->AttrValue);
@@ -75,7 +73,7 @@ ndt_attr_del(ndt_attr_t *attr)
 }
 
 void
-ndt_attr_array_del(ndt_attr_t *attr, int64_t nattr)
+ndt_attr_array_clear(ndt_attr_t *attr, int64_t nattr)
 {
     int64_t i, k;
 
@@ -84,8 +82,6 @@ ndt_attr_array_del(ndt_attr_t *attr, int64_t nattr)
     }
 
     for (i = 0; i < nattr; i++) {
-        ndt_free(attr[i].name);
-
         switch (attr[i].tag) {
         case AttrValue:
             ndt_free(attr[i].AttrValue);
@@ -101,7 +97,12 @@ ndt_attr_array_del(ndt_attr_t *attr, int64_t nattr)
         /* NOT REACHED: tags should be exhaustive. */
         ndt_internal_error("invalid attribute");
     }
+}
 
+void
+ndt_attr_array_del(ndt_attr_t *attr, int64_t nattr)
+{
+    ndt_attr_array_clear(attr, nattr);
     ndt_free(attr);
 }
 
@@ -229,8 +230,9 @@ ndt_parse_attr(const attr_spec *spec, ndt_context_t *ctx,
             goto endloop;
         }
 
-        case AttrInt32List: {
-            int32_t *values = ndt_alloc(v[i]->AttrList.len, sizeof(int32_t));
+        case AttrInt32List: { /* var dimension offsets */
+            int32_t *values = ndt_alloc_class(NDT_ALLOC_OFFSETS, v[i]->AttrList.len,
+                                              sizeof(int32_t));
 
             if (values == NULL) {
                 ndt_err_format(ctx, NDT_MemoryError, "out of memory");
@@ -240,7 +242,7 @@ ndt_parse_attr(const attr_spec *spec, ndt_context_t *ctx,
             for (k = 0; k < v[i]->AttrList.len; k++) {
                 values[k] = (int32_t)ndt_strtol(v[i]->AttrList.items[k], 0, INT32_MAX, ctx);
                 if (ndt_err_occurred(ctx)) {
-                    ndt_free(values);
+                    ndt_free_class(NDT_ALLOC_OFFSETS, values);
                     return -1;
                 }
             }
@@ -72,7 +72,7 @@ enum ndt_attr_tag {
 /* Attribute: name=value or name=[value, value, ...]. */
 typedef struct {
     enum ndt_attr_tag tag;
-    char *name;
+    const char *name;  /* in the scratch space */
     union {
         char *AttrValue;
         struct {
@@ -96,6 +96,7 @@ typedef struct {
 } ndt_attr_seq_t;
 
 void ndt_attr_del(ndt_attr_t *attr);
+void ndt_attr_array_clear(ndt_attr_t *attr, int64_t nattr);
 void ndt_attr_array_del(ndt_attr_t *attr, int64_t nattr);
 
 ndt_attr_seq_t *ndt_attr_seq_new(ndt_attr_t *, ndt_context_t *ctx);
@@ -43,6 +43,11 @@ yyerror(YYLTYPE *loc, yyscan_t scanner, const ndt_t **ast, ndt_context_t *ctx,
     (void)scanner;
     (void)ast;
 
+    /* Keep the message of an exceeded resource limit. */
+    if (ctx->flags & NDT_LimitExceeded) {
+        return;
+    }
+
     ndt_err_format(ctx, NDT_ParseError, "%d:%d: %s\n", loc->first_line,
                    loc->first_column, msg);
 }
@@ -221,7 +226,7 @@ make_dimensions(ndt_string_seq_t *seq, const ndt_t *type, ndt_context_t *ctx)
 }
 
 static ndt_field_t *
-make_field(char *name, const ndt_t *type, uint16_t padding, ndt_context_t *ctx)
+make_field(const char *name, const ndt_t *type, uint16_t padding, ndt_context_t *ctx)
 {
     uint16_opt_t align = {None, 0};
     uint16_opt_t pack = {None, 0};
@@ -229,7 +234,7 @@ make_field(char *name, const ndt_t *type, uint16_t padding, ndt_context_t *ctx)
     ndt_field_t *f;
 
     pad.Some = padding;
-    f = ndt_field(name, type, align, pack, pad, ctx);
+    f = ndt_scratch_field(name, type, align, pack, pad, ctx);
     ndt_decref(type);
     return f;
 }
@@ -317,7 +322,7 @@ broadcast_seq_append(ndt_type_seq_t *seq, const ndt_t *type, ndt_context_t *ctx)
 }
 
 
-%pure-parser
+%define api.pure
 %define parse.error verbose
 
 
@@ -339,6 +344,7 @@ broadcast_seq_append(ndt_type_seq_t *seq, const ndt_t *type, ndt_context_t *ctx)
     ndt_string_seq_t *string_seq;
     ndt_type_seq_t *type_seq;
     char *string;
+    const char *name;
     unsigned char uchar;
     uint16_t uint16;
 }
@@ -372,12 +378,16 @@ ERRTOKEN
   DTYPE
 
 %token <string>
-  INTEGER NAME
+  INTEGER
+
+/* Names are allocated in the scratch space and need no destructor. */
+%token <name>
+  NAME
 
 %token ENDMARKER 0 "end of file"
 
 %destructor { ndt_decref($$); } <ndt>
-%destructor { ndt_field_del($$); } <field>
+%destructor { ndt_decref($$->type); } <field>
 %destructor { ndt_field_seq_del($$); } <field_seq>
 %destructor { ndt_string_seq_del($$); } <string_seq>
 %destructor { ndt_type_seq_del($$); } <type_seq>
@@ -795,7 +795,7 @@ yyalloc(size_t size, yyscan_t yyscanner)
 {
     (void)yyscanner;
 
-    return ndt_alloc(1, size);
+    return ndt_alloc_class(NDT_ALLOC_SCRATCH, 1, size);
 }
 
 void *
@@ -803,7 +803,7 @@ yyrealloc(void *ptr, size_t size, yyscan_t yyscanner)
 {
     (void)yyscanner;
 
-    return ndt_realloc(ptr, 1, size);
+    return ndt_realloc_class(NDT_ALLOC_SCRATCH, ptr, 1, size);
 }
 
 void
@@ -811,7 +811,7 @@ yyfree(void *ptr, yyscan_t yyscanner)
 {
     (void)yyscanner;
 
-    ndt_free(ptr);
+    ndt_free_class(NDT_ALLOC_SCRATCH, ptr);
 }
 
 #line 817 "bplexer.c"
@@ -1372,7 +1372,7 @@ YY_RULE_SETUP
 case 39:
 YY_RULE_SETUP
 #line 166 "bplexer.l"
-{ yylval->string = ndt_strdup(yytext, ctx); if (yylval->string == NULL) return ERRTOKEN; return NAME; }
+{ yylval->name = ndt_scratch_strdup(yytext, ctx); if (yylval->name == NULL) return ERRTOKEN; return NAME; }
 	YY_BREAK
 
 
@@ -31,6 +31,10 @@
  */
 
 
+#ifdef _MSC_VER
+  #include <windows.h>
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
@@ -40,6 +44,7 @@
 #include <errno.h>
 #include <assert.h>
 #include "ndtypes.h"
+#include "threadlocal.h"
 
 
 /******************************************************************************/
@@ -542,3 +547,178 @@ ndt_to_nbformat(char **sig, char **dtype, const ndt_t *t, ndt_context_t *ctx)
 
     return 0;
 }
+
+
+/******************************************************************************/
+/*                     API: structured numba signature                        */
+/******************************************************************************/
+
+/*
+ * Recently used descriptors are kept in a small, lossy direct-mapped cache
+ * keyed by the address of the function type: a miss replaces the entry in
+ * its slot.  Each descriptor owns a reference to its type, so an address
+ * cannot be reused while the entry is alive.  Every thread has its own
+ * cache, so lookups need no locking.  Descriptors themselves have atomic
+ * reference counts and may be released by any thread.
+ */
+#define NB_CACHE_SIZE 64
+
+static NDT_THREAD_LOCAL const ndt_nb_signature_t *nb_cache[NB_CACHE_SIZE];
+
+static size_t
+nb_cache_index(const ndt_t *t)
+{
+    uintptr_t h = (uintptr_t)t;
+
+    h ^= h >> 12;
+    return (size_t)(h >> 4) & (NB_CACHE_SIZE-1);
+}
+
+static void
+nb_signature_incref(const ndt_nb_signature_t *s)
+{
+    ndt_nb_signature_t *u = (ndt_nb_signature_t *)s;
+#ifdef _MSC_VER
+    (void)InterlockedIncrement64(&u->refcnt);
+#else
+    ++u->refcnt;
+#endif
+}
+
+static void
+nb_signature_del(ndt_nb_signature_t *s)
+{
+    ndt_free(s->sig);
+    ndt_free(s->core);
+    ndt_decref(s->type);
+    ndt_free(s);
+}
+
+void
+ndt_nb_signature_decref(const ndt_nb_signature_t *s)
+{
+    ndt_nb_signature_t *u = (ndt_nb_signature_t *)s;
+
+    if (u == NULL) {
+        return;
+    }
+
+#ifdef _MSC_VER
+    if (InterlockedDecrement64(&u->refcnt) == 0) {
+        nb_signature_del(u);
+    }
+#else
+    if (--u->refcnt == 0) {
+        nb_signature_del(u);
+    }
+#endif
+}
+
+/* The argument has been validated by ndt_to_nbformat(). */
+static void
+nb_arg(ndt_nb_arg_t *arg, const char **dims, const ndt_t *t)
+{
+    enum ndt_contig tag;
+    int k;
+
+    assert(t->tag == EllipsisDim);
+
+    tag = t->EllipsisDim.tag;
+    arg->ndims = t->ndim-1;
+    arg->dims = arg->ndims > 0 ? dims : NULL;
+
+    for (k=0, t=t->EllipsisDim.type; t->ndim > 0; k++, t=t->SymbolicDim.type) {
+        if (k == 0 && t->SymbolicDim.tag != RequireNA) {
+            tag = t->SymbolicDim.tag;
+        }
+        dims[k] = t->SymbolicDim.name;
+    }
+
+    arg->tag = t->tag;
+    arg->itemsize = t->datasize;
+    arg->layout = tag == RequireC ? 'C' : tag == RequireF ? 'F' : 'A';
+}
+
+static ndt_nb_signature_t *
+nb_signature_new(const ndt_t *t, ndt_context_t *ctx)
+{
+    ndt_nb_signature_t *s;
+    const char **dims;
+    char *sig, *core;
+    int64_t ndims = 0;
+    int64_t i;
+
+    if (ndt_to_nbformat(&sig, &core, t, ctx) < 0) {
+        return NULL;
+    }
+
+    for (i = 0; i < t->Function.nargs; i++) {
+        ndims += t->Function.types[i]->ndim-1;
+    }
+
+    /* Descriptor, arguments and dimension names share one allocation. */
+    s = ndt_alloc(1, sizeof *s + t->Function.nargs * sizeof(ndt_nb_arg_t) +
+                     ndims * sizeof(char *));
+    if (s == NULL) {
+        ndt_free(sig);
+        ndt_free(core);
+        return ndt_memory_error(ctx);
+    }
+
+    s->refcnt = 1;
+    s->nin = t->Function.nin;
+    s->nout = t->Function.nout;
+    s->nargs = t->Function.nargs;
+    s->args = (ndt_nb_arg_t *)(s+1);
+    s->sig = sig;
+    s->core = core;
+
+    dims = (const char **)(s->args + s->nargs);
+    for (i = 0; i < t->Function.nargs; i++) {
+        nb_arg(&s->args[i], dims, t->Function.types[i]);
+        dims += s->args[i].ndims;
+    }
+
+    ndt_incref(t);
+    s->type = t;
+
+    return s;
+}
+
+/*
+ * Return a new reference to the structured numba signature of 't'.  Repeated
+ * calls with the same type in the same thread usually only cost a cache
+ * lookup.
+ */
+const ndt_nb_signature_t *
+ndt_to_nb_signature(const ndt_t *t, ndt_context_t *ctx)
+{
+    const size_t i = nb_cache_index(t);
+    ndt_nb_signature_t *s;
+
+    if (nb_cache[i] != NULL && nb_cache[i]->type == t) {
+        nb_signature_incref(nb_cache[i]);
+        return nb_cache[i];
+    }
+
+    s = nb_signature_new(t, ctx);
+    if (s == NULL) {
+        return NULL;
+    }
+
+    ndt_nb_signature_decref(nb_cache[i]);
+    nb_signature_incref(s);
+    nb_cache[i] = s;
+
+    return s;
+}
+
+/* Clear the cache of the calling thread. */
+void
+ndt_nb_signature_cache_clear(void)
+{
+    for (int i = 0; i < NB_CACHE_SIZE; i++) {
+        ndt_nb_signature_decref(nb_cache[i]);
+        nb_cache[i] = NULL;
+    }
+}
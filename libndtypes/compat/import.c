@@ -66,17 +66,28 @@ ndt_from_bpformat(const char *input, ndt_context_t *ctx)
         return NULL;
     }
 
+    ndt_limits_begin(ctx);
+    if (ndt_limit_bytes(ctx, (int64_t)size+2) < 0) {
+        ndt_limits_end(ctx);
+        return NULL;
+    }
+
     buffer = ndt_alloc_size(size+2);
     if (buffer == NULL) {
+        ndt_limits_end(ctx);
         return ndt_memory_error(ctx);
     }
     memcpy(buffer, input, size);
     buffer[size] = '\0';
     buffer[size+1] = '\0';
 
+    ndt_scratch_enter();
+
     if (setjmp(ndt_bp_lexerror) == 0) {
         if (ndt_bplex_init_extra(ctx, (yyscan_t *)&scanner) != 0) {
             ndt_err_format(ctx, NDT_LexError, "lexer initialization failed");
+            ndt_scratch_leave();
+            ndt_limits_end(ctx);
             ndt_free(buffer);
             return NULL;
         }
@@ -88,6 +99,8 @@ ndt_from_bpformat(const char *input, ndt_context_t *ctx)
         ret = ndt_bpparse(scanner, &ast, ctx);
         ndt_bp_delete_buffer(state, scanner);
         ndt_bplex_destroy(scanner);
+        ndt_scratch_leave();
+        ndt_limits_end(ctx);
         ndt_free(buffer);
 
         if (ret == 2) {
@@ -103,6 +116,8 @@ ndt_from_bpformat(const char *input, ndt_context_t *ctx)
         if (scanner) {
             ndt_bplex_destroy(scanner);
         }
+        ndt_scratch_leave();
+        ndt_limits_end(ctx);
         ndt_free(buffer);
         ndt_err_format(ctx, NDT_MemoryError, "flex: internal lexer error");
         return NULL;
@@ -32,7 +32,9 @@
 
 
 #include <stdarg.h>
+#include <string.h>
 #include "ndtypes.h"
+#include "threadlocal.h"
 
 
 /******************************************************************************/
@@ -53,6 +55,9 @@ ndt_context_new(void)
     ctx->err = NDT_Success;
     ctx->msg = ConstMsg;
     ctx->ConstMsg = "Success";
+    ctx->buffer = NULL;
+    ctx->bufsize = 0;
+    ndt_context_set_limits(ctx, NULL);
 
     return ctx;
 }
@@ -71,28 +76,242 @@ ndt_context_del(ndt_context_t *ctx)
 }
 
 
+/*
+ * Messages that fit into the buffer are formatted in place and stored as a
+ * ConstMsg, so setting an error does not allocate.  Longer messages fall
+ * back to a DynamicMsg.  The buffer must outlive the context.
+ */
+void
+ndt_context_set_buffer(ndt_context_t *ctx, char *buffer, size_t bufsize)
+{
+    ndt_context_reset(ctx);
+    ctx->buffer = bufsize > 0 ? buffer : NULL;
+    ctx->bufsize = bufsize > 0 ? bufsize : 0;
+}
+
+/* Clear the error and release a dynamic message.  The buffer is kept. */
+void
+ndt_context_reset(ndt_context_t *ctx)
+{
+    ndt_err_clear(ctx);
+    ctx->msg = ConstMsg;
+    ctx->ConstMsg = "Success";
+}
+
+
+#define NDT_MSG_BUFSIZE 256
+
+static NDT_THREAD_LOCAL ndt_context_t default_context = {
+  .flags=0, .err=NDT_Success, .msg=ConstMsg, .ConstMsg="Success",
+  .buffer=NULL, .bufsize=0, .limits={0}, .used={0}
+};
+static NDT_THREAD_LOCAL char default_buffer[NDT_MSG_BUFSIZE];
+
+/*
+ * Return the context of the current thread.  It is never deallocated and
+ * has a preallocated message buffer, so it can be used in hot loops instead
+ * of ndt_context_new() and ndt_context_del().  Errors persist until the next
+ * error or ndt_context_reset().
+ */
+ndt_context_t *
+ndt_context_default(void)
+{
+    ndt_context_t *ctx = &default_context;
+
+    if (ctx->buffer == NULL) {
+        ctx->buffer = default_buffer;
+        ctx->bufsize = NDT_MSG_BUFSIZE;
+    }
+
+    return ctx;
+}
+
+
+/******************************************************************************/
+/*                              Resource limits                               */
+/******************************************************************************/
+
+/*
+ * Limits are intended for untrusted input.  They are set once on a context
+ * and apply to each subsequent call of the parser or the deserializer, which
+ * bracket their work with ndt_limits_begin() and ndt_limits_end().  Outside
+ * of that region, and for contexts without limits, all checks are no-ops.
+ */
+void
+ndt_context_set_limits(ndt_context_t *ctx, const ndt_limits_t *limits)
+{
+    static const ndt_limits_t unlimited = {0, 0, 0, 0, 0};
+
+    ctx->limits = limits ? *limits : unlimited;
+    ctx->used = unlimited;
+    ctx->flags &= ~(NDT_Limited|NDT_LimitExceeded);
+}
+
+void
+ndt_limits_begin(ndt_context_t *ctx)
+{
+    const ndt_limits_t *l = &ctx->limits;
+
+    memset(&ctx->used, 0, sizeof ctx->used);
+    ctx->flags &= ~(NDT_Limited|NDT_LimitExceeded);
+
+    if (l->nodes || l->depth || l->bytes || l->offsets || l->string) {
+        ctx->flags |= NDT_Limited;
+    }
+}
+
+void
+ndt_limits_end(ndt_context_t *ctx)
+{
+    ctx->flags &= ~NDT_Limited;
+}
+
+static int
+limit_error(ndt_context_t *ctx, const char *what, int64_t limit)
+{
+    ctx->flags |= NDT_LimitExceeded;
+    ndt_err_format(ctx, NDT_ValueError,
+        "resource limit exceeded: maximum %s is %" PRIi64, what, limit);
+    return -1;
+}
+
+/* Add 'n' to a counter, saturating instead of overflowing. */
+static inline int
+limit_add(int64_t *used, int64_t n, int64_t limit)
+{
+    *used = n > INT64_MAX - *used ? INT64_MAX : *used + n;
+    return limit > 0 && *used > limit;
+}
+
+int
+ndt_limit_bytes(ndt_context_t *ctx, int64_t n)
+{
+    if (!(ctx->flags & NDT_Limited)) {
+        return 0;
+    }
+
+    if (limit_add(&ctx->used.bytes, n, ctx->limits.bytes)) {
+        return limit_error(ctx, "number of bytes", ctx->limits.bytes);
+    }
+
+    return 0;
+}
+
+int
+ndt_limit_node(ndt_context_t *ctx, int64_t size)
+{
+    if (!(ctx->flags & NDT_Limited)) {
+        return 0;
+    }
+
+    if (limit_add(&ctx->used.nodes, 1, ctx->limits.nodes)) {
+        return limit_error(ctx, "number of nodes", ctx->limits.nodes);
+    }
+
+    return ndt_limit_bytes(ctx, size);
+}
+
+int
+ndt_limit_offsets(ndt_context_t *ctx, int64_t n)
+{
+    if (!(ctx->flags & NDT_Limited)) {
+        return 0;
+    }
+
+    if (limit_add(&ctx->used.offsets, n, ctx->limits.offsets)) {
+        return limit_error(ctx, "number of offsets", ctx->limits.offsets);
+    }
+
+    return ndt_limit_bytes(ctx, n > INT64_MAX / 4 ? INT64_MAX : n * 4);
+}
+
+int
+ndt_limit_string(ndt_context_t *ctx, int64_t len)
+{
+    if (!(ctx->flags & NDT_Limited)) {
+        return 0;
+    }
+
+    if (ctx->limits.string > 0 && len > ctx->limits.string) {
+        return limit_error(ctx, "string length", ctx->limits.string);
+    }
+
+    return ndt_limit_bytes(ctx, len + 1);
+}
+
+int
+ndt_limit_depth(ndt_context_t *ctx, int delta)
+{
+    if (!(ctx->flags & NDT_Limited)) {
+        return 0;
+    }
+
+    ctx->used.depth += delta;
+    if (ctx->limits.depth > 0 && ctx->used.depth > ctx->limits.depth) {
+        return limit_error(ctx, "depth", ctx->limits.depth);
+    }
+
+    return 0;
+}
+
 /******************************************************************************/
 /*                              Error handling                                */
 /******************************************************************************/
 
-/* Set an error with a message. */
+/*
+ * Set an error with a message.  The arguments may refer to the current
+ * message, e.g. when a prefix is added to ndt_context_msg(ctx).  Therefore
+ * a dynamic message is freed only after formatting, and a message in the
+ * buffer is formatted into a temporary on the stack first.
+ */
 void
 ndt_err_format(ndt_context_t *ctx, enum ndt_error err, const char *fmt, ...)
 {
+    char tmp[NDT_MSG_BUFSIZE];
     va_list ap, aq;
+    char *old = NULL;
+    bool in_buffer;
+    char *buf;
+    size_t bufsize;
     char *s;
     int n;
 
-    ndt_err_clear(ctx);
+    if (ctx->msg == DynamicMsg) {
+        old = ctx->DynamicMsg;
+    }
+    in_buffer = ctx->msg == ConstMsg && ctx->buffer != NULL &&
+                ctx->ConstMsg == ctx->buffer;
+
     ctx->err = err;
+    ctx->msg = ConstMsg;
+
+    buf = in_buffer ? tmp : ctx->buffer;
+    bufsize = in_buffer ? sizeof tmp : ctx->bufsize;
 
     va_start(ap, fmt);
     va_copy(aq, ap);
 
-    n = vsnprintf(NULL, 0, fmt, ap);
-    va_end(ap);
+    if (buf != NULL) {
+        n = vsnprintf(buf, bufsize, fmt, ap);
+        va_end(ap);
+        if (n >= 0 && (size_t)n < bufsize && (size_t)n < ctx->bufsize) {
+            va_end(aq);
+            if (in_buffer) {
+                memcpy(ctx->buffer, tmp, n+1);
+            }
+            ndt_free(old);
+            ctx->ConstMsg = ctx->buffer;
+            return;
+        }
+    }
+    else {
+        n = vsnprintf(NULL, 0, fmt, ap);
+        va_end(ap);
+    }
+
     if (n < 0 || n == INT_MAX) {
-        ctx->msg = ConstMsg;
+        va_end(aq);
+        ndt_free(old);
         ctx->ConstMsg = \
            "internal error during the handling of the original error";
         return;
@@ -101,22 +320,30 @@ ndt_err_format(ndt_context_t *ctx, enum ndt_error err, const char *fmt, ...)
     s = ndt_alloc(1, n+1);
     if (s == NULL) {
         va_end(aq);
+        ndt_free(old);
         ctx->err = NDT_MemoryError;
-        ctx->msg = ConstMsg;
         ctx->ConstMsg = "out of memory";
         return;
     }
 
     n = vsnprintf(s, n+1, fmt, aq);
     va_end(aq);
+    ndt_free(old);
     if (n < 0) {
         ndt_free(s);
-        ctx->msg = ConstMsg;
         ctx->ConstMsg = \
             "internal error during the handling of the original error";
         return;
     }
 
+    /* Only reached for user buffers that are larger than 'tmp'. */
+    if (in_buffer && (size_t)n < ctx->bufsize) {
+        memcpy(ctx->buffer, s, n+1);
+        ndt_free(s);
+        ctx->ConstMsg = ctx->buffer;
+        return;
+    }
+
     ctx->msg = DynamicMsg;
     ctx->DynamicMsg = s;
 }
@@ -67,7 +67,7 @@ ndt_copy_var_dim(const ndt_t *t, bool opt, ndt_context_t *ctx)
     nslices = t->Concrete.VarDim.nslices;
 
     if (nslices > 0) {
-        slices = ndt_alloc(nslices, sizeof *slices);
+        slices = ndt_alloc_slices(nslices);
         if (slices == NULL) {
             return ndt_memory_error(ctx);
         }
@@ -84,7 +84,6 @@ const ndt_t *
 ndt_convert_to_var_elem(const ndt_t *t, const ndt_t *type, int64_t index,
                         ndt_context_t *ctx)
 {
-    ndt_t *u;
     ndt_slice_t *slices;
     int nslices;
 
@@ -110,7 +109,7 @@ ndt_convert_to_var_elem(const ndt_t *t, const ndt_t *type, int64_t index,
     nslices = t->Concrete.VarDim.nslices;
 
     if (nslices > 0) {
-        slices = ndt_alloc(nslices, sizeof *slices);
+        slices = ndt_alloc_slices(nslices);
         if (slices == NULL) {
             return ndt_memory_error(ctx);
         }
@@ -118,16 +117,8 @@ ndt_convert_to_var_elem(const ndt_t *t, const ndt_t *type, int64_t index,
                nslices * (sizeof *slices));
     }
 
-    u = (ndt_t *)ndt_var_dim(type, t->Concrete.VarDim.offsets,
-                             nslices, slices,
-                             false, ctx);
-    if (u == NULL) {
-        return NULL;
-    }
-
-    u->tag = VarDimElem;
-    u->VarDimElem.index = index;
-    return u;
+    return ndt_var_dim_elem(type, t->Concrete.VarDim.offsets, nslices, slices,
+                            index, ctx);
 }
 
 static const ndt_t *
@@ -186,11 +177,16 @@ static const ndt_t *
 ndt_copy_record(const ndt_t *t, bool opt, ndt_context_t *ctx)
 {
     ndt_t *u;
+    int64_t namesize = 0;
     int64_t i;
 
     assert(t->tag == Record);
 
-    u = ndt_record_new(t->Record.flag, t->Record.shape, opt, ctx);
+    for (i = 0; i < t->Record.shape; i++) {
+        namesize += (int64_t)strlen(t->Record.names[i]) + 1;
+    }
+
+    u = ndt_record_new(t->Record.flag, t->Record.shape, namesize, opt, ctx);
     if (u == NULL) {
         return NULL;
     }
@@ -198,11 +194,7 @@ ndt_copy_record(const ndt_t *t, bool opt, ndt_context_t *ctx)
     copy_common(u, t);
 
     for (i = 0; i < t->Record.shape; i++) {
-        u->Record.names[i] = ndt_strdup(t->Record.names[i], ctx);
-        if (u->Record.names[i] == NULL) {
-            ndt_decref(u);
-            return NULL;
-        }
+        ndt_record_set_name(u, i, t->Record.names[i]);
 
         ndt_incref(t->Record.types[i]);
         u->Record.types[i] = t->Record.types[i];
@@ -302,8 +294,16 @@ ndt_copy(const ndt_t *t, ndt_context_t *ctx)
 
     switch (t->tag) {
     case FixedDim: {
-        u = (ndt_t *)ndt_fixed_dim_tag(t->FixedDim.type, t->FixedDim.tag, t->FixedDim.shape,
-                                       t->Concrete.FixedDim.step, ctx);
+        if (t->Concrete.FixedDim.tile != 0) {
+            u = (ndt_t *)ndt_fixed_dim_tiled(t->FixedDim.type, t->FixedDim.shape,
+                                             t->Concrete.FixedDim.step,
+                                             t->Concrete.FixedDim.tile,
+                                             t->Concrete.FixedDim.tile_step, ctx);
+        }
+        else {
+            u = (ndt_t *)ndt_fixed_dim_tag(t->FixedDim.type, t->FixedDim.tag, t->FixedDim.shape,
+                                           t->Concrete.FixedDim.step, ctx);
+        }
         goto copy_common_fields;
     }
 
@@ -433,6 +433,7 @@ ndt_copy(const ndt_t *t, ndt_context_t *ctx)
         }
         *u = *t;
         u->refcnt = 1;
+        u->owned = false;
         return u;
     }
 
@@ -462,6 +463,65 @@ invalid_tag:
     return NULL;
 }
 
+/*
+ * Return a copy of the concrete type 't' in which the optional dimensions and
+ * the optional dtype are marked as containing no missing values.  Fields of
+ * tuples and records are not visited.
+ */
+const ndt_t *
+ndt_all_valid(const ndt_t *t, ndt_context_t *ctx)
+{
+    const ndt_t **child;
+    const ndt_t *type;
+    ndt_t *u;
+
+    if (ndt_is_abstract(t)) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "missing value hints require a concrete type");
+        return NULL;
+    }
+
+    if (!(t->flags & (NDT_OPTION|NDT_SUBTREE_OPTION))) {
+        ndt_incref(t);
+        return t;
+    }
+
+    if (!ndt_is_optional(t) && t->tag != FixedDim && t->tag != VarDim) {
+        ndt_incref(t);
+        return t;
+    }
+
+    if (ndt_is_static(t)) {
+        return ndt_primitive(t->tag, t->flags|NDT_ALL_VALID, ctx);
+    }
+
+    u = (ndt_t *)ndt_copy(t, ctx);
+    if (u == NULL) {
+        return NULL;
+    }
+
+    switch (u->tag) {
+    case FixedDim: child = &u->FixedDim.type; break;
+    case VarDim: child = &u->VarDim.type; break;
+    default: child = NULL; break;
+    }
+
+    if (child != NULL) {
+        type = ndt_all_valid(*child, ctx);
+        if (type == NULL) {
+            ndt_decref(u);
+            return NULL;
+        }
+        ndt_move(child, type);
+    }
+
+    if (ndt_is_optional(u)) {
+        u->flags |= NDT_ALL_VALID;
+    }
+
+    return u;
+}
+
 static const ndt_t *
 fixed_copy_contiguous(const ndt_t *t, const ndt_t *type, ndt_context_t *ctx)
 {
@@ -490,27 +550,27 @@ typedef struct {
     int maxdim;
     bool active[NDT_MAX_DIM+1];
     int32_t index[NDT_MAX_DIM+1];
-    int32_t *offsets[NDT_MAX_DIM+1];
+    ndt_offsets_t *offsets[NDT_MAX_DIM+1];
 } offsets_t;
 
 static void
 clear_offsets(offsets_t *m)
 {
     for (int i = 0; i < NDT_MAX_DIM+1; i++) {
-        ndt_free(m->offsets[i]);
+        ndt_decref_offsets(m->offsets[i]);
+        m->offsets[i] = NULL;
     }
 }
 
 static int
 var_init_offsets(offsets_t *m, ndt_context_t *ctx)
 {
-    int32_t *offsets;
+    ndt_offsets_t *offsets;
 
     for (int i = 1; i <= m->maxdim; i++) {
-        offsets = ndt_calloc(m->index[i]+1, sizeof *offsets);
+        offsets = ndt_offsets_new(m->index[i]+1, ctx);
         if (offsets == NULL) {
             clear_offsets(m);
-            (void)ndt_memory_error(ctx);
             return -1;
         }
         m->offsets[i] = offsets;
@@ -569,8 +629,8 @@ var_copy_shapes(bool write, offsets_t *m, int64_t linear_index, const ndt_t *t,
 
     int32_t write_index = m->index[t->ndim]++;
     if (write) {
-        int32_t sum = m->offsets[t->ndim][write_index];
-        m->offsets[t->ndim][write_index+1] = sum + (int32_t)shape;
+        int32_t *v = (int32_t *)m->offsets[t->ndim]->v;
+        v[write_index+1] = v[write_index] + (int32_t)shape;
     }
 
     for (int64_t i = k; i < k+shape; i++) {
@@ -594,19 +654,13 @@ var_from_offsets_and_dtype(offsets_t *m, const ndt_t *t, ndt_context_t *ctx)
 
     for (i = 1; i <= m->maxdim; i++) {
         if (!m->active[i]) {
-            ndt_free(m->offsets[i]);
+            ndt_decref_offsets(m->offsets[i]);
             m->offsets[i] = NULL;
             continue;
         }
 
-        ndt_offsets_t *offsets = ndt_offsets_from_ptr(m->offsets[i], m->index[i]+1, ctx);
-
+        ndt_offsets_t *offsets = ndt_offsets_intern(m->offsets[i]);
         m->offsets[i] = NULL;
-        if (offsets == NULL) {
-            ndt_decref(t);
-            clear_offsets(m);
-            return NULL;
-        }
 
         u = ndt_var_dim(t, offsets, 0, NULL, false, ctx);
         ndt_move(&t, u);
@@ -681,6 +735,137 @@ ndt_copy_contiguous(const ndt_t *t, int64_t linear_index, ndt_context_t *ctx)
     return ndt_copy_contiguous_dtype(t, dtype, linear_index, ctx);
 }
 
+/*
+ * Two-pass helper for ndt_var_copy_contiguous_at(): descend 'n' logical
+ * dimensions and copy the shapes of every row that is reached.
+ */
+static int
+var_copy_rows(bool write, offsets_t *m, int64_t linear_index, const ndt_t *t,
+              int n, ndt_context_t *ctx)
+{
+    int64_t shape, start, step;
+    int64_t k;
+
+    if (n == 0) {
+        return var_copy_shapes(write, m, linear_index, t, ctx);
+    }
+
+    shape = ndt_var_indices(&start, &step, t, linear_index, ctx);
+    if (shape < 0) {
+        clear_offsets(m);
+        return -1;
+    }
+
+    k = 0;
+    if (t->tag == VarDimElem) {
+        k = get_index(shape, t->VarDimElem.index, ctx);
+        if (k < 0) {
+            clear_offsets(m);
+            return -1;
+        }
+        shape = 1;
+        n++; /* not a logical dimension */
+    }
+
+    for (int64_t i = k; i < k+shape; i++) {
+        int64_t next = start + i * step;
+        if (var_copy_rows(write, m, next, t->VarDim.type, n-1, ctx) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* Return true if all rows at every level are described by the offsets. */
+static bool
+var_shareable_offsets(const ndt_t *t)
+{
+    while (t->ndim > 0) {
+        if (t->tag != VarDim || t->Concrete.VarDim.nslices != 0 ||
+            t->Concrete.VarDim.offsets->v[0] != 0) {
+            return false;
+        }
+        t = t->VarDim.type;
+    }
+
+    return true;
+}
+
+/*
+ * Contiguous copy of the var dimensions starting at logical dimension 'n',
+ * with one outer row for each element at that depth.  If no dimension is
+ * sliced or indexed, the result shares the offsets of 't' and the cost is
+ * O(ndim).  Otherwise new offsets are computed in O(rows).
+ */
+const ndt_t *
+ndt_var_copy_contiguous_at(const ndt_t *t, int n, const ndt_t *dtype,
+                           ndt_context_t *ctx)
+{
+    offsets_t m = {.maxdim=0, .index={0}, .offsets={NULL}};
+    const ndt_t *dims[NDT_MAX_DIM];
+    const ndt_t *u;
+    int ndim, i;
+
+    if (ndt_is_abstract(t) || ndt_is_abstract(dtype) ||
+        !(t->tag == VarDim || t->tag == VarDimElem)) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "ndt_var_copy_contiguous_at() called on abstract type or "
+            "non-var dimension");
+        return NULL;
+    }
+
+    if (n < 0 || n > ndt_logical_ndim(t)) {
+        ndt_err_format(ctx, NDT_ValueError, "n out of bounds");
+        return NULL;
+    }
+
+    if (var_shareable_offsets(t)) {
+        for (ndim = 0, u = t; u->ndim > 0; u = u->VarDim.type) {
+            dims[ndim++] = u;
+        }
+
+        ndt_incref(dtype);
+        u = dtype;
+
+        for (i = ndim-1; i >= n; i--) {
+            const ndt_t *v = ndt_var_dim(u, dims[i]->Concrete.VarDim.offsets,
+                                         0, NULL, false, ctx);
+            ndt_move(&u, v);
+            if (u == NULL) {
+                return NULL;
+            }
+        }
+
+        return u;
+    }
+
+    for (i = n, u = t; i > 0; u = u->VarDim.type) {
+        if (u->tag == VarDim) {
+            i--;
+        }
+    }
+    m.maxdim = u->ndim;
+
+    if (var_copy_rows(false, &m, 0, t, n, ctx) < 0) {
+        return NULL;
+    }
+
+    if (var_init_offsets(&m, ctx) < 0) {
+        return NULL;
+    }
+
+    for (i = 0; i <= m.maxdim; i++) {
+        m.index[i] = 0;
+    }
+
+    if (var_copy_rows(true, &m, 0, t, n, ctx) < 0) {
+        return NULL;
+    }
+
+    return var_from_offsets_and_dtype(&m, dtype, ctx);
+}
+
 const ndt_t *
 ndt_copy_abstract_var_dtype(const ndt_t *t, const ndt_t *dtype, ndt_context_t *ctx)
 {
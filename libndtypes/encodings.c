@@ -31,7 +31,9 @@
  */
 
 
-#include "string.h"
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
 #include "ndtypes.h"
 
 
@@ -114,3 +116,194 @@ ndt_alignof_encoding(enum ndt_encoding encoding)
 {
     return (uint16_t)ndt_sizeof_encoding(encoding);
 }
+
+
+/******************************************************************************/
+/*                        UTF-8 validation and lengths                        */
+/******************************************************************************/
+
+#define ASCII_MASK 0x8080808080808080ULL
+
+typedef struct {
+    int64_t codepoints;  /* number of code points */
+    int64_t astral;      /* code points outside the BMP */
+    bool ascii;          /* all code points are ASCII */
+} utf8_count_t;
+
+/*
+ * Validate 'len' bytes of UTF-8 and count the code points.  ASCII runs are
+ * skipped eight bytes at a time.  Return the byte offset of the first
+ * invalid sequence or -1 if the input is valid.
+ */
+static int64_t
+utf8_scan(utf8_count_t *c, const unsigned char *s, int64_t len)
+{
+    int64_t i = 0;
+    uint64_t w;
+
+    c->codepoints = 0;
+    c->astral = 0;
+    c->ascii = true;
+
+    while (i < len) {
+        if (len - i >= 8) {
+            memcpy(&w, s+i, 8);
+            if ((w & ASCII_MASK) == 0) {
+                c->codepoints += 8;
+                i += 8;
+                continue;
+            }
+        }
+
+        const unsigned char x = s[i];
+        unsigned char lo = 0x80, hi = 0xBF;
+        int n;
+
+        if (x < 0x80) {
+            c->codepoints++;
+            i++;
+            continue;
+        }
+
+        if (x >= 0xC2 && x <= 0xDF) {
+            n = 1;
+        }
+        else if (x >= 0xE0 && x <= 0xEF) {
+            n = 2;
+            if (x == 0xE0) lo = 0xA0;      /* overlong */
+            else if (x == 0xED) hi = 0x9F; /* surrogates */
+        }
+        else if (x >= 0xF0 && x <= 0xF4) {
+            n = 3;
+            if (x == 0xF0) lo = 0x90;      /* overlong */
+            else if (x == 0xF4) hi = 0x8F; /* > U+10FFFF */
+        }
+        else {
+            return i;
+        }
+
+        if (len - i <= n || s[i+1] < lo || s[i+1] > hi) {
+            return i;
+        }
+
+        for (int k = 2; k <= n; k++) {
+            if ((s[i+k] & 0xC0) != 0x80) {
+                return i;
+            }
+        }
+
+        c->ascii = false;
+        c->astral += n == 3;
+        c->codepoints++;
+        i += n+1;
+    }
+
+    return -1;
+}
+
+/* Number of code units of the valid UTF-8 input in 'encoding'. */
+static int64_t
+utf8_units(const utf8_count_t *c, int64_t len, enum ndt_encoding encoding)
+{
+    switch (encoding) {
+    case Ascii:
+        return c->ascii ? len : -1;
+    case Utf8:
+        return len;
+    case Ucs2:
+        return c->astral == 0 ? c->codepoints : -1;
+    case Utf16:
+        return c->codepoints + c->astral;
+    case Utf32:
+        return c->codepoints;
+    }
+
+    /* NOT REACHED: tags should be exhaustive. */
+    ndt_internal_error("invalid encoding");
+}
+
+/*
+ * Validate 'len' bytes of UTF-8 and return the number of code units that
+ * are required to store the string in 'encoding'.  If 'len' is negative,
+ * 's' is NUL-terminated.
+ */
+int64_t
+ndt_utf8_length(const char *s, int64_t len, enum ndt_encoding encoding,
+                ndt_context_t *ctx)
+{
+    utf8_count_t c;
+    int64_t pos, n;
+
+    if (len < 0) {
+        len = (int64_t)strlen(s);
+    }
+
+    pos = utf8_scan(&c, (const unsigned char *)s, len);
+    if (pos >= 0) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "invalid utf-8 sequence at byte %" PRIi64, pos);
+        return -1;
+    }
+
+    n = utf8_units(&c, len, encoding);
+    if (n < 0) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "string cannot be represented in encoding %s",
+            ndt_encoding_as_string(encoding));
+        return -1;
+    }
+
+    return n;
+}
+
+int
+ndt_utf8_check(const char *s, int64_t len, ndt_context_t *ctx)
+{
+    return ndt_utf8_length(s, len, Utf8, ctx) < 0 ? -1 : 0;
+}
+
+/*
+ * Set bit i in 'bitmap' if strings[i] is valid UTF-8 that fits into the
+ * fixed_string type 't' after transcoding.  If 'lengths' is NULL, the
+ * strings are NUL-terminated.  Return the number of fitting strings.
+ */
+int64_t
+ndt_fixed_string_fits(uint8_t *bitmap, const ndt_t *t,
+                      const char * const strings[], const int64_t lengths[],
+                      int64_t n, ndt_context_t *ctx)
+{
+    utf8_count_t c;
+    int64_t count = 0;
+
+    if (t->tag != FixedString) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "ndt_fixed_string_fits: expected fixed_string type");
+        return -1;
+    }
+
+    if (n < 0) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "ndt_fixed_string_fits: n must be a natural number");
+        return -1;
+    }
+
+    memset(bitmap, 0, (size_t)((n+7) / 8));
+
+    for (int64_t i = 0; i < n; i++) {
+        const char *s = strings[i];
+        int64_t len = lengths ? lengths[i] : (int64_t)strlen(s);
+        int64_t units;
+
+        if (len < 0 || utf8_scan(&c, (const unsigned char *)s, len) >= 0) {
+            continue;
+        }
+
+        units = utf8_units(&c, len, t->FixedString.encoding);
+        if (units >= 0 && units <= t->FixedString.size) {
+            bitmap[i/8] |= (uint8_t)(1U << (i%8));
+            count++;
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,546 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2017-2018, plures
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#include "ndtypes.h"
+#include "overflow.h"
+
+
+/*****************************************************************************/
+/*                                 Predicates                                */
+/*****************************************************************************/
+
+static inline bool
+is_foreign_endian(const ndt_t *t)
+{
+#if NDT_SYS_BIG_ENDIAN == 1
+    return t->flags & NDT_LITTLE_ENDIAN;
+#else
+    return t->flags & NDT_BIG_ENDIAN;
+#endif
+}
+
+/* Return true if any primitive in the inline data of 't' has an endian flag. */
+static bool
+has_endian_flags(const ndt_t *t)
+{
+    switch (t->tag) {
+    case FixedDim:
+        return has_endian_flags(t->FixedDim.type);
+    case VarDim: case VarDimElem:
+        return has_endian_flags(t->VarDim.type);
+    case Tuple:
+        for (int64_t i = 0; i < t->Tuple.shape; i++) {
+            if (has_endian_flags(t->Tuple.types[i])) {
+                return true;
+            }
+        }
+        return false;
+    case Record:
+        for (int64_t i = 0; i < t->Record.shape; i++) {
+            if (has_endian_flags(t->Record.types[i])) {
+                return true;
+            }
+        }
+        return false;
+    case Ref:
+        return has_endian_flags(t->Ref.type);
+    case Constr:
+        return has_endian_flags(t->Constr.type);
+    case Nominal:
+        return has_endian_flags(t->Nominal.type);
+    default:
+        return ndt_endian_is_set(t);
+    }
+}
+
+
+/*****************************************************************************/
+/*                          Native endian equivalent                         */
+/*****************************************************************************/
+
+static inline void
+copy_common(ndt_t *u, const ndt_t *t)
+{
+    u->access = t->access;
+    u->flags = t->flags;
+    u->ndim = t->ndim;
+    u->datasize = t->datasize;
+    u->align = t->align;
+}
+
+static const ndt_t *native_endian(const ndt_t *t, ndt_context_t *ctx);
+
+static const ndt_t *
+native_var_dim(const ndt_t *t, ndt_context_t *ctx)
+{
+    int32_t nslices = t->Concrete.VarDim.nslices;
+    ndt_slice_t *slices = NULL;
+    const ndt_t *type;
+    const ndt_t *u;
+
+    type = native_endian(t->VarDim.type, ctx);
+    if (type == NULL) {
+        return NULL;
+    }
+
+    if (nslices > 0) {
+        slices = ndt_alloc_slices(nslices);
+        if (slices == NULL) {
+            ndt_decref(type);
+            return ndt_memory_error(ctx);
+        }
+        memcpy(slices, t->Concrete.VarDim.slices, nslices * (sizeof *slices));
+    }
+
+    if (t->tag == VarDimElem) {
+        u = ndt_var_dim_elem(type, t->Concrete.VarDim.offsets, nslices, slices,
+                             t->VarDimElem.index, ctx);
+    }
+    else {
+        u = ndt_var_dim(type, t->Concrete.VarDim.offsets, nslices, slices,
+                        ndt_is_optional(t), ctx);
+    }
+    ndt_decref(type);
+
+    return u;
+}
+
+static const ndt_t *
+native_tuple(const ndt_t *t, ndt_context_t *ctx)
+{
+    ndt_t *u;
+
+    u = ndt_tuple_new(t->Tuple.flag, t->Tuple.shape, ndt_is_optional(t), ctx);
+    if (u == NULL) {
+        return NULL;
+    }
+    copy_common(u, t);
+
+    for (int64_t i = 0; i < t->Tuple.shape; i++) {
+        u->Tuple.types[i] = native_endian(t->Tuple.types[i], ctx);
+        if (u->Tuple.types[i] == NULL) {
+            ndt_decref(u);
+            return NULL;
+        }
+
+        u->Concrete.Tuple.offset[i] = t->Concrete.Tuple.offset[i];
+        u->Concrete.Tuple.align[i] = t->Concrete.Tuple.align[i];
+        u->Concrete.Tuple.pad[i] = t->Concrete.Tuple.pad[i];
+    }
+
+    return u;
+}
+
+static const ndt_t *
+native_record(const ndt_t *t, ndt_context_t *ctx)
+{
+    int64_t namesize = 0;
+    ndt_t *u;
+
+    for (int64_t i = 0; i < t->Record.shape; i++) {
+        namesize += (int64_t)strlen(t->Record.names[i]) + 1;
+    }
+
+    u = ndt_record_new(t->Record.flag, t->Record.shape, namesize,
+                       ndt_is_optional(t), ctx);
+    if (u == NULL) {
+        return NULL;
+    }
+    copy_common(u, t);
+
+    for (int64_t i = 0; i < t->Record.shape; i++) {
+        ndt_record_set_name(u, i, t->Record.names[i]);
+
+        u->Record.types[i] = native_endian(t->Record.types[i], ctx);
+        if (u->Record.types[i] == NULL) {
+            ndt_decref(u);
+            return NULL;
+        }
+
+        u->Concrete.Record.offset[i] = t->Concrete.Record.offset[i];
+        u->Concrete.Record.align[i] = t->Concrete.Record.align[i];
+        u->Concrete.Record.pad[i] = t->Concrete.Record.pad[i];
+    }
+
+    return u;
+}
+
+static const ndt_t *
+native_endian(const ndt_t *t, ndt_context_t *ctx)
+{
+    const ndt_t *type;
+    const ndt_t *u;
+
+    if (!has_endian_flags(t)) {
+        ndt_incref(t);
+        return t;
+    }
+
+    switch (t->tag) {
+    case FixedDim: {
+        type = native_endian(t->FixedDim.type, ctx);
+        if (type == NULL) {
+            return NULL;
+        }
+
+        if (t->Concrete.FixedDim.tile != 0) {
+            u = ndt_fixed_dim_tiled(type, t->FixedDim.shape,
+                                    t->Concrete.FixedDim.step,
+                                    t->Concrete.FixedDim.tile,
+                                    t->Concrete.FixedDim.tile_step, ctx);
+        }
+        else {
+            u = ndt_fixed_dim_tag(type, t->FixedDim.tag, t->FixedDim.shape,
+                                  t->Concrete.FixedDim.step, ctx);
+        }
+        ndt_decref(type);
+        return u;
+    }
+
+    case VarDim: case VarDimElem:
+        return native_var_dim(t, ctx);
+
+    case Tuple:
+        return native_tuple(t, ctx);
+
+    case Record:
+        return native_record(t, ctx);
+
+    case Ref: {
+        type = native_endian(t->Ref.type, ctx);
+        if (type == NULL) {
+            return NULL;
+        }
+
+        u = ndt_ref(type, ndt_is_optional(t), ctx);
+        ndt_decref(type);
+        return u;
+    }
+
+    case Constr: {
+        char *name;
+
+        type = native_endian(t->Constr.type, ctx);
+        if (type == NULL) {
+            return NULL;
+        }
+
+        name = ndt_strdup(t->Constr.name, ctx);
+        if (name == NULL) {
+            ndt_decref(type);
+            return NULL;
+        }
+
+        u = ndt_constr(name, type, ndt_is_optional(t), ctx);
+        ndt_decref(type);
+        return u;
+    }
+
+    /*
+     * The typedef for a nominal type fixes its byte order, so the native
+     * equivalent is the structural type.
+     */
+    case Nominal:
+        return native_endian(t->Nominal.type, ctx);
+
+    default:
+        return ndt_primitive(t->tag, t->flags & ~(NDT_LITTLE_ENDIAN|NDT_BIG_ENDIAN),
+                             ctx);
+    }
+}
+
+/*
+ * Return the equivalent of the concrete type 't' with all explicit byte order
+ * flags removed.  Memory layouts of 't' and the result are identical.  If 't'
+ * does not contain explicit byte order flags, 't' is returned with a new
+ * reference.
+ */
+const ndt_t *
+ndt_native_endian(const ndt_t *t, ndt_context_t *ctx)
+{
+    if (ndt_is_abstract(t)) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "native byte order conversion requires a concrete type");
+        return NULL;
+    }
+
+    return native_endian(t, ctx);
+}
+
+
+/*****************************************************************************/
+/*                              Byte swap plan                               */
+/*****************************************************************************/
+
+typedef struct {
+    int64_t nruns;
+    int64_t alloc;
+    ndt_swap_run_t *runs;
+} plan_t;
+
+static int
+plan_append(plan_t *p, int64_t offset, int64_t width, int64_t count,
+            int64_t stride, ndt_context_t *ctx)
+{
+    ndt_swap_run_t *r;
+
+    if (count == 1) {
+        stride = width;
+    }
+
+    /* Merge with the previous run if this run continues it. */
+    if (p->nruns > 0) {
+        r = &p->runs[p->nruns-1];
+        if (r->width == width) {
+            int64_t s = r->count > 1 ? r->stride : offset - r->offset;
+            if (s >= width && offset == r->offset + r->count * s &&
+                (count == 1 || stride == s)) {
+                r->stride = s;
+                r->count += count;
+                return 0;
+            }
+        }
+    }
+
+    if (p->nruns == p->alloc) {
+        int64_t alloc = p->alloc == 0 ? 8 : 2 * p->alloc;
+        ndt_swap_run_t *runs = ndt_realloc(p->runs, alloc, sizeof *runs);
+        if (runs == NULL) {
+            (void)ndt_memory_error(ctx);
+            return -1;
+        }
+        p->runs = runs;
+        p->alloc = alloc;
+    }
+
+    r = &p->runs[p->nruns++];
+    r->offset = offset;
+    r->width = width;
+    r->count = count;
+    r->stride = stride;
+
+    return 0;
+}
+
+static int swap_runs(plan_t *p, const ndt_t *t, int64_t offset, ndt_context_t *ctx);
+
+/*
+ * Repeat the runs of an element type 'n' times with a byte stride of 'step'.
+ * Single runs that cover the element contiguously are extended in place,
+ * otherwise the loop with the smaller number of runs is chosen.
+ */
+static int
+swap_runs_repeat(plan_t *p, const ndt_t *elem, int64_t offset, int64_t n,
+                 int64_t step, ndt_context_t *ctx)
+{
+    plan_t e = {0, 0, NULL};
+    bool overflow = 0;
+    int ret = 0;
+
+    if (n == 0) {
+        return 0;
+    }
+
+    /* Broadcast dimensions: every index refers to the same element. */
+    if (step == 0) {
+        n = 1;
+    }
+
+    if (swap_runs(&e, elem, 0, ctx) < 0) {
+        ndt_free(e.runs);
+        return -1;
+    }
+
+    for (int64_t i = 0; i < e.nruns && ret == 0; i++) {
+        const ndt_swap_run_t *r = &e.runs[i];
+
+        if (r->count == 1) {
+            ret = plan_append(p, offset+r->offset, r->width, n, step, ctx);
+        }
+        else if (r->count * r->stride == step) {
+            int64_t count = MULi64(r->count, n, &overflow);
+            ret = plan_append(p, offset+r->offset, r->width, count, r->stride, ctx);
+        }
+        else if (r->count <= n) {
+            for (int64_t k = 0; k < r->count && ret == 0; k++) {
+                ret = plan_append(p, offset+r->offset+k*r->stride, r->width, n, step, ctx);
+            }
+        }
+        else {
+            for (int64_t k = 0; k < n && ret == 0; k++) {
+                ret = plan_append(p, offset+r->offset+k*step, r->width, r->count, r->stride, ctx);
+            }
+        }
+    }
+
+    ndt_free(e.runs);
+
+    if (overflow) {
+        ndt_err_format(ctx, NDT_ValueError, "overflow in byte swap plan");
+        return -1;
+    }
+
+    return ret;
+}
+
+static int
+swap_runs(plan_t *p, const ndt_t *t, int64_t offset, ndt_context_t *ctx)
+{
+    if (!has_endian_flags(t)) {
+        return 0;
+    }
+
+    switch (t->tag) {
+    case FixedDim: {
+        const int64_t step = t->Concrete.FixedDim.step * t->Concrete.FixedDim.itemsize;
+        const int64_t tile = t->Concrete.FixedDim.tile;
+
+        if (tile != 0) {
+            /* One run group per tile. */
+            const int64_t tile_step = t->Concrete.FixedDim.tile_step * t->Concrete.FixedDim.itemsize;
+            for (int64_t j = 0; j < t->FixedDim.shape / tile; j++) {
+                if (swap_runs_repeat(p, t->FixedDim.type, offset+j*tile_step, tile,
+                                     step, ctx) < 0) {
+                    return -1;
+                }
+            }
+            return 0;
+        }
+
+        return swap_runs_repeat(p, t->FixedDim.type, offset, t->FixedDim.shape,
+                                step, ctx);
+    }
+
+    case VarDim: case VarDimElem: {
+        /* Var dimensions store the dtype data contiguously. */
+        const ndt_t *dtype = ndt_dtype(t);
+        if (dtype->datasize == 0) {
+            return 0;
+        }
+
+        return swap_runs_repeat(p, dtype, offset, t->datasize / dtype->datasize,
+                                dtype->datasize, ctx);
+    }
+
+    case Tuple:
+        for (int64_t i = 0; i < t->Tuple.shape; i++) {
+            if (swap_runs(p, t->Tuple.types[i], offset+t->Concrete.Tuple.offset[i], ctx) < 0) {
+                return -1;
+            }
+        }
+        return 0;
+
+    case Record:
+        for (int64_t i = 0; i < t->Record.shape; i++) {
+            if (swap_runs(p, t->Record.types[i], offset+t->Concrete.Record.offset[i], ctx) < 0) {
+                return -1;
+            }
+        }
+        return 0;
+
+    case Constr:
+        return swap_runs(p, t->Constr.type, offset, ctx);
+
+    case Nominal:
+        return swap_runs(p, t->Nominal.type, offset, ctx);
+
+    case Ref:
+        ndt_err_format(ctx, NDT_NotImplementedError,
+            "byte swap plan: data behind references is not supported");
+        return -1;
+
+    case Int16: case Int32: case Int64:
+    case Uint16: case Uint32: case Uint64:
+    case BFloat16: case Float16: case Float32: case Float64:
+        if (!is_foreign_endian(t)) {
+            return 0;
+        }
+        return plan_append(p, offset, t->datasize, 1, t->datasize, ctx);
+
+    case BComplex32: case Complex32: case Complex64: case Complex128:
+        if (!is_foreign_endian(t)) {
+            return 0;
+        }
+        return plan_append(p, offset, t->datasize/2, 2, t->datasize/2, ctx);
+
+    default:
+        return 0;
+    }
+}
+
+/*
+ * Compute the byte swap plan for converting data of the concrete type 't'
+ * from the byte order given by the type to native byte order.  Each run
+ * swaps 'count' elements of size 'width' at 'offset + k * stride'.  Offsets
+ * are relative to the data pointer of 't'.  Adjacent runs are merged across
+ * fields and dimensions.
+ */
+int
+ndt_swap_plan(ndt_swap_plan_t *plan, const ndt_t *t, ndt_context_t *ctx)
+{
+    plan_t p = {0, 0, NULL};
+
+    plan->nruns = 0;
+    plan->runs = NULL;
+
+    if (ndt_is_abstract(t)) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "byte swap plan requires a concrete type");
+        return -1;
+    }
+
+    if (swap_runs(&p, t, 0, ctx) < 0) {
+        ndt_free(p.runs);
+        return -1;
+    }
+
+    plan->nruns = p.nruns;
+    plan->runs = p.runs;
+
+    return 0;
+}
+
+void
+ndt_swap_plan_clear(ndt_swap_plan_t *plan)
+{
+    ndt_free(plan->runs);
+    plan->nruns = 0;
+    plan->runs = NULL;
+}
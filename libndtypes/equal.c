@@ -36,18 +36,20 @@
 #include <string.h>
 #include <assert.h>
 #include "ndtypes.h"
+#include "intern.h"
 
 
 /*****************************************************************************/
 /*                          Structural equality                              */
 /*****************************************************************************/
 
+/* The NDT_ALL_VALID hint is not part of the type identity. */
 static inline int
 ndt_common_equal(const ndt_t *t, const ndt_t *u)
 {
     return t->tag == u->tag &&
            t->access == u->access &&
-           t->flags == u->flags &&
+           ((t->flags ^ u->flags) & ~NDT_ALL_VALID) == 0 &&
            t->ndim == u->ndim &&
            t->datasize == u->datasize &&
            t->align == u->align;
@@ -158,6 +160,9 @@ categorical_equal(const ndt_value_t *t, const ndt_value_t *u, int64_t shape)
 static int
 offsets_equal(const ndt_offsets_t *x, const ndt_offsets_t *y)
 {
+    if (x == y) {
+        return 1;
+    }
     if (x == NULL) {
         return y == NULL;
     }
@@ -201,6 +206,8 @@ ndt_equal(const ndt_t *t, const ndt_t *u)
                t->FixedDim.shape == u->FixedDim.shape &&
                t->Concrete.FixedDim.itemsize == u->Concrete.FixedDim.itemsize &&
                t->Concrete.FixedDim.step == u->Concrete.FixedDim.step &&
+               t->Concrete.FixedDim.tile == u->Concrete.FixedDim.tile &&
+               t->Concrete.FixedDim.tile_step == u->Concrete.FixedDim.tile_step &&
                ndt_equal(t->FixedDim.type, u->FixedDim.type);
     }
 
@@ -229,7 +236,7 @@ ndt_equal(const ndt_t *t, const ndt_t *u)
 
     case SymbolicDim: {
         return t->SymbolicDim.tag == u->SymbolicDim.tag &&
-               strcmp(t->SymbolicDim.name, u->SymbolicDim.name) == 0 &&
+               symbol_equal(t->SymbolicDim.name, u->SymbolicDim.name) &&
                ndt_equal(t->SymbolicDim.type, u->SymbolicDim.type);
     }
 
@@ -243,7 +250,7 @@ ndt_equal(const ndt_t *t, const ndt_t *u)
         }
 
         if (t->EllipsisDim.name &&
-            strcmp(t->EllipsisDim.name, u->EllipsisDim.name) != 0) {
+            !symbol_equal(t->EllipsisDim.name, u->EllipsisDim.name)) {
             return 0;
         }
 
@@ -326,7 +333,7 @@ ndt_equal(const ndt_t *t, const ndt_t *u)
     }
 
     case Typevar: {
-        return strcmp(t->Typevar.name, u->Typevar.name) == 0;
+        return symbol_equal(t->Typevar.name, u->Typevar.name);
     }
 
     case AnyKind:
@@ -346,3 +353,44 @@ ndt_equal(const ndt_t *t, const ndt_t *u)
     /* NOT REACHED: tags should be exhaustive. */
     ndt_internal_error("invalid type");
 }
+
+/*
+ * Compare 't' with all types in 'types'.  Bit i of 'bitmap' (least significant
+ * bit first, (n+7)/8 bytes) is set if types[i] is equal to 't'.  Identical
+ * and repeated pointers are not compared again.  Return the number of equal
+ * types.
+ */
+int64_t
+ndt_equal_batch(uint8_t *bitmap, const ndt_t *t, const ndt_t * const types[],
+                int64_t n)
+{
+    int64_t count = 0;
+    int ret = 0;
+
+    if (n <= 0) {
+        return 0;
+    }
+
+    memset(bitmap, 0, (size_t)((n+7)/8));
+
+    for (int64_t i = 0; i < n; i++) {
+        const ndt_t *u = types[i];
+
+        if (i > 0 && u == types[i-1]) {
+            ; /* same result */
+        }
+        else if (u == t) {
+            ret = 1;
+        }
+        else {
+            ret = ndt_equal(t, u);
+        }
+
+        if (ret) {
+            bitmap[i/8] |= (uint8_t)(1U << (i%8));
+            count++;
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,532 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2017-2018, plures
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include "ndtypes.h"
+
+
+/******************************************************************************/
+/*                         Streaming MurmurHash3 (x64/128)                    */
+/******************************************************************************/
+
+/*
+ * Blocks are assembled from bytes in little endian order, so the result does
+ * not depend on the byte order of the host.
+ */
+typedef struct {
+    uint64_t h1;
+    uint64_t h2;
+    uint64_t len;
+    int ntail;
+    unsigned char tail[16];
+} fp_state_t;
+
+static const uint64_t c1 = 0x87c37b91114253d5ULL;
+static const uint64_t c2 = 0x4cf5ad432745937fULL;
+
+static inline uint64_t
+rotl64(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t
+fmix64(uint64_t k)
+{
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+static inline uint64_t
+load_le64(const unsigned char *p)
+{
+    uint64_t x = 0;
+
+    for (int i = 7; i >= 0; i--) {
+        x = (x << 8) | p[i];
+    }
+
+    return x;
+}
+
+static void
+fp_block(fp_state_t *st, const unsigned char *p)
+{
+    uint64_t k1 = load_le64(p);
+    uint64_t k2 = load_le64(p+8);
+
+    k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; st->h1 ^= k1;
+    st->h1 = rotl64(st->h1, 27); st->h1 += st->h2; st->h1 = st->h1*5+0x52dce729;
+
+    k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; st->h2 ^= k2;
+    st->h2 = rotl64(st->h2, 31); st->h2 += st->h1; st->h2 = st->h2*5+0x38495ab5;
+}
+
+static void
+fp_init(fp_state_t *st)
+{
+    st->h1 = st->h2 = 0;
+    st->len = 0;
+    st->ntail = 0;
+}
+
+static void
+fp_update(fp_state_t *st, const void *data, size_t n)
+{
+    const unsigned char *p = data;
+
+    st->len += n;
+
+    if (st->ntail > 0) {
+        while (n > 0 && st->ntail < 16) {
+            st->tail[st->ntail++] = *p++;
+            n--;
+        }
+        if (st->ntail < 16) {
+            return;
+        }
+        fp_block(st, st->tail);
+        st->ntail = 0;
+    }
+
+    for (; n >= 16; n -= 16, p += 16) {
+        fp_block(st, p);
+    }
+
+    memcpy(st->tail, p, n);
+    st->ntail = (int)n;
+}
+
+static void
+fp_final(ndt_fingerprint_t *fp, fp_state_t *st)
+{
+    const unsigned char *tail = st->tail;
+    uint64_t k1 = 0, k2 = 0;
+
+    switch (st->ntail) {
+    case 15: k2 ^= (uint64_t)tail[14] << 48; /* fall through */
+    case 14: k2 ^= (uint64_t)tail[13] << 40; /* fall through */
+    case 13: k2 ^= (uint64_t)tail[12] << 32; /* fall through */
+    case 12: k2 ^= (uint64_t)tail[11] << 24; /* fall through */
+    case 11: k2 ^= (uint64_t)tail[10] << 16; /* fall through */
+    case 10: k2 ^= (uint64_t)tail[9] << 8;   /* fall through */
+    case 9:  k2 ^= (uint64_t)tail[8];
+             k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; st->h2 ^= k2;
+             /* fall through */
+    case 8:  k1 ^= (uint64_t)tail[7] << 56;  /* fall through */
+    case 7:  k1 ^= (uint64_t)tail[6] << 48;  /* fall through */
+    case 6:  k1 ^= (uint64_t)tail[5] << 40;  /* fall through */
+    case 5:  k1 ^= (uint64_t)tail[4] << 32;  /* fall through */
+    case 4:  k1 ^= (uint64_t)tail[3] << 24;  /* fall through */
+    case 3:  k1 ^= (uint64_t)tail[2] << 16;  /* fall through */
+    case 2:  k1 ^= (uint64_t)tail[1] << 8;   /* fall through */
+    case 1:  k1 ^= (uint64_t)tail[0];
+             k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; st->h1 ^= k1;
+    }
+
+    st->h1 ^= st->len; st->h2 ^= st->len;
+    st->h1 += st->h2; st->h2 += st->h1;
+    st->h1 = fmix64(st->h1); st->h2 = fmix64(st->h2);
+    st->h1 += st->h2; st->h2 += st->h1;
+
+    fp->hi = st->h2;
+    fp->lo = st->h1;
+}
+
+
+/******************************************************************************/
+/*                             Canonical encoding                             */
+/******************************************************************************/
+
+static void
+put_u8(fp_state_t *st, uint8_t x)
+{
+    fp_update(st, &x, 1);
+}
+
+static void
+put_u64(fp_state_t *st, uint64_t x)
+{
+    unsigned char b[8];
+
+    for (int i = 0; i < 8; i++) {
+        b[i] = (unsigned char)(x >> (8*i));
+    }
+
+    fp_update(st, b, 8);
+}
+
+static void
+put_i64(fp_state_t *st, int64_t x)
+{
+    put_u64(st, (uint64_t)x);
+}
+
+static void
+put_string(fp_state_t *st, const char *s)
+{
+    if (s == NULL) {
+        put_u64(st, UINT64_MAX);
+        return;
+    }
+
+    size_t len = strlen(s);
+    put_u64(st, len);
+    fp_update(st, s, len);
+}
+
+static void
+put_value(fp_state_t *st, const ndt_value_t *v)
+{
+    put_u8(st, (uint8_t)v->tag);
+
+    switch (v->tag) {
+    case ValBool: put_u8(st, v->ValBool); return;
+    case ValInt64: put_i64(st, v->ValInt64); return;
+    case ValFloat64: {
+        uint64_t bits;
+        memcpy(&bits, &v->ValFloat64, sizeof bits);
+        put_u64(st, bits);
+        return;
+    }
+    case ValString: put_string(st, v->ValString); return;
+    case ValNA: return;
+    }
+
+    /* NOT REACHED: tags should be exhaustive. */
+    ndt_internal_error("invalid value tag");
+}
+
+static void encode(fp_state_t *st, const ndt_t *t, uint32_t flags);
+
+static void
+encode_types(fp_state_t *st, const ndt_t * const *types, int64_t n, uint32_t flags)
+{
+    put_i64(st, n);
+    for (int64_t i = 0; i < n; i++) {
+        encode(st, types[i], flags);
+    }
+}
+
+static void
+encode_fields(fp_state_t *st, const ndt_t *t, int64_t shape,
+              const int64_t *offset, const uint16_t *align, const uint16_t *pad)
+{
+    if (t->access != Concrete) {
+        return;
+    }
+
+    for (int64_t i = 0; i < shape; i++) {
+        put_i64(st, offset[i]);
+        put_u64(st, align[i]);
+        put_u64(st, pad[i]);
+    }
+}
+
+/* Concrete metadata is only included with NDT_FP_CONCRETE. */
+static void
+encode(fp_state_t *st, const ndt_t *t, uint32_t flags)
+{
+    const bool concrete = (flags & NDT_FP_CONCRETE) && t->access == Concrete;
+
+    put_u8(st, (uint8_t)t->tag);
+    put_u64(st, t->flags & (NDT_OPTION|NDT_LITTLE_ENDIAN|NDT_BIG_ENDIAN));
+    put_u8(st, concrete);
+
+    if (concrete) {
+        put_i64(st, t->datasize);
+        put_u64(st, t->align);
+    }
+
+    switch (t->tag) {
+    case Module:
+        put_string(st, t->Module.name);
+        encode(st, t->Module.type, flags);
+        return;
+
+    case Function:
+        put_u8(st, t->Function.elemwise);
+        put_i64(st, t->Function.nin);
+        put_i64(st, t->Function.nout);
+        encode_types(st, t->Function.types, t->Function.nargs, flags);
+        return;
+
+    case FixedDim:
+        put_u8(st, (uint8_t)t->FixedDim.tag);
+        put_i64(st, t->FixedDim.shape);
+        if (concrete) {
+            put_i64(st, t->Concrete.FixedDim.itemsize);
+            put_i64(st, t->Concrete.FixedDim.step);
+            if (t->Concrete.FixedDim.tile != 0) {
+                put_i64(st, t->Concrete.FixedDim.tile);
+                put_i64(st, t->Concrete.FixedDim.tile_step);
+            }
+        }
+        encode(st, t->FixedDim.type, flags);
+        return;
+
+    case VarDim: case VarDimElem: /* same layout */
+        if (t->tag == VarDimElem) {
+            put_i64(st, t->VarDimElem.index);
+        }
+        if (concrete) {
+            const ndt_offsets_t *offsets = t->Concrete.VarDim.offsets;
+            put_i64(st, t->Concrete.VarDim.itemsize);
+            put_i64(st, offsets->n);
+            for (int32_t i = 0; i < offsets->n; i++) {
+                put_i64(st, offsets->v[i]);
+            }
+            put_i64(st, t->Concrete.VarDim.nslices);
+            for (int i = 0; i < t->Concrete.VarDim.nslices; i++) {
+                put_i64(st, t->Concrete.VarDim.slices[i].start);
+                put_i64(st, t->Concrete.VarDim.slices[i].stop);
+                put_i64(st, t->Concrete.VarDim.slices[i].step);
+            }
+        }
+        encode(st, t->VarDim.type, flags);
+        return;
+
+    case SymbolicDim:
+        put_u8(st, (uint8_t)t->SymbolicDim.tag);
+        put_string(st, t->SymbolicDim.name);
+        encode(st, t->SymbolicDim.type, flags);
+        return;
+
+    case EllipsisDim:
+        put_u8(st, (uint8_t)t->EllipsisDim.tag);
+        put_string(st, t->EllipsisDim.name);
+        encode(st, t->EllipsisDim.type, flags);
+        return;
+
+    case Array:
+        encode(st, t->Array.type, flags);
+        return;
+
+    case Tuple:
+        put_u8(st, (uint8_t)t->Tuple.flag);
+        encode_types(st, t->Tuple.types, t->Tuple.shape, flags);
+        if (concrete) {
+            encode_fields(st, t, t->Tuple.shape, t->Concrete.Tuple.offset,
+                          t->Concrete.Tuple.align, t->Concrete.Tuple.pad);
+        }
+        return;
+
+    case Record:
+        put_u8(st, (uint8_t)t->Record.flag);
+        put_i64(st, t->Record.shape);
+        for (int64_t i = 0; i < t->Record.shape; i++) {
+            put_string(st, t->Record.names[i]);
+        }
+        encode_types(st, t->Record.types, t->Record.shape, flags);
+        if (concrete) {
+            encode_fields(st, t, t->Record.shape, t->Concrete.Record.offset,
+                          t->Concrete.Record.align, t->Concrete.Record.pad);
+        }
+        return;
+
+    case Union:
+        put_i64(st, t->Union.ntags);
+        for (int64_t i = 0; i < t->Union.ntags; i++) {
+            put_string(st, t->Union.tags[i]);
+        }
+        encode_types(st, t->Union.types, t->Union.ntags, flags);
+        return;
+
+    case Ref:
+        encode(st, t->Ref.type, flags);
+        return;
+
+    case Constr:
+        put_string(st, t->Constr.name);
+        encode(st, t->Constr.type, flags);
+        return;
+
+    case Nominal:
+        put_string(st, t->Nominal.name);
+        encode(st, t->Nominal.type, flags);
+        return;
+
+    case Categorical:
+        put_i64(st, t->Categorical.ntypes);
+        for (int64_t i = 0; i < t->Categorical.ntypes; i++) {
+            put_value(st, &t->Categorical.types[i]);
+        }
+        return;
+
+    case FixedString:
+        put_i64(st, t->FixedString.size);
+        put_u8(st, (uint8_t)t->FixedString.encoding);
+        return;
+
+    case FixedBytes:
+        put_i64(st, t->FixedBytes.size);
+        put_u64(st, t->FixedBytes.align);
+        return;
+
+    case Bytes:
+        put_u64(st, t->Bytes.target_align);
+        return;
+
+    case Char:
+        put_u8(st, (uint8_t)t->Char.encoding);
+        return;
+
+    case Typevar:
+        put_string(st, t->Typevar.name);
+        return;
+
+    case AnyKind: case ScalarKind:
+    case FixedStringKind: case FixedBytesKind:
+    case String: case Bool:
+    case SignedKind: case Int8: case Int16: case Int32: case Int64:
+    case UnsignedKind: case Uint8: case Uint16: case Uint32: case Uint64:
+    case FloatKind: case BFloat16: case Float16: case Float32: case Float64:
+    case ComplexKind: case BComplex32: case Complex32: case Complex64: case Complex128:
+        return;
+    }
+
+    /* NOT REACHED: tags should be exhaustive. */
+    ndt_internal_error("invalid tag");
+}
+
+static const ndt_t *
+next_dim(const ndt_t *t)
+{
+    assert(t->ndim > 0);
+
+    switch (t->tag) {
+    case FixedDim: return t->FixedDim.type;
+    case VarDim: return t->VarDim.type;
+    case VarDimElem: return t->VarDimElem.type;
+    case SymbolicDim: return t->SymbolicDim.type;
+    case EllipsisDim: return t->EllipsisDim.type;
+    case Array: return t->Array.type;
+    default:
+        /* NOT REACHED: tags should be exhaustive. */
+        ndt_internal_error("invalid value");
+    }
+}
+
+enum fp_domain {
+  DomainType,
+  DomainKernel
+};
+
+static void
+fp_start(fp_state_t *st, enum fp_domain domain, uint32_t flags)
+{
+    fp_init(st);
+    put_u64(st, NDT_FINGERPRINT_VERSION);
+    put_u8(st, (uint8_t)domain);
+    put_u64(st, flags);
+}
+
+
+/******************************************************************************/
+/*                                    API                                     */
+/******************************************************************************/
+
+/*
+ * Stable content fingerprint of 't'.  The result only depends on the type
+ * structure and NDT_FINGERPRINT_VERSION, not on pointer values or on the
+ * byte order of the host.
+ */
+int
+ndt_fingerprint(ndt_fingerprint_t *fp, const ndt_t *t, uint32_t flags,
+                ndt_context_t *ctx)
+{
+    fp_state_t st;
+
+    if (flags & ~NDT_FP_CONCRETE) {
+        ndt_err_format(ctx, NDT_ValueError, "invalid fingerprint flags");
+        return -1;
+    }
+
+    fp_start(&st, DomainType, flags);
+    encode(&st, t, flags);
+    fp_final(fp, &st);
+
+    return 0;
+}
+
+/*
+ * Key for a specialized kernel: the kernel strategy flags, the dimension
+ * kinds of each argument and the dtype layouts.  Shapes, steps and offsets
+ * are excluded, so the key is shared by all inputs that can use the kernel.
+ */
+int
+ndt_kernel_key(ndt_fingerprint_t *fp, const ndt_apply_spec_t *spec,
+               ndt_context_t *ctx)
+{
+    fp_state_t st;
+
+    if (spec->nargs < 0 || spec->nargs > NDT_MAX_ARGS ||
+        spec->nin < 0 || spec->nout < 0 || spec->nin + spec->nout != spec->nargs) {
+        ndt_err_format(ctx, NDT_ValueError, "invalid apply spec");
+        return -1;
+    }
+
+    fp_start(&st, DomainKernel, 0);
+    put_u64(&st, spec->flags);
+    put_i64(&st, spec->outer_dims);
+    put_i64(&st, spec->nin);
+    put_i64(&st, spec->nout);
+
+    for (int i = 0; i < spec->nargs; i++) {
+        const ndt_t *t = spec->types[i];
+
+        if (t == NULL) {
+            ndt_err_format(ctx, NDT_ValueError, "invalid apply spec");
+            return -1;
+        }
+
+        put_i64(&st, t->ndim);
+        for (; t->ndim > 0; t = next_dim(t)) {
+            put_u8(&st, (uint8_t)t->tag);
+        }
+        encode(&st, t, NDT_FP_CONCRETE);
+    }
+
+    fp_final(fp, &st);
+
+    return 0;
+}
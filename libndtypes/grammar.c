@@ -1,8 +1,8 @@
-/* A Bison parser, made by GNU Bison 3.3.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison implementation for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2019 Free Software Foundation,
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
    Inc.
 
    This program is free software: you can redistribute it and/or modify
@@ -16,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -34,6 +34,10 @@
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -41,14 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Undocumented macros, especially those whose name start with YY_,
-   are private implementation details.  Do not rely on them.  */
-
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "3.3"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -70,9 +71,8 @@
 #define yydebug         ndt_yydebug
 #define yynerrs         ndt_yynerrs
 
-
 /* First part of user prologue.  */
-#line 1 "grammar.y" /* yacc.c:337  */
+#line 1 "grammar.y"
 
 /*
  * BSD 3-Clause License
@@ -117,6 +117,11 @@ yyerror(YYLTYPE *loc, yyscan_t scanner, const ndt_t **ast, ndt_context_t *ctx,
     (void)scanner;
     (void)ast;
 
+    /* Keep the message of an exceeded resource limit. */
+    if (ctx->flags & NDT_LimitExceeded) {
+        return;
+    }
+
     ndt_err_format(ctx, NDT_ParseError, "%d:%d: %s", loc->first_line,
                    loc->first_column, msg);
 }
@@ -124,10 +129,43 @@ yyerror(YYLTYPE *loc, yyscan_t scanner, const ndt_t **ast, ndt_context_t *ctx,
 int
 yylex(YYSTYPE *val, YYLTYPE *loc, yyscan_t scanner, ndt_context_t *ctx)
 {
-    return ndt_yylexfunc(val, loc, scanner, ctx);
+    int token = ndt_yylexfunc(val, loc, scanner, ctx);
+
+    /*
+     * The nesting depth of a limited context is tracked by the brackets and
+     * by the tokens that nest the type that follows them: '&' and 'ref' of
+     * a reference and '*' of a dimension.  The constructors of references
+     * and dimensions decrement the depth again.
+     */
+    if (ctx->flags & NDT_Limited) {
+        switch (token) {
+        case LPAREN: case LBRACE: case LBRACK: case AMPERSAND: case REF: case STAR:
+            if (ndt_limit_depth(ctx, 1) < 0) {
+                return ERRTOKEN;
+            }
+            break;
+        case RPAREN: case RBRACE: case RBRACK:
+            (void)ndt_limit_depth(ctx, -1);
+            break;
+        default:
+            break;
+        }
+    }
+
+    return token;
 }
 
-#line 131 "grammar.c" /* yacc.c:337  */
+#line 159 "grammar.c"
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
 # ifndef YY_NULLPTR
 #  if defined __cplusplus
 #   if 201103L <= __cplusplus
@@ -140,200 +178,221 @@ yylex(YYSTYPE *val, YYLTYPE *loc, yyscan_t scanner, ndt_context_t *ctx)
 #  endif
 # endif
 
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 1
-#endif
-
-/* In a future release of Bison, this section will be replaced
-   by #include "grammar.h".  */
-#ifndef YY_NDT_YY_GRAMMAR_H_INCLUDED
-# define YY_NDT_YY_GRAMMAR_H_INCLUDED
-/* Debug traces.  */
-#ifndef YYDEBUG
-# define YYDEBUG 0
-#endif
-#if YYDEBUG
-extern int ndt_yydebug;
-#endif
-/* "%code requires" blocks.  */
-#line 56 "grammar.y" /* yacc.c:352  */
-
-  #include "ndtypes.h"
-  #include "seq.h"
-  #include "attr.h"
-  #include "parsefuncs.h"
-  #define YY_TYPEDEF_YY_SCANNER_T
-  typedef void * yyscan_t;
-
-#line 173 "grammar.c" /* yacc.c:352  */
-
-/* Token type.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-  enum yytokentype
-  {
-    ENDMARKER = 0,
-    ANY_KIND = 258,
-    SCALAR_KIND = 259,
-    VOID = 260,
-    BOOL = 261,
-    SIGNED_KIND = 262,
-    INT8 = 263,
-    INT16 = 264,
-    INT32 = 265,
-    INT64 = 266,
-    UNSIGNED_KIND = 267,
-    UINT8 = 268,
-    UINT16 = 269,
-    UINT32 = 270,
-    UINT64 = 271,
-    FLOAT_KIND = 272,
-    BFLOAT16 = 273,
-    FLOAT16 = 274,
-    FLOAT32 = 275,
-    FLOAT64 = 276,
-    COMPLEX_KIND = 277,
-    BCOMPLEX32 = 278,
-    COMPLEX32 = 279,
-    COMPLEX64 = 280,
-    COMPLEX128 = 281,
-    CATEGORICAL = 282,
-    NA = 283,
-    INTPTR = 284,
-    UINTPTR = 285,
-    SIZE = 286,
-    CHAR = 287,
-    STRING = 288,
-    FIXED_STRING_KIND = 289,
-    FIXED_STRING = 290,
-    BYTES = 291,
-    FIXED_BYTES_KIND = 292,
-    FIXED_BYTES = 293,
-    REF = 294,
-    FIXED = 295,
-    VAR = 296,
-    ARRAY = 297,
-    OF = 298,
-    COMMA = 299,
-    COLON = 300,
-    LPAREN = 301,
-    RPAREN = 302,
-    LBRACE = 303,
-    RBRACE = 304,
-    LBRACK = 305,
-    RBRACK = 306,
-    STAR = 307,
-    ELLIPSIS = 308,
-    RARROW = 309,
-    EQUAL = 310,
-    LESS = 311,
-    GREATER = 312,
-    QUESTIONMARK = 313,
-    BANG = 314,
-    AMPERSAND = 315,
-    BAR = 316,
-    ERRTOKEN = 317,
-    INTEGER = 318,
-    FLOATNUMBER = 319,
-    STRINGLIT = 320,
-    NAME_LOWER = 321,
-    NAME_UPPER = 322,
-    NAME_OTHER = 323,
-    BELOW_BAR = 324
-  };
-#endif
-
-/* Value type.  */
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-
-union YYSTYPE
-{
-#line 85 "grammar.y" /* yacc.c:352  */
-
-    const ndt_t *ndt;
-    enum ndt tag;
-    enum ndt_alias alias;
-    ndt_field_t *field;
-    ndt_field_seq_t *field_seq;
-    ndt_value_t *typed_value;
-    ndt_value_seq_t *typed_value_seq;
-    ndt_attr_t *attribute;
-    ndt_attr_seq_t *attribute_seq;
-    enum ndt_variadic variadic_flag;
-    enum ndt_encoding encoding;
-    uint32_t uint32;
-    char *string;
-    ndt_string_seq_t *string_seq;
-    ndt_type_seq_t *type_seq;
-
-#line 274 "grammar.c" /* yacc.c:352  */
-};
-
-typedef union YYSTYPE YYSTYPE;
-# define YYSTYPE_IS_TRIVIAL 1
-# define YYSTYPE_IS_DECLARED 1
-#endif
-
-/* Location type.  */
-#if ! defined YYLTYPE && ! defined YYLTYPE_IS_DECLARED
-typedef struct YYLTYPE YYLTYPE;
-struct YYLTYPE
+#include "grammar.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
 {
-  int first_line;
-  int first_column;
-  int last_line;
-  int last_column;
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_ANY_KIND = 3,                   /* ANY_KIND  */
+  YYSYMBOL_SCALAR_KIND = 4,                /* SCALAR_KIND  */
+  YYSYMBOL_VOID = 5,                       /* VOID  */
+  YYSYMBOL_BOOL = 6,                       /* BOOL  */
+  YYSYMBOL_SIGNED_KIND = 7,                /* SIGNED_KIND  */
+  YYSYMBOL_INT8 = 8,                       /* INT8  */
+  YYSYMBOL_INT16 = 9,                      /* INT16  */
+  YYSYMBOL_INT32 = 10,                     /* INT32  */
+  YYSYMBOL_INT64 = 11,                     /* INT64  */
+  YYSYMBOL_UNSIGNED_KIND = 12,             /* UNSIGNED_KIND  */
+  YYSYMBOL_UINT8 = 13,                     /* UINT8  */
+  YYSYMBOL_UINT16 = 14,                    /* UINT16  */
+  YYSYMBOL_UINT32 = 15,                    /* UINT32  */
+  YYSYMBOL_UINT64 = 16,                    /* UINT64  */
+  YYSYMBOL_FLOAT_KIND = 17,                /* FLOAT_KIND  */
+  YYSYMBOL_BFLOAT16 = 18,                  /* BFLOAT16  */
+  YYSYMBOL_FLOAT16 = 19,                   /* FLOAT16  */
+  YYSYMBOL_FLOAT32 = 20,                   /* FLOAT32  */
+  YYSYMBOL_FLOAT64 = 21,                   /* FLOAT64  */
+  YYSYMBOL_COMPLEX_KIND = 22,              /* COMPLEX_KIND  */
+  YYSYMBOL_BCOMPLEX32 = 23,                /* BCOMPLEX32  */
+  YYSYMBOL_COMPLEX32 = 24,                 /* COMPLEX32  */
+  YYSYMBOL_COMPLEX64 = 25,                 /* COMPLEX64  */
+  YYSYMBOL_COMPLEX128 = 26,                /* COMPLEX128  */
+  YYSYMBOL_CATEGORICAL = 27,               /* CATEGORICAL  */
+  YYSYMBOL_NA = 28,                        /* NA  */
+  YYSYMBOL_INTPTR = 29,                    /* INTPTR  */
+  YYSYMBOL_UINTPTR = 30,                   /* UINTPTR  */
+  YYSYMBOL_SIZE = 31,                      /* SIZE  */
+  YYSYMBOL_CHAR = 32,                      /* CHAR  */
+  YYSYMBOL_STRING = 33,                    /* STRING  */
+  YYSYMBOL_FIXED_STRING_KIND = 34,         /* FIXED_STRING_KIND  */
+  YYSYMBOL_FIXED_STRING = 35,              /* FIXED_STRING  */
+  YYSYMBOL_BYTES = 36,                     /* BYTES  */
+  YYSYMBOL_FIXED_BYTES_KIND = 37,          /* FIXED_BYTES_KIND  */
+  YYSYMBOL_FIXED_BYTES = 38,               /* FIXED_BYTES  */
+  YYSYMBOL_REF = 39,                       /* REF  */
+  YYSYMBOL_FIXED = 40,                     /* FIXED  */
+  YYSYMBOL_VAR = 41,                       /* VAR  */
+  YYSYMBOL_ARRAY = 42,                     /* ARRAY  */
+  YYSYMBOL_OF = 43,                        /* OF  */
+  YYSYMBOL_COMMA = 44,                     /* COMMA  */
+  YYSYMBOL_COLON = 45,                     /* COLON  */
+  YYSYMBOL_LPAREN = 46,                    /* LPAREN  */
+  YYSYMBOL_RPAREN = 47,                    /* RPAREN  */
+  YYSYMBOL_LBRACE = 48,                    /* LBRACE  */
+  YYSYMBOL_RBRACE = 49,                    /* RBRACE  */
+  YYSYMBOL_LBRACK = 50,                    /* LBRACK  */
+  YYSYMBOL_RBRACK = 51,                    /* RBRACK  */
+  YYSYMBOL_STAR = 52,                      /* STAR  */
+  YYSYMBOL_ELLIPSIS = 53,                  /* ELLIPSIS  */
+  YYSYMBOL_RARROW = 54,                    /* RARROW  */
+  YYSYMBOL_EQUAL = 55,                     /* EQUAL  */
+  YYSYMBOL_LESS = 56,                      /* LESS  */
+  YYSYMBOL_GREATER = 57,                   /* GREATER  */
+  YYSYMBOL_QUESTIONMARK = 58,              /* QUESTIONMARK  */
+  YYSYMBOL_BANG = 59,                      /* BANG  */
+  YYSYMBOL_AMPERSAND = 60,                 /* AMPERSAND  */
+  YYSYMBOL_BAR = 61,                       /* BAR  */
+  YYSYMBOL_ERRTOKEN = 62,                  /* ERRTOKEN  */
+  YYSYMBOL_INTEGER = 63,                   /* INTEGER  */
+  YYSYMBOL_FLOATNUMBER = 64,               /* FLOATNUMBER  */
+  YYSYMBOL_STRINGLIT = 65,                 /* STRINGLIT  */
+  YYSYMBOL_NAME_LOWER = 66,                /* NAME_LOWER  */
+  YYSYMBOL_NAME_UPPER = 67,                /* NAME_UPPER  */
+  YYSYMBOL_NAME_OTHER = 68,                /* NAME_OTHER  */
+  YYSYMBOL_BELOW_BAR = 69,                 /* BELOW_BAR  */
+  YYSYMBOL_YYACCEPT = 70,                  /* $accept  */
+  YYSYMBOL_input = 71,                     /* input  */
+  YYSYMBOL_datashape_or_module = 72,       /* datashape_or_module  */
+  YYSYMBOL_datashape_with_ellipsis = 73,   /* datashape_with_ellipsis  */
+  YYSYMBOL_fixed_ellipsis = 74,            /* fixed_ellipsis  */
+  YYSYMBOL_datashape = 75,                 /* datashape  */
+  YYSYMBOL_dimensions = 76,                /* dimensions  */
+  YYSYMBOL_dimensions_nooption = 77,       /* dimensions_nooption  */
+  YYSYMBOL_dimensions_tail = 78,           /* dimensions_tail  */
+  YYSYMBOL_dtype = 79,                     /* dtype  */
+  YYSYMBOL_scalar = 80,                    /* scalar  */
+  YYSYMBOL_signed = 81,                    /* signed  */
+  YYSYMBOL_unsigned = 82,                  /* unsigned  */
+  YYSYMBOL_ieee_float = 83,                /* ieee_float  */
+  YYSYMBOL_ieee_complex = 84,              /* ieee_complex  */
+  YYSYMBOL_alias = 85,                     /* alias  */
+  YYSYMBOL_character = 86,                 /* character  */
+  YYSYMBOL_string = 87,                    /* string  */
+  YYSYMBOL_fixed_string = 88,              /* fixed_string  */
+  YYSYMBOL_flags_opt = 89,                 /* flags_opt  */
+  YYSYMBOL_option_opt = 90,                /* option_opt  */
+  YYSYMBOL_endian_opt = 91,                /* endian_opt  */
+  YYSYMBOL_encoding = 92,                  /* encoding  */
+  YYSYMBOL_bytes = 93,                     /* bytes  */
+  YYSYMBOL_fixed_bytes = 94,               /* fixed_bytes  */
+  YYSYMBOL_ref = 95,                       /* ref  */
+  YYSYMBOL_categorical = 96,               /* categorical  */
+  YYSYMBOL_typed_value_seq = 97,           /* typed_value_seq  */
+  YYSYMBOL_typed_value = 98,               /* typed_value  */
+  YYSYMBOL_variadic_flag = 99,             /* variadic_flag  */
+  YYSYMBOL_comma_variadic_flag = 100,      /* comma_variadic_flag  */
+  YYSYMBOL_tuple_type = 101,               /* tuple_type  */
+  YYSYMBOL_tuple_field_seq = 102,          /* tuple_field_seq  */
+  YYSYMBOL_tuple_field = 103,              /* tuple_field  */
+  YYSYMBOL_record_type = 104,              /* record_type  */
+  YYSYMBOL_record_field_seq = 105,         /* record_field_seq  */
+  YYSYMBOL_record_field = 106,             /* record_field  */
+  YYSYMBOL_field_name_or_tag = 107,        /* field_name_or_tag  */
+  YYSYMBOL_union_type = 108,               /* union_type  */
+  YYSYMBOL_union_member_seq = 109,         /* union_member_seq  */
+  YYSYMBOL_union_member = 110,             /* union_member  */
+  YYSYMBOL_arguments_opt = 111,            /* arguments_opt  */
+  YYSYMBOL_attribute_seq = 112,            /* attribute_seq  */
+  YYSYMBOL_attribute = 113,                /* attribute  */
+  YYSYMBOL_untyped_value_seq = 114,        /* untyped_value_seq  */
+  YYSYMBOL_untyped_value = 115,            /* untyped_value  */
+  YYSYMBOL_function_type = 116,            /* function_type  */
+  YYSYMBOL_type_seq_or_void = 117,         /* type_seq_or_void  */
+  YYSYMBOL_type_seq = 118                  /* type_seq  */
 };
-# define YYLTYPE_IS_DECLARED 1
-# define YYLTYPE_IS_TRIVIAL 1
-#endif
+typedef enum yysymbol_kind_t yysymbol_kind_t;
 
 
 
-int ndt_yyparse (yyscan_t scanner, const ndt_t **ast, ndt_context_t *ctx);
-/* "%code provides" blocks.  */
-#line 65 "grammar.y" /* yacc.c:352  */
 
-  #define YY_DECL extern int ndt_yylexfunc(YYSTYPE *yylval_param, YYLTYPE *yylloc_param, yyscan_t yyscanner, ndt_context_t *ctx)
-  extern int ndt_yylexfunc(YYSTYPE *, YYLTYPE *, yyscan_t, ndt_context_t *);
-  void yyerror(YYLTYPE *loc, yyscan_t scanner, const ndt_t **ast, ndt_context_t *ctx, const char *msg);
-
-#line 306 "grammar.c" /* yacc.c:352  */
+#ifdef short
+# undef short
+#endif
 
-#endif /* !YY_NDT_YY_GRAMMAR_H_INCLUDED  */
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
 
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
 
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
 
-#ifdef short
-# undef short
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
 #else
-typedef unsigned char yytype_uint8;
+typedef short yytype_int16;
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
-#else
-typedef signed char yytype_int8;
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -341,7 +400,7 @@ typedef short yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
@@ -349,7 +408,20 @@ typedef short yytype_int16;
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int16 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
 # if defined YYENABLE_NLS && YYENABLE_NLS
@@ -363,38 +435,43 @@ typedef short yytype_int16;
 # endif
 #endif
 
-#ifndef YY_ATTRIBUTE
-# if (defined __GNUC__                                               \
-      && (2 < __GNUC__ || (__GNUC__ == 2 && 96 <= __GNUC_MINOR__)))  \
-     || defined __SUNPRO_C && 0x5110 <= __SUNPRO_C
-#  define YY_ATTRIBUTE(Spec) __attribute__(Spec)
-# else
-#  define YY_ATTRIBUTE(Spec) /* empty */
-# endif
-#endif
 
 #ifndef YY_ATTRIBUTE_PURE
-# define YY_ATTRIBUTE_PURE   YY_ATTRIBUTE ((__pure__))
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
 #endif
 
 #ifndef YY_ATTRIBUTE_UNUSED
-# define YY_ATTRIBUTE_UNUSED YY_ATTRIBUTE ((__unused__))
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
 #endif
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(E) ((void) (E))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(E) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-#if defined __GNUC__ && ! defined __ICC && 407 <= __GNUC__ * 100 + __GNUC_MINOR__
 /* Suppress an incorrect diagnostic about yylval being uninitialized.  */
-# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN \
-    _Pragma ("GCC diagnostic push") \
-    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")\
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
     _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
-# define YY_IGNORE_MAYBE_UNINITIALIZED_END \
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
     _Pragma ("GCC diagnostic pop")
 #else
 # define YY_INITIAL_VALUE(Value) Value
@@ -407,8 +484,22 @@ typedef short yytype_int16;
 # define YY_INITIAL_VALUE(Value) /* Nothing. */
 #endif
 
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if 1
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -473,8 +564,7 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* 1 */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
@@ -484,18 +574,19 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss_alloc;
+  yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
   YYLTYPE yyls_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE) + sizeof (YYLTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE) \
+             + YYSIZEOF (YYLTYPE)) \
       + 2 * YYSTACK_GAP_MAXIMUM)
 
 # define YYCOPY_NEEDED 1
@@ -508,11 +599,11 @@ union yyalloc
 # define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
     do                                                                  \
       {                                                                 \
-        YYSIZE_T yynewbytes;                                            \
+        YYPTRDIFF_T yynewbytes;                                         \
         YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
         Stack = &yyptr->Stack_alloc;                                    \
-        yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-        yyptr += yynewbytes / sizeof (*yyptr);                          \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
       }                                                                 \
     while (0)
 
@@ -524,12 +615,12 @@ union yyalloc
 # ifndef YYCOPY
 #  if defined __GNUC__ && 1 < __GNUC__
 #   define YYCOPY(Dst, Src, Count) \
-      __builtin_memcpy (Dst, Src, (Count) * sizeof (*(Src)))
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
 #  else
 #   define YYCOPY(Dst, Src, Count)              \
       do                                        \
         {                                       \
-          YYSIZE_T yyi;                         \
+          YYPTRDIFF_T yyi;                      \
           for (yyi = 0; yyi < (Count); yyi++)   \
             (Dst)[yyi] = (Src)[yyi];            \
         }                                       \
@@ -552,17 +643,20 @@ union yyalloc
 /* YYNSTATES -- Number of states.  */
 #define YYNSTATES  266
 
-#define YYUNDEFTOK  2
+/* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   324
 
+
 /* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
    as returned by yylex, with out-of-bounds checking.  */
-#define YYTRANSLATE(YYX)                                                \
-  ((unsigned) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
 
 /* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
    as returned by yylex.  */
-static const yytype_uint8 yytranslate[] =
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -600,86 +694,84 @@ static const yytype_uint8 yytranslate[] =
 };
 
 #if YYDEBUG
-  /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
-static const yytype_uint16 yyrline[] =
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
 {
-       0,   212,   212,   216,   217,   218,   222,   223,   224,   225,
-     226,   229,   230,   233,   234,   237,   238,   239,   242,   243,
-     244,   245,   246,   247,   248,   251,   252,   255,   256,   257,
-     258,   259,   260,   261,   262,   263,   264,   265,   268,   269,
-     270,   271,   272,   273,   274,   275,   276,   277,   278,   279,
-     280,   281,   282,   283,   284,   285,   286,   287,   288,   291,
-     292,   293,   294,   297,   298,   299,   300,   303,   304,   305,
-     308,   309,   310,   314,   315,   316,   319,   320,   323,   326,
-     327,   330,   333,   334,   337,   338,   339,   340,   341,   344,
-     347,   350,   353,   354,   357,   360,   361,   364,   365,   366,
-     367,   370,   371,   374,   375,   376,   379,   380,   381,   382,
-     383,   384,   387,   388,   391,   392,   395,   396,   397,   398,
-     399,   400,   403,   404,   407,   408,   411,   412,   413,   416,
-     417,   418,   419,   422,   423,   426,   429,   430,   433,   434,
-     437,   438,   441,   442,   445,   446,   447,   450,   453,   454,
-     457,   458
+       0,   244,   244,   248,   249,   250,   254,   255,   256,   257,
+     258,   261,   262,   265,   266,   269,   270,   271,   274,   275,
+     276,   277,   278,   279,   280,   283,   284,   287,   288,   289,
+     290,   291,   292,   293,   294,   295,   296,   297,   300,   301,
+     302,   303,   304,   305,   306,   307,   308,   309,   310,   311,
+     312,   313,   314,   315,   316,   317,   318,   319,   320,   323,
+     324,   325,   326,   329,   330,   331,   332,   335,   336,   337,
+     340,   341,   342,   346,   347,   348,   351,   352,   355,   358,
+     359,   362,   365,   366,   369,   370,   371,   372,   373,   376,
+     379,   382,   385,   386,   389,   392,   393,   396,   397,   398,
+     399,   402,   403,   406,   407,   408,   411,   412,   413,   414,
+     415,   416,   419,   420,   423,   424,   427,   428,   429,   430,
+     431,   432,   435,   436,   439,   440,   443,   444,   445,   448,
+     449,   450,   451,   454,   455,   458,   461,   462,   465,   466,
+     469,   470,   473,   474,   477,   478,   479,   482,   485,   486,
+     489,   490
 };
 #endif
 
-#if YYDEBUG || YYERROR_VERBOSE || 1
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if 1
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "\"end of file\"", "error", "$undefined", "ANY_KIND", "SCALAR_KIND",
-  "VOID", "BOOL", "SIGNED_KIND", "INT8", "INT16", "INT32", "INT64",
-  "UNSIGNED_KIND", "UINT8", "UINT16", "UINT32", "UINT64", "FLOAT_KIND",
-  "BFLOAT16", "FLOAT16", "FLOAT32", "FLOAT64", "COMPLEX_KIND",
-  "BCOMPLEX32", "COMPLEX32", "COMPLEX64", "COMPLEX128", "CATEGORICAL",
-  "NA", "INTPTR", "UINTPTR", "SIZE", "CHAR", "STRING", "FIXED_STRING_KIND",
-  "FIXED_STRING", "BYTES", "FIXED_BYTES_KIND", "FIXED_BYTES", "REF",
-  "FIXED", "VAR", "ARRAY", "OF", "COMMA", "COLON", "LPAREN", "RPAREN",
-  "LBRACE", "RBRACE", "LBRACK", "RBRACK", "STAR", "ELLIPSIS", "RARROW",
-  "EQUAL", "LESS", "GREATER", "QUESTIONMARK", "BANG", "AMPERSAND", "BAR",
-  "ERRTOKEN", "INTEGER", "FLOATNUMBER", "STRINGLIT", "NAME_LOWER",
-  "NAME_UPPER", "NAME_OTHER", "BELOW_BAR", "$accept", "input",
-  "datashape_or_module", "datashape_with_ellipsis", "fixed_ellipsis",
-  "datashape", "dimensions", "dimensions_nooption", "dimensions_tail",
-  "dtype", "scalar", "signed", "unsigned", "ieee_float", "ieee_complex",
-  "alias", "character", "string", "fixed_string", "flags_opt",
-  "option_opt", "endian_opt", "encoding", "bytes", "fixed_bytes", "ref",
-  "categorical", "typed_value_seq", "typed_value", "variadic_flag",
-  "comma_variadic_flag", "tuple_type", "tuple_field_seq", "tuple_field",
-  "record_type", "record_field_seq", "record_field", "field_name_or_tag",
-  "union_type", "union_member_seq", "union_member", "arguments_opt",
-  "attribute_seq", "attribute", "untyped_value_seq", "untyped_value",
-  "function_type", "type_seq_or_void", "type_seq", YY_NULLPTR
+  "\"end of file\"", "error", "\"invalid token\"", "ANY_KIND",
+  "SCALAR_KIND", "VOID", "BOOL", "SIGNED_KIND", "INT8", "INT16", "INT32",
+  "INT64", "UNSIGNED_KIND", "UINT8", "UINT16", "UINT32", "UINT64",
+  "FLOAT_KIND", "BFLOAT16", "FLOAT16", "FLOAT32", "FLOAT64",
+  "COMPLEX_KIND", "BCOMPLEX32", "COMPLEX32", "COMPLEX64", "COMPLEX128",
+  "CATEGORICAL", "NA", "INTPTR", "UINTPTR", "SIZE", "CHAR", "STRING",
+  "FIXED_STRING_KIND", "FIXED_STRING", "BYTES", "FIXED_BYTES_KIND",
+  "FIXED_BYTES", "REF", "FIXED", "VAR", "ARRAY", "OF", "COMMA", "COLON",
+  "LPAREN", "RPAREN", "LBRACE", "RBRACE", "LBRACK", "RBRACK", "STAR",
+  "ELLIPSIS", "RARROW", "EQUAL", "LESS", "GREATER", "QUESTIONMARK", "BANG",
+  "AMPERSAND", "BAR", "ERRTOKEN", "INTEGER", "FLOATNUMBER", "STRINGLIT",
+  "NAME_LOWER", "NAME_UPPER", "NAME_OTHER", "BELOW_BAR", "$accept",
+  "input", "datashape_or_module", "datashape_with_ellipsis",
+  "fixed_ellipsis", "datashape", "dimensions", "dimensions_nooption",
+  "dimensions_tail", "dtype", "scalar", "signed", "unsigned", "ieee_float",
+  "ieee_complex", "alias", "character", "string", "fixed_string",
+  "flags_opt", "option_opt", "endian_opt", "encoding", "bytes",
+  "fixed_bytes", "ref", "categorical", "typed_value_seq", "typed_value",
+  "variadic_flag", "comma_variadic_flag", "tuple_type", "tuple_field_seq",
+  "tuple_field", "record_type", "record_field_seq", "record_field",
+  "field_name_or_tag", "union_type", "union_member_seq", "union_member",
+  "arguments_opt", "attribute_seq", "attribute", "untyped_value_seq",
+  "untyped_value", "function_type", "type_seq_or_void", "type_seq", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[NUM] -- (External) token number corresponding to the
-   (internal) symbol number NUM (which must be that of a token).  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286,   287,   288,   289,   290,   291,   292,   293,   294,
-     295,   296,   297,   298,   299,   300,   301,   302,   303,   304,
-     305,   306,   307,   308,   309,   310,   311,   312,   313,   314,
-     315,   316,   317,   318,   319,   320,   321,   322,   323,   324
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
-#define YYPACT_NINF -224
+#define YYPACT_NINF (-224)
 
-#define yypact_value_is_default(Yystate) \
-  (!!((Yystate) == (-224)))
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
 
-#define YYTABLE_NINF -128
+#define YYTABLE_NINF (-128)
 
-#define yytable_value_is_error(Yytable_value) \
+#define yytable_value_is_error(Yyn) \
   0
 
-  /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-     STATE-NUM.  */
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
      115,  -224,    -6,   -23,   118,   180,    20,    15,    12,   237,
@@ -711,9 +803,9 @@ static const yytype_int16 yypact[] =
      261,   145,  -224,  -224,  -224,  -224
 };
 
-  /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
-     Performed when YYTABLE does not specify something else to do.  Zero
-     means the default is an error.  */
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
 static const yytype_uint8 yydefact[] =
 {
       82,   149,     0,   136,     0,    82,   101,     0,     0,    83,
@@ -745,7 +837,7 @@ static const yytype_uint8 yydefact[] =
        0,     0,   141,   125,    80,   143
 };
 
-  /* YYPGOTO[NTERM-NUM].  */
+/* YYPGOTO[NTERM-NUM].  */
 static const yytype_int16 yypgoto[] =
 {
     -224,  -224,  -224,  -118,   220,    -3,   -10,  -224,   -58,   -59,
@@ -755,19 +847,19 @@ static const yytype_int16 yypgoto[] =
      212,   -52,   -40,   164,  -224,  -223,  -224,   184,  -224
 };
 
-  /* YYDEFGOTO[NTERM-NUM].  */
-static const yytype_int16 yydefgoto[] =
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_uint8 yydefgoto[] =
 {
-      -1,    15,    16,    17,    18,    19,    20,    21,   152,    22,
+       0,    15,    16,    17,    18,    19,    20,    21,   152,    22,
       23,   107,   108,   109,   110,   111,    24,    25,    26,    27,
       28,   128,   225,    29,    30,    31,    32,   222,   223,    53,
      145,    33,    54,    55,    34,    59,    60,    35,    36,    37,
       38,    45,   134,   135,   253,   233,    39,    40,    41
 };
 
-  /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
-     positive, shift that token.  If negative, reduce the rule whose
-     number is the opposite.  If YYTABLE_NINF, syntax error.  */
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_int16 yytable[] =
 {
       74,    61,    52,   136,   153,    62,   254,    71,   148,   195,
@@ -852,9 +944,9 @@ static const yytype_int16 yycheck[] =
       50,    -1,    52
 };
 
-  /* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-     symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
        0,     5,    40,    41,    42,    46,    48,    50,    53,    58,
       59,    63,    66,    67,    68,    71,    72,    73,    74,    75,
@@ -885,8 +977,8 @@ static const yytype_uint8 yystos[] =
       92,    44,    51,    61,    47,   115
 };
 
-  /* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
 {
        0,    70,    71,    72,    72,    72,    73,    73,    73,    73,
       73,    74,    74,    75,    75,    76,    76,    76,    77,    77,
@@ -906,8 +998,8 @@ static const yytype_uint8 yyr1[] =
      118,   118
 };
 
-  /* YYR2[YYN] -- Number of symbols on the right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
 {
        0,     2,     2,     1,     1,     4,     1,     1,     4,     4,
        4,     3,     4,     1,     1,     1,     4,     2,     3,     6,
@@ -928,14 +1020,15 @@ static const yytype_uint8 yyr2[] =
 };
 
 
+enum { YYENOMEM = -2 };
+
 #define yyerrok         (yyerrstatus = 0)
 #define yyclearin       (yychar = YYEMPTY)
-#define YYEMPTY         (-2)
-#define YYEOF           0
 
 #define YYACCEPT        goto yyacceptlab
 #define YYABORT         goto yyabortlab
 #define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
 
 #define YYRECOVERING()  (!!yyerrstatus)
@@ -957,10 +1050,9 @@ static const yytype_uint8 yyr2[] =
       }                                                           \
   while (0)
 
-/* Error token number */
-#define YYTERROR        1
-#define YYERRCODE       256
-
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
 /* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
    If N is 0, then set CURRENT to the empty location which ends
@@ -1004,12 +1096,19 @@ do {                                            \
 } while (0)
 
 
-/* YY_LOCATION_PRINT -- Print the location on the stream.
+/* YYLOCATION_PRINT -- Print the location on the stream.
    This macro was not mandated originally: define only if we know
    we won't break user code: when these are the locations we know.  */
 
-#ifndef YY_LOCATION_PRINT
-# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+# ifndef YYLOCATION_PRINT
+
+#  if defined YY_LOCATION_PRINT
+
+   /* Temporary convenience wrapper in case some people defined the
+      undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YYLOCATION_PRINT(File, Loc)  YY_LOCATION_PRINT(File, *(Loc))
+
+#  elif defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
 
 /* Print *YYLOCP on YYO.  Private, do not rely on its existence. */
 
@@ -1037,24 +1136,32 @@ yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
         res += YYFPRINTF (yyo, "-%d", end_col);
     }
   return res;
- }
+}
 
-#  define YY_LOCATION_PRINT(File, Loc)          \
-  yy_location_print_ (File, &(Loc))
+#   define YYLOCATION_PRINT  yy_location_print_
 
-# else
-#  define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-# endif
-#endif
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT(File, Loc)  YYLOCATION_PRINT(File, &(Loc))
+
+#  else
+
+#   define YYLOCATION_PRINT(File, Loc) ((void) 0)
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT  YYLOCATION_PRINT
+
+#  endif
+# endif /* !defined YYLOCATION_PRINT */
 
 
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)                    \
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
 do {                                                                      \
   if (yydebug)                                                            \
     {                                                                     \
       YYFPRINTF (stderr, "%s ", Title);                                   \
       yy_symbol_print (stderr,                                            \
-                  Type, Value, Location, scanner, ast, ctx); \
+                  Kind, Value, Location, scanner, ast, ctx); \
       YYFPRINTF (stderr, "\n");                                           \
     }                                                                     \
 } while (0)
@@ -1065,21 +1172,20 @@ do {                                                                      \
 `-----------------------------------*/
 
 static void
-yy_symbol_value_print (FILE *yyo, int yytype, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, yyscan_t scanner, const ndt_t **ast, ndt_context_t *ctx)
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, yyscan_t scanner, const ndt_t **ast, ndt_context_t *ctx)
 {
   FILE *yyoutput = yyo;
-  YYUSE (yyoutput);
-  YYUSE (yylocationp);
-  YYUSE (scanner);
-  YYUSE (ast);
-  YYUSE (ctx);
+  YY_USE (yyoutput);
+  YY_USE (yylocationp);
+  YY_USE (scanner);
+  YY_USE (ast);
+  YY_USE (ctx);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyo, yytoknum[yytype], *yyvaluep);
-# endif
-  YYUSE (yytype);
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
@@ -1088,14 +1194,15 @@ yy_symbol_value_print (FILE *yyo, int yytype, YYSTYPE const * const yyvaluep, YY
 `---------------------------*/
 
 static void
-yy_symbol_print (FILE *yyo, int yytype, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, yyscan_t scanner, const ndt_t **ast, ndt_context_t *ctx)
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, yyscan_t scanner, const ndt_t **ast, ndt_context_t *ctx)
 {
   YYFPRINTF (yyo, "%s %s (",
-             yytype < YYNTOKENS ? "token" : "nterm", yytname[yytype]);
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  YY_LOCATION_PRINT (yyo, *yylocationp);
+  YYLOCATION_PRINT (yyo, yylocationp);
   YYFPRINTF (yyo, ": ");
-  yy_symbol_value_print (yyo, yytype, yyvaluep, yylocationp, scanner, ast, ctx);
+  yy_symbol_value_print (yyo, yykind, yyvaluep, yylocationp, scanner, ast, ctx);
   YYFPRINTF (yyo, ")");
 }
 
@@ -1105,7 +1212,7 @@ yy_symbol_print (FILE *yyo, int yytype, YYSTYPE const * const yyvaluep, YYLTYPE
 `------------------------------------------------------------------*/
 
 static void
-yy_stack_print (yytype_int16 *yybottom, yytype_int16 *yytop)
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
   for (; yybottom <= yytop; yybottom++)
@@ -1128,21 +1235,22 @@ do {                                                            \
 `------------------------------------------------*/
 
 static void
-yy_reduce_print (yytype_int16 *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp, int yyrule, yyscan_t scanner, const ndt_t **ast, ndt_context_t *ctx)
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp,
+                 int yyrule, yyscan_t scanner, const ndt_t **ast, ndt_context_t *ctx)
 {
-  unsigned long yylno = yyrline[yyrule];
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
              yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
       yy_symbol_print (stderr,
-                       yystos[yyssp[yyi + 1 - yynrhs]],
-                       &yyvsp[(yyi + 1) - (yynrhs)]
-                       , &(yylsp[(yyi + 1) - (yynrhs)])                       , scanner, ast, ctx);
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)],
+                       &(yylsp[(yyi + 1) - (yynrhs)]), scanner, ast, ctx);
       YYFPRINTF (stderr, "\n");
     }
 }
@@ -1157,8 +1265,8 @@ do {                                    \
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
@@ -1181,28 +1289,77 @@ int yydebug;
 #endif
 
 
-#if YYERROR_VERBOSE
+/* Context of a parse error.  */
+typedef struct
+{
+  yy_state_t *yyssp;
+  yysymbol_kind_t yytoken;
+  YYLTYPE *yylloc;
+} yypcontext_t;
+
+/* Put in YYARG at most YYARGN of the expected tokens given the
+   current YYCTX, and return the number of tokens stored in YYARG.  If
+   YYARG is null, return the number of expected tokens (guaranteed to
+   be less than YYNTOKENS).  Return YYENOMEM on memory exhaustion.
+   Return 0 if there are more than YYARGN expected tokens, yet fill
+   YYARG up to YYARGN. */
+static int
+yypcontext_expected_tokens (const yypcontext_t *yyctx,
+                            yysymbol_kind_t yyarg[], int yyargn)
+{
+  /* Actual size of YYARG. */
+  int yycount = 0;
+  int yyn = yypact[+*yyctx->yyssp];
+  if (!yypact_value_is_default (yyn))
+    {
+      /* Start YYX at -YYN if negative to avoid negative indexes in
+         YYCHECK.  In other words, skip the first -YYN actions for
+         this state because they are default actions.  */
+      int yyxbegin = yyn < 0 ? -yyn : 0;
+      /* Stay within bounds of both yycheck and yytname.  */
+      int yychecklim = YYLAST - yyn + 1;
+      int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
+      int yyx;
+      for (yyx = yyxbegin; yyx < yyxend; ++yyx)
+        if (yycheck[yyx + yyn] == yyx && yyx != YYSYMBOL_YYerror
+            && !yytable_value_is_error (yytable[yyx + yyn]))
+          {
+            if (!yyarg)
+              ++yycount;
+            else if (yycount == yyargn)
+              return 0;
+            else
+              yyarg[yycount++] = YY_CAST (yysymbol_kind_t, yyx);
+          }
+    }
+  if (yyarg && yycount == 0 && 0 < yyargn)
+    yyarg[0] = YYSYMBOL_YYEMPTY;
+  return yycount;
+}
+
+
 
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
+
+#ifndef yystrlen
+# if defined __GLIBC__ && defined _STRING_H
+#  define yystrlen(S) (YY_CAST (YYPTRDIFF_T, strlen (S)))
+# else
 /* Return the length of YYSTR.  */
-static YYSIZE_T
+static YYPTRDIFF_T
 yystrlen (const char *yystr)
 {
-  YYSIZE_T yylen;
+  YYPTRDIFF_T yylen;
   for (yylen = 0; yystr[yylen]; yylen++)
     continue;
   return yylen;
 }
-#  endif
 # endif
+#endif
 
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
+#ifndef yystpcpy
+# if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
+#  define yystpcpy stpcpy
+# else
 /* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
    YYDEST.  */
 static char *
@@ -1216,10 +1373,10 @@ yystpcpy (char *yydest, const char *yysrc)
 
   return yyd - 1;
 }
-#  endif
 # endif
+#endif
 
-# ifndef yytnamerr
+#ifndef yytnamerr
 /* Copy to YYRES the contents of YYSTR after stripping away unnecessary
    quotes and backslashes, so that it's suitable for yyerror.  The
    heuristic is that double-quoting is unnecessary unless the string
@@ -1227,14 +1384,13 @@ yystpcpy (char *yydest, const char *yysrc)
    backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
    null, do not copy; instead, return the length of what the result
    would have been.  */
-static YYSIZE_T
+static YYPTRDIFF_T
 yytnamerr (char *yyres, const char *yystr)
 {
   if (*yystr == '"')
     {
-      YYSIZE_T yyn = 0;
+      YYPTRDIFF_T yyn = 0;
       char const *yyp = yystr;
-
       for (;;)
         switch (*++yyp)
           {
@@ -1263,36 +1419,20 @@ yytnamerr (char *yyres, const char *yystr)
     do_not_strip_quotes: ;
     }
 
-  if (! yyres)
+  if (yyres)
+    return yystpcpy (yyres, yystr) - yyres;
+  else
     return yystrlen (yystr);
-
-  return (YYSIZE_T) (yystpcpy (yyres, yystr) - yyres);
 }
-# endif
+#endif
 
-/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
-   about the unexpected token YYTOKEN for the state stack whose top is
-   YYSSP.
 
-   Return 0 if *YYMSG was successfully written.  Return 1 if *YYMSG is
-   not large enough to hold the message.  In that case, also set
-   *YYMSG_ALLOC to the required number of bytes.  Return 2 if the
-   required number of bytes is too large to store.  */
 static int
-yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
-                yytype_int16 *yyssp, int yytoken)
+yy_syntax_error_arguments (const yypcontext_t *yyctx,
+                           yysymbol_kind_t yyarg[], int yyargn)
 {
-  YYSIZE_T yysize0 = yytnamerr (YY_NULLPTR, yytname[yytoken]);
-  YYSIZE_T yysize = yysize0;
-  enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-  /* Internationalized format string. */
-  const char *yyformat = YY_NULLPTR;
-  /* Arguments of yyformat. */
-  char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-  /* Number of reported tokens (one for the "unexpected", one per
-     "expected"). */
+  /* Actual size of YYARG. */
   int yycount = 0;
-
   /* There are many possibilities here to consider:
      - If this state is a consistent state with a default action, then
        the only way this function was invoked is if the default action
@@ -1316,49 +1456,54 @@ yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
        one exception: it will still contain any token that will not be
        accepted due to an error action in a later state.
   */
-  if (yytoken != YYEMPTY)
+  if (yyctx->yytoken != YYSYMBOL_YYEMPTY)
     {
-      int yyn = yypact[*yyssp];
-      yyarg[yycount++] = yytname[yytoken];
-      if (!yypact_value_is_default (yyn))
-        {
-          /* Start YYX at -YYN if negative to avoid negative indexes in
-             YYCHECK.  In other words, skip the first -YYN actions for
-             this state because they are default actions.  */
-          int yyxbegin = yyn < 0 ? -yyn : 0;
-          /* Stay within bounds of both yycheck and yytname.  */
-          int yychecklim = YYLAST - yyn + 1;
-          int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-          int yyx;
-
-          for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-            if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR
-                && !yytable_value_is_error (yytable[yyx + yyn]))
-              {
-                if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-                  {
-                    yycount = 1;
-                    yysize = yysize0;
-                    break;
-                  }
-                yyarg[yycount++] = yytname[yyx];
-                {
-                  YYSIZE_T yysize1 = yysize + yytnamerr (YY_NULLPTR, yytname[yyx]);
-                  if (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM)
-                    yysize = yysize1;
-                  else
-                    return 2;
-                }
-              }
-        }
+      int yyn;
+      if (yyarg)
+        yyarg[yycount] = yyctx->yytoken;
+      ++yycount;
+      yyn = yypcontext_expected_tokens (yyctx,
+                                        yyarg ? yyarg + 1 : yyarg, yyargn - 1);
+      if (yyn == YYENOMEM)
+        return YYENOMEM;
+      else
+        yycount += yyn;
     }
+  return yycount;
+}
+
+/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
+   about the unexpected token YYTOKEN for the state stack whose top is
+   YYSSP.
+
+   Return 0 if *YYMSG was successfully written.  Return -1 if *YYMSG is
+   not large enough to hold the message.  In that case, also set
+   *YYMSG_ALLOC to the required number of bytes.  Return YYENOMEM if the
+   required number of bytes is too large to store.  */
+static int
+yysyntax_error (YYPTRDIFF_T *yymsg_alloc, char **yymsg,
+                const yypcontext_t *yyctx)
+{
+  enum { YYARGS_MAX = 5 };
+  /* Internationalized format string. */
+  const char *yyformat = YY_NULLPTR;
+  /* Arguments of yyformat: reported tokens (one for the "unexpected",
+     one per "expected"). */
+  yysymbol_kind_t yyarg[YYARGS_MAX];
+  /* Cumulated lengths of YYARG.  */
+  YYPTRDIFF_T yysize = 0;
+
+  /* Actual size of YYARG. */
+  int yycount = yy_syntax_error_arguments (yyctx, yyarg, YYARGS_MAX);
+  if (yycount == YYENOMEM)
+    return YYENOMEM;
 
   switch (yycount)
     {
-# define YYCASE_(N, S)                      \
+#define YYCASE_(N, S)                       \
       case N:                               \
         yyformat = S;                       \
-      break
+        break
     default: /* Avoid compiler warnings. */
       YYCASE_(0, YY_("syntax error"));
       YYCASE_(1, YY_("syntax error, unexpected %s"));
@@ -1366,15 +1511,23 @@ yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
       YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
       YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
       YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
-# undef YYCASE_
+#undef YYCASE_
     }
 
+  /* Compute error message size.  Don't count the "%s"s, but reserve
+     room for the terminator.  */
+  yysize = yystrlen (yyformat) - 2 * yycount + 1;
   {
-    YYSIZE_T yysize1 = yysize + yystrlen (yyformat);
-    if (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM)
-      yysize = yysize1;
-    else
-      return 2;
+    int yyi;
+    for (yyi = 0; yyi < yycount; ++yyi)
+      {
+        YYPTRDIFF_T yysize1
+          = yysize + yytnamerr (YY_NULLPTR, yytname[yyarg[yyi]]);
+        if (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM)
+          yysize = yysize1;
+        else
+          return YYENOMEM;
+      }
   }
 
   if (*yymsg_alloc < yysize)
@@ -1383,7 +1536,7 @@ yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
       if (! (yysize <= *yymsg_alloc
              && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
         *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
-      return 1;
+      return -1;
     }
 
   /* Avoid sprintf, as that infringes on the user's name space.
@@ -1395,294 +1548,271 @@ yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
     while ((*yyp = *yyformat) != '\0')
       if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
         {
-          yyp += yytnamerr (yyp, yyarg[yyi++]);
+          yyp += yytnamerr (yyp, yytname[yyarg[yyi++]]);
           yyformat += 2;
         }
       else
         {
-          yyp++;
-          yyformat++;
+          ++yyp;
+          ++yyformat;
         }
   }
   return 0;
 }
-#endif /* YYERROR_VERBOSE */
+
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
 static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, YYLTYPE *yylocationp, yyscan_t scanner, const ndt_t **ast, ndt_context_t *ctx)
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, YYLTYPE *yylocationp, yyscan_t scanner, const ndt_t **ast, ndt_context_t *ctx)
 {
-  YYUSE (yyvaluep);
-  YYUSE (yylocationp);
-  YYUSE (scanner);
-  YYUSE (ast);
-  YYUSE (ctx);
+  YY_USE (yyvaluep);
+  YY_USE (yylocationp);
+  YY_USE (scanner);
+  YY_USE (ast);
+  YY_USE (ctx);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  switch (yytype)
+  switch (yykind)
     {
-    case 63: /* INTEGER  */
-#line 201 "grammar.y" /* yacc.c:1257  */
-      { ndt_free(((*yyvaluep).string)); }
-#line 1434 "grammar.c" /* yacc.c:1257  */
-        break;
-
-    case 64: /* FLOATNUMBER  */
-#line 201 "grammar.y" /* yacc.c:1257  */
-      { ndt_free(((*yyvaluep).string)); }
-#line 1440 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_INTEGER: /* INTEGER  */
+#line 233 "grammar.y"
+            { ndt_free(((*yyvaluep).string)); }
+#line 1588 "grammar.c"
         break;
 
-    case 65: /* STRINGLIT  */
-#line 201 "grammar.y" /* yacc.c:1257  */
-      { ndt_free(((*yyvaluep).string)); }
-#line 1446 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_FLOATNUMBER: /* FLOATNUMBER  */
+#line 233 "grammar.y"
+            { ndt_free(((*yyvaluep).string)); }
+#line 1594 "grammar.c"
         break;
 
-    case 66: /* NAME_LOWER  */
-#line 201 "grammar.y" /* yacc.c:1257  */
-      { ndt_free(((*yyvaluep).string)); }
-#line 1452 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_STRINGLIT: /* STRINGLIT  */
+#line 233 "grammar.y"
+            { ndt_free(((*yyvaluep).string)); }
+#line 1600 "grammar.c"
         break;
 
-    case 67: /* NAME_UPPER  */
-#line 201 "grammar.y" /* yacc.c:1257  */
-      { ndt_free(((*yyvaluep).string)); }
-#line 1458 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_input: /* input  */
+#line 226 "grammar.y"
+            { ndt_decref(((*yyvaluep).ndt)); }
+#line 1606 "grammar.c"
         break;
 
-    case 68: /* NAME_OTHER  */
-#line 201 "grammar.y" /* yacc.c:1257  */
-      { ndt_free(((*yyvaluep).string)); }
-#line 1464 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_datashape_or_module: /* datashape_or_module  */
+#line 226 "grammar.y"
+            { ndt_decref(((*yyvaluep).ndt)); }
+#line 1612 "grammar.c"
         break;
 
-    case 71: /* input  */
-#line 194 "grammar.y" /* yacc.c:1257  */
-      { ndt_decref(((*yyvaluep).ndt)); }
-#line 1470 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_datashape_with_ellipsis: /* datashape_with_ellipsis  */
+#line 226 "grammar.y"
+            { ndt_decref(((*yyvaluep).ndt)); }
+#line 1618 "grammar.c"
         break;
 
-    case 72: /* datashape_or_module  */
-#line 194 "grammar.y" /* yacc.c:1257  */
-      { ndt_decref(((*yyvaluep).ndt)); }
-#line 1476 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_fixed_ellipsis: /* fixed_ellipsis  */
+#line 226 "grammar.y"
+            { ndt_decref(((*yyvaluep).ndt)); }
+#line 1624 "grammar.c"
         break;
 
-    case 73: /* datashape_with_ellipsis  */
-#line 194 "grammar.y" /* yacc.c:1257  */
-      { ndt_decref(((*yyvaluep).ndt)); }
-#line 1482 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_datashape: /* datashape  */
+#line 226 "grammar.y"
+            { ndt_decref(((*yyvaluep).ndt)); }
+#line 1630 "grammar.c"
         break;
 
-    case 74: /* fixed_ellipsis  */
-#line 194 "grammar.y" /* yacc.c:1257  */
-      { ndt_decref(((*yyvaluep).ndt)); }
-#line 1488 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_dimensions: /* dimensions  */
+#line 226 "grammar.y"
+            { ndt_decref(((*yyvaluep).ndt)); }
+#line 1636 "grammar.c"
         break;
 
-    case 75: /* datashape  */
-#line 194 "grammar.y" /* yacc.c:1257  */
-      { ndt_decref(((*yyvaluep).ndt)); }
-#line 1494 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_dimensions_nooption: /* dimensions_nooption  */
+#line 226 "grammar.y"
+            { ndt_decref(((*yyvaluep).ndt)); }
+#line 1642 "grammar.c"
         break;
 
-    case 76: /* dimensions  */
-#line 194 "grammar.y" /* yacc.c:1257  */
-      { ndt_decref(((*yyvaluep).ndt)); }
-#line 1500 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_dimensions_tail: /* dimensions_tail  */
+#line 226 "grammar.y"
+            { ndt_decref(((*yyvaluep).ndt)); }
+#line 1648 "grammar.c"
         break;
 
-    case 77: /* dimensions_nooption  */
-#line 194 "grammar.y" /* yacc.c:1257  */
-      { ndt_decref(((*yyvaluep).ndt)); }
-#line 1506 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_dtype: /* dtype  */
+#line 226 "grammar.y"
+            { ndt_decref(((*yyvaluep).ndt)); }
+#line 1654 "grammar.c"
         break;
 
-    case 78: /* dimensions_tail  */
-#line 194 "grammar.y" /* yacc.c:1257  */
-      { ndt_decref(((*yyvaluep).ndt)); }
-#line 1512 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_scalar: /* scalar  */
+#line 226 "grammar.y"
+            { ndt_decref(((*yyvaluep).ndt)); }
+#line 1660 "grammar.c"
         break;
 
-    case 79: /* dtype  */
-#line 194 "grammar.y" /* yacc.c:1257  */
-      { ndt_decref(((*yyvaluep).ndt)); }
-#line 1518 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_character: /* character  */
+#line 226 "grammar.y"
+            { ndt_decref(((*yyvaluep).ndt)); }
+#line 1666 "grammar.c"
         break;
 
-    case 80: /* scalar  */
-#line 194 "grammar.y" /* yacc.c:1257  */
-      { ndt_decref(((*yyvaluep).ndt)); }
-#line 1524 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_string: /* string  */
+#line 226 "grammar.y"
+            { ndt_decref(((*yyvaluep).ndt)); }
+#line 1672 "grammar.c"
         break;
 
-    case 86: /* character  */
-#line 194 "grammar.y" /* yacc.c:1257  */
-      { ndt_decref(((*yyvaluep).ndt)); }
-#line 1530 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_fixed_string: /* fixed_string  */
+#line 226 "grammar.y"
+            { ndt_decref(((*yyvaluep).ndt)); }
+#line 1678 "grammar.c"
         break;
 
-    case 87: /* string  */
-#line 194 "grammar.y" /* yacc.c:1257  */
-      { ndt_decref(((*yyvaluep).ndt)); }
-#line 1536 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_bytes: /* bytes  */
+#line 226 "grammar.y"
+            { ndt_decref(((*yyvaluep).ndt)); }
+#line 1684 "grammar.c"
         break;
 
-    case 88: /* fixed_string  */
-#line 194 "grammar.y" /* yacc.c:1257  */
-      { ndt_decref(((*yyvaluep).ndt)); }
-#line 1542 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_fixed_bytes: /* fixed_bytes  */
+#line 226 "grammar.y"
+            { ndt_decref(((*yyvaluep).ndt)); }
+#line 1690 "grammar.c"
         break;
 
-    case 93: /* bytes  */
-#line 194 "grammar.y" /* yacc.c:1257  */
-      { ndt_decref(((*yyvaluep).ndt)); }
-#line 1548 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_ref: /* ref  */
+#line 226 "grammar.y"
+            { ndt_decref(((*yyvaluep).ndt)); }
+#line 1696 "grammar.c"
         break;
 
-    case 94: /* fixed_bytes  */
-#line 194 "grammar.y" /* yacc.c:1257  */
-      { ndt_decref(((*yyvaluep).ndt)); }
-#line 1554 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_categorical: /* categorical  */
+#line 226 "grammar.y"
+            { ndt_decref(((*yyvaluep).ndt)); }
+#line 1702 "grammar.c"
         break;
 
-    case 95: /* ref  */
-#line 194 "grammar.y" /* yacc.c:1257  */
-      { ndt_decref(((*yyvaluep).ndt)); }
-#line 1560 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_typed_value_seq: /* typed_value_seq  */
+#line 230 "grammar.y"
+            { ndt_value_seq_del(((*yyvaluep).typed_value_seq)); }
+#line 1708 "grammar.c"
         break;
 
-    case 96: /* categorical  */
-#line 194 "grammar.y" /* yacc.c:1257  */
-      { ndt_decref(((*yyvaluep).ndt)); }
-#line 1566 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_typed_value: /* typed_value  */
+#line 229 "grammar.y"
+            { ndt_value_del(((*yyvaluep).typed_value)); }
+#line 1714 "grammar.c"
         break;
 
-    case 97: /* typed_value_seq  */
-#line 198 "grammar.y" /* yacc.c:1257  */
-      { ndt_value_seq_del(((*yyvaluep).typed_value_seq)); }
-#line 1572 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_tuple_type: /* tuple_type  */
+#line 226 "grammar.y"
+            { ndt_decref(((*yyvaluep).ndt)); }
+#line 1720 "grammar.c"
         break;
 
-    case 98: /* typed_value  */
-#line 197 "grammar.y" /* yacc.c:1257  */
-      { ndt_value_del(((*yyvaluep).typed_value)); }
-#line 1578 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_tuple_field_seq: /* tuple_field_seq  */
+#line 228 "grammar.y"
+            { ndt_field_seq_del(((*yyvaluep).field_seq)); }
+#line 1726 "grammar.c"
         break;
 
-    case 101: /* tuple_type  */
-#line 194 "grammar.y" /* yacc.c:1257  */
-      { ndt_decref(((*yyvaluep).ndt)); }
-#line 1584 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_tuple_field: /* tuple_field  */
+#line 227 "grammar.y"
+            { ndt_decref(((*yyvaluep).field)->type); }
+#line 1732 "grammar.c"
         break;
 
-    case 102: /* tuple_field_seq  */
-#line 196 "grammar.y" /* yacc.c:1257  */
-      { ndt_field_seq_del(((*yyvaluep).field_seq)); }
-#line 1590 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_record_type: /* record_type  */
+#line 226 "grammar.y"
+            { ndt_decref(((*yyvaluep).ndt)); }
+#line 1738 "grammar.c"
         break;
 
-    case 103: /* tuple_field  */
-#line 195 "grammar.y" /* yacc.c:1257  */
-      { ndt_field_del(((*yyvaluep).field)); }
-#line 1596 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_record_field_seq: /* record_field_seq  */
+#line 228 "grammar.y"
+            { ndt_field_seq_del(((*yyvaluep).field_seq)); }
+#line 1744 "grammar.c"
         break;
 
-    case 104: /* record_type  */
-#line 194 "grammar.y" /* yacc.c:1257  */
-      { ndt_decref(((*yyvaluep).ndt)); }
-#line 1602 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_record_field: /* record_field  */
+#line 227 "grammar.y"
+            { ndt_decref(((*yyvaluep).field)->type); }
+#line 1750 "grammar.c"
         break;
 
-    case 105: /* record_field_seq  */
-#line 196 "grammar.y" /* yacc.c:1257  */
-      { ndt_field_seq_del(((*yyvaluep).field_seq)); }
-#line 1608 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_union_type: /* union_type  */
+#line 226 "grammar.y"
+            { ndt_decref(((*yyvaluep).ndt)); }
+#line 1756 "grammar.c"
         break;
 
-    case 106: /* record_field  */
-#line 195 "grammar.y" /* yacc.c:1257  */
-      { ndt_field_del(((*yyvaluep).field)); }
-#line 1614 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_union_member_seq: /* union_member_seq  */
+#line 228 "grammar.y"
+            { ndt_field_seq_del(((*yyvaluep).field_seq)); }
+#line 1762 "grammar.c"
         break;
 
-    case 107: /* field_name_or_tag  */
-#line 201 "grammar.y" /* yacc.c:1257  */
-      { ndt_free(((*yyvaluep).string)); }
-#line 1620 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_union_member: /* union_member  */
+#line 227 "grammar.y"
+            { ndt_decref(((*yyvaluep).field)->type); }
+#line 1768 "grammar.c"
         break;
 
-    case 108: /* union_type  */
-#line 194 "grammar.y" /* yacc.c:1257  */
-      { ndt_decref(((*yyvaluep).ndt)); }
-#line 1626 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_arguments_opt: /* arguments_opt  */
+#line 232 "grammar.y"
+            { ndt_attr_seq_del(((*yyvaluep).attribute_seq)); }
+#line 1774 "grammar.c"
         break;
 
-    case 109: /* union_member_seq  */
-#line 196 "grammar.y" /* yacc.c:1257  */
-      { ndt_field_seq_del(((*yyvaluep).field_seq)); }
-#line 1632 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_attribute_seq: /* attribute_seq  */
+#line 232 "grammar.y"
+            { ndt_attr_seq_del(((*yyvaluep).attribute_seq)); }
+#line 1780 "grammar.c"
         break;
 
-    case 110: /* union_member  */
-#line 195 "grammar.y" /* yacc.c:1257  */
-      { ndt_field_del(((*yyvaluep).field)); }
-#line 1638 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_attribute: /* attribute  */
+#line 231 "grammar.y"
+            { ndt_attr_del(((*yyvaluep).attribute)); }
+#line 1786 "grammar.c"
         break;
 
-    case 111: /* arguments_opt  */
-#line 200 "grammar.y" /* yacc.c:1257  */
-      { ndt_attr_seq_del(((*yyvaluep).attribute_seq)); }
-#line 1644 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_untyped_value_seq: /* untyped_value_seq  */
+#line 234 "grammar.y"
+            { ndt_string_seq_del(((*yyvaluep).string_seq)); }
+#line 1792 "grammar.c"
         break;
 
-    case 112: /* attribute_seq  */
-#line 200 "grammar.y" /* yacc.c:1257  */
-      { ndt_attr_seq_del(((*yyvaluep).attribute_seq)); }
-#line 1650 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_untyped_value: /* untyped_value  */
+#line 233 "grammar.y"
+            { ndt_free(((*yyvaluep).string)); }
+#line 1798 "grammar.c"
         break;
 
-    case 113: /* attribute  */
-#line 199 "grammar.y" /* yacc.c:1257  */
-      { ndt_attr_del(((*yyvaluep).attribute)); }
-#line 1656 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_function_type: /* function_type  */
+#line 226 "grammar.y"
+            { ndt_decref(((*yyvaluep).ndt)); }
+#line 1804 "grammar.c"
         break;
 
-    case 114: /* untyped_value_seq  */
-#line 202 "grammar.y" /* yacc.c:1257  */
-      { ndt_string_seq_del(((*yyvaluep).string_seq)); }
-#line 1662 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_type_seq_or_void: /* type_seq_or_void  */
+#line 235 "grammar.y"
+            { ndt_type_seq_del(((*yyvaluep).type_seq)); }
+#line 1810 "grammar.c"
         break;
 
-    case 115: /* untyped_value  */
-#line 201 "grammar.y" /* yacc.c:1257  */
-      { ndt_free(((*yyvaluep).string)); }
-#line 1668 "grammar.c" /* yacc.c:1257  */
-        break;
-
-    case 116: /* function_type  */
-#line 194 "grammar.y" /* yacc.c:1257  */
-      { ndt_decref(((*yyvaluep).ndt)); }
-#line 1674 "grammar.c" /* yacc.c:1257  */
-        break;
-
-    case 117: /* type_seq_or_void  */
-#line 203 "grammar.y" /* yacc.c:1257  */
-      { ndt_type_seq_del(((*yyvaluep).type_seq)); }
-#line 1680 "grammar.c" /* yacc.c:1257  */
-        break;
-
-    case 118: /* type_seq  */
-#line 203 "grammar.y" /* yacc.c:1257  */
-      { ndt_type_seq_del(((*yyvaluep).type_seq)); }
-#line 1686 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_type_seq: /* type_seq  */
+#line 235 "grammar.y"
+            { ndt_type_seq_del(((*yyvaluep).type_seq)); }
+#line 1816 "grammar.c"
         break;
 
       default:
@@ -1694,6 +1824,8 @@ yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, YYLTYPE *yylocatio
 
 
 
+
+
 /*----------.
 | yyparse.  |
 `----------*/
@@ -1701,7 +1833,7 @@ yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, YYLTYPE *yylocatio
 int
 yyparse (yyscan_t scanner, const ndt_t **ast, ndt_context_t *ctx)
 {
-/* The lookahead symbol.  */
+/* Lookahead token kind.  */
 int yychar;
 
 
@@ -1720,55 +1852,50 @@ static YYLTYPE yyloc_default
 YYLTYPE yylloc = yyloc_default;
 
     /* Number of syntax errors so far.  */
-    int yynerrs;
+    int yynerrs = 0;
 
-    int yystate;
+    yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
-
-    /* The stacks and their tools:
-       'yyss': related to states.
-       'yyvs': related to semantic values.
-       'yyls': related to locations.
+    int yyerrstatus = 0;
 
-       Refer to the stacks through separate pointers, to allow yyoverflow
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
        to reallocate them elsewhere.  */
 
-    /* The state stack.  */
-    yytype_int16 yyssa[YYINITDEPTH];
-    yytype_int16 *yyss;
-    yytype_int16 *yyssp;
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
 
-    /* The semantic value stack.  */
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
     YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
-    /* The location stack.  */
+    /* The location stack: array, bottom, top.  */
     YYLTYPE yylsa[YYINITDEPTH];
-    YYLTYPE *yyls;
-    YYLTYPE *yylsp;
-
-    /* The locations where the error started and ended.  */
-    YYLTYPE yyerror_range[3];
-
-    YYSIZE_T yystacksize;
+    YYLTYPE *yyls = yylsa;
+    YYLTYPE *yylsp = yyls;
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken = 0;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
   YYLTYPE yyloc;
 
-#if YYERROR_VERBOSE
+  /* The locations where the error started and ended.  */
+  YYLTYPE yyerror_range[3];
+
   /* Buffer for error messages, and its allocated size.  */
   char yymsgbuf[128];
   char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+  YYPTRDIFF_T yymsg_alloc = sizeof yymsgbuf;
 
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N), yylsp -= (N))
 
@@ -1776,20 +1903,13 @@ YYLTYPE yylloc = yyloc_default;
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yyssp = yyss = yyssa;
-  yyvsp = yyvs = yyvsa;
-  yylsp = yyls = yylsa;
-  yystacksize = YYINITDEPTH;
-
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
   yychar = YYEMPTY; /* Cause a token to be read.  */
 
+
 /* User initialization code.  */
-#line 75 "grammar.y" /* yacc.c:1431  */
+#line 103 "grammar.y"
 {
    yylloc.first_line = 1;
    yylloc.first_column = 1;
@@ -1797,7 +1917,8 @@ YYLTYPE yylloc = yyloc_default;
    yylloc.last_column = 1;
 }
 
-#line 1801 "grammar.c" /* yacc.c:1431  */
+#line 1921 "grammar.c"
+
   yylsp[0] = yylloc;
   goto yysetstate;
 
@@ -1812,26 +1933,31 @@ yynewstate:
 
 
 /*--------------------------------------------------------------------.
-| yynewstate -- set current state (the top of the stack) to yystate.  |
+| yysetstate -- set current state (the top of the stack) to yystate.  |
 `--------------------------------------------------------------------*/
 yysetstate:
-  *yyssp = (yytype_int16) yystate;
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
 #if !defined yyoverflow && !defined YYSTACK_RELOCATE
-    goto yyexhaustedlab;
+    YYNOMEM;
 #else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = (YYSIZE_T) (yyssp - yyss + 1);
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
 # if defined yyoverflow
       {
         /* Give user a chance to reallocate the stack.  Use copies of
            these so that the &'s don't force the real ones into
            memory.  */
+        yy_state_t *yyss1 = yyss;
         YYSTYPE *yyvs1 = yyvs;
-        yytype_int16 *yyss1 = yyss;
         YYLTYPE *yyls1 = yyls;
 
         /* Each stack pointer address is followed by the size of the
@@ -1839,9 +1965,9 @@ yysetstate:
            conditional around just the two extra args, but that might
            be undefined if yyoverflow is a macro.  */
         yyoverflow (YY_("memory exhausted"),
-                    &yyss1, yysize * sizeof (*yyssp),
-                    &yyvs1, yysize * sizeof (*yyvsp),
-                    &yyls1, yysize * sizeof (*yylsp),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yyls1, yysize * YYSIZEOF (*yylsp),
                     &yystacksize);
         yyss = yyss1;
         yyvs = yyvs1;
@@ -1850,21 +1976,22 @@ yysetstate:
 # else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-        goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
         yystacksize = YYMAXDEPTH;
 
       {
-        yytype_int16 *yyss1 = yyss;
+        yy_state_t *yyss1 = yyss;
         union yyalloc *yyptr =
-          (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
         if (! yyptr)
-          goto yyexhaustedlab;
+          YYNOMEM;
         YYSTACK_RELOCATE (yyss_alloc, yyss);
         YYSTACK_RELOCATE (yyvs_alloc, yyvs);
         YYSTACK_RELOCATE (yyls_alloc, yyls);
-# undef YYSTACK_RELOCATE
+#  undef YYSTACK_RELOCATE
         if (yyss1 != yyssa)
           YYSTACK_FREE (yyss1);
       }
@@ -1874,15 +2001,16 @@ yysetstate:
       yyvsp = yyvs + yysize - 1;
       yylsp = yyls + yysize - 1;
 
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-                  (unsigned long) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
         YYABORT;
     }
 #endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
 
   if (yystate == YYFINAL)
     YYACCEPT;
@@ -1904,18 +2032,30 @@ yybackup:
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
+      YYDPRINTF ((stderr, "Reading a token\n"));
       yychar = yylex (&yylval, &yylloc, scanner, ctx);
     }
 
-  if (yychar <= YYEOF)
+  if (yychar <= ENDMARKER)
     {
-      yychar = yytoken = YYEOF;
+      yychar = ENDMARKER;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      yyerror_range[1] = yylloc;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1943,15 +2083,14 @@ yybackup:
 
   /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token.  */
-  yychar = YYEMPTY;
-
   yystate = yyn;
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
   *++yylsp = yylloc;
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1988,908 +2127,909 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 2:
-#line 212 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = (yyvsp[-1].ndt);  *ast = (yyval.ndt); YYACCEPT; }
-#line 1995 "grammar.c" /* yacc.c:1652  */
+  case 2: /* input: datashape_or_module "end of file"  */
+#line 244 "grammar.y"
+                                { (yyval.ndt) = (yyvsp[-1].ndt);  *ast = (yyval.ndt); YYACCEPT; }
+#line 2134 "grammar.c"
     break;
 
-  case 3:
-#line 216 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2001 "grammar.c" /* yacc.c:1652  */
+  case 3: /* datashape_or_module: datashape_with_ellipsis  */
+#line 248 "grammar.y"
+                                                 { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2140 "grammar.c"
     break;
 
-  case 4:
-#line 217 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2007 "grammar.c" /* yacc.c:1652  */
+  case 4: /* datashape_or_module: function_type  */
+#line 249 "grammar.y"
+                                                 { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2146 "grammar.c"
     break;
 
-  case 5:
-#line 218 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_module((yyvsp[-3].string), (yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2013 "grammar.c" /* yacc.c:1652  */
+  case 5: /* datashape_or_module: NAME_UPPER COLON COLON datashape_with_ellipsis  */
+#line 250 "grammar.y"
+                                                 { (yyval.ndt) = mk_module((yyvsp[-3].name), (yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2152 "grammar.c"
     break;
 
-  case 6:
-#line 222 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2019 "grammar.c" /* yacc.c:1652  */
+  case 6: /* datashape_with_ellipsis: datashape  */
+#line 254 "grammar.y"
+                                           { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2158 "grammar.c"
     break;
 
-  case 7:
-#line 223 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2025 "grammar.c" /* yacc.c:1652  */
+  case 7: /* datashape_with_ellipsis: fixed_ellipsis  */
+#line 255 "grammar.y"
+                                           { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2164 "grammar.c"
     break;
 
-  case 8:
-#line 224 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_contig((yyvsp[-3].string), (ndt_t *)(yyvsp[-1].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2031 "grammar.c" /* yacc.c:1652  */
+  case 8: /* datashape_with_ellipsis: NAME_UPPER LBRACK fixed_ellipsis RBRACK  */
+#line 256 "grammar.y"
+                                           { (yyval.ndt) = mk_contig((yyvsp[-3].name), (ndt_t *)(yyvsp[-1].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2170 "grammar.c"
     break;
 
-  case 9:
-#line 225 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_var_ellipsis((yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2037 "grammar.c" /* yacc.c:1652  */
+  case 9: /* datashape_with_ellipsis: VAR ELLIPSIS STAR dtype  */
+#line 257 "grammar.y"
+                                           { (yyval.ndt) = mk_var_ellipsis((yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2176 "grammar.c"
     break;
 
-  case 10:
-#line 226 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_array_ellipsis((yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2043 "grammar.c" /* yacc.c:1652  */
+  case 10: /* datashape_with_ellipsis: ARRAY ELLIPSIS STAR datashape  */
+#line 258 "grammar.y"
+                                           { (yyval.ndt) = mk_array_ellipsis((yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2182 "grammar.c"
     break;
 
-  case 11:
-#line 229 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_ellipsis_dim(NULL, (yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2049 "grammar.c" /* yacc.c:1652  */
+  case 11: /* fixed_ellipsis: ELLIPSIS STAR dimensions_tail  */
+#line 261 "grammar.y"
+                                           { (yyval.ndt) = mk_ellipsis_dim(NULL, (yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2188 "grammar.c"
     break;
 
-  case 12:
-#line 230 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_ellipsis_dim((yyvsp[-3].string), (yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2055 "grammar.c" /* yacc.c:1652  */
+  case 12: /* fixed_ellipsis: NAME_UPPER ELLIPSIS STAR dimensions_tail  */
+#line 262 "grammar.y"
+                                           { (yyval.ndt) = mk_ellipsis_dim((yyvsp[-3].name), (yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2194 "grammar.c"
     break;
 
-  case 13:
-#line 233 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2061 "grammar.c" /* yacc.c:1652  */
+  case 13: /* datashape: dimensions  */
+#line 265 "grammar.y"
+                     { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2200 "grammar.c"
     break;
 
-  case 14:
-#line 234 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2067 "grammar.c" /* yacc.c:1652  */
+  case 14: /* datashape: dtype  */
+#line 266 "grammar.y"
+                     { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2206 "grammar.c"
     break;
 
-  case 15:
-#line 237 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2073 "grammar.c" /* yacc.c:1652  */
+  case 15: /* dimensions: dimensions_nooption  */
+#line 269 "grammar.y"
+                                      { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2212 "grammar.c"
     break;
 
-  case 16:
-#line 238 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_contig((yyvsp[-3].string), (ndt_t *)(yyvsp[-1].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2079 "grammar.c" /* yacc.c:1652  */
+  case 16: /* dimensions: NAME_UPPER LBRACK dimensions RBRACK  */
+#line 270 "grammar.y"
+                                      { (yyval.ndt) = mk_contig((yyvsp[-3].name), (ndt_t *)(yyvsp[-1].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2218 "grammar.c"
     break;
 
-  case 17:
-#line 239 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_fortran((yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2085 "grammar.c" /* yacc.c:1652  */
+  case 17: /* dimensions: BANG dimensions  */
+#line 271 "grammar.y"
+                                      { (yyval.ndt) = mk_fortran((yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2224 "grammar.c"
     break;
 
-  case 18:
-#line 242 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_fixed_dim_from_shape((yyvsp[-2].string), (yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2091 "grammar.c" /* yacc.c:1652  */
+  case 18: /* dimensions_nooption: INTEGER STAR dimensions_tail  */
+#line 274 "grammar.y"
+                                                         { (yyval.ndt) = mk_fixed_dim_from_shape((yyvsp[-2].string), (yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2230 "grammar.c"
     break;
 
-  case 19:
-#line 243 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_fixed_dim_from_attrs((yyvsp[-3].attribute_seq), (yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2097 "grammar.c" /* yacc.c:1652  */
+  case 19: /* dimensions_nooption: FIXED LPAREN attribute_seq RPAREN STAR dimensions_tail  */
+#line 275 "grammar.y"
+                                                         { (yyval.ndt) = mk_fixed_dim_from_attrs((yyvsp[-3].attribute_seq), (yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2236 "grammar.c"
     break;
 
-  case 20:
-#line 244 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_symbolic_dim((yyvsp[-2].string), (yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2103 "grammar.c" /* yacc.c:1652  */
+  case 20: /* dimensions_nooption: NAME_UPPER STAR dimensions_tail  */
+#line 276 "grammar.y"
+                                                         { (yyval.ndt) = mk_symbolic_dim((yyvsp[-2].name), (yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2242 "grammar.c"
     break;
 
-  case 21:
-#line 245 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_var_dim((yyvsp[-2].attribute_seq), (yyvsp[0].ndt), false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2109 "grammar.c" /* yacc.c:1652  */
+  case 21: /* dimensions_nooption: VAR arguments_opt STAR dimensions_tail  */
+#line 277 "grammar.y"
+                                                         { (yyval.ndt) = mk_var_dim((yyvsp[-2].attribute_seq), (yyvsp[0].ndt), false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2248 "grammar.c"
     break;
 
-  case 22:
-#line 246 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_var_dim((yyvsp[-2].attribute_seq), (yyvsp[0].ndt), true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2115 "grammar.c" /* yacc.c:1652  */
+  case 22: /* dimensions_nooption: QUESTIONMARK VAR arguments_opt STAR dimensions_tail  */
+#line 278 "grammar.y"
+                                                         { (yyval.ndt) = mk_var_dim((yyvsp[-2].attribute_seq), (yyvsp[0].ndt), true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2254 "grammar.c"
     break;
 
-  case 23:
-#line 247 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_array((yyvsp[0].ndt), false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2121 "grammar.c" /* yacc.c:1652  */
+  case 23: /* dimensions_nooption: ARRAY STAR datashape  */
+#line 279 "grammar.y"
+                                                         { (yyval.ndt) = mk_array((yyvsp[0].ndt), false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2260 "grammar.c"
     break;
 
-  case 24:
-#line 248 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_array((yyvsp[0].ndt), true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2127 "grammar.c" /* yacc.c:1652  */
+  case 24: /* dimensions_nooption: QUESTIONMARK ARRAY STAR datashape  */
+#line 280 "grammar.y"
+                                                         { (yyval.ndt) = mk_array((yyvsp[0].ndt), true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2266 "grammar.c"
     break;
 
-  case 25:
-#line 251 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2133 "grammar.c" /* yacc.c:1652  */
+  case 25: /* dimensions_tail: dtype  */
+#line 283 "grammar.y"
+                     { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2272 "grammar.c"
     break;
 
-  case 26:
-#line 252 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2139 "grammar.c" /* yacc.c:1652  */
+  case 26: /* dimensions_tail: dimensions  */
+#line 284 "grammar.y"
+                     { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2278 "grammar.c"
     break;
 
-  case 27:
-#line 255 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_any_kind((yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2145 "grammar.c" /* yacc.c:1652  */
+  case 27: /* dtype: option_opt ANY_KIND  */
+#line 287 "grammar.y"
+                                                  { (yyval.ndt) = ndt_any_kind((yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2284 "grammar.c"
     break;
 
-  case 28:
-#line 256 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_scalar_kind((yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2151 "grammar.c" /* yacc.c:1652  */
+  case 28: /* dtype: option_opt SCALAR_KIND  */
+#line 288 "grammar.y"
+                                                  { (yyval.ndt) = ndt_scalar_kind((yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2290 "grammar.c"
     break;
 
-  case 29:
-#line 257 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2157 "grammar.c" /* yacc.c:1652  */
+  case 29: /* dtype: scalar  */
+#line 289 "grammar.y"
+                                                  { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2296 "grammar.c"
     break;
 
-  case 30:
-#line 258 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2163 "grammar.c" /* yacc.c:1652  */
+  case 30: /* dtype: tuple_type  */
+#line 290 "grammar.y"
+                                                  { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2302 "grammar.c"
     break;
 
-  case 31:
-#line 259 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2169 "grammar.c" /* yacc.c:1652  */
+  case 31: /* dtype: record_type  */
+#line 291 "grammar.y"
+                                                  { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2308 "grammar.c"
     break;
 
-  case 32:
-#line 260 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2175 "grammar.c" /* yacc.c:1652  */
+  case 32: /* dtype: union_type  */
+#line 292 "grammar.y"
+                                                  { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2314 "grammar.c"
     break;
 
-  case 33:
-#line 261 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_nominal((yyvsp[0].string), NULL, false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2181 "grammar.c" /* yacc.c:1652  */
+  case 33: /* dtype: NAME_LOWER  */
+#line 293 "grammar.y"
+                                                  { (yyval.ndt) = mk_nominal((yyvsp[0].name), false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2320 "grammar.c"
     break;
 
-  case 34:
-#line 262 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_nominal((yyvsp[0].string), NULL, true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2187 "grammar.c" /* yacc.c:1652  */
+  case 34: /* dtype: QUESTIONMARK NAME_LOWER  */
+#line 294 "grammar.y"
+                                                  { (yyval.ndt) = mk_nominal((yyvsp[0].name), true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2326 "grammar.c"
     break;
 
-  case 35:
-#line 263 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_constr((yyvsp[-3].string), (yyvsp[-1].ndt), false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2193 "grammar.c" /* yacc.c:1652  */
+  case 35: /* dtype: NAME_UPPER LPAREN datashape RPAREN  */
+#line 295 "grammar.y"
+                                                  { (yyval.ndt) = mk_constr((yyvsp[-3].name), (yyvsp[-1].ndt), false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2332 "grammar.c"
     break;
 
-  case 36:
-#line 264 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_constr((yyvsp[-3].string), (yyvsp[-1].ndt), true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2199 "grammar.c" /* yacc.c:1652  */
+  case 36: /* dtype: QUESTIONMARK NAME_UPPER LPAREN datashape RPAREN  */
+#line 296 "grammar.y"
+                                                  { (yyval.ndt) = mk_constr((yyvsp[-3].name), (yyvsp[-1].ndt), true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2338 "grammar.c"
     break;
 
-  case 37:
-#line 265 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_typevar((yyvsp[0].string), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2205 "grammar.c" /* yacc.c:1652  */
+  case 37: /* dtype: NAME_UPPER  */
+#line 297 "grammar.y"
+                                                  { (yyval.ndt) = mk_typevar((yyvsp[0].name), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2344 "grammar.c"
     break;
 
-  case 38:
-#line 268 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_primitive(Bool, (yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2211 "grammar.c" /* yacc.c:1652  */
+  case 38: /* scalar: flags_opt BOOL  */
+#line 300 "grammar.y"
+                               { (yyval.ndt) = ndt_primitive(Bool, (yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2350 "grammar.c"
     break;
 
-  case 39:
-#line 269 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_signed_kind((yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2217 "grammar.c" /* yacc.c:1652  */
+  case 39: /* scalar: flags_opt SIGNED_KIND  */
+#line 301 "grammar.y"
+                               { (yyval.ndt) = ndt_signed_kind((yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2356 "grammar.c"
     break;
 
-  case 40:
-#line 270 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_primitive((yyvsp[0].tag), (yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2223 "grammar.c" /* yacc.c:1652  */
+  case 40: /* scalar: flags_opt signed  */
+#line 302 "grammar.y"
+                               { (yyval.ndt) = ndt_primitive((yyvsp[0].tag), (yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2362 "grammar.c"
     break;
 
-  case 41:
-#line 271 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_unsigned_kind((yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2229 "grammar.c" /* yacc.c:1652  */
+  case 41: /* scalar: flags_opt UNSIGNED_KIND  */
+#line 303 "grammar.y"
+                               { (yyval.ndt) = ndt_unsigned_kind((yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2368 "grammar.c"
     break;
 
-  case 42:
-#line 272 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_primitive((yyvsp[0].tag), (yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2235 "grammar.c" /* yacc.c:1652  */
+  case 42: /* scalar: flags_opt unsigned  */
+#line 304 "grammar.y"
+                               { (yyval.ndt) = ndt_primitive((yyvsp[0].tag), (yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2374 "grammar.c"
     break;
 
-  case 43:
-#line 273 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_float_kind((yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2241 "grammar.c" /* yacc.c:1652  */
+  case 43: /* scalar: flags_opt FLOAT_KIND  */
+#line 305 "grammar.y"
+                               { (yyval.ndt) = ndt_float_kind((yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2380 "grammar.c"
     break;
 
-  case 44:
-#line 274 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_primitive(BFloat16, (yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2247 "grammar.c" /* yacc.c:1652  */
+  case 44: /* scalar: flags_opt BFLOAT16  */
+#line 306 "grammar.y"
+                               { (yyval.ndt) = ndt_primitive(BFloat16, (yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2386 "grammar.c"
     break;
 
-  case 45:
-#line 275 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_primitive((yyvsp[0].tag), (yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2253 "grammar.c" /* yacc.c:1652  */
+  case 45: /* scalar: flags_opt ieee_float  */
+#line 307 "grammar.y"
+                               { (yyval.ndt) = ndt_primitive((yyvsp[0].tag), (yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2392 "grammar.c"
     break;
 
-  case 46:
-#line 276 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_complex_kind((yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2259 "grammar.c" /* yacc.c:1652  */
+  case 46: /* scalar: flags_opt COMPLEX_KIND  */
+#line 308 "grammar.y"
+                               { (yyval.ndt) = ndt_complex_kind((yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2398 "grammar.c"
     break;
 
-  case 47:
-#line 277 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_primitive(BComplex32, (yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2265 "grammar.c" /* yacc.c:1652  */
+  case 47: /* scalar: flags_opt BCOMPLEX32  */
+#line 309 "grammar.y"
+                               { (yyval.ndt) = ndt_primitive(BComplex32, (yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2404 "grammar.c"
     break;
 
-  case 48:
-#line 278 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_primitive((yyvsp[0].tag), (yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2271 "grammar.c" /* yacc.c:1652  */
+  case 48: /* scalar: flags_opt ieee_complex  */
+#line 310 "grammar.y"
+                               { (yyval.ndt) = ndt_primitive((yyvsp[0].tag), (yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2410 "grammar.c"
     break;
 
-  case 49:
-#line 279 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_from_alias((yyvsp[0].alias), (yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2277 "grammar.c" /* yacc.c:1652  */
+  case 49: /* scalar: flags_opt alias  */
+#line 311 "grammar.y"
+                               { (yyval.ndt) = ndt_from_alias((yyvsp[0].alias), (yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2416 "grammar.c"
     break;
 
-  case 50:
-#line 280 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2283 "grammar.c" /* yacc.c:1652  */
+  case 50: /* scalar: character  */
+#line 312 "grammar.y"
+                               { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2422 "grammar.c"
     break;
 
-  case 51:
-#line 281 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2289 "grammar.c" /* yacc.c:1652  */
+  case 51: /* scalar: string  */
+#line 313 "grammar.y"
+                               { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2428 "grammar.c"
     break;
 
-  case 52:
-#line 282 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_fixed_string_kind((yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2295 "grammar.c" /* yacc.c:1652  */
+  case 52: /* scalar: option_opt FIXED_STRING_KIND  */
+#line 314 "grammar.y"
+                               { (yyval.ndt) = ndt_fixed_string_kind((yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2434 "grammar.c"
     break;
 
-  case 53:
-#line 283 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2301 "grammar.c" /* yacc.c:1652  */
+  case 53: /* scalar: fixed_string  */
+#line 315 "grammar.y"
+                               { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2440 "grammar.c"
     break;
 
-  case 54:
-#line 284 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2307 "grammar.c" /* yacc.c:1652  */
+  case 54: /* scalar: bytes  */
+#line 316 "grammar.y"
+                               { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2446 "grammar.c"
     break;
 
-  case 55:
-#line 285 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_fixed_bytes_kind((yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2313 "grammar.c" /* yacc.c:1652  */
+  case 55: /* scalar: option_opt FIXED_BYTES_KIND  */
+#line 317 "grammar.y"
+                               { (yyval.ndt) = ndt_fixed_bytes_kind((yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2452 "grammar.c"
     break;
 
-  case 56:
-#line 286 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2319 "grammar.c" /* yacc.c:1652  */
+  case 56: /* scalar: fixed_bytes  */
+#line 318 "grammar.y"
+                               { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2458 "grammar.c"
     break;
 
-  case 57:
-#line 287 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2325 "grammar.c" /* yacc.c:1652  */
+  case 57: /* scalar: categorical  */
+#line 319 "grammar.y"
+                               { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2464 "grammar.c"
     break;
 
-  case 58:
-#line 288 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2331 "grammar.c" /* yacc.c:1652  */
+  case 58: /* scalar: ref  */
+#line 320 "grammar.y"
+                               { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2470 "grammar.c"
     break;
 
-  case 59:
-#line 291 "grammar.y" /* yacc.c:1652  */
-    { (yyval.tag) = Int8; }
-#line 2337 "grammar.c" /* yacc.c:1652  */
+  case 59: /* signed: INT8  */
+#line 323 "grammar.y"
+        { (yyval.tag) = Int8; }
+#line 2476 "grammar.c"
     break;
 
-  case 60:
-#line 292 "grammar.y" /* yacc.c:1652  */
-    { (yyval.tag) = Int16; }
-#line 2343 "grammar.c" /* yacc.c:1652  */
+  case 60: /* signed: INT16  */
+#line 324 "grammar.y"
+        { (yyval.tag) = Int16; }
+#line 2482 "grammar.c"
     break;
 
-  case 61:
-#line 293 "grammar.y" /* yacc.c:1652  */
-    { (yyval.tag) = Int32; }
-#line 2349 "grammar.c" /* yacc.c:1652  */
+  case 61: /* signed: INT32  */
+#line 325 "grammar.y"
+        { (yyval.tag) = Int32; }
+#line 2488 "grammar.c"
     break;
 
-  case 62:
-#line 294 "grammar.y" /* yacc.c:1652  */
-    { (yyval.tag) = Int64; }
-#line 2355 "grammar.c" /* yacc.c:1652  */
+  case 62: /* signed: INT64  */
+#line 326 "grammar.y"
+        { (yyval.tag) = Int64; }
+#line 2494 "grammar.c"
     break;
 
-  case 63:
-#line 297 "grammar.y" /* yacc.c:1652  */
-    { (yyval.tag) = Uint8; }
-#line 2361 "grammar.c" /* yacc.c:1652  */
+  case 63: /* unsigned: UINT8  */
+#line 329 "grammar.y"
+         { (yyval.tag) = Uint8; }
+#line 2500 "grammar.c"
     break;
 
-  case 64:
-#line 298 "grammar.y" /* yacc.c:1652  */
-    { (yyval.tag) = Uint16; }
-#line 2367 "grammar.c" /* yacc.c:1652  */
+  case 64: /* unsigned: UINT16  */
+#line 330 "grammar.y"
+         { (yyval.tag) = Uint16; }
+#line 2506 "grammar.c"
     break;
 
-  case 65:
-#line 299 "grammar.y" /* yacc.c:1652  */
-    { (yyval.tag) = Uint32; }
-#line 2373 "grammar.c" /* yacc.c:1652  */
+  case 65: /* unsigned: UINT32  */
+#line 331 "grammar.y"
+         { (yyval.tag) = Uint32; }
+#line 2512 "grammar.c"
     break;
 
-  case 66:
-#line 300 "grammar.y" /* yacc.c:1652  */
-    { (yyval.tag) = Uint64; }
-#line 2379 "grammar.c" /* yacc.c:1652  */
+  case 66: /* unsigned: UINT64  */
+#line 332 "grammar.y"
+         { (yyval.tag) = Uint64; }
+#line 2518 "grammar.c"
     break;
 
-  case 67:
-#line 303 "grammar.y" /* yacc.c:1652  */
-    { (yyval.tag) = Float16; }
-#line 2385 "grammar.c" /* yacc.c:1652  */
+  case 67: /* ieee_float: FLOAT16  */
+#line 335 "grammar.y"
+          { (yyval.tag) = Float16; }
+#line 2524 "grammar.c"
     break;
 
-  case 68:
-#line 304 "grammar.y" /* yacc.c:1652  */
-    { (yyval.tag) = Float32; }
-#line 2391 "grammar.c" /* yacc.c:1652  */
+  case 68: /* ieee_float: FLOAT32  */
+#line 336 "grammar.y"
+          { (yyval.tag) = Float32; }
+#line 2530 "grammar.c"
     break;
 
-  case 69:
-#line 305 "grammar.y" /* yacc.c:1652  */
-    { (yyval.tag) = Float64; }
-#line 2397 "grammar.c" /* yacc.c:1652  */
+  case 69: /* ieee_float: FLOAT64  */
+#line 337 "grammar.y"
+          { (yyval.tag) = Float64; }
+#line 2536 "grammar.c"
     break;
 
-  case 70:
-#line 308 "grammar.y" /* yacc.c:1652  */
-    { (yyval.tag) = Complex32; }
-#line 2403 "grammar.c" /* yacc.c:1652  */
+  case 70: /* ieee_complex: COMPLEX32  */
+#line 340 "grammar.y"
+             { (yyval.tag) = Complex32; }
+#line 2542 "grammar.c"
     break;
 
-  case 71:
-#line 309 "grammar.y" /* yacc.c:1652  */
-    { (yyval.tag) = Complex64; }
-#line 2409 "grammar.c" /* yacc.c:1652  */
+  case 71: /* ieee_complex: COMPLEX64  */
+#line 341 "grammar.y"
+             { (yyval.tag) = Complex64; }
+#line 2548 "grammar.c"
     break;
 
-  case 72:
-#line 310 "grammar.y" /* yacc.c:1652  */
-    { (yyval.tag) = Complex128; }
-#line 2415 "grammar.c" /* yacc.c:1652  */
+  case 72: /* ieee_complex: COMPLEX128  */
+#line 342 "grammar.y"
+             { (yyval.tag) = Complex128; }
+#line 2554 "grammar.c"
     break;
 
-  case 73:
-#line 314 "grammar.y" /* yacc.c:1652  */
-    { (yyval.alias) = Intptr; }
-#line 2421 "grammar.c" /* yacc.c:1652  */
+  case 73: /* alias: INTPTR  */
+#line 346 "grammar.y"
+          { (yyval.alias) = Intptr; }
+#line 2560 "grammar.c"
     break;
 
-  case 74:
-#line 315 "grammar.y" /* yacc.c:1652  */
-    { (yyval.alias) = Uintptr; }
-#line 2427 "grammar.c" /* yacc.c:1652  */
+  case 74: /* alias: UINTPTR  */
+#line 347 "grammar.y"
+          { (yyval.alias) = Uintptr; }
+#line 2566 "grammar.c"
     break;
 
-  case 75:
-#line 316 "grammar.y" /* yacc.c:1652  */
-    { (yyval.alias) = Size; }
-#line 2433 "grammar.c" /* yacc.c:1652  */
+  case 75: /* alias: SIZE  */
+#line 348 "grammar.y"
+          { (yyval.alias) = Size; }
+#line 2572 "grammar.c"
     break;
 
-  case 76:
-#line 319 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_char(Utf32, (yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2439 "grammar.c" /* yacc.c:1652  */
+  case 76: /* character: option_opt CHAR  */
+#line 351 "grammar.y"
+                                         { (yyval.ndt) = ndt_char(Utf32, (yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2578 "grammar.c"
     break;
 
-  case 77:
-#line 320 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_char((yyvsp[-1].encoding), (yyvsp[-4].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2445 "grammar.c" /* yacc.c:1652  */
+  case 77: /* character: option_opt CHAR LPAREN encoding RPAREN  */
+#line 352 "grammar.y"
+                                         { (yyval.ndt) = ndt_char((yyvsp[-1].encoding), (yyvsp[-4].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2584 "grammar.c"
     break;
 
-  case 78:
-#line 323 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = ndt_string((yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2451 "grammar.c" /* yacc.c:1652  */
+  case 78: /* string: option_opt STRING  */
+#line 355 "grammar.y"
+                    { (yyval.ndt) = ndt_string((yyvsp[-1].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2590 "grammar.c"
     break;
 
-  case 79:
-#line 326 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_fixed_string((yyvsp[-1].string), Utf8, (yyvsp[-4].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2457 "grammar.c" /* yacc.c:1652  */
+  case 79: /* fixed_string: option_opt FIXED_STRING LPAREN INTEGER RPAREN  */
+#line 358 "grammar.y"
+                                                               { (yyval.ndt) = mk_fixed_string((yyvsp[-1].string), Utf8, (yyvsp[-4].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2596 "grammar.c"
     break;
 
-  case 80:
-#line 327 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_fixed_string((yyvsp[-3].string), (yyvsp[-1].encoding), (yyvsp[-6].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2463 "grammar.c" /* yacc.c:1652  */
+  case 80: /* fixed_string: option_opt FIXED_STRING LPAREN INTEGER COMMA encoding RPAREN  */
+#line 359 "grammar.y"
+                                                               { (yyval.ndt) = mk_fixed_string((yyvsp[-3].string), (yyvsp[-1].encoding), (yyvsp[-6].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2602 "grammar.c"
     break;
 
-  case 81:
-#line 330 "grammar.y" /* yacc.c:1652  */
-    { (yyval.uint32) = (yyvsp[-1].uint32) | (yyvsp[0].uint32); }
-#line 2469 "grammar.c" /* yacc.c:1652  */
+  case 81: /* flags_opt: option_opt endian_opt  */
+#line 362 "grammar.y"
+                        { (yyval.uint32) = (yyvsp[-1].uint32) | (yyvsp[0].uint32); }
+#line 2608 "grammar.c"
     break;
 
-  case 82:
-#line 333 "grammar.y" /* yacc.c:1652  */
-    { (yyval.uint32) = 0; }
-#line 2475 "grammar.c" /* yacc.c:1652  */
+  case 82: /* option_opt: %empty  */
+#line 365 "grammar.y"
+               { (yyval.uint32) = 0; }
+#line 2614 "grammar.c"
     break;
 
-  case 83:
-#line 334 "grammar.y" /* yacc.c:1652  */
-    { (yyval.uint32) = NDT_OPTION; }
-#line 2481 "grammar.c" /* yacc.c:1652  */
+  case 83: /* option_opt: QUESTIONMARK  */
+#line 366 "grammar.y"
+               { (yyval.uint32) = NDT_OPTION; }
+#line 2620 "grammar.c"
     break;
 
-  case 84:
-#line 337 "grammar.y" /* yacc.c:1652  */
-    { (yyval.uint32) = 0; }
-#line 2487 "grammar.c" /* yacc.c:1652  */
+  case 84: /* endian_opt: %empty  */
+#line 369 "grammar.y"
+          { (yyval.uint32) = 0; }
+#line 2626 "grammar.c"
     break;
 
-  case 85:
-#line 338 "grammar.y" /* yacc.c:1652  */
-    { (yyval.uint32) = NDT_SYS_BIG_ENDIAN ? NDT_BIG_ENDIAN : NDT_LITTLE_ENDIAN; }
-#line 2493 "grammar.c" /* yacc.c:1652  */
+  case 85: /* endian_opt: EQUAL  */
+#line 370 "grammar.y"
+          { (yyval.uint32) = NDT_SYS_BIG_ENDIAN ? NDT_BIG_ENDIAN : NDT_LITTLE_ENDIAN; }
+#line 2632 "grammar.c"
     break;
 
-  case 86:
-#line 339 "grammar.y" /* yacc.c:1652  */
-    { (yyval.uint32) = NDT_LITTLE_ENDIAN; }
-#line 2499 "grammar.c" /* yacc.c:1652  */
+  case 86: /* endian_opt: LESS  */
+#line 371 "grammar.y"
+          { (yyval.uint32) = NDT_LITTLE_ENDIAN; }
+#line 2638 "grammar.c"
     break;
 
-  case 87:
-#line 340 "grammar.y" /* yacc.c:1652  */
-    { (yyval.uint32) = NDT_BIG_ENDIAN; }
-#line 2505 "grammar.c" /* yacc.c:1652  */
+  case 87: /* endian_opt: GREATER  */
+#line 372 "grammar.y"
+          { (yyval.uint32) = NDT_BIG_ENDIAN; }
+#line 2644 "grammar.c"
     break;
 
-  case 88:
-#line 341 "grammar.y" /* yacc.c:1652  */
-    { (yyval.uint32) = 0; }
-#line 2511 "grammar.c" /* yacc.c:1652  */
+  case 88: /* endian_opt: BAR  */
+#line 373 "grammar.y"
+          { (yyval.uint32) = 0; }
+#line 2650 "grammar.c"
     break;
 
-  case 89:
-#line 344 "grammar.y" /* yacc.c:1652  */
-    { (yyval.encoding) = encoding_from_string((yyvsp[0].string), ctx); if (ndt_err_occurred(ctx)) YYABORT; }
-#line 2517 "grammar.c" /* yacc.c:1652  */
+  case 89: /* encoding: STRINGLIT  */
+#line 376 "grammar.y"
+            { (yyval.encoding) = encoding_from_string((yyvsp[0].string), ctx); if (ndt_err_occurred(ctx)) YYABORT; }
+#line 2656 "grammar.c"
     break;
 
-  case 90:
-#line 347 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_bytes((yyvsp[0].attribute_seq), (yyvsp[-2].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2523 "grammar.c" /* yacc.c:1652  */
+  case 90: /* bytes: option_opt BYTES arguments_opt  */
+#line 379 "grammar.y"
+                                 { (yyval.ndt) = mk_bytes((yyvsp[0].attribute_seq), (yyvsp[-2].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2662 "grammar.c"
     break;
 
-  case 91:
-#line 350 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_fixed_bytes((yyvsp[-1].attribute_seq), (yyvsp[-4].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2529 "grammar.c" /* yacc.c:1652  */
+  case 91: /* fixed_bytes: option_opt FIXED_BYTES LPAREN attribute_seq RPAREN  */
+#line 382 "grammar.y"
+                                                     { (yyval.ndt) = mk_fixed_bytes((yyvsp[-1].attribute_seq), (yyvsp[-4].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2668 "grammar.c"
     break;
 
-  case 92:
-#line 353 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_ref((yyvsp[-1].ndt), (yyvsp[-4].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2535 "grammar.c" /* yacc.c:1652  */
+  case 92: /* ref: option_opt REF LPAREN datashape RPAREN  */
+#line 385 "grammar.y"
+                                         { (yyval.ndt) = mk_ref((yyvsp[-1].ndt), (yyvsp[-4].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2674 "grammar.c"
     break;
 
-  case 93:
-#line 354 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_ref((yyvsp[0].ndt), (yyvsp[-2].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2541 "grammar.c" /* yacc.c:1652  */
+  case 93: /* ref: option_opt AMPERSAND datashape  */
+#line 386 "grammar.y"
+                                         { (yyval.ndt) = mk_ref((yyvsp[0].ndt), (yyvsp[-2].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2680 "grammar.c"
     break;
 
-  case 94:
-#line 357 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_categorical((yyvsp[-1].typed_value_seq), (yyvsp[-4].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2547 "grammar.c" /* yacc.c:1652  */
+  case 94: /* categorical: option_opt CATEGORICAL LPAREN typed_value_seq RPAREN  */
+#line 389 "grammar.y"
+                                                       { (yyval.ndt) = mk_categorical((yyvsp[-1].typed_value_seq), (yyvsp[-4].uint32), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2686 "grammar.c"
     break;
 
-  case 95:
-#line 360 "grammar.y" /* yacc.c:1652  */
-    { (yyval.typed_value_seq) = ndt_value_seq_new((yyvsp[0].typed_value), ctx); if ((yyval.typed_value_seq) == NULL) YYABORT; }
-#line 2553 "grammar.c" /* yacc.c:1652  */
+  case 95: /* typed_value_seq: typed_value  */
+#line 392 "grammar.y"
+                                    { (yyval.typed_value_seq) = ndt_value_seq_new((yyvsp[0].typed_value), ctx); if ((yyval.typed_value_seq) == NULL) YYABORT; }
+#line 2692 "grammar.c"
     break;
 
-  case 96:
-#line 361 "grammar.y" /* yacc.c:1652  */
-    { (yyval.typed_value_seq) = ndt_value_seq_append((yyvsp[-2].typed_value_seq), (yyvsp[0].typed_value), ctx); if ((yyval.typed_value_seq) == NULL) YYABORT; }
-#line 2559 "grammar.c" /* yacc.c:1652  */
+  case 96: /* typed_value_seq: typed_value_seq COMMA typed_value  */
+#line 393 "grammar.y"
+                                    { (yyval.typed_value_seq) = ndt_value_seq_append((yyvsp[-2].typed_value_seq), (yyvsp[0].typed_value), ctx); if ((yyval.typed_value_seq) == NULL) YYABORT; }
+#line 2698 "grammar.c"
     break;
 
-  case 97:
-#line 364 "grammar.y" /* yacc.c:1652  */
-    { (yyval.typed_value) = ndt_value_from_number(ValInt64, (yyvsp[0].string), ctx); if ((yyval.typed_value) == NULL) YYABORT; }
-#line 2565 "grammar.c" /* yacc.c:1652  */
+  case 97: /* typed_value: INTEGER  */
+#line 396 "grammar.y"
+              { (yyval.typed_value) = ndt_value_from_number(ValInt64, (yyvsp[0].string), ctx); if ((yyval.typed_value) == NULL) YYABORT; }
+#line 2704 "grammar.c"
     break;
 
-  case 98:
-#line 365 "grammar.y" /* yacc.c:1652  */
-    { (yyval.typed_value) = ndt_value_from_number(ValFloat64, (yyvsp[0].string), ctx); if ((yyval.typed_value) == NULL) YYABORT; }
-#line 2571 "grammar.c" /* yacc.c:1652  */
+  case 98: /* typed_value: FLOATNUMBER  */
+#line 397 "grammar.y"
+              { (yyval.typed_value) = ndt_value_from_number(ValFloat64, (yyvsp[0].string), ctx); if ((yyval.typed_value) == NULL) YYABORT; }
+#line 2710 "grammar.c"
     break;
 
-  case 99:
-#line 366 "grammar.y" /* yacc.c:1652  */
-    { (yyval.typed_value) = ndt_value_from_string((yyvsp[0].string), ctx); if ((yyval.typed_value) == NULL) YYABORT; }
-#line 2577 "grammar.c" /* yacc.c:1652  */
+  case 99: /* typed_value: STRINGLIT  */
+#line 398 "grammar.y"
+              { (yyval.typed_value) = ndt_value_from_string((yyvsp[0].string), ctx); if ((yyval.typed_value) == NULL) YYABORT; }
+#line 2716 "grammar.c"
     break;
 
-  case 100:
-#line 367 "grammar.y" /* yacc.c:1652  */
-    { (yyval.typed_value) = ndt_value_na(ctx); if ((yyval.typed_value) == NULL) YYABORT; }
-#line 2583 "grammar.c" /* yacc.c:1652  */
+  case 100: /* typed_value: NA  */
+#line 399 "grammar.y"
+              { (yyval.typed_value) = ndt_value_na(ctx); if ((yyval.typed_value) == NULL) YYABORT; }
+#line 2722 "grammar.c"
     break;
 
-  case 101:
-#line 370 "grammar.y" /* yacc.c:1652  */
-    { (yyval.variadic_flag) = Nonvariadic; }
-#line 2589 "grammar.c" /* yacc.c:1652  */
+  case 101: /* variadic_flag: %empty  */
+#line 402 "grammar.y"
+           { (yyval.variadic_flag) = Nonvariadic; }
+#line 2728 "grammar.c"
     break;
 
-  case 102:
-#line 371 "grammar.y" /* yacc.c:1652  */
-    { (yyval.variadic_flag) = Variadic; }
-#line 2595 "grammar.c" /* yacc.c:1652  */
+  case 102: /* variadic_flag: ELLIPSIS  */
+#line 403 "grammar.y"
+           { (yyval.variadic_flag) = Variadic; }
+#line 2734 "grammar.c"
     break;
 
-  case 103:
-#line 374 "grammar.y" /* yacc.c:1652  */
-    { (yyval.variadic_flag) = Nonvariadic; }
-#line 2601 "grammar.c" /* yacc.c:1652  */
+  case 103: /* comma_variadic_flag: %empty  */
+#line 406 "grammar.y"
+                 { (yyval.variadic_flag) = Nonvariadic; }
+#line 2740 "grammar.c"
     break;
 
-  case 104:
-#line 375 "grammar.y" /* yacc.c:1652  */
-    { (yyval.variadic_flag) = Nonvariadic; }
-#line 2607 "grammar.c" /* yacc.c:1652  */
+  case 104: /* comma_variadic_flag: COMMA  */
+#line 407 "grammar.y"
+                 { (yyval.variadic_flag) = Nonvariadic; }
+#line 2746 "grammar.c"
     break;
 
-  case 105:
-#line 376 "grammar.y" /* yacc.c:1652  */
-    { (yyval.variadic_flag) = Variadic; }
-#line 2613 "grammar.c" /* yacc.c:1652  */
+  case 105: /* comma_variadic_flag: COMMA ELLIPSIS  */
+#line 408 "grammar.y"
+                 { (yyval.variadic_flag) = Variadic; }
+#line 2752 "grammar.c"
     break;
 
-  case 106:
-#line 379 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_tuple((yyvsp[-1].variadic_flag), NULL, NULL, false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2619 "grammar.c" /* yacc.c:1652  */
+  case 106: /* tuple_type: LPAREN variadic_flag RPAREN  */
+#line 411 "grammar.y"
+                                                                 { (yyval.ndt) = mk_tuple((yyvsp[-1].variadic_flag), NULL, NULL, false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2758 "grammar.c"
     break;
 
-  case 107:
-#line 380 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_tuple((yyvsp[-1].variadic_flag), (yyvsp[-2].field_seq), NULL, false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2625 "grammar.c" /* yacc.c:1652  */
+  case 107: /* tuple_type: LPAREN tuple_field_seq comma_variadic_flag RPAREN  */
+#line 412 "grammar.y"
+                                                                 { (yyval.ndt) = mk_tuple((yyvsp[-1].variadic_flag), (yyvsp[-2].field_seq), NULL, false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2764 "grammar.c"
     break;
 
-  case 108:
-#line 381 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_tuple(Nonvariadic, (yyvsp[-3].field_seq), (yyvsp[-1].attribute_seq), false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2631 "grammar.c" /* yacc.c:1652  */
+  case 108: /* tuple_type: LPAREN tuple_field_seq COMMA attribute_seq RPAREN  */
+#line 413 "grammar.y"
+                                                                 { (yyval.ndt) = mk_tuple(Nonvariadic, (yyvsp[-3].field_seq), (yyvsp[-1].attribute_seq), false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2770 "grammar.c"
     break;
 
-  case 109:
-#line 382 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_tuple((yyvsp[-1].variadic_flag), NULL, NULL, true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2637 "grammar.c" /* yacc.c:1652  */
+  case 109: /* tuple_type: QUESTIONMARK LPAREN variadic_flag RPAREN  */
+#line 414 "grammar.y"
+                                                                 { (yyval.ndt) = mk_tuple((yyvsp[-1].variadic_flag), NULL, NULL, true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2776 "grammar.c"
     break;
 
-  case 110:
-#line 383 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_tuple((yyvsp[-1].variadic_flag), (yyvsp[-2].field_seq), NULL, true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2643 "grammar.c" /* yacc.c:1652  */
+  case 110: /* tuple_type: QUESTIONMARK LPAREN tuple_field_seq comma_variadic_flag RPAREN  */
+#line 415 "grammar.y"
+                                                                 { (yyval.ndt) = mk_tuple((yyvsp[-1].variadic_flag), (yyvsp[-2].field_seq), NULL, true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2782 "grammar.c"
     break;
 
-  case 111:
-#line 384 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_tuple(Nonvariadic, (yyvsp[-3].field_seq), (yyvsp[-1].attribute_seq), true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2649 "grammar.c" /* yacc.c:1652  */
+  case 111: /* tuple_type: QUESTIONMARK LPAREN tuple_field_seq COMMA attribute_seq RPAREN  */
+#line 416 "grammar.y"
+                                                                 { (yyval.ndt) = mk_tuple(Nonvariadic, (yyvsp[-3].field_seq), (yyvsp[-1].attribute_seq), true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2788 "grammar.c"
     break;
 
-  case 112:
-#line 387 "grammar.y" /* yacc.c:1652  */
-    { (yyval.field_seq) = ndt_field_seq_new((yyvsp[0].field), ctx); if ((yyval.field_seq) == NULL) YYABORT; }
-#line 2655 "grammar.c" /* yacc.c:1652  */
+  case 112: /* tuple_field_seq: tuple_field  */
+#line 419 "grammar.y"
+                                    { (yyval.field_seq) = ndt_field_seq_new((yyvsp[0].field), ctx); if ((yyval.field_seq) == NULL) YYABORT; }
+#line 2794 "grammar.c"
     break;
 
-  case 113:
-#line 388 "grammar.y" /* yacc.c:1652  */
-    { (yyval.field_seq) = ndt_field_seq_append((yyvsp[-2].field_seq), (yyvsp[0].field), ctx); if ((yyval.field_seq) == NULL) YYABORT; }
-#line 2661 "grammar.c" /* yacc.c:1652  */
+  case 113: /* tuple_field_seq: tuple_field_seq COMMA tuple_field  */
+#line 420 "grammar.y"
+                                    { (yyval.field_seq) = ndt_field_seq_append((yyvsp[-2].field_seq), (yyvsp[0].field), ctx); if ((yyval.field_seq) == NULL) YYABORT; }
+#line 2800 "grammar.c"
     break;
 
-  case 114:
-#line 391 "grammar.y" /* yacc.c:1652  */
-    { (yyval.field) = mk_field(NULL, (yyvsp[0].ndt), NULL, ctx); if ((yyval.field) == NULL) YYABORT; }
-#line 2667 "grammar.c" /* yacc.c:1652  */
+  case 114: /* tuple_field: datashape  */
+#line 423 "grammar.y"
+                                  { (yyval.field) = mk_field(NULL, (yyvsp[0].ndt), NULL, ctx); if ((yyval.field) == NULL) YYABORT; }
+#line 2806 "grammar.c"
     break;
 
-  case 115:
-#line 392 "grammar.y" /* yacc.c:1652  */
-    { (yyval.field) = mk_field(NULL, (yyvsp[-3].ndt), (yyvsp[-1].attribute_seq), ctx); if ((yyval.field) == NULL) YYABORT; }
-#line 2673 "grammar.c" /* yacc.c:1652  */
+  case 115: /* tuple_field: datashape BAR attribute_seq BAR  */
+#line 424 "grammar.y"
+                                  { (yyval.field) = mk_field(NULL, (yyvsp[-3].ndt), (yyvsp[-1].attribute_seq), ctx); if ((yyval.field) == NULL) YYABORT; }
+#line 2812 "grammar.c"
     break;
 
-  case 116:
-#line 395 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_record((yyvsp[-1].variadic_flag), NULL, NULL, false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2679 "grammar.c" /* yacc.c:1652  */
+  case 116: /* record_type: LBRACE variadic_flag RBRACE  */
+#line 427 "grammar.y"
+                                                                  { (yyval.ndt) = mk_record((yyvsp[-1].variadic_flag), NULL, NULL, false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2818 "grammar.c"
     break;
 
-  case 117:
-#line 396 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_record((yyvsp[-1].variadic_flag), (yyvsp[-2].field_seq), NULL, false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2685 "grammar.c" /* yacc.c:1652  */
+  case 117: /* record_type: LBRACE record_field_seq comma_variadic_flag RBRACE  */
+#line 428 "grammar.y"
+                                                                  { (yyval.ndt) = mk_record((yyvsp[-1].variadic_flag), (yyvsp[-2].field_seq), NULL, false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2824 "grammar.c"
     break;
 
-  case 118:
-#line 397 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_record(Nonvariadic, (yyvsp[-3].field_seq), (yyvsp[-1].attribute_seq), false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2691 "grammar.c" /* yacc.c:1652  */
+  case 118: /* record_type: LBRACE record_field_seq COMMA attribute_seq RBRACE  */
+#line 429 "grammar.y"
+                                                                  { (yyval.ndt) = mk_record(Nonvariadic, (yyvsp[-3].field_seq), (yyvsp[-1].attribute_seq), false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2830 "grammar.c"
     break;
 
-  case 119:
-#line 398 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_record((yyvsp[-1].variadic_flag), NULL, NULL, true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2697 "grammar.c" /* yacc.c:1652  */
+  case 119: /* record_type: QUESTIONMARK LBRACE variadic_flag RBRACE  */
+#line 430 "grammar.y"
+                                                                  { (yyval.ndt) = mk_record((yyvsp[-1].variadic_flag), NULL, NULL, true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2836 "grammar.c"
     break;
 
-  case 120:
-#line 399 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_record((yyvsp[-1].variadic_flag), (yyvsp[-2].field_seq), NULL, true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2703 "grammar.c" /* yacc.c:1652  */
+  case 120: /* record_type: QUESTIONMARK LBRACE record_field_seq comma_variadic_flag RBRACE  */
+#line 431 "grammar.y"
+                                                                  { (yyval.ndt) = mk_record((yyvsp[-1].variadic_flag), (yyvsp[-2].field_seq), NULL, true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2842 "grammar.c"
     break;
 
-  case 121:
-#line 400 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_record(Nonvariadic, (yyvsp[-3].field_seq), (yyvsp[-1].attribute_seq), true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2709 "grammar.c" /* yacc.c:1652  */
+  case 121: /* record_type: QUESTIONMARK LBRACE record_field_seq COMMA attribute_seq RBRACE  */
+#line 432 "grammar.y"
+                                                                  { (yyval.ndt) = mk_record(Nonvariadic, (yyvsp[-3].field_seq), (yyvsp[-1].attribute_seq), true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2848 "grammar.c"
     break;
 
-  case 122:
-#line 403 "grammar.y" /* yacc.c:1652  */
-    { (yyval.field_seq) = ndt_field_seq_new((yyvsp[0].field), ctx); if ((yyval.field_seq) == NULL) YYABORT; }
-#line 2715 "grammar.c" /* yacc.c:1652  */
+  case 122: /* record_field_seq: record_field  */
+#line 435 "grammar.y"
+                                       { (yyval.field_seq) = ndt_field_seq_new((yyvsp[0].field), ctx); if ((yyval.field_seq) == NULL) YYABORT; }
+#line 2854 "grammar.c"
     break;
 
-  case 123:
-#line 404 "grammar.y" /* yacc.c:1652  */
-    { (yyval.field_seq) = ndt_field_seq_append((yyvsp[-2].field_seq), (yyvsp[0].field), ctx); if ((yyval.field_seq) == NULL) YYABORT; }
-#line 2721 "grammar.c" /* yacc.c:1652  */
+  case 123: /* record_field_seq: record_field_seq COMMA record_field  */
+#line 436 "grammar.y"
+                                       { (yyval.field_seq) = ndt_field_seq_append((yyvsp[-2].field_seq), (yyvsp[0].field), ctx); if ((yyval.field_seq) == NULL) YYABORT; }
+#line 2860 "grammar.c"
     break;
 
-  case 124:
-#line 407 "grammar.y" /* yacc.c:1652  */
-    { (yyval.field) = mk_field((yyvsp[-2].string), (yyvsp[0].ndt), NULL, ctx); if ((yyval.field) == NULL) YYABORT; }
-#line 2727 "grammar.c" /* yacc.c:1652  */
+  case 124: /* record_field: field_name_or_tag COLON datashape  */
+#line 439 "grammar.y"
+                                                          { (yyval.field) = mk_field((yyvsp[-2].name), (yyvsp[0].ndt), NULL, ctx); if ((yyval.field) == NULL) YYABORT; }
+#line 2866 "grammar.c"
     break;
 
-  case 125:
-#line 408 "grammar.y" /* yacc.c:1652  */
-    { (yyval.field) = mk_field((yyvsp[-5].string), (yyvsp[-3].ndt), (yyvsp[-1].attribute_seq), ctx); if ((yyval.field) == NULL) YYABORT; }
-#line 2733 "grammar.c" /* yacc.c:1652  */
+  case 125: /* record_field: field_name_or_tag COLON datashape BAR attribute_seq BAR  */
+#line 440 "grammar.y"
+                                                          { (yyval.field) = mk_field((yyvsp[-5].name), (yyvsp[-3].ndt), (yyvsp[-1].attribute_seq), ctx); if ((yyval.field) == NULL) YYABORT; }
+#line 2872 "grammar.c"
     break;
 
-  case 126:
-#line 411 "grammar.y" /* yacc.c:1652  */
-    { (yyval.string) = (yyvsp[0].string); if ((yyval.string) == NULL) YYABORT; }
-#line 2739 "grammar.c" /* yacc.c:1652  */
+  case 126: /* field_name_or_tag: NAME_LOWER  */
+#line 443 "grammar.y"
+             { (yyval.name) = (yyvsp[0].name); if ((yyval.name) == NULL) YYABORT; }
+#line 2878 "grammar.c"
     break;
 
-  case 127:
-#line 412 "grammar.y" /* yacc.c:1652  */
-    { (yyval.string) = (yyvsp[0].string); if ((yyval.string) == NULL) YYABORT; }
-#line 2745 "grammar.c" /* yacc.c:1652  */
+  case 127: /* field_name_or_tag: NAME_UPPER  */
+#line 444 "grammar.y"
+             { (yyval.name) = (yyvsp[0].name); if ((yyval.name) == NULL) YYABORT; }
+#line 2884 "grammar.c"
     break;
 
-  case 128:
-#line 413 "grammar.y" /* yacc.c:1652  */
-    { (yyval.string) = (yyvsp[0].string); if ((yyval.string) == NULL) YYABORT; }
-#line 2751 "grammar.c" /* yacc.c:1652  */
+  case 128: /* field_name_or_tag: NAME_OTHER  */
+#line 445 "grammar.y"
+             { (yyval.name) = (yyvsp[0].name); if ((yyval.name) == NULL) YYABORT; }
+#line 2890 "grammar.c"
     break;
 
-  case 129:
-#line 416 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_union((yyvsp[0].field_seq), false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2757 "grammar.c" /* yacc.c:1652  */
+  case 129: /* union_type: union_member_seq  */
+#line 448 "grammar.y"
+                                                { (yyval.ndt) = mk_union((yyvsp[0].field_seq), false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2896 "grammar.c"
     break;
 
-  case 130:
-#line 417 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_union((yyvsp[-1].field_seq), false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2763 "grammar.c" /* yacc.c:1652  */
+  case 130: /* union_type: LBRACK union_member_seq RBRACK  */
+#line 449 "grammar.y"
+                                                { (yyval.ndt) = mk_union((yyvsp[-1].field_seq), false, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2902 "grammar.c"
     break;
 
-  case 131:
-#line 418 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_union((yyvsp[0].field_seq), true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2769 "grammar.c" /* yacc.c:1652  */
+  case 131: /* union_type: QUESTIONMARK union_member_seq  */
+#line 450 "grammar.y"
+                                                { (yyval.ndt) = mk_union((yyvsp[0].field_seq), true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2908 "grammar.c"
     break;
 
-  case 132:
-#line 419 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_union((yyvsp[-1].field_seq), true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2775 "grammar.c" /* yacc.c:1652  */
+  case 132: /* union_type: QUESTIONMARK LBRACK union_member_seq RBRACK  */
+#line 451 "grammar.y"
+                                                { (yyval.ndt) = mk_union((yyvsp[-1].field_seq), true, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2914 "grammar.c"
     break;
 
-  case 133:
-#line 422 "grammar.y" /* yacc.c:1652  */
-    { (yyval.field_seq) = ndt_field_seq_new((yyvsp[0].field), ctx); if ((yyval.field_seq) == NULL) YYABORT; }
-#line 2781 "grammar.c" /* yacc.c:1652  */
+  case 133: /* union_member_seq: union_member  */
+#line 454 "grammar.y"
+                                    { (yyval.field_seq) = ndt_field_seq_new((yyvsp[0].field), ctx); if ((yyval.field_seq) == NULL) YYABORT; }
+#line 2920 "grammar.c"
     break;
 
-  case 134:
-#line 423 "grammar.y" /* yacc.c:1652  */
-    { (yyval.field_seq) = ndt_field_seq_append((yyvsp[-2].field_seq), (yyvsp[0].field), ctx); if ((yyval.field_seq) == NULL) YYABORT; }
-#line 2787 "grammar.c" /* yacc.c:1652  */
+  case 134: /* union_member_seq: union_member_seq BAR union_member  */
+#line 455 "grammar.y"
+                                    { (yyval.field_seq) = ndt_field_seq_append((yyvsp[-2].field_seq), (yyvsp[0].field), ctx); if ((yyval.field_seq) == NULL) YYABORT; }
+#line 2926 "grammar.c"
     break;
 
-  case 135:
-#line 426 "grammar.y" /* yacc.c:1652  */
-    { (yyval.field) = mk_field((yyvsp[-2].string), (yyvsp[0].ndt), NULL, ctx); if ((yyval.field) == NULL) YYABORT; }
-#line 2793 "grammar.c" /* yacc.c:1652  */
+  case 135: /* union_member: field_name_or_tag OF datashape  */
+#line 458 "grammar.y"
+                                    { (yyval.field) = mk_field((yyvsp[-2].name), (yyvsp[0].ndt), NULL, ctx); if ((yyval.field) == NULL) YYABORT; }
+#line 2932 "grammar.c"
     break;
 
-  case 136:
-#line 429 "grammar.y" /* yacc.c:1652  */
-    { (yyval.attribute_seq) = NULL; }
-#line 2799 "grammar.c" /* yacc.c:1652  */
+  case 136: /* arguments_opt: %empty  */
+#line 461 "grammar.y"
+                              { (yyval.attribute_seq) = NULL; }
+#line 2938 "grammar.c"
     break;
 
-  case 137:
-#line 430 "grammar.y" /* yacc.c:1652  */
-    { (yyval.attribute_seq) = (yyvsp[-1].attribute_seq); if ((yyval.attribute_seq) == NULL) YYABORT; }
-#line 2805 "grammar.c" /* yacc.c:1652  */
+  case 137: /* arguments_opt: LPAREN attribute_seq RPAREN  */
+#line 462 "grammar.y"
+                              { (yyval.attribute_seq) = (yyvsp[-1].attribute_seq); if ((yyval.attribute_seq) == NULL) YYABORT; }
+#line 2944 "grammar.c"
     break;
 
-  case 138:
-#line 433 "grammar.y" /* yacc.c:1652  */
-    { (yyval.attribute_seq) = ndt_attr_seq_new((yyvsp[0].attribute), ctx); if ((yyval.attribute_seq) == NULL) YYABORT; }
-#line 2811 "grammar.c" /* yacc.c:1652  */
+  case 138: /* attribute_seq: attribute  */
+#line 465 "grammar.y"
+                                { (yyval.attribute_seq) = ndt_attr_seq_new((yyvsp[0].attribute), ctx); if ((yyval.attribute_seq) == NULL) YYABORT; }
+#line 2950 "grammar.c"
     break;
 
-  case 139:
-#line 434 "grammar.y" /* yacc.c:1652  */
-    { (yyval.attribute_seq) = ndt_attr_seq_append((yyvsp[-2].attribute_seq), (yyvsp[0].attribute), ctx); if ((yyval.attribute_seq) == NULL) YYABORT; }
-#line 2817 "grammar.c" /* yacc.c:1652  */
+  case 139: /* attribute_seq: attribute_seq COMMA attribute  */
+#line 466 "grammar.y"
+                                { (yyval.attribute_seq) = ndt_attr_seq_append((yyvsp[-2].attribute_seq), (yyvsp[0].attribute), ctx); if ((yyval.attribute_seq) == NULL) YYABORT; }
+#line 2956 "grammar.c"
     break;
 
-  case 140:
-#line 437 "grammar.y" /* yacc.c:1652  */
-    { (yyval.attribute) = mk_attr((yyvsp[-2].string), (yyvsp[0].string), ctx); if ((yyval.attribute) == NULL) YYABORT; }
-#line 2823 "grammar.c" /* yacc.c:1652  */
+  case 140: /* attribute: NAME_LOWER EQUAL untyped_value  */
+#line 469 "grammar.y"
+                                                   { (yyval.attribute) = mk_attr((yyvsp[-2].name), (yyvsp[0].string), ctx); if ((yyval.attribute) == NULL) YYABORT; }
+#line 2962 "grammar.c"
     break;
 
-  case 141:
-#line 438 "grammar.y" /* yacc.c:1652  */
-    { (yyval.attribute) = mk_attr_from_seq((yyvsp[-4].string), (yyvsp[-1].string_seq), ctx); if ((yyval.attribute) == NULL) YYABORT; }
-#line 2829 "grammar.c" /* yacc.c:1652  */
+  case 141: /* attribute: NAME_LOWER EQUAL LBRACK untyped_value_seq RBRACK  */
+#line 470 "grammar.y"
+                                                   { (yyval.attribute) = mk_attr_from_seq((yyvsp[-4].name), (yyvsp[-1].string_seq), ctx); if ((yyval.attribute) == NULL) YYABORT; }
+#line 2968 "grammar.c"
     break;
 
-  case 142:
-#line 441 "grammar.y" /* yacc.c:1652  */
-    { (yyval.string_seq) = ndt_string_seq_new((yyvsp[0].string), ctx); if ((yyval.string_seq) == NULL) YYABORT; }
-#line 2835 "grammar.c" /* yacc.c:1652  */
+  case 142: /* untyped_value_seq: untyped_value  */
+#line 473 "grammar.y"
+                                        { (yyval.string_seq) = ndt_string_seq_new((yyvsp[0].string), ctx); if ((yyval.string_seq) == NULL) YYABORT; }
+#line 2974 "grammar.c"
     break;
 
-  case 143:
-#line 442 "grammar.y" /* yacc.c:1652  */
-    { (yyval.string_seq) = ndt_string_seq_append((yyvsp[-2].string_seq), (yyvsp[0].string), ctx); if ((yyval.string_seq) == NULL) YYABORT; }
-#line 2841 "grammar.c" /* yacc.c:1652  */
+  case 143: /* untyped_value_seq: untyped_value_seq COMMA untyped_value  */
+#line 474 "grammar.y"
+                                        { (yyval.string_seq) = ndt_string_seq_append((yyvsp[-2].string_seq), (yyvsp[0].string), ctx); if ((yyval.string_seq) == NULL) YYABORT; }
+#line 2980 "grammar.c"
     break;
 
-  case 144:
-#line 445 "grammar.y" /* yacc.c:1652  */
-    { (yyval.string) = (yyvsp[0].string); if ((yyval.string) == NULL) YYABORT; }
-#line 2847 "grammar.c" /* yacc.c:1652  */
+  case 144: /* untyped_value: INTEGER  */
+#line 477 "grammar.y"
+              { (yyval.string) = (yyvsp[0].string); if ((yyval.string) == NULL) YYABORT; }
+#line 2986 "grammar.c"
     break;
 
-  case 145:
-#line 446 "grammar.y" /* yacc.c:1652  */
-    { (yyval.string) = (yyvsp[0].string); if ((yyval.string) == NULL) YYABORT; }
-#line 2853 "grammar.c" /* yacc.c:1652  */
+  case 145: /* untyped_value: FLOATNUMBER  */
+#line 478 "grammar.y"
+              { (yyval.string) = (yyvsp[0].string); if ((yyval.string) == NULL) YYABORT; }
+#line 2992 "grammar.c"
     break;
 
-  case 146:
-#line 447 "grammar.y" /* yacc.c:1652  */
-    { (yyval.string) = (yyvsp[0].string); if ((yyval.string) == NULL) YYABORT; }
-#line 2859 "grammar.c" /* yacc.c:1652  */
+  case 146: /* untyped_value: STRINGLIT  */
+#line 479 "grammar.y"
+              { (yyval.string) = (yyvsp[0].string); if ((yyval.string) == NULL) YYABORT; }
+#line 2998 "grammar.c"
     break;
 
-  case 147:
-#line 450 "grammar.y" /* yacc.c:1652  */
-    { (yyval.ndt) = mk_function((yyvsp[-2].type_seq), (yyvsp[0].type_seq), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2865 "grammar.c" /* yacc.c:1652  */
+  case 147: /* function_type: type_seq_or_void RARROW type_seq_or_void  */
+#line 482 "grammar.y"
+                                           { (yyval.ndt) = mk_function((yyvsp[-2].type_seq), (yyvsp[0].type_seq), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 3004 "grammar.c"
     break;
 
-  case 148:
-#line 453 "grammar.y" /* yacc.c:1652  */
-    { (yyval.type_seq) = (yyvsp[0].type_seq); }
-#line 2871 "grammar.c" /* yacc.c:1652  */
+  case 148: /* type_seq_or_void: type_seq  */
+#line 485 "grammar.y"
+           { (yyval.type_seq) = (yyvsp[0].type_seq); }
+#line 3010 "grammar.c"
     break;
 
-  case 149:
-#line 454 "grammar.y" /* yacc.c:1652  */
-    { (yyval.type_seq) = ndt_type_seq_empty(ctx); if ((yyval.type_seq) == NULL) YYABORT; }
-#line 2877 "grammar.c" /* yacc.c:1652  */
+  case 149: /* type_seq_or_void: VOID  */
+#line 486 "grammar.y"
+           { (yyval.type_seq) = ndt_type_seq_empty(ctx); if ((yyval.type_seq) == NULL) YYABORT; }
+#line 3016 "grammar.c"
     break;
 
-  case 150:
-#line 457 "grammar.y" /* yacc.c:1652  */
-    { (yyval.type_seq) = ndt_type_seq_new((ndt_t *)(yyvsp[0].ndt), ctx); if ((yyval.type_seq) == NULL) YYABORT; }
-#line 2883 "grammar.c" /* yacc.c:1652  */
+  case 150: /* type_seq: datashape_with_ellipsis  */
+#line 489 "grammar.y"
+                                         { (yyval.type_seq) = ndt_type_seq_new((ndt_t *)(yyvsp[0].ndt), ctx); if ((yyval.type_seq) == NULL) YYABORT; }
+#line 3022 "grammar.c"
     break;
 
-  case 151:
-#line 458 "grammar.y" /* yacc.c:1652  */
-    { (yyval.type_seq) = ndt_type_seq_append((yyvsp[-2].type_seq), (ndt_t *)(yyvsp[0].ndt), ctx); if ((yyval.type_seq) == NULL) YYABORT; }
-#line 2889 "grammar.c" /* yacc.c:1652  */
+  case 151: /* type_seq: type_seq COMMA datashape_with_ellipsis  */
+#line 490 "grammar.y"
+                                         { (yyval.type_seq) = ndt_type_seq_append((yyvsp[-2].type_seq), (ndt_t *)(yyvsp[0].ndt), ctx); if ((yyval.type_seq) == NULL) YYABORT; }
+#line 3028 "grammar.c"
     break;
 
 
-#line 2893 "grammar.c" /* yacc.c:1652  */
+#line 3032 "grammar.c"
+
       default: break;
     }
   /* User semantic actions sometimes alter yychar, and that requires
@@ -2903,11 +3043,10 @@ yyreduce:
      case of YYERROR or YYBACKUP, subsequent parser actions might lead
      to an incorrect destructor call or verbose syntax error message
      before the lookahead is translated.  */
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
   *++yylsp = yyloc;
@@ -2932,59 +3071,54 @@ yyreduce:
 yyerrlab:
   /* Make sure we have latest lookahead translation.  See comments at
      user semantic actions for why this is necessary.  */
-  yytoken = yychar == YYEMPTY ? YYEMPTY : YYTRANSLATE (yychar);
-
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
-      yyerror (&yylloc, scanner, ast, ctx, YY_("syntax error"));
-#else
-# define YYSYNTAX_ERROR yysyntax_error (&yymsg_alloc, &yymsg, \
-                                        yyssp, yytoken)
       {
+        yypcontext_t yyctx
+          = {yyssp, yytoken, &yylloc};
         char const *yymsgp = YY_("syntax error");
         int yysyntax_error_status;
-        yysyntax_error_status = YYSYNTAX_ERROR;
+        yysyntax_error_status = yysyntax_error (&yymsg_alloc, &yymsg, &yyctx);
         if (yysyntax_error_status == 0)
           yymsgp = yymsg;
-        else if (yysyntax_error_status == 1)
+        else if (yysyntax_error_status == -1)
           {
             if (yymsg != yymsgbuf)
               YYSTACK_FREE (yymsg);
-            yymsg = (char *) YYSTACK_ALLOC (yymsg_alloc);
-            if (!yymsg)
+            yymsg = YY_CAST (char *,
+                             YYSTACK_ALLOC (YY_CAST (YYSIZE_T, yymsg_alloc)));
+            if (yymsg)
               {
-                yymsg = yymsgbuf;
-                yymsg_alloc = sizeof yymsgbuf;
-                yysyntax_error_status = 2;
+                yysyntax_error_status
+                  = yysyntax_error (&yymsg_alloc, &yymsg, &yyctx);
+                yymsgp = yymsg;
               }
             else
               {
-                yysyntax_error_status = YYSYNTAX_ERROR;
-                yymsgp = yymsg;
+                yymsg = yymsgbuf;
+                yymsg_alloc = sizeof yymsgbuf;
+                yysyntax_error_status = YYENOMEM;
               }
           }
         yyerror (&yylloc, scanner, ast, ctx, yymsgp);
-        if (yysyntax_error_status == 2)
-          goto yyexhaustedlab;
+        if (yysyntax_error_status == YYENOMEM)
+          YYNOMEM;
       }
-# undef YYSYNTAX_ERROR
-#endif
     }
 
   yyerror_range[1] = yylloc;
-
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
          error, discard it.  */
 
-      if (yychar <= YYEOF)
+      if (yychar <= ENDMARKER)
         {
           /* Return failure if at end of input.  */
-          if (yychar == YYEOF)
+          if (yychar == ENDMARKER)
             YYABORT;
         }
       else
@@ -3008,6 +3142,7 @@ yyerrorlab:
      label yyerrorlab therefore never appears in user code.  */
   if (0)
     YYERROR;
+  ++yynerrs;
 
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
@@ -3024,13 +3159,14 @@ yyerrorlab:
 yyerrlab1:
   yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
       if (!yypact_value_is_default (yyn))
         {
-          yyn += YYTERROR;
-          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
             {
               yyn = yytable[yyn];
               if (0 < yyn)
@@ -3044,7 +3180,7 @@ yyerrlab1:
 
       yyerror_range[1] = *yylsp;
       yydestruct ("Error: popping",
-                  yystos[yystate], yyvsp, yylsp, scanner, ast, ctx);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, yylsp, scanner, ast, ctx);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -3055,13 +3191,11 @@ yyerrlab1:
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 
   yyerror_range[2] = yylloc;
-  /* Using YYLLOC is tempting, but would change the location of
-     the lookahead.  YYLOC is available though.  */
-  YYLLOC_DEFAULT (yyloc, yyerror_range, 2);
-  *++yylsp = yyloc;
+  ++yylsp;
+  YYLLOC_DEFAULT (*yylsp, yyerror_range, 2);
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -3072,7 +3206,7 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
 
 
 /*-----------------------------------.
@@ -3080,24 +3214,22 @@ yyacceptlab:
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
 
 
-#if !defined yyoverflow || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (&yylloc, scanner, ast, ctx, YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
 
 
-/*-----------------------------------------------------.
-| yyreturn -- parsing is finished, return the result.  |
-`-----------------------------------------------------*/
-yyreturn:
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
     {
       /* Make sure we have latest lookahead translation.  See comments at
@@ -3113,16 +3245,15 @@ yyreturn:
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-                  yystos[*yyssp], yyvsp, yylsp, scanner, ast, ctx);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, yylsp, scanner, ast, ctx);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
   if (yymsg != yymsgbuf)
     YYSTACK_FREE (yymsg);
-#endif
   return yyresult;
 }
+
@@ -1,8 +1,8 @@
-/* A Bison parser, made by GNU Bison 3.3.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison interface for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2019 Free Software Foundation,
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
    Inc.
 
    This program is free software: you can redistribute it and/or modify
@@ -16,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -31,8 +31,9 @@
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
-/* Undocumented macros, especially those whose name start with YY_,
-   are private implementation details.  Do not rely on them.  */
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
 
 #ifndef YY_NDT_YY_GRAMMAR_H_INCLUDED
 # define YY_NDT_YY_GRAMMAR_H_INCLUDED
@@ -44,7 +45,7 @@
 extern int ndt_yydebug;
 #endif
 /* "%code requires" blocks.  */
-#line 56 "grammar.y" /* yacc.c:1921  */
+#line 84 "grammar.y"
 
   #include "ndtypes.h"
   #include "seq.h"
@@ -53,90 +54,93 @@ extern int ndt_yydebug;
   #define YY_TYPEDEF_YY_SCANNER_T
   typedef void * yyscan_t;
 
-#line 57 "grammar.h" /* yacc.c:1921  */
+#line 58 "grammar.h"
 
-/* Token type.  */
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
   enum yytokentype
   {
-    ENDMARKER = 0,
-    ANY_KIND = 258,
-    SCALAR_KIND = 259,
-    VOID = 260,
-    BOOL = 261,
-    SIGNED_KIND = 262,
-    INT8 = 263,
-    INT16 = 264,
-    INT32 = 265,
-    INT64 = 266,
-    UNSIGNED_KIND = 267,
-    UINT8 = 268,
-    UINT16 = 269,
-    UINT32 = 270,
-    UINT64 = 271,
-    FLOAT_KIND = 272,
-    BFLOAT16 = 273,
-    FLOAT16 = 274,
-    FLOAT32 = 275,
-    FLOAT64 = 276,
-    COMPLEX_KIND = 277,
-    BCOMPLEX32 = 278,
-    COMPLEX32 = 279,
-    COMPLEX64 = 280,
-    COMPLEX128 = 281,
-    CATEGORICAL = 282,
-    NA = 283,
-    INTPTR = 284,
-    UINTPTR = 285,
-    SIZE = 286,
-    CHAR = 287,
-    STRING = 288,
-    FIXED_STRING_KIND = 289,
-    FIXED_STRING = 290,
-    BYTES = 291,
-    FIXED_BYTES_KIND = 292,
-    FIXED_BYTES = 293,
-    REF = 294,
-    FIXED = 295,
-    VAR = 296,
-    ARRAY = 297,
-    OF = 298,
-    COMMA = 299,
-    COLON = 300,
-    LPAREN = 301,
-    RPAREN = 302,
-    LBRACE = 303,
-    RBRACE = 304,
-    LBRACK = 305,
-    RBRACK = 306,
-    STAR = 307,
-    ELLIPSIS = 308,
-    RARROW = 309,
-    EQUAL = 310,
-    LESS = 311,
-    GREATER = 312,
-    QUESTIONMARK = 313,
-    BANG = 314,
-    AMPERSAND = 315,
-    BAR = 316,
-    ERRTOKEN = 317,
-    INTEGER = 318,
-    FLOATNUMBER = 319,
-    STRINGLIT = 320,
-    NAME_LOWER = 321,
-    NAME_UPPER = 322,
-    NAME_OTHER = 323,
-    BELOW_BAR = 324
+    YYEMPTY = -2,
+    ENDMARKER = 0,                 /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    ANY_KIND = 258,                /* ANY_KIND  */
+    SCALAR_KIND = 259,             /* SCALAR_KIND  */
+    VOID = 260,                    /* VOID  */
+    BOOL = 261,                    /* BOOL  */
+    SIGNED_KIND = 262,             /* SIGNED_KIND  */
+    INT8 = 263,                    /* INT8  */
+    INT16 = 264,                   /* INT16  */
+    INT32 = 265,                   /* INT32  */
+    INT64 = 266,                   /* INT64  */
+    UNSIGNED_KIND = 267,           /* UNSIGNED_KIND  */
+    UINT8 = 268,                   /* UINT8  */
+    UINT16 = 269,                  /* UINT16  */
+    UINT32 = 270,                  /* UINT32  */
+    UINT64 = 271,                  /* UINT64  */
+    FLOAT_KIND = 272,              /* FLOAT_KIND  */
+    BFLOAT16 = 273,                /* BFLOAT16  */
+    FLOAT16 = 274,                 /* FLOAT16  */
+    FLOAT32 = 275,                 /* FLOAT32  */
+    FLOAT64 = 276,                 /* FLOAT64  */
+    COMPLEX_KIND = 277,            /* COMPLEX_KIND  */
+    BCOMPLEX32 = 278,              /* BCOMPLEX32  */
+    COMPLEX32 = 279,               /* COMPLEX32  */
+    COMPLEX64 = 280,               /* COMPLEX64  */
+    COMPLEX128 = 281,              /* COMPLEX128  */
+    CATEGORICAL = 282,             /* CATEGORICAL  */
+    NA = 283,                      /* NA  */
+    INTPTR = 284,                  /* INTPTR  */
+    UINTPTR = 285,                 /* UINTPTR  */
+    SIZE = 286,                    /* SIZE  */
+    CHAR = 287,                    /* CHAR  */
+    STRING = 288,                  /* STRING  */
+    FIXED_STRING_KIND = 289,       /* FIXED_STRING_KIND  */
+    FIXED_STRING = 290,            /* FIXED_STRING  */
+    BYTES = 291,                   /* BYTES  */
+    FIXED_BYTES_KIND = 292,        /* FIXED_BYTES_KIND  */
+    FIXED_BYTES = 293,             /* FIXED_BYTES  */
+    REF = 294,                     /* REF  */
+    FIXED = 295,                   /* FIXED  */
+    VAR = 296,                     /* VAR  */
+    ARRAY = 297,                   /* ARRAY  */
+    OF = 298,                      /* OF  */
+    COMMA = 299,                   /* COMMA  */
+    COLON = 300,                   /* COLON  */
+    LPAREN = 301,                  /* LPAREN  */
+    RPAREN = 302,                  /* RPAREN  */
+    LBRACE = 303,                  /* LBRACE  */
+    RBRACE = 304,                  /* RBRACE  */
+    LBRACK = 305,                  /* LBRACK  */
+    RBRACK = 306,                  /* RBRACK  */
+    STAR = 307,                    /* STAR  */
+    ELLIPSIS = 308,                /* ELLIPSIS  */
+    RARROW = 309,                  /* RARROW  */
+    EQUAL = 310,                   /* EQUAL  */
+    LESS = 311,                    /* LESS  */
+    GREATER = 312,                 /* GREATER  */
+    QUESTIONMARK = 313,            /* QUESTIONMARK  */
+    BANG = 314,                    /* BANG  */
+    AMPERSAND = 315,               /* AMPERSAND  */
+    BAR = 316,                     /* BAR  */
+    ERRTOKEN = 317,                /* ERRTOKEN  */
+    INTEGER = 318,                 /* INTEGER  */
+    FLOATNUMBER = 319,             /* FLOATNUMBER  */
+    STRINGLIT = 320,               /* STRINGLIT  */
+    NAME_LOWER = 321,              /* NAME_LOWER  */
+    NAME_UPPER = 322,              /* NAME_UPPER  */
+    NAME_OTHER = 323,              /* NAME_OTHER  */
+    BELOW_BAR = 324                /* BELOW_BAR  */
   };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
 
 /* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-
 union YYSTYPE
 {
-#line 85 "grammar.y" /* yacc.c:1921  */
+#line 113 "grammar.y"
 
     const ndt_t *ndt;
     enum ndt tag;
@@ -151,12 +155,13 @@ union YYSTYPE
     enum ndt_encoding encoding;
     uint32_t uint32;
     char *string;
+    const char *name;
     ndt_string_seq_t *string_seq;
     ndt_type_seq_t *type_seq;
 
-#line 158 "grammar.h" /* yacc.c:1921  */
-};
+#line 163 "grammar.h"
 
+};
 typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_TRIVIAL 1
 # define YYSTYPE_IS_DECLARED 1
@@ -178,14 +183,16 @@ struct YYLTYPE
 
 
 
+
 int ndt_yyparse (yyscan_t scanner, const ndt_t **ast, ndt_context_t *ctx);
+
 /* "%code provides" blocks.  */
-#line 65 "grammar.y" /* yacc.c:1921  */
+#line 93 "grammar.y"
 
   #define YY_DECL extern int ndt_yylexfunc(YYSTYPE *yylval_param, YYLTYPE *yylloc_param, yyscan_t yyscanner, ndt_context_t *ctx)
   extern int ndt_yylexfunc(YYSTYPE *, YYLTYPE *, yyscan_t, ndt_context_t *);
   void yyerror(YYLTYPE *loc, yyscan_t scanner, const ndt_t **ast, ndt_context_t *ctx, const char *msg);
 
-#line 190 "grammar.h" /* yacc.c:1921  */
+#line 197 "grammar.h"
 
 #endif /* !YY_NDT_YY_GRAMMAR_H_INCLUDED  */
@@ -42,6 +42,11 @@ yyerror(YYLTYPE *loc, yyscan_t scanner, const ndt_t **ast, ndt_context_t *ctx,
     (void)scanner;
     (void)ast;
 
+    /* Keep the message of an exceeded resource limit. */
+    if (ctx->flags & NDT_LimitExceeded) {
+        return;
+    }
+
     ndt_err_format(ctx, NDT_ParseError, "%d:%d: %s", loc->first_line,
                    loc->first_column, msg);
 }
@@ -49,7 +54,30 @@ yyerror(YYLTYPE *loc, yyscan_t scanner, const ndt_t **ast, ndt_context_t *ctx,
 int
 yylex(YYSTYPE *val, YYLTYPE *loc, yyscan_t scanner, ndt_context_t *ctx)
 {
-    return ndt_yylexfunc(val, loc, scanner, ctx);
+    int token = ndt_yylexfunc(val, loc, scanner, ctx);
+
+    /*
+     * The nesting depth of a limited context is tracked by the brackets and
+     * by the tokens that nest the type that follows them: '&' and 'ref' of
+     * a reference and '*' of a dimension.  The constructors of references
+     * and dimensions decrement the depth again.
+     */
+    if (ctx->flags & NDT_Limited) {
+        switch (token) {
+        case LPAREN: case LBRACE: case LBRACK: case AMPERSAND: case REF: case STAR:
+            if (ndt_limit_depth(ctx, 1) < 0) {
+                return ERRTOKEN;
+            }
+            break;
+        case RPAREN: case RBRACE: case RBRACK:
+            (void)ndt_limit_depth(ctx, -1);
+            break;
+        default:
+            break;
+        }
+    }
+
+    return token;
 }
 %}
 
@@ -68,7 +96,7 @@ yylex(YYSTYPE *val, YYLTYPE *loc, yyscan_t scanner, ndt_context_t *ctx)
   void yyerror(YYLTYPE *loc, yyscan_t scanner, const ndt_t **ast, ndt_context_t *ctx, const char *msg);
 }
 
-%pure-parser
+%define api.pure
 %define parse.error verbose
 
 %locations
@@ -96,6 +124,7 @@ yylex(YYSTYPE *val, YYLTYPE *loc, yyscan_t scanner, ndt_context_t *ctx)
     enum ndt_encoding encoding;
     uint32_t uint32;
     char *string;
+    const char *name;
     ndt_string_seq_t *string_seq;
     ndt_type_seq_t *type_seq;
 }
@@ -137,7 +166,7 @@ yylex(YYSTYPE *val, YYLTYPE *loc, yyscan_t scanner, ndt_context_t *ctx)
 %type <field> union_member
 %type <field_seq> union_member_seq
 
-%type <string> field_name_or_tag
+%type <name> field_name_or_tag
 
 %type <ndt> categorical
 %type <typed_value> typed_value
@@ -187,12 +216,15 @@ ERRTOKEN
 
 %token <string>
   INTEGER FLOATNUMBER STRINGLIT
+
+/* Names are allocated in the scratch space and need no destructor. */
+%token <name>
   NAME_LOWER NAME_UPPER NAME_OTHER
 
 %token ENDMARKER 0 "end of file"
 
 %destructor { ndt_decref($$); } <ndt>
-%destructor { ndt_field_del($$); } <field>
+%destructor { ndt_decref($$->type); } <field>
 %destructor { ndt_field_seq_del($$); } <field_seq>
 %destructor { ndt_value_del($$); } <typed_value>
 %destructor { ndt_value_seq_del($$); } <typed_value_seq>
@@ -258,11 +290,11 @@ dtype:
 | tuple_type                                      { $$ = $1; }
 | record_type                                     { $$ = $1; }
 | union_type                                      { $$ = $1; }
-| NAME_LOWER                                      { $$ = ndt_nominal($1, NULL, false, ctx); if ($$ == NULL) YYABORT; }
-| QUESTIONMARK NAME_LOWER                         { $$ = ndt_nominal($2, NULL, true, ctx); if ($$ == NULL) YYABORT; }
+| NAME_LOWER                                      { $$ = mk_nominal($1, false, ctx); if ($$ == NULL) YYABORT; }
+| QUESTIONMARK NAME_LOWER                         { $$ = mk_nominal($2, true, ctx); if ($$ == NULL) YYABORT; }
 | NAME_UPPER LPAREN datashape RPAREN              { $$ = mk_constr($1, $3, false, ctx); if ($$ == NULL) YYABORT; }
 | QUESTIONMARK NAME_UPPER LPAREN datashape RPAREN { $$ = mk_constr($2, $4, true, ctx); if ($$ == NULL) YYABORT; }
-| NAME_UPPER                                      { $$ = ndt_typevar($1, ctx); if ($$ == NULL) YYABORT; }
+| NAME_UPPER                                      { $$ = mk_typevar($1, ctx); if ($$ == NULL) YYABORT; }
 
 scalar:
   flags_opt BOOL               { $$ = ndt_primitive(Bool, $1, ctx); if ($$ == NULL) YYABORT; }
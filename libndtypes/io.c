@@ -828,6 +828,12 @@ ast_type_flags(buf_t *buf, const ndt_t *t, ndt_context_t *ctx)
         cont = 1;
     }
 
+    if (t->flags & NDT_ALL_VALID) {
+        n = ndt_snprintf(ctx, buf, "%sALL_VALID", cont ? ", " : "");
+        if (n > 0) return -1;
+        cont = 1;
+    }
+
     if (t->flags & NDT_SUBTREE_OPTION) {
         n = ndt_snprintf(ctx, buf, "%sSUBTREE_OPTION", cont ? ", " : "");
         if (n > 0) return -1;
@@ -1175,6 +1181,15 @@ ast_datashape(buf_t *buf, const ndt_t *t, int d, int cont, ndt_context_t *ctx)
                 n = ndt_snprintf(ctx, buf, ",\n");
                 if (n < 0) return -1;
             }
+            else if (t->Concrete.FixedDim.tile != 0) {
+                n = ndt_snprintf(ctx, buf,
+                    ", itemsize=%" PRIi64 ", step=%" PRIi64
+                    ", tile=%" PRIi64 ", tile_step=%" PRIi64 ",\n",
+                    t->Concrete.FixedDim.itemsize,
+                    t->Concrete.FixedDim.step,
+                    t->Concrete.FixedDim.tile,
+                    t->Concrete.FixedDim.tile_step);
+            }
             else {
                 n = ndt_snprintf(ctx, buf,
                     ", itemsize=%" PRIi64 ", step=%" PRIi64 ",\n",
@@ -0,0 +1,35 @@
+/* Generated from lexer.l by tools/gen_keywords.py.  Do not edit. */
+
+#define KEYWORD_SLOTS 128
+#define KEYWORD_HASH(s, n)        \
+    (((unsigned char)(s)[0] +     \
+      (unsigned char)(s)[(n)-1] + \
+      10 * (unsigned char)(s)[(n)-2]) & (KEYWORD_SLOTS-1))
+
+static const struct {
+    const char *name;
+    size_t len;
+    int token;
+} keywords[KEYWORD_SLOTS] = {
+  [2] = {"bfloat16", 8, BFLOAT16},
+  [6] = {"float16", 7, FLOAT16},
+  [9] = {"int16", 5, INT16},
+  [15] = {"complex128", 10, COMPLEX128},
+  [18] = {"bcomplex32", 10, BCOMPLEX32},
+  [19] = {"complex32", 9, COMPLEX32},
+  [21] = {"uint16", 6, UINT16},
+  [22] = {"float32", 7, FLOAT32},
+  [25] = {"int32", 5, INT32},
+  [29] = {"size_t", 6, SIZE},
+  [36] = {"bool", 4, BOOL},
+  [37] = {"uint32", 6, UINT32},
+  [38] = {"string", 6, STRING},
+  [41] = {"int8", 4, INT8},
+  [51] = {"complex64", 9, COMPLEX64},
+  [53] = {"uint8", 5, UINT8},
+  [54] = {"float64", 7, FLOAT64},
+  [57] = {"int64", 5, INT64},
+  [69] = {"uint64", 6, UINT64},
+  [99] = {"intptr", 6, INTPTR},
+  [111] = {"uintptr", 7, UINTPTR},
+};
@@ -924,7 +924,7 @@ yyalloc(size_t size, yyscan_t yyscanner)
 {
     (void)yyscanner;
 
-    return ndt_alloc(1, size);
+    return ndt_alloc_class(NDT_ALLOC_SCRATCH, 1, size);
 }
 
 void *
@@ -932,7 +932,7 @@ yyrealloc(void *ptr, size_t size, yyscan_t yyscanner)
 {
     (void)yyscanner;
 
-    return ndt_realloc(ptr, 1, size);
+    return ndt_realloc_class(NDT_ALLOC_SCRATCH, ptr, 1, size);
 }
 
 void
@@ -940,7 +940,7 @@ yyfree(void *ptr, yyscan_t yyscanner)
 {
     (void)yyscanner;
 
-    ndt_free(ptr);
+    ndt_free_class(NDT_ALLOC_SCRATCH, ptr);
 }
 
 #line 946 "lexer.c"
@@ -1606,17 +1606,17 @@ YY_RULE_SETUP
 case 61:
 YY_RULE_SETUP
 #line 214 "lexer.l"
-{ yylval->string = ndt_strdup(yytext, ctx); if (yylval->string == NULL) return ERRTOKEN; return NAME_LOWER; }
+{ yylval->name = ndt_scratch_strdup(yytext, ctx); if (yylval->name == NULL) return ERRTOKEN; return NAME_LOWER; }
 	YY_BREAK
 case 62:
 YY_RULE_SETUP
 #line 215 "lexer.l"
-{ yylval->string = ndt_strdup(yytext, ctx); if (yylval->string == NULL) return ERRTOKEN; return NAME_UPPER; }
+{ yylval->name = ndt_scratch_strdup(yytext, ctx); if (yylval->name == NULL) return ERRTOKEN; return NAME_UPPER; }
 	YY_BREAK
 case 63:
 YY_RULE_SETUP
 #line 216 "lexer.l"
-{ yylval->string = ndt_strdup(yytext, ctx); if (yylval->string == NULL) return ERRTOKEN; return NAME_OTHER; }
+{ yylval->name = ndt_scratch_strdup(yytext, ctx); if (yylval->name == NULL) return ERRTOKEN; return NAME_OTHER; }
 	YY_BREAK
 case 64:
 YY_RULE_SETUP
@@ -40,8 +40,11 @@
 #include <stdarg.h>
 #include <assert.h>
 #include "ndtypes.h"
+#include "intern.h"
 #include "symtable.h"
 #include "substitute.h"
+#include "threadlocal.h"
+#include "overflow.h"
 
 
 static int match_datashape(const ndt_t *, const ndt_t *, symtable_t *, ndt_context_t *);
@@ -84,7 +87,7 @@ resolve_broadcast(symtable_entry_t w, symtable_t *tbl, ndt_context_t *ctx)
     int vsize;
 
     v = symtable_find_ptr(tbl, key);
-    if (v == NULL) {
+    if (v == NULL || v->tag == Unbound) {
         if (symtable_add(tbl, key, w, ctx) < 0) {
             return -1;
         }
@@ -778,6 +781,112 @@ ndt_match(const ndt_t *p, const ndt_t *c, ndt_context_t *ctx)
     return ret;
 }
 
+/*
+ * Match the pattern 'p' against all candidates in 'types'.  Bit i of 'bitmap'
+ * (least significant bit first, (n+7)/8 bytes) is set if types[i] matches.
+ * The symbol table is reused across candidates.  Repeated candidates are
+ * only matched once.  Return the number of matches or -1 on error.
+ */
+int64_t
+ndt_match_batch(uint8_t *bitmap, const ndt_t *p, const ndt_t * const types[],
+                int64_t n, ndt_context_t *ctx)
+{
+    symtable_t *tbl;
+    int64_t count = 0;
+    int ret = 0;
+
+    if (n < 0) {
+        ndt_err_format(ctx, NDT_ValueError, "number of types must be non-negative");
+        return -1;
+    }
+
+    tbl = symtable_new(ctx);
+    if (tbl == NULL) {
+        return -1;
+    }
+
+    memset(bitmap, 0, (size_t)((n+7)/8));
+
+    for (int64_t i = 0; i < n; i++) {
+        const ndt_t *c = types[i];
+
+        if (i > 0 && c == types[i-1]) {
+            ; /* same result */
+        }
+        else if (ndt_is_abstract(c)) {
+            ret = 0;
+        }
+        else if (c == p) {
+            ret = 1;
+        }
+        else {
+            symtable_clear(tbl);
+            ret = match_datashape_top(p, c, 0, tbl, ctx);
+            if (ret < 0) {
+                symtable_del(tbl);
+                return -1;
+            }
+        }
+
+        if (ret) {
+            bitmap[i/8] |= (uint8_t)(1U << (i%8));
+            count++;
+        }
+    }
+
+    symtable_del(tbl);
+    return count;
+}
+
+/*
+ * Tiled inner dimensions are kept as they are, only the regular outer
+ * dimensions are broadcast.
+ */
+static const ndt_t *
+broadcast_tiled(const ndt_t *t, const int64_t *shape,
+                int outer_dims, int inner_dims,
+                bool use_max, ndt_context_t *ctx)
+{
+    const ndt_t *dims[NDT_MAX_DIM];
+    const ndt_t *dtype;
+    const ndt_t *v, *w;
+    int64_t step;
+    int ndim;
+    int i, k;
+
+    ndim = ndt_dims_dtype(dims, &dtype, t);
+
+    for (i = 0; i < ndim-inner_dims; i++) {
+        if (dims[i]->Concrete.FixedDim.tile != 0) {
+            ndt_err_format(ctx, NDT_ValueError,
+                "tiled dimensions cannot be broadcast");
+            return NULL;
+        }
+    }
+
+    v = inner_dims == 0 ? dtype : dims[ndim-inner_dims];
+    ndt_incref(v);
+
+    for (i=ndim-inner_dims-1, k=outer_dims-1; i>=0 && k>=0; i--, k--) {
+        step = dims[i]->FixedDim.shape<=1 ? 0 : dims[i]->Concrete.FixedDim.step;
+        w = ndt_fixed_dim(v, shape[k], step, ctx);
+        ndt_move(&v, w);
+        if (v == NULL) {
+            return NULL;
+        }
+    }
+
+    for (; k>=0; k--) {
+        w = ndt_fixed_dim(v, shape[k], use_max ? INT64_MAX : 0, ctx);
+        ndt_move(&v, w);
+        if (v == NULL) {
+            return NULL;
+        }
+    }
+
+    return v;
+}
+
 static const ndt_t *
 broadcast(const ndt_t *t, const int64_t *shape,
           int outer_dims, int inner_dims,
@@ -789,6 +898,10 @@ broadcast(const ndt_t *t, const int64_t *shape,
     int ndim;
     int i, k;
 
+    if (t->flags & NDT_TILED) {
+        return broadcast_tiled(t, shape, outer_dims, inner_dims, use_max, ctx);
+    }
+
     ndim = ndt_as_ndarray(&u, t, ctx);
     if (ndim < 0) {
         return NULL;
@@ -923,31 +1036,31 @@ resolve_constraint(const ndt_constraint_t *c, const void *args, symtable_t *tbl,
     return 0;
 }
 
+static int specialized_typecheck(ndt_apply_spec_t *spec, const ndt_t *sig,
+                                 const ndt_t *types[], const int64_t li[],
+                                 int nin, int nout, const ndt_constraint_t *c,
+                                 ndt_context_t *ctx);
+static void specialize_profile(const ndt_apply_spec_t *spec, const ndt_t *sig,
+                               const ndt_t *types[], const int64_t li[],
+                               int nin, int nout, const ndt_constraint_t *c);
+
 /*
- * Check the concrete function arguments 'in' against the function
- * signature 'sig'.  On success, infer and return the concrete return
- * types and the (possibly broadcasted) 'in' types.
+ * Check the function arguments against 'sig', binding symbols in 'tbl'.
+ * Symbols that are already bound must match.  On failure 'spec' is cleared.
  */
-int
-ndt_typecheck(ndt_apply_spec_t *spec, const ndt_t *sig,
-              const ndt_t *types[], const int64_t li[],
-              const int nin, const int nout, bool check_broadcast,
-              const ndt_constraint_t *c, const void *args,
-              ndt_context_t *ctx)
+static int
+typecheck(ndt_apply_spec_t *spec, const ndt_t *sig,
+          const ndt_t *types[], const int64_t li[],
+          const int nin, const int nout, bool check_broadcast,
+          const ndt_constraint_t *c, const void *args,
+          symtable_t *tbl, ndt_context_t *ctx)
 {
-    symtable_t *tbl;
     const ndt_t *t;
     const char *name;
     const int nargs = nin + nout;
     int64_t i;
     int ret;
 
-    assert(spec->flags == 0);
-    assert(spec->outer_dims == 0);
-    assert(spec->nin == 0);
-    assert(spec->nout == 0);
-    assert(spec->nargs == 0);
-
     if (sig->tag != Function) {
         ndt_err_format(ctx, NDT_ValueError,
             "signature must be a function type");
@@ -990,16 +1103,9 @@ ndt_typecheck(ndt_apply_spec_t *spec, const ndt_t *sig,
         }
     }
 
-    tbl = symtable_new(ctx);
-    if (tbl == NULL) {
-        return -1;
-    }
-
     for (i = 0; i < nargs; i++) {
         ret = match_datashape_top(sig->Function.types[i], types[i], li[i], tbl, ctx);
         if (ret <= 0) {
-            symtable_del(tbl);
-
             if (ret == 0) {
                 ndt_err_format(ctx, NDT_TypeError,
                     "argument types do not match");
@@ -1010,7 +1116,6 @@ ndt_typecheck(ndt_apply_spec_t *spec, const ndt_t *sig,
     }
 
     if (c != NULL && resolve_constraint(c, args, tbl, ctx) < 0) {
-        symtable_del(tbl);
         return -1;
     }
 
@@ -1028,7 +1133,6 @@ ndt_typecheck(ndt_apply_spec_t *spec, const ndt_t *sig,
             spec->types[nin+i] = ndt_substitute(sig->Function.types[nin+i], tbl, false, ctx);
             if (spec->types[nin+i] == NULL) {
                 ndt_apply_spec_clear(spec);
-                symtable_del(tbl);
                 return -1;
             }
             spec->nout++;
@@ -1048,7 +1152,6 @@ ndt_typecheck(ndt_apply_spec_t *spec, const ndt_t *sig,
             ndt_err_format(ctx, NDT_RuntimeError,
                "unexpected configuration of ellipsis flag and function types");
             ndt_apply_spec_clear(spec);
-            symtable_del(tbl);
             return -1;
         }
 
@@ -1077,21 +1180,17 @@ ndt_typecheck(ndt_apply_spec_t *spec, const ndt_t *sig,
                 ndt_err_format(ctx, NDT_RuntimeError,
                     "unexpected missing dimension list entry");
                 ndt_apply_spec_clear(spec);
-                symtable_del(tbl);
                 return -1;
             }
         }
         else {
             if (broadcast_all(spec, sig, check_broadcast, tbl, ctx) < 0) {
                 ndt_apply_spec_clear(spec);
-                symtable_del(tbl);
                 return -1;
             }
         }
     }
 
-    symtable_del(tbl);
-
     if (nout == 0) {
         for (i = 0; i < sig->Function.nout; i++) {
            const ndt_t *_p = sig->Function.types[nin+i];
@@ -1123,6 +1222,51 @@ ndt_typecheck(ndt_apply_spec_t *spec, const ndt_t *sig,
 }
 
 
+
+/*
+ * Check the concrete function arguments 'in' against the function
+ * signature 'sig'.  On success, infer and return the concrete return
+ * types and the (possibly broadcasted) 'in' types.
+ */
+int
+ndt_typecheck(ndt_apply_spec_t *spec, const ndt_t *sig,
+              const ndt_t *types[], const int64_t li[],
+              const int nin, const int nout, bool check_broadcast,
+              const ndt_constraint_t *c, const void *args,
+              ndt_context_t *ctx)
+{
+    symtable_t *tbl;
+    int ret;
+
+    assert(spec->flags == 0);
+    assert(spec->outer_dims == 0);
+    assert(spec->nin == 0);
+    assert(spec->nout == 0);
+    assert(spec->nargs == 0);
+
+    ret = specialized_typecheck(spec, sig, types, li, nin, nout, c, ctx);
+    if (ret != 0) {
+        return ret < 0 ? -1 : 0;
+    }
+
+    tbl = symtable_new(ctx);
+    if (tbl == NULL) {
+        return -1;
+    }
+
+    ret = typecheck(spec, sig, types, li, nin, nout, check_broadcast, c, args,
+                    tbl, ctx);
+    symtable_del(tbl);
+    if (ret < 0) {
+        return -1;
+    }
+
+    specialize_profile(spec, sig, types, li, nin, nout, c);
+
+    return 0;
+}
+
+
 /*****************************************************************************/
 /*                  Optimized binary typecheck for fixed input               */
 /*****************************************************************************/
@@ -1288,7 +1432,7 @@ unary_all_same_symbol(const ndt_t *t0, const ndt_t *t1)
         return false;
     }
 
-    return strcmp(t0->SymbolicDim.name, t1->SymbolicDim.name) == 0;
+    return symbol_equal(t0->SymbolicDim.name, t1->SymbolicDim.name);
 }
 
 static bool
@@ -1510,8 +1654,8 @@ binary_all_same_symbol(const ndt_t *t0, const ndt_t *t1, const ndt_t *t2)
         return false;
     }
 
-    return strcmp(t0->SymbolicDim.name, t1->SymbolicDim.name) == 0 &&
-           strcmp(t0->SymbolicDim.name, t2->SymbolicDim.name) == 0;
+    return symbol_equal(t0->SymbolicDim.name, t1->SymbolicDim.name) &&
+           symbol_equal(t0->SymbolicDim.name, t2->SymbolicDim.name);
 }
 
 static bool
@@ -1631,3 +1775,1241 @@ ndt_fast_binary_fixed_typecheck(ndt_apply_spec_t *spec, const ndt_t *sig,
         return -1;
     }
 }
+
+
+/******************************************************************************/
+/*                     Typecheck without type construction                    */
+/******************************************************************************/
+
+/*
+ * Bindings of dimension variables and dtype variables.  Broadcast shapes
+ * and inner dimensions are resolved numerically, so no types are built.
+ */
+typedef struct {
+    int nshapes;
+    const char *shape_names[NDT_MAX_SYMBOLS];
+    int64_t shapes[NDT_MAX_SYMBOLS];
+    int ndtypes;
+    const char *dtype_names[NDT_MAX_SYMBOLS];
+    const ndt_t *dtypes[NDT_MAX_SYMBOLS];
+} bindings_t;
+
+static int
+unsupported_signature(ndt_context_t *ctx)
+{
+    ndt_err_format(ctx, NDT_NotImplementedError,
+        "unsupported signature in ndarray typecheck");
+    return -1;
+}
+
+static int
+type_mismatch(ndt_context_t *ctx)
+{
+    ndt_err_format(ctx, NDT_TypeError, "argument types do not match");
+    return -1;
+}
+
+static int
+bind_shape(bindings_t *b, const char *name, int64_t shape, ndt_context_t *ctx)
+{
+    for (int i = 0; i < b->nshapes; i++) {
+        if (symbol_equal(b->shape_names[i], name)) {
+            return b->shapes[i] == shape ? 0 : type_mismatch(ctx);
+        }
+    }
+
+    if (b->nshapes == NDT_MAX_SYMBOLS) {
+        return unsupported_signature(ctx);
+    }
+
+    b->shape_names[b->nshapes] = name;
+    b->shapes[b->nshapes] = shape;
+    b->nshapes++;
+
+    return 0;
+}
+
+static const ndt_t *
+find_dtype(const bindings_t *b, const char *name)
+{
+    for (int i = 0; i < b->ndtypes; i++) {
+        if (symbol_equal(b->dtype_names[i], name)) {
+            return b->dtypes[i];
+        }
+    }
+
+    return NULL;
+}
+
+static int
+bind_dtype(bindings_t *b, const ndt_t *p, const ndt_t *c, ndt_context_t *ctx)
+{
+    const ndt_t *t;
+
+    if (p->tag == Typevar) {
+        t = find_dtype(b, p->Typevar.name);
+        if (t != NULL) {
+            return ndt_equal(t, c) ? 0 : type_mismatch(ctx);
+        }
+
+        if (b->ndtypes == NDT_MAX_SYMBOLS) {
+            return unsupported_signature(ctx);
+        }
+
+        b->dtype_names[b->ndtypes] = p->Typevar.name;
+        b->dtypes[b->ndtypes] = c;
+        b->ndtypes++;
+
+        return 0;
+    }
+
+    if (ndt_is_abstract(p)) {
+        return unsupported_signature(ctx);
+    }
+
+    return ndt_equal(p, c) ? 0 : type_mismatch(ctx);
+}
+
+static inline const ndt_t *
+next_dim(const ndt_t *p)
+{
+    return p->tag == FixedDim ? p->FixedDim.type : p->SymbolicDim.type;
+}
+
+/*
+ * Split the pattern 'p' into the first inner dimension and the dtype.  Return
+ * the number of inner dimensions or -1 if the pattern is not supported.
+ */
+static int
+pattern_dims(const ndt_t **dims, const ndt_t **dtype, bool *ellipsis,
+             const ndt_t *p)
+{
+    int n = 0;
+
+    *ellipsis = false;
+    if (p->tag == EllipsisDim) {
+        if (p->EllipsisDim.name != NULL || p->EllipsisDim.tag != RequireNA) {
+            return -1;
+        }
+        *ellipsis = true;
+        p = p->EllipsisDim.type;
+    }
+
+    *dims = p;
+    for (; p->tag == FixedDim || p->tag == SymbolicDim; n++) {
+        if (p->tag == SymbolicDim && p->SymbolicDim.tag != RequireNA) {
+            return -1;
+        }
+        p = next_dim(p);
+    }
+
+    if (p->ndim != 0 || p->tag == EllipsisDim) {
+        return -1;
+    }
+
+    *dtype = p;
+    return n;
+}
+
+static int
+match_inner(bindings_t *b, const ndt_t *dims, int n, const ndt_ndarray_t *x,
+            ndt_context_t *ctx)
+{
+    const int64_t *shape = x->shape + (x->ndim-n);
+
+    for (int i = 0; i < n; i++, dims = next_dim(dims)) {
+        if (dims->tag == FixedDim) {
+            if (dims->FixedDim.shape != shape[i]) {
+                return type_mismatch(ctx);
+            }
+        }
+        else if (bind_shape(b, dims->SymbolicDim.name, shape[i], ctx) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* Describe an inferred return value as a C-contiguous array. */
+static int
+infer_ndarray(ndt_ndarray_t *x, const bindings_t *b, const ndt_t *dims, int n,
+              const ndt_t *dtype, const int64_t *shape, int size,
+              ndt_context_t *ctx)
+{
+    bool overflow = 0;
+    int64_t step = 1;
+    int i, k;
+
+    if (size+n > NDT_MAX_DIM) {
+        ndt_err_format(ctx, NDT_ValueError, "too many dimensions");
+        return -1;
+    }
+
+    x->ndim = size+n;
+    x->itemsize = dtype->datasize;
+
+    for (i = 0; i < size; i++) {
+        x->shape[i] = shape[i];
+    }
+
+    for (k = 0; k < n; k++, i++, dims = next_dim(dims)) {
+        if (dims->tag == FixedDim) {
+            x->shape[i] = dims->FixedDim.shape;
+        }
+        else {
+            int j;
+            for (j = 0; j < b->nshapes; j++) {
+                if (symbol_equal(b->shape_names[j], dims->SymbolicDim.name)) {
+                    break;
+                }
+            }
+            if (j == b->nshapes) {
+                ndt_err_format(ctx, NDT_ValueError,
+                    "unbound dimension variable '%s'", dims->SymbolicDim.name);
+                return -1;
+            }
+            x->shape[i] = b->shapes[j];
+        }
+    }
+
+    for (i = x->ndim-1; i >= 0; i--) {
+        x->steps[i] = step;
+        x->strides[i] = MULi64(step, x->itemsize, &overflow);
+        step = MULi64(step, x->shape[i], &overflow);
+    }
+
+    (void)MULi64(step, x->itemsize, &overflow);
+    if (overflow) {
+        ndt_err_format(ctx, NDT_ValueError, "data size too large");
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Broadcast the outer dimensions of 'x' to 'shape' by using zero strides. */
+static void
+broadcast_ndarray(ndt_ndarray_t *x, int inner, const int64_t *shape, int size)
+{
+    const int outer = x->ndim-inner;
+    const int shift = size-outer;
+    int i;
+
+    assert(shift >= 0);
+
+    for (i = x->ndim-1; i >= 0; i--) {
+        x->shape[i+shift] = x->shape[i];
+        x->strides[i+shift] = x->strides[i];
+        x->steps[i+shift] = x->steps[i];
+    }
+
+    for (i = 0; i < size; i++) {
+        if (i < shift || x->shape[i] <= 1) {
+            x->strides[i] = x->steps[i] = 0;
+        }
+        x->shape[i] = shape[i];
+    }
+
+    x->ndim = size+inner;
+}
+
+/*
+ * Type check fixed ndarray arguments against 'sig' without constructing
+ * any types.  On success, spec->args contains the shapes and strides of
+ * the broadcast 'in' arguments and of the 'out' arguments.  Inferred 'out'
+ * arguments are described as C-contiguous arrays.  Explicit 'out' arguments
+ * are not broadcast; their outer shape must be the broadcast shape.
+ *
+ * Supported signatures have an unnamed ellipsis in all or in none of the
+ * arguments, fixed or symbolic inner dimensions and concrete or typevar
+ * dtypes.  Other signatures and var dimension arguments raise
+ * NotImplementedError.  NDT_INNER_VALID depends on the 'in' arguments only.
+ */
+int
+ndt_typecheck_ndarray(ndt_ndarray_spec_t *spec, const ndt_t *sig,
+                      const ndt_t *types[], const int nin, const int nout,
+                      ndt_context_t *ctx)
+{
+    const ndt_t *dims[NDT_MAX_ARGS];
+    const ndt_t *dtypes[NDT_MAX_ARGS];
+    int inner[NDT_MAX_ARGS];
+    int64_t shape[NDT_MAX_DIM];
+    bindings_t b = { .nshapes=0, .ndtypes=0 };
+    bool optional = false;
+    bool valid = true;
+    bool ellipsis = false;
+    int size = 0;
+    int nargs;
+    int i;
+
+    spec->flags = 0;
+    spec->outer_dims = 0;
+    spec->nin = spec->nout = spec->nargs = 0;
+
+    if (sig->tag != Function) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "signature must be a function type");
+        return -1;
+    }
+
+    if (nin != sig->Function.nin) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "expected %" PRIi64 " arguments, got %d", sig->Function.nin, nin);
+        return -1;
+    }
+
+    if (nout && nout != sig->Function.nout) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "expected %" PRIi64 " 'out' arguments, got %d", sig->Function.nout, nout);
+        return -1;
+    }
+
+    nargs = (int)sig->Function.nargs;
+
+    for (i = 0; i < nargs; i++) {
+        bool e;
+
+        inner[i] = pattern_dims(&dims[i], &dtypes[i], &e, sig->Function.types[i]);
+        if (inner[i] < 0 || (i > 0 && e != ellipsis)) {
+            return unsupported_signature(ctx);
+        }
+        ellipsis = e;
+    }
+
+    for (i = 0; i < nin+nout; i++) {
+        if (types[i]->tag == VarDim) {
+            ndt_err_format(ctx, NDT_NotImplementedError,
+                "var dimensions are not supported in ndarray typecheck");
+            return -1;
+        }
+    }
+
+    for (i = 0; i < nin+nout; i++) {
+        ndt_ndarray_t *x = &spec->args[i];
+        const ndt_t *t = types[i];
+
+        if (ndt_as_ndarray(x, t, ctx) < 0) {
+            return -1;
+        }
+
+        if (ellipsis ? x->ndim < inner[i] : x->ndim != inner[i]) {
+            return type_mismatch(ctx);
+        }
+
+        if (match_inner(&b, dims[i], inner[i], x, ctx) < 0 ||
+            bind_dtype(&b, dtypes[i], ndt_dtype(t), ctx) < 0) {
+            return -1;
+        }
+
+        if (i < nin) {
+            if (t->flags & (NDT_OPTION|NDT_SUBTREE_OPTION)) {
+                optional = true;
+                valid &= ndt_is_all_valid(t) != 0;
+            }
+
+            size = _resolve_broadcast(shape, size, x->shape, x->ndim-inner[i]);
+            if (size < 0) {
+                ndt_err_format(ctx, NDT_TypeError, "could not broadcast arguments");
+                return -1;
+            }
+        }
+    }
+
+    for (i = 0; i < nin; i++) {
+        broadcast_ndarray(&spec->args[i], inner[i], shape, size);
+    }
+
+    for (i = nin; i < nin+nout; i++) {
+        const ndt_ndarray_t *x = &spec->args[i];
+        const int outer = x->ndim-inner[i];
+
+        if (outer != size || memcmp(x->shape, shape, size * sizeof *shape) != 0) {
+            ndt_err_format(ctx, NDT_ValueError,
+                "explicit 'out' type not compatible with input types");
+            return -1;
+        }
+    }
+
+    if (nout == 0) {
+        for (i = nin; i < nargs; i++) {
+            const ndt_t *dtype = dtypes[i];
+
+            if (dtype->tag == Typevar) {
+                dtype = find_dtype(&b, dtype->Typevar.name);
+                if (dtype == NULL) {
+                    ndt_err_format(ctx, NDT_ValueError,
+                        "unbound type variable '%s'", dtypes[i]->Typevar.name);
+                    return -1;
+                }
+            }
+
+            if (infer_ndarray(&spec->args[i], &b, dims[i], inner[i], dtype,
+                              shape, size, ctx) < 0) {
+                return -1;
+            }
+        }
+    }
+
+    spec->nin = nin;
+    spec->nout = nargs-nin;
+    spec->nargs = nargs;
+    spec->outer_dims = size;
+
+    if (ndt_select_kernel_strategy_ndarray(spec, ctx) < 0) {
+        return -1;
+    }
+
+    if (optional && valid) {
+        spec->flags |= NDT_INNER_VALID;
+    }
+
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                                 Reductions                                 */
+/******************************************************************************/
+
+/* Normalize the axes and mark the reduced ones.  Return the number of axes. */
+static int
+reduce_axes(bool reduced[NDT_MAX_DIM], const int axes[], int naxes, int ndim,
+            ndt_context_t *ctx)
+{
+    int i;
+
+    for (i = 0; i < ndim; i++) {
+        reduced[i] = axes == NULL;
+    }
+
+    if (axes == NULL) {
+        return ndim;
+    }
+
+    if (naxes < 0 || naxes > ndim) {
+        ndt_err_format(ctx, NDT_ValueError, "invalid number of axes: %d", naxes);
+        return -1;
+    }
+
+    for (i = 0; i < naxes; i++) {
+        int k = axes[i] < 0 ? axes[i] + ndim : axes[i];
+
+        if (k < 0 || k >= ndim) {
+            ndt_err_format(ctx, NDT_ValueError,
+                "axis with value %d out of bounds", axes[i]);
+            return -1;
+        }
+
+        if (reduced[k]) {
+            ndt_err_format(ctx, NDT_ValueError,
+                "duplicate axis with value %d", axes[i]);
+            return -1;
+        }
+
+        reduced[k] = true;
+    }
+
+    return naxes;
+}
+
+static int
+reduce_fixed(ndt_apply_spec_t *spec, const ndt_t **out, const ndt_t *in,
+             const ndt_ndarray_t *a, const bool reduced[NDT_MAX_DIM],
+             const ndt_t *dtype, bool keepdims, ndt_context_t *ctx)
+{
+    int perm[NDT_MAX_DIM];
+    const ndt_t *t, *u;
+    int nkept = 0;
+    int i, k;
+
+    for (i = 0, k = 0; i < a->ndim; i++) {
+        if (!reduced[i]) {
+            perm[k++] = i;
+        }
+    }
+    nkept = k;
+
+    for (i = 0; i < a->ndim; i++) {
+        if (reduced[i]) {
+            perm[k++] = i;
+        }
+    }
+
+    spec->types[0] = ndt_transpose(in, perm, a->ndim, ctx);
+    if (spec->types[0] == NULL) {
+        return -1;
+    }
+
+    /* The output in loop order: the kept dimensions. */
+    ndt_incref(dtype);
+    t = dtype;
+    for (i = nkept-1; i >= 0; i--) {
+        u = ndt_fixed_dim(t, a->shape[perm[i]], INT64_MAX, ctx);
+        ndt_move(&t, u);
+        if (t == NULL) {
+            return -1;
+        }
+    }
+    spec->types[1] = t;
+
+    if (!keepdims) {
+        ndt_incref(t);
+        *out = t;
+        return 0;
+    }
+
+    /* With keepdims the reduced dimensions have shape 1 and the same layout. */
+    ndt_incref(dtype);
+    t = dtype;
+    for (i = a->ndim-1; i >= 0; i--) {
+        u = ndt_fixed_dim(t, reduced[i] ? 1 : a->shape[i], INT64_MAX, ctx);
+        ndt_move(&t, u);
+        if (t == NULL) {
+            return -1;
+        }
+    }
+
+    *out = t;
+    return 0;
+}
+
+static int
+reduce_var(ndt_apply_spec_t *spec, const ndt_t **out, const ndt_t *in,
+           int ndim, int nkept, const ndt_t *dtype, bool keepdims,
+           ndt_context_t *ctx)
+{
+    const ndt_t *dims[NDT_MAX_DIM];
+    const ndt_t *c, *t, *u;
+    ndt_offsets_t *ones;
+    int32_t *v;
+    int32_t nrows;
+    int i;
+
+    /* Contiguous copy that shares the offsets of 'in' if possible. */
+    c = ndt_var_copy_contiguous_at(in, 0, ndt_dtype(in), ctx);
+    if (c == NULL) {
+        return -1;
+    }
+
+    for (i = 0, t = c; i < ndim; i++, t = t->VarDim.type) {
+        dims[i] = t;
+    }
+
+    ndt_incref(in);
+    spec->types[0] = in;
+
+    /* The output in loop order: the kept dimensions. */
+    ndt_incref(dtype);
+    t = dtype;
+    for (i = nkept-1; i >= 0; i--) {
+        u = ndt_var_dim(t, dims[i]->Concrete.VarDim.offsets, 0, NULL, false, ctx);
+        ndt_move(&t, u);
+        if (t == NULL) {
+            ndt_decref(c);
+            return -1;
+        }
+    }
+    spec->types[1] = t;
+
+    if (!keepdims || nkept == ndim) {
+        ndt_decref(c);
+        ndt_incref(t);
+        *out = t;
+        return 0;
+    }
+
+    /* With keepdims every row of a reduced dimension has length 1. */
+    nrows = dims[nkept]->Concrete.VarDim.offsets->n - 1;
+    ndt_decref(c);
+
+    ones = ndt_offsets_new_uninit(nrows+1, ctx);
+    if (ones == NULL) {
+        return -1;
+    }
+
+    v = (int32_t *)ones->v;
+    for (i = 0; i <= nrows; i++) {
+        v[i] = i;
+    }
+    ones = ndt_offsets_intern(ones);
+
+    ndt_incref(dtype);
+    t = dtype;
+    for (i = ndim-1; i >= nkept; i--) {
+        u = ndt_var_dim(t, ones, 0, NULL, false, ctx);
+        ndt_move(&t, u);
+        if (t == NULL) {
+            ndt_decref_offsets(ones);
+            return -1;
+        }
+    }
+    ndt_decref_offsets(ones);
+
+    for (i = nkept-1; i >= 0; i--) {
+        u = ndt_var_dim(t, spec->types[1]->Concrete.VarDim.offsets, 0, NULL,
+                        false, ctx);
+        ndt_move(&t, u);
+        if (t == NULL) {
+            return -1;
+        }
+    }
+
+    *out = t;
+    return 0;
+}
+
+/*
+ * Typecheck a reduction of 'in' over 'axes'.  If 'axes' is NULL, all
+ * dimensions are reduced.  If 'dtype' is NULL, the output has the dtype
+ * of 'in'.
+ *
+ * On success, '*out' is the output type and 'spec' describes the loop:
+ * 'spec->types[0]' is 'in' with the reduced axes moved innermost and
+ * 'spec->types[1]' is the output without the reduced axes.  The outer
+ * dimensions are the kept axes, and the flags describe the contiguity
+ * of the reduced axes.
+ *
+ * Fixed dimensions can be reduced over any axes.  Var dimensions cannot
+ * be permuted and can only be reduced over trailing axes.
+ */
+int
+ndt_typecheck_reduce(ndt_apply_spec_t *spec, const ndt_t **out,
+                     const ndt_t *in, const int axes[], int naxes,
+                     bool keepdims, const ndt_t *dtype, ndt_context_t *ctx)
+{
+    bool reduced[NDT_MAX_DIM];
+    ndt_ndarray_t a;
+    int ndim, nreduced;
+    int ret;
+
+    *spec = ndt_apply_spec_empty;
+    *out = NULL;
+
+    if (ndt_is_abstract(in) || (dtype != NULL && ndt_is_abstract(dtype))) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "ndt_typecheck_reduce() called on abstract type");
+        return -1;
+    }
+
+    if (dtype == NULL) {
+        dtype = ndt_dtype(in);
+    }
+    else if (dtype->ndim > 0) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "ndt_typecheck_reduce(): dtype must have zero dimensions");
+        return -1;
+    }
+
+    ndim = ndt_logical_ndim(in);
+    nreduced = reduce_axes(reduced, axes, naxes, ndim, ctx);
+    if (nreduced < 0) {
+        return -1;
+    }
+
+    spec->nin = 1;
+    spec->nout = 1;
+    spec->nargs = 2;
+    spec->outer_dims = ndim - nreduced;
+
+    switch (in->tag) {
+    case VarDim: case VarDimElem:
+        for (int i = spec->outer_dims; i < ndim; i++) {
+            if (!reduced[i]) {
+                ndt_err_format(ctx, NDT_NotImplementedError,
+                    "var dimensions can only be reduced over trailing axes");
+                ndt_apply_spec_clear(spec);
+                return -1;
+            }
+        }
+        ret = reduce_var(spec, out, in, ndim, spec->outer_dims, dtype,
+                         keepdims, ctx);
+        break;
+    default:
+        if (ndt_as_ndarray(&a, in, ctx) < 0) {
+            ndt_err_clear(ctx);
+            ndt_err_format(ctx, NDT_NotImplementedError,
+                "reductions are restricted to fixed and var dimensions");
+            ndt_apply_spec_clear(spec);
+            return -1;
+        }
+        ret = reduce_fixed(spec, out, in, &a, reduced, dtype, keepdims, ctx);
+        break;
+    }
+
+    if (ret < 0 || ndt_select_kernel_strategy(spec, ctx) < 0) {
+        ndt_decref(*out);
+        *out = NULL;
+        ndt_apply_spec_clear(spec);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                     Adaptive specialization of typecheck                   */
+/******************************************************************************/
+
+/*
+ * In adaptive mode ndt_typecheck() profiles the classes of its argument
+ * types.  A class is "all 'in' arguments are C-contiguous fixed arrays
+ * of the same shape and ndim, with given dtypes".  The kernel flags only
+ * depend on which dimensions have shapes 0, 1 or > 1, so these are part
+ * of the class.
+ *
+ * Classes are only profiled for signatures whose arguments all have the
+ * same dimensions (e.g. "... * float64, ... * float64 -> ... * float64"),
+ * so the inferred return types have the shape of the first argument.
+ * After 'threshold' successful calls with the same class a specialization
+ * is installed.  It checks the class and fills the apply spec directly.
+ *
+ * The tables are per thread.  When a table is full, rejected candidates are
+ * recycled first, then the slot with the fewest calls.  An installed
+ * specialization is only replaced by a candidate with more calls.
+ */
+
+#define SPEC_MAX_NDIM 32
+#define SPEC_MAX_ARGS 8
+#define SPEC_MAX_ENTRIES 16
+#define SPEC_MAX_CANDIDATES 32
+
+typedef struct {
+    int ndim;
+    uint32_t nontrivial;  /* dimensions with shape > 1 */
+    uint32_t empty;       /* dimensions with shape 0 */
+    int64_t shape[SPEC_MAX_NDIM];
+    const ndt_t *dtypes[SPEC_MAX_ARGS];
+    uint64_t keys[SPEC_MAX_ARGS];
+} spec_class_t;
+
+typedef struct {
+    const ndt_t *sig;
+    int ndim;
+    uint32_t nontrivial;
+    uint32_t empty;
+    const ndt_t *dtypes[SPEC_MAX_ARGS]; /* 'in' dtypes, then 'out' dtypes */
+    uint64_t keys[SPEC_MAX_ARGS];       /* spec_dtype_key() of the 'in' dtypes */
+    uint32_t flags;
+    int outer_dims;
+    bool rejected;                      /* candidate that cannot be specialized */
+    int64_t count;                      /* number of calls */
+} spec_entry_t;
+
+static NDT_THREAD_LOCAL struct {
+    bool enabled;
+    int64_t threshold;
+    int nentries;
+    int ncandidates;
+    spec_entry_t entries[SPEC_MAX_ENTRIES];
+    spec_entry_t candidates[SPEC_MAX_CANDIDATES];
+    ndt_typecheck_stats_t stats;
+} specialize;
+
+static bool
+name_equal(const char *s, const char *t)
+{
+    if (s == NULL || t == NULL) {
+        return s == t;
+    }
+
+    return symbol_equal(s, t);
+}
+
+static bool
+same_dims(const ndt_t *p, const ndt_t *q)
+{
+    while (p->tag == EllipsisDim || p->tag == SymbolicDim) {
+        if (q->tag != p->tag) {
+            return false;
+        }
+
+        if (p->tag == EllipsisDim) {
+            if (p->EllipsisDim.tag == RequireF || q->EllipsisDim.tag == RequireF ||
+                !name_equal(p->EllipsisDim.name, q->EllipsisDim.name)) {
+                return false;
+            }
+            p = p->EllipsisDim.type;
+            q = q->EllipsisDim.type;
+        }
+        else {
+            if (!name_equal(p->SymbolicDim.name, q->SymbolicDim.name)) {
+                return false;
+            }
+            p = p->SymbolicDim.type;
+            q = q->SymbolicDim.type;
+        }
+    }
+
+    return p->ndim == 0 && q->ndim == 0 &&
+           q->tag != EllipsisDim && q->tag != SymbolicDim;
+}
+
+static bool
+elementwise_signature(const ndt_t *sig)
+{
+    const ndt_t * const *types = sig->Function.types;
+
+    for (int64_t i = 1; i < sig->Function.nargs; i++) {
+        if (!same_dims(types[0], types[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Cheap hash of a dtype.  ndt_equal() dtypes have the same tag, datasize and
+ * flags except for NDT_ALL_VALID.  The hint determines NDT_ALL_VALID, so it
+ * is part of the key, and equal keys imply equal NDT_ALL_VALID bits.
+ */
+static inline uint64_t
+spec_dtype_key(const ndt_t *t)
+{
+    return ((uint64_t)t->datasize << 32) ^ ((uint64_t)t->tag << 16) ^ t->flags;
+}
+
+/* Return true if the 'in' types belong to a class, false otherwise. */
+static bool
+spec_class(spec_class_t *k, const ndt_t *types[], int nin)
+{
+    const ndt_t *dims[SPEC_MAX_NDIM];
+
+    for (int i = 0; i < nin; i++) {
+        const ndt_t *t;
+        int64_t step = 1;
+        int n = 0;
+
+        for (t = types[i]; t->tag == FixedDim; t = t->FixedDim.type) {
+            if (n == SPEC_MAX_NDIM || t->access != Concrete ||
+                (t->flags & NDT_OPTION) || t->Concrete.FixedDim.tile != 0) {
+                return false;
+            }
+            dims[n++] = t;
+        }
+
+        if (n == 0 || t->ndim != 0 || t->access != Concrete) {
+            return false;
+        }
+
+        if (i == 0) {
+            k->ndim = n;
+            k->nontrivial = k->empty = 0;
+        }
+        else if (n != k->ndim) {
+            return false;
+        }
+
+        for (int j = n-1; j >= 0; j--) {
+            const int64_t shape = dims[j]->FixedDim.shape;
+
+            if (i == 0) {
+                k->shape[j] = shape;
+                k->nontrivial |= (uint32_t)(shape > 1) << j;
+                k->empty |= (uint32_t)(shape == 0) << j;
+            }
+            else if (shape != k->shape[j]) {
+                return false;
+            }
+
+            if (shape > 1 && dims[j]->Concrete.FixedDim.step != step) {
+                return false;
+            }
+            step *= shape;
+        }
+
+        k->dtypes[i] = t;
+        k->keys[i] = spec_dtype_key(t);
+    }
+
+    return true;
+}
+
+static spec_entry_t *
+spec_find(spec_entry_t entries[], int n, const ndt_t *sig, int nin,
+          const spec_class_t *k)
+{
+    for (int i = 0; i < n; i++) {
+        spec_entry_t *e = &entries[i];
+        int j;
+
+        if (e->sig != sig || e->ndim != k->ndim ||
+            e->nontrivial != k->nontrivial || e->empty != k->empty) {
+            continue;
+        }
+
+        /*
+         * Interned dtypes match by pointer.  Others are compared structurally
+         * only if their keys are equal.
+         */
+        for (j = 0; j < nin; j++) {
+            if (e->dtypes[j] != k->dtypes[j] &&
+                (e->keys[j] != k->keys[j] ||
+                 !ndt_equal(e->dtypes[j], k->dtypes[j]))) {
+                break;
+            }
+        }
+
+        if (j == nin) {
+            return e;
+        }
+    }
+
+    return NULL;
+}
+
+static void
+spec_entry_clear(spec_entry_t *e)
+{
+    for (int64_t i = 0; i < e->sig->Function.nargs; i++) {
+        ndt_decref(e->dtypes[i]);
+    }
+    ndt_decref(e->sig);
+}
+
+/* Return the slot to recycle in a full table: a rejected or the coldest one. */
+static spec_entry_t *
+spec_victim(spec_entry_t entries[], int n)
+{
+    spec_entry_t *v = &entries[0];
+
+    for (int i = 0; i < n; i++) {
+        spec_entry_t *e = &entries[i];
+        if (e->rejected) {
+            return e;
+        }
+        if (e->count < v->count) {
+            v = e;
+        }
+    }
+
+    return v;
+}
+
+/*
+ * Initialize a candidate from a successful general typecheck.  The candidate
+ * is rejected if the spec cannot be reproduced from the class.
+ */
+static void
+spec_entry_init(spec_entry_t *e, const ndt_t *sig, const spec_class_t *k,
+                const ndt_apply_spec_t *spec, const ndt_t *types[])
+{
+    NDT_STATIC_CONTEXT(ctx);
+    const int nin = (int)sig->Function.nin;
+    const int nargs = (int)sig->Function.nargs;
+
+    ndt_incref(sig);
+    e->sig = sig;
+    e->ndim = k->ndim;
+    e->nontrivial = k->nontrivial;
+    e->empty = k->empty;
+    e->flags = spec->flags;
+    e->outer_dims = spec->outer_dims;
+    e->rejected = !elementwise_signature(sig);
+    e->count = 0;
+
+    for (int i = 0; i < nin; i++) {
+        ndt_incref(k->dtypes[i]);
+        e->dtypes[i] = k->dtypes[i];
+        e->keys[i] = k->keys[i];
+        if (!ndt_equal(spec->types[i], types[i])) {
+            e->rejected = true;
+        }
+    }
+
+    for (int i = nin; i < nargs; i++) {
+        const ndt_t *dtype = ndt_dtype(spec->types[i]);
+        const ndt_t *t;
+
+        ndt_incref(dtype);
+        e->dtypes[i] = dtype;
+
+        if (!e->rejected) {
+            t = fixed_dim_from_shape(k->shape, k->ndim, dtype, &ctx);
+            if (t == NULL) {
+                ndt_err_clear(&ctx);
+                e->rejected = true;
+                continue;
+            }
+
+            if (!ndt_equal(t, spec->types[i])) {
+                e->rejected = true;
+            }
+            ndt_decref(t);
+        }
+    }
+}
+
+/*
+ * Return 1 if a specialization has filled in 'spec', 0 if the general
+ * path must be taken, -1 on error.
+ */
+static int
+specialized_typecheck(ndt_apply_spec_t *spec, const ndt_t *sig,
+                      const ndt_t *types[], const int64_t li[],
+                      int nin, int nout, const ndt_constraint_t *c,
+                      ndt_context_t *ctx)
+{
+    spec_class_t k;
+    spec_entry_t *e;
+    int i;
+
+    if (!specialize.enabled) {
+        return 0;
+    }
+
+    specialize.stats.calls++;
+
+    if (specialize.nentries == 0 || nout != 0 || c != NULL ||
+        nin < 1 || nin > SPEC_MAX_ARGS) {
+        return 0;
+    }
+
+    for (i = 0; i < nin; i++) {
+        if (li[i] != 0) {
+            return 0;
+        }
+    }
+
+    if (!spec_class(&k, types, nin)) {
+        return 0;
+    }
+
+    e = spec_find(specialize.entries, specialize.nentries, sig, nin, &k);
+    if (e == NULL || sig->Function.nin != nin) {
+        return 0;
+    }
+
+    for (i = 0; i < nin; i++) {
+        ndt_incref(types[i]);
+        spec->types[i] = types[i];
+        spec->nin++;
+    }
+
+    for (; i < sig->Function.nargs; i++) {
+        spec->types[i] = fixed_dim_from_shape(k.shape, k.ndim, e->dtypes[i], ctx);
+        if (spec->types[i] == NULL) {
+            ndt_apply_spec_clear(spec);
+            return -1;
+        }
+        spec->nout++;
+    }
+
+    spec->nargs = spec->nin + spec->nout;
+    spec->flags = e->flags;
+    spec->outer_dims = e->outer_dims;
+
+    e->count++;
+    specialize.stats.hits++;
+
+    return 1;
+}
+
+static void
+specialize_profile(const ndt_apply_spec_t *spec, const ndt_t *sig,
+                   const ndt_t *types[], const int64_t li[],
+                   int nin, int nout, const ndt_constraint_t *c)
+{
+    spec_class_t k;
+    spec_entry_t *e;
+
+    if (!specialize.enabled || nout != 0 || c != NULL ||
+        sig->Function.nargs > SPEC_MAX_ARGS) {
+        return;
+    }
+
+    for (int i = 0; i < nin; i++) {
+        if (li[i] != 0) {
+            return;
+        }
+    }
+
+    if (!spec_class(&k, types, nin)) {
+        return;
+    }
+
+    e = spec_find(specialize.candidates, specialize.ncandidates, sig, nin, &k);
+    if (e == NULL) {
+        if (specialize.ncandidates == SPEC_MAX_CANDIDATES) {
+            e = spec_victim(specialize.candidates, specialize.ncandidates);
+            spec_entry_clear(e);
+        }
+        else {
+            e = &specialize.candidates[specialize.ncandidates++];
+        }
+        spec_entry_init(e, sig, &k, spec, types);
+    }
+
+    e->count++;
+
+    if (!e->rejected && e->count >= specialize.threshold) {
+        spec_entry_t *slot;
+
+        if (specialize.nentries < SPEC_MAX_ENTRIES) {
+            slot = &specialize.entries[specialize.nentries++];
+        }
+        else {
+            slot = spec_victim(specialize.entries, specialize.nentries);
+            if (slot->count >= e->count) {
+                return;
+            }
+            spec_entry_clear(slot);
+        }
+
+        *slot = *e;
+        specialize.stats.installed++;
+
+        *e = specialize.candidates[--specialize.ncandidates];
+    }
+}
+
+/*
+ * Enable adaptive mode: argument classes that are typechecked successfully
+ * 'threshold' times are served by a specialization.  The setting and the
+ * tables only apply to the calling thread.
+ */
+int
+ndt_typecheck_specialize_enable(int64_t threshold, ndt_context_t *ctx)
+{
+    if (threshold < 1) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "specialization threshold must be positive");
+        return -1;
+    }
+
+    ndt_typecheck_specialize_disable();
+
+    specialize.threshold = threshold;
+    specialize.stats = (ndt_typecheck_stats_t){0, 0, 0};
+    specialize.enabled = true;
+
+    return 0;
+}
+
+/*
+ * Disable adaptive mode and remove all specializations of the calling thread.
+ * Statistics are kept.
+ */
+void
+ndt_typecheck_specialize_disable(void)
+{
+    for (int i = 0; i < specialize.nentries; i++) {
+        spec_entry_clear(&specialize.entries[i]);
+    }
+
+    for (int i = 0; i < specialize.ncandidates; i++) {
+        spec_entry_clear(&specialize.candidates[i]);
+    }
+
+    specialize.nentries = 0;
+    specialize.ncandidates = 0;
+    specialize.enabled = false;
+}
+
+void
+ndt_typecheck_specialize_stats(ndt_typecheck_stats_t *stats)
+{
+    *stats = specialize.stats;
+}
+
+
+/******************************************************************************/
+/*                          Type propagation in graphs                        */
+/******************************************************************************/
+
+/*
+ * Type check a DAG of gufunc signatures in a single pass.  'nodes' must be in
+ * topological order: an edge may only refer to a graph input or to an output
+ * of an earlier node.  On success, specs[i] contains the argument types of
+ * node i, including the inferred concrete output types (and therefore their
+ * datasize and alignment), so buffers for the whole pipeline can be planned
+ * ahead of execution.
+ *
+ * Each node has its own symbol scope, so unrelated nodes may reuse the same
+ * symbol names.  Bindings are related only along the edges: the inferred
+ * output types are concrete, so the consumer of an edge matches its symbols
+ * against the shapes that the producer has bound.  The trie of the symbol
+ * table is allocated once and unbound before each node.
+ */
+int
+ndt_graph_typecheck(ndt_apply_spec_t specs[], const ndt_graph_node_t nodes[],
+                    int nnodes, const ndt_t *inputs[], int ninputs,
+                    ndt_context_t *ctx)
+{
+    static const int64_t li[NDT_MAX_ARGS] = {0};
+    const ndt_t *types[NDT_MAX_ARGS];
+    symtable_t *tbl;
+    int i, k;
+
+    for (i = 0; i < nnodes; i++) {
+        specs[i] = ndt_apply_spec_empty;
+    }
+
+    tbl = symtable_new(ctx);
+    if (tbl == NULL) {
+        return -1;
+    }
+
+    for (i = 0; i < nnodes; i++) {
+        const ndt_t *sig = nodes[i].sig;
+        int64_t nin;
+
+        if (sig == NULL || sig->tag != Function) {
+            ndt_err_format(ctx, NDT_ValueError,
+                "graph node %d: signature must be a function type", i);
+            goto error;
+        }
+
+        nin = sig->Function.nin;
+        if (nin > NDT_MAX_ARGS || sig->Function.nargs > NDT_MAX_ARGS) {
+            ndt_err_format(ctx, NDT_ValueError,
+                "graph node %d: too many arguments", i);
+            goto error;
+        }
+
+        for (k = 0; k < nin; k++) {
+            const ndt_graph_edge_t e = nodes[i].in[k];
+
+            if (e.node < 0) {
+                if (e.index < 0 || e.index >= ninputs) {
+                    ndt_err_format(ctx, NDT_ValueError,
+                        "graph node %d: invalid graph input %d", i, e.index);
+                    goto error;
+                }
+                types[k] = inputs[e.index];
+            }
+            else {
+                if (e.node >= i) {
+                    ndt_err_format(ctx, NDT_ValueError,
+                        "graph node %d: edge from node %d violates topological order",
+                        i, e.node);
+                    goto error;
+                }
+                if (e.index < 0 || e.index >= specs[e.node].nout) {
+                    ndt_err_format(ctx, NDT_ValueError,
+                        "graph node %d: node %d has no output %d", i, e.node, e.index);
+                    goto error;
+                }
+                types[k] = specs[e.node].types[specs[e.node].nin + e.index];
+            }
+        }
+
+        symtable_clear(tbl);
+        if (typecheck(&specs[i], sig, types, li, (int)nin, 0, false,
+                      NULL, NULL, tbl, ctx) < 0) {
+            goto error;
+        }
+    }
+
+    symtable_del(tbl);
+    return 0;
+
+error:
+    for (k = 0; k < i; k++) {
+        ndt_apply_spec_clear(&specs[k]);
+    }
+    symtable_del(tbl);
+    return -1;
+}
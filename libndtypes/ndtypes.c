@@ -36,6 +36,7 @@
 #endif
 
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdint.h>
 #include <inttypes.h>
@@ -43,7 +44,10 @@
 #include <complex.h>
 #include <assert.h>
 #include "ndtypes.h"
+#include "intern.h"
+#include "nelem.h"
 #include "overflow.h"
+#include "seq.h"
 #include "slice.h"
 
 
@@ -114,12 +118,12 @@ ndt_subtree_flags(const ndt_t *type)
     return flags;
 }
 
-/* Determine general subtree and ellipsis flags. */
+/* Determine general subtree, ellipsis and tiling flags. */
 static uint32_t
 ndt_dim_flags(const ndt_t *type)
 {
     uint32_t flags = ndt_subtree_flags(type);
-    flags |= (type->flags & NDT_ELLIPSIS);
+    flags |= (type->flags & (NDT_ELLIPSIS|NDT_TILED));
     return flags;
 }
 
@@ -207,6 +211,64 @@ ndt_subtree_is_optional(const ndt_t *t)
     return t->flags & NDT_SUBTREE_OPTION;
 }
 
+/*
+ * Return 1 if no optional type in 't' can contain missing values.  Types
+ * without optional parts are trivially all valid.
+ */
+int
+ndt_is_all_valid(const ndt_t *t)
+{
+    int64_t i;
+
+    if (!(t->flags & (NDT_OPTION|NDT_SUBTREE_OPTION))) {
+        return 1;
+    }
+
+    if ((t->flags & NDT_OPTION) && !(t->flags & NDT_ALL_VALID)) {
+        return 0;
+    }
+
+    switch (t->tag) {
+    case FixedDim:
+        return ndt_is_all_valid(t->FixedDim.type);
+    case VarDim:
+        return ndt_is_all_valid(t->VarDim.type);
+    case VarDimElem:
+        return ndt_is_all_valid(t->VarDimElem.type);
+    case Array:
+        return ndt_is_all_valid(t->Array.type);
+    case Tuple:
+        for (i = 0; i < t->Tuple.shape; i++) {
+            if (!ndt_is_all_valid(t->Tuple.types[i])) {
+                return 0;
+            }
+        }
+        return 1;
+    case Record:
+        for (i = 0; i < t->Record.shape; i++) {
+            if (!ndt_is_all_valid(t->Record.types[i])) {
+                return 0;
+            }
+        }
+        return 1;
+    case Union:
+        for (i = 0; i < t->Union.ntags; i++) {
+            if (!ndt_is_all_valid(t->Union.types[i])) {
+                return 0;
+            }
+        }
+        return 1;
+    case Ref:
+        return ndt_is_all_valid(t->Ref.type);
+    case Constr:
+        return ndt_is_all_valid(t->Constr.type);
+    case Nominal:
+        return ndt_is_all_valid(t->Nominal.type);
+    default:
+        return 1;
+    }
+}
+
 int
 ndt_is_pointer_free(const ndt_t *t)
 {
@@ -225,7 +287,7 @@ ndt_is_ndarray(const ndt_t *t)
 {
     switch (t->tag) {
     case FixedDim:
-        return 1;
+        return !(t->flags & NDT_TILED);
     default:
         return t->ndim == 0;
     }
@@ -558,6 +620,26 @@ get_align(uint16_opt_t align, uint16_t default_align, ndt_context_t *ctx)
  *
  * 'name' is NULL for a tuple field.
  */
+static void
+field_init(ndt_field_t *field, char *name, const ndt_t *type,
+           uint16_opt_t align, uint16_opt_t pack, uint16_opt_t pad,
+           uint16_t min_align)
+{
+    field->name = name;
+
+    ndt_incref(type);
+    field->type = type;
+
+    /* concrete access */
+    field->access = type->access;
+    if (field->access == Concrete) {
+        field->Concrete.align = min_align;
+        field->Concrete.explicit_align = (align.tag==Some || pack.tag==Some);
+        field->Concrete.pad = (pad.tag==Some) ? pad.Some : UINT16_MAX;
+        field->Concrete.explicit_pad = (pad.tag==Some);
+    }
+}
+
 ndt_field_t *
 ndt_field(char *name, const ndt_t *type, uint16_opt_t align, uint16_opt_t pack,
           uint16_opt_t pad, ndt_context_t *ctx)
@@ -581,20 +663,34 @@ ndt_field(char *name, const ndt_t *type, uint16_opt_t align, uint16_opt_t pack,
         ndt_free(name);
         return ndt_memory_error(ctx);
     }
-    field->name = name;
 
-    ndt_incref(type);
-    field->type = type;
+    field_init(field, name, type, align, pack, pad, min_align);
+    return field;
+}
 
-    /* concrete access */
-    field->access = type->access;
-    if (field->access == Concrete) {
-        field->Concrete.align = min_align;
-        field->Concrete.explicit_align = (align.tag==Some || pack.tag==Some);
-        field->Concrete.pad = (pad.tag==Some) ? pad.Some : UINT16_MAX;
-        field->Concrete.explicit_pad = (pad.tag==Some);
+/*
+ * Like ndt_field(), but allocate the field in the scratch space.  'name' is
+ * not copied and must outlive the field.  Only the reference to 'type' is
+ * owned by the field.
+ */
+ndt_field_t *
+ndt_scratch_field(const char *name, const ndt_t *type, uint16_opt_t align,
+                  uint16_opt_t pack, uint16_opt_t pad, ndt_context_t *ctx)
+{
+    ndt_field_t *field;
+    uint16_t min_align;
+
+    min_align = min_field_align(type, align, pack, ctx);
+    if (min_align == UINT16_MAX) {
+        return NULL;
+    }
+
+    field = ndt_scratch_alloc(1, sizeof *field, ctx);
+    if (field == NULL) {
+        return NULL;
     }
 
+    field_init(field, (char *)name, type, align, pack, pad, min_align);
     return field;
 }
 
@@ -843,7 +939,7 @@ strcmp_null(const char *s, const char *t)
     if (s == NULL) {
         return t == NULL;
     }
-    return t != NULL && strcmp(s, t) == 0;
+    return t != NULL && (s == t || strcmp(s, t) == 0);
 }
 
 static int
@@ -910,6 +1006,344 @@ is_elemwise(const ndt_t **types, int64_t nargs)
 }
 
 
+/******************************************************************************/
+/*                              Symbol interning                              */
+/******************************************************************************/
+
+/*
+ * Opt-in table of shared symbol names (dimension variables, type variables
+ * and named ellipses).  Interned names are refcounted and released with the
+ * last type that uses them.  Equal interned names have equal pointers, so
+ * name comparisons reduce to a pointer comparison in the common case.
+ *
+ * The symbol and offsets tables are process global.  Types may be deleted
+ * from any thread, so all table accesses are serialized by a spinlock.  The
+ * critical sections are short lookups, except for the occasional resize.
+ *
+ * 'intern_used' mirrors the total number of entries.  A released name or
+ * offsets struct can only be interned if the count is nonzero: the entry was
+ * counted before the object was handed out.  Releases skip the lock if the
+ * tables are empty, which is always the case if interning is not used.
+ */
+
+static ATOMIC_INT64 intern_used = 0;
+
+#ifdef _MSC_VER
+static volatile LONG intern_mutex = 0;
+
+static inline void
+intern_lock(void)
+{
+    while (InterlockedExchange(&intern_mutex, 1) != 0) {
+        YieldProcessor();
+    }
+}
+
+static inline void
+intern_unlock(void)
+{
+    (void)InterlockedExchange(&intern_mutex, 0);
+}
+#else
+static atomic_flag intern_mutex = ATOMIC_FLAG_INIT;
+
+static inline void
+intern_pause(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+static inline void
+intern_lock(void)
+{
+    while (atomic_flag_test_and_set_explicit(&intern_mutex, memory_order_acquire)) {
+        intern_pause();
+    }
+}
+
+static inline void
+intern_unlock(void)
+{
+    atomic_flag_clear_explicit(&intern_mutex, memory_order_release);
+}
+#endif
+
+/* Return false if no entry can be found without taking the lock. */
+static inline bool
+intern_nonempty(void)
+{
+#ifdef _MSC_VER
+    return intern_used != 0;
+#else
+    return atomic_load_explicit(&intern_used, memory_order_relaxed) != 0;
+#endif
+}
+
+/* Adjust the total number of entries.  Called with the lock held. */
+static inline void
+intern_count(int64_t delta)
+{
+#ifdef _MSC_VER
+    intern_used += delta;
+#else
+    int64_t n = atomic_load_explicit(&intern_used, memory_order_relaxed);
+    atomic_store_explicit(&intern_used, n+delta, memory_order_relaxed);
+#endif
+}
+
+typedef struct {
+    int64_t refcnt;
+    char name[];
+} symbol_t;
+
+typedef struct {
+    uint64_t hash;
+    symbol_t *symbol;
+} symbol_entry_t;
+
+static struct {
+    bool enabled;
+    int64_t size;   /* power of two or 0 if no table is allocated */
+    int64_t used;
+    symbol_entry_t *entries;
+} symbol_table = {false, 0, 0, NULL};
+
+#define SYMBOL_MINSIZE 64
+
+static uint64_t
+symbol_hash(const char *name)
+{
+    uint64_t h = 14695981039346656037ULL;
+
+    for (const unsigned char *cp = (const unsigned char *)name; *cp != '\0'; cp++) {
+        h ^= *cp;
+        h *= 1099511628211ULL;
+    }
+
+    return h;
+}
+
+static int
+symbol_table_resize(int64_t size)
+{
+    symbol_entry_t *entries;
+    int64_t mask = size-1;
+
+    entries = ndt_calloc(size, sizeof *entries);
+    if (entries == NULL) {
+        return -1;
+    }
+
+    for (int64_t i = 0; i < symbol_table.size; i++) {
+        const symbol_entry_t *e = &symbol_table.entries[i];
+        if (e->symbol != NULL) {
+            int64_t k = (int64_t)(e->hash & (uint64_t)mask);
+            while (entries[k].symbol != NULL) {
+                k = (k+1) & mask;
+            }
+            entries[k] = *e;
+        }
+    }
+
+    ndt_free(symbol_table.entries);
+    symbol_table.entries = entries;
+    symbol_table.size = size;
+
+    return 0;
+}
+
+static void
+symbol_table_free(void)
+{
+    ndt_free(symbol_table.entries);
+    symbol_table.entries = NULL;
+    symbol_table.size = 0;
+    symbol_table.used = 0;
+}
+
+static void
+symbol_table_remove(int64_t i)
+{
+    const int64_t mask = symbol_table.size-1;
+    symbol_entry_t *entries = symbol_table.entries;
+    int64_t j, k;
+
+    /* Backward shift deletion for linear probing. */
+    for (j = (i+1) & mask; entries[j].symbol != NULL; j = (j+1) & mask) {
+        k = (int64_t)(entries[j].hash & (uint64_t)mask);
+        if ((j > i && (k <= i || k > j)) || (j < i && (k <= i && k > j))) {
+            entries[i] = entries[j];
+            i = j;
+        }
+    }
+
+    entries[i].symbol = NULL;
+    entries[i].hash = 0;
+    symbol_table.used--;
+    intern_count(-1);
+}
+
+/* Release a name owned by a type. */
+static void
+symbol_release(char *name)
+{
+    symbol_t *sym;
+
+    if (name == NULL) {
+        return;
+    }
+
+    if (!intern_nonempty()) {
+        ndt_free(name);
+        return;
+    }
+
+    intern_lock();
+    if (symbol_table.used > 0) {
+        const int64_t mask = symbol_table.size-1;
+        int64_t i = (int64_t)(symbol_hash(name) & (uint64_t)mask);
+
+        for (; symbol_table.entries[i].symbol != NULL; i = (i+1) & mask) {
+            sym = symbol_table.entries[i].symbol;
+            if (sym->name == name) {
+                if (--sym->refcnt == 0) {
+                    symbol_table_remove(i);
+                    if (!symbol_table.enabled && symbol_table.used == 0) {
+                        symbol_table_free();
+                    }
+                    intern_unlock();
+                    ndt_free(sym);
+                    return;
+                }
+                intern_unlock();
+                return;
+            }
+        }
+    }
+    intern_unlock();
+
+    ndt_free(name);
+}
+
+int
+ndt_symbol_intern_enable(ndt_context_t *ctx)
+{
+    int ret = 0;
+
+    intern_lock();
+    if (symbol_table.size == 0) {
+        ret = symbol_table_resize(SYMBOL_MINSIZE);
+    }
+    if (ret == 0) {
+        symbol_table.enabled = true;
+    }
+    intern_unlock();
+
+    if (ret < 0) {
+        (void)ndt_memory_error(ctx);
+    }
+
+    return ret;
+}
+
+/* Stop interning.  Names that are still in use remain shared. */
+void
+ndt_symbol_intern_disable(void)
+{
+    intern_lock();
+    symbol_table.enabled = false;
+    if (symbol_table.used == 0) {
+        symbol_table_free();
+    }
+    intern_unlock();
+}
+
+int64_t
+ndt_symbol_intern_size(void)
+{
+    int64_t used;
+
+    intern_lock();
+    used = symbol_table.used;
+    intern_unlock();
+
+    return used;
+}
+
+/*
+ * Steal 'name' and return a new reference to the shared name with the same
+ * content.  If interning is disabled or memory is short, 'name' is returned
+ * unchanged.  The result must only be passed to a type constructor.
+ */
+char *
+ndt_symbol_intern(char *name)
+{
+    symbol_t *sym;
+    int64_t mask;
+    uint64_t hash;
+    size_t len;
+    int64_t i;
+
+    if (name == NULL) {
+        return name;
+    }
+
+    intern_lock();
+    if (!symbol_table.enabled) {
+        intern_unlock();
+        return name;
+    }
+
+    if (3 * (symbol_table.used+1) > 2 * symbol_table.size) {
+        if (symbol_table_resize(2 * symbol_table.size) < 0) {
+            intern_unlock();
+            return name;
+        }
+    }
+
+    mask = symbol_table.size-1;
+    hash = symbol_hash(name);
+    i = (int64_t)(hash & (uint64_t)mask);
+
+    for (; symbol_table.entries[i].symbol != NULL; i = (i+1) & mask) {
+        sym = symbol_table.entries[i].symbol;
+        if (sym->name == name) {
+            intern_unlock();
+            return name;
+        }
+        if (symbol_table.entries[i].hash == hash && strcmp(sym->name, name) == 0) {
+            sym->refcnt++;
+            intern_unlock();
+            ndt_free(name);
+            return sym->name;
+        }
+    }
+
+    len = strlen(name);
+    sym = ndt_alloc(1, offsetof(symbol_t, name) + len + 1);
+    if (sym == NULL) {
+        intern_unlock();
+        return name;
+    }
+
+    sym->refcnt = 1;
+    memcpy(sym->name, name, len+1);
+
+    symbol_table.entries[i].hash = hash;
+    symbol_table.entries[i].symbol = sym;
+    symbol_table.used++;
+    intern_count(1);
+    intern_unlock();
+
+    ndt_free(name);
+    return sym->name;
+}
+
+
 /******************************************************************************/
 /*                         Type allocation/deallocation                       */
 /******************************************************************************/
@@ -919,7 +1353,11 @@ ndt_new(enum ndt tag, uint32_t flags, ndt_context_t *ctx)
 {
     ndt_t *t;
 
-    t = ndt_alloc_size(sizeof *t);
+    if (ndt_limit_node(ctx, sizeof *t) < 0) {
+        return NULL;
+    }
+
+    t = ndt_alloc_class(NDT_ALLOC_NODE, 1, sizeof *t);
     if (t == NULL) {
         return ndt_memory_error(ctx);
     }
@@ -933,6 +1371,7 @@ ndt_new(enum ndt tag, uint32_t flags, ndt_context_t *ctx)
     t->align = UINT16_MAX;
 
     t->refcnt = 1;
+    t->owned = false;
 
     return t;
 }
@@ -950,7 +1389,11 @@ ndt_new_extra(enum ndt tag, int64_t n, uint32_t flags, ndt_context_t *ctx)
         return NULL;
     }
 
-    t = ndt_alloc(1, size);
+    if (ndt_limit_node(ctx, size) < 0) {
+        return NULL;
+    }
+
+    t = ndt_alloc_class(NDT_ALLOC_NODE, 1, size);
     if (t == NULL) {
         return ndt_memory_error(ctx);
     }
@@ -964,6 +1407,7 @@ ndt_new_extra(enum ndt tag, int64_t n, uint32_t flags, ndt_context_t *ctx)
     t->align = UINT16_MAX;
 
     t->refcnt = 1;
+    t->owned = false;
 
     return t;
 }
@@ -1046,8 +1490,14 @@ ndt_tuple_new(enum ndt_variadic flag, int64_t shape, bool opt, ndt_context_t *ct
     return t;
 }
 
+/*
+ * The field names are stored after the field arrays.  'namesize' is their
+ * total size including the terminating NUL bytes.  The names are copied in
+ * with ndt_record_set_name().
+ */
 ndt_t *
-ndt_record_new(enum ndt_variadic flag, int64_t shape, bool opt, ndt_context_t *ctx)
+ndt_record_new(enum ndt_variadic flag, int64_t shape, int64_t namesize, bool opt,
+               ndt_context_t *ctx)
 {
     ndt_t *t = NULL;
     bool overflow = 0;
@@ -1055,10 +1505,16 @@ ndt_record_new(enum ndt_variadic flag, int64_t shape, bool opt, ndt_context_t *c
     int64_t offset_offset;
     int64_t align_offset;
     int64_t pad_offset;
+    int64_t names_offset;
     int64_t extra;
     int64_t size;
     int64_t i;
 
+    if (namesize < 0) {
+        ndt_err_format(ctx, NDT_ValueError, "invalid size of the field names");
+        return NULL;
+    }
+
     size = types_offset = MULi64(shape, sizeof(char *), &overflow);
 
     offset_offset = ADDi64(types_offset, size, &overflow);
@@ -1070,7 +1526,8 @@ ndt_record_new(enum ndt_variadic flag, int64_t shape, bool opt, ndt_context_t *c
     size = MULi64(shape, sizeof(uint16_t), &overflow);
     pad_offset = ADDi64(align_offset, size, &overflow);
 
-    extra = ADDi64(pad_offset, size, &overflow);
+    names_offset = ADDi64(pad_offset, size, &overflow);
+    extra = ADDi64(names_offset, namesize, &overflow);
 
     if (overflow) {
         ndt_err_format(ctx, NDT_ValueError, "record size too large");
@@ -1101,6 +1558,27 @@ ndt_record_new(enum ndt_variadic flag, int64_t shape, bool opt, ndt_context_t *c
     return t;
 }
 
+/* Copy the name of field 'i' into the record.  The names are set in order. */
+void
+ndt_record_set_name(ndt_t *t, int64_t i, const char *name)
+{
+    size_t len = strlen(name);
+    char *s;
+
+    assert(t->tag == Record);
+    assert(0 <= i && i < t->Record.shape);
+
+    if (i == 0) {
+        s = (char *)(t->Concrete.Record.pad + t->Record.shape);
+    }
+    else {
+        s = t->Record.names[i-1] + strlen(t->Record.names[i-1]) + 1;
+    }
+
+    memcpy(s, name, len+1);
+    t->Record.names[i] = s;
+}
+
 ndt_t *
 ndt_union_new(int64_t ntags, bool opt, ndt_context_t *ctx)
 {
@@ -1166,19 +1644,19 @@ ndt_del(ndt_t *t)
         ndt_decref(t->VarDim.type);
         if (ndt_is_concrete(t)) {
             ndt_decref_offsets(t->Concrete.VarDim.offsets);
-            ndt_free(t->Concrete.VarDim.slices);
+            ndt_free_slices(t->Concrete.VarDim.slices);
         }
         goto free_type;
     }
 
     case SymbolicDim: {
-        ndt_free(t->SymbolicDim.name);
+        symbol_release(t->SymbolicDim.name);
         ndt_decref(t->SymbolicDim.type);
         goto free_type;
     }
 
     case EllipsisDim: {
-        ndt_free(t->EllipsisDim.name);
+        symbol_release(t->EllipsisDim.name);
         ndt_decref(t->EllipsisDim.type);
         goto free_type;
     }
@@ -1199,7 +1677,6 @@ ndt_del(ndt_t *t)
     case Record: {
         int64_t i;
         for (i = 0; i < t->Record.shape; i++) {
-            ndt_free(t->Record.names[i]);
             ndt_decref(t->Record.types[i]);
         }
         goto free_type;
@@ -1237,7 +1714,7 @@ ndt_del(ndt_t *t)
     }
 
     case Typevar: {
-        ndt_free(t->Typevar.name);
+        symbol_release(t->Typevar.name);
         goto free_type;
     }
 
@@ -1261,23 +1738,123 @@ ndt_del(ndt_t *t)
 
 
 free_type:
-    ndt_free(t);
+    ndt_free_class(NDT_ALLOC_NODE, t);
 }
 
-void
-ndt_incref(const ndt_t *t)
+/*
+ * Reference counts use relaxed increments: a new reference is always created
+ * from an existing one, so no ordering is required.  Decrements release all
+ * prior writes to the object, and the thread that drops the last reference
+ * acquires them before deleting it.  Objects that are owned by a single
+ * thread skip the atomic read-modify-write entirely.
+ */
+static inline void
+refcnt_incr(ATOMIC_INT64 *refcnt, bool owned)
 {
-    if (ndt_is_static(t)) {
-        return;
-    }
-
-    ndt_t *u = (ndt_t *)t;
 #ifdef _MSC_VER
-    (void)InterlockedIncrement64(&u->refcnt);
+    if (owned) {
+        ++*refcnt;
+    }
+    else {
+        (void)InterlockedIncrementNoFence64(refcnt);
+    }
 #else
-    ++u->refcnt;
-#endif
-}
+    if (owned) {
+        int64_t n = atomic_load_explicit(refcnt, memory_order_relaxed);
+        atomic_store_explicit(refcnt, n+1, memory_order_relaxed);
+    }
+    else {
+        (void)atomic_fetch_add_explicit(refcnt, 1, memory_order_relaxed);
+    }
+#endif
+}
+
+/* Return true if the last reference has been dropped. */
+static inline bool
+refcnt_decr(ATOMIC_INT64 *refcnt, bool owned)
+{
+#ifdef _MSC_VER
+    if (owned) {
+        return --*refcnt == 0;
+    }
+
+    return InterlockedDecrement64(refcnt) == 0;
+#else
+    if (owned) {
+        int64_t n = atomic_load_explicit(refcnt, memory_order_relaxed);
+        atomic_store_explicit(refcnt, n-1, memory_order_relaxed);
+        return n == 1;
+    }
+
+    if (atomic_fetch_sub_explicit(refcnt, 1, memory_order_release) == 1) {
+        atomic_thread_fence(memory_order_acquire);
+        return true;
+    }
+
+    return false;
+#endif
+}
+
+/*
+ * Take a new reference unless the last one has already been dropped.  Used
+ * for lookups in the intern tables, which do not own references.
+ */
+static inline bool
+refcnt_incr_live(ATOMIC_INT64 *refcnt, bool owned)
+{
+#ifdef _MSC_VER
+    int64_t n = *refcnt;
+
+    if (owned) {
+        if (n == 0) {
+            return false;
+        }
+        *refcnt = n+1;
+        return true;
+    }
+
+    while (n != 0) {
+        int64_t m = InterlockedCompareExchangeNoFence64(refcnt, n+1, n);
+        if (m == n) {
+            return true;
+        }
+        n = m;
+    }
+
+    return false;
+#else
+    int64_t n = atomic_load_explicit(refcnt, memory_order_relaxed);
+
+    if (owned) {
+        if (n == 0) {
+            return false;
+        }
+        atomic_store_explicit(refcnt, n+1, memory_order_relaxed);
+        return true;
+    }
+
+    while (n != 0) {
+        if (atomic_compare_exchange_weak_explicit(refcnt, &n, n+1,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+            return true;
+        }
+    }
+
+    return false;
+#endif
+}
+
+void
+ndt_incref(const ndt_t *t)
+{
+    if (ndt_is_static(t)) {
+        return;
+    }
+
+    ndt_t *u = (ndt_t *)t;
+    refcnt_incr(&u->refcnt, u->owned);
+}
 
 void
 ndt_decref(const ndt_t *t)
@@ -1287,15 +1864,25 @@ ndt_decref(const ndt_t *t)
     }
 
     ndt_t *u = (ndt_t *)t;
-#ifdef _MSC_VER
-    if (InterlockedDecrement64(&u->refcnt) == 0) {
+    if (refcnt_decr(&u->refcnt, u->owned)) {
         ndt_del(u);
     }
-#else
-    if (--u->refcnt == 0) {
-        ndt_del(u);
+}
+
+/*
+ * Select non-atomic reference counting for 't'.  While 'owned' is set, all
+ * references to 't' must be acquired and released by the calling thread.
+ * Before other threads share the type again, the owner resets the flag and
+ * publishes the type with the usual synchronization.
+ */
+void
+ndt_set_owned(const ndt_t *t, bool owned)
+{
+    if (ndt_is_static(t)) {
+        return;
     }
-#endif
+
+    ((ndt_t *)t)->owned = owned;
 }
 
 void
@@ -1306,54 +1893,368 @@ ndt_move(const ndt_t **dst, const ndt_t *src)
 }
 
 
+/******************************************************************************/
+/*                             Offsets interning                              */
+/******************************************************************************/
+
+/*
+ * Opt-in table of shared offset arrays.  The table does not own references:
+ * entries are removed when the last reference to an interned offsets struct
+ * is dropped.  The table shares the lock of the symbol table.  A lookup may
+ * race with the release of the last reference to a matching entry, so new
+ * references are only taken from entries that are still alive.
+ */
+
+typedef struct {
+    uint64_t hash;
+    const ndt_offsets_t *offsets;
+} intern_entry_t;
+
+static struct {
+    int64_t size;   /* power of two or 0 if disabled */
+    int64_t used;
+    intern_entry_t *entries;
+} offsets_table = {0, 0, NULL};
+
+#define INTERN_MINSIZE 64
+
+static uint64_t
+offsets_hash(const ndt_offsets_t *offsets)
+{
+    uint64_t h = 14695981039346656037ULL;
+
+    h ^= (uint32_t)offsets->n;
+    h *= 1099511628211ULL;
+
+    for (int32_t i = 0; i < offsets->n; i++) {
+        h ^= (uint32_t)offsets->v[i];
+        h *= 1099511628211ULL;
+    }
+
+    return h;
+}
+
+static bool
+offsets_content_equal(const ndt_offsets_t *x, const ndt_offsets_t *y)
+{
+    return x->n == y->n &&
+           memcmp(x->v, y->v, x->n * (sizeof *x->v)) == 0;
+}
+
+static int
+offsets_table_resize(int64_t size)
+{
+    intern_entry_t *entries;
+    int64_t mask = size-1;
+
+    entries = ndt_calloc(size, sizeof *entries);
+    if (entries == NULL) {
+        return -1;
+    }
+
+    for (int64_t i = 0; i < offsets_table.size; i++) {
+        const intern_entry_t *e = &offsets_table.entries[i];
+        if (e->offsets != NULL) {
+            int64_t k = (int64_t)(e->hash & (uint64_t)mask);
+            while (entries[k].offsets != NULL) {
+                k = (k+1) & mask;
+            }
+            entries[k] = *e;
+        }
+    }
+
+    ndt_free(offsets_table.entries);
+    offsets_table.entries = entries;
+    offsets_table.size = size;
+
+    return 0;
+}
+
+/* Return the slot of 'offsets' or -1.  Called with the lock held. */
+static int64_t
+offsets_table_find(const ndt_offsets_t *offsets)
+{
+    const intern_entry_t *entries = offsets_table.entries;
+    int64_t mask, i;
+
+    if (offsets_table.size == 0) {
+        return -1;
+    }
+
+    mask = offsets_table.size-1;
+    i = (int64_t)(offsets_hash(offsets) & (uint64_t)mask);
+    while (entries[i].offsets != offsets) {
+        if (entries[i].offsets == NULL) {
+            return -1;
+        }
+        i = (i+1) & mask;
+    }
+
+    return i;
+}
+
+/* Remove an offsets struct whose refcount has dropped to zero. */
+static void
+offsets_table_remove(const ndt_offsets_t *offsets)
+{
+    intern_entry_t *entries;
+    int64_t mask, i, j, k;
+
+    if (!intern_nonempty()) {
+        return;
+    }
+
+    intern_lock();
+    i = offsets_table_find(offsets);
+    if (i < 0) {
+        intern_unlock();
+        return; /* not interned */
+    }
+
+    mask = offsets_table.size-1;
+    entries = offsets_table.entries;
+
+    /* Backward shift deletion for linear probing. */
+    for (j = (i+1) & mask; entries[j].offsets != NULL; j = (j+1) & mask) {
+        k = (int64_t)(entries[j].hash & (uint64_t)mask);
+        if ((j > i && (k <= i || k > j)) || (j < i && (k <= i && k > j))) {
+            entries[i] = entries[j];
+            i = j;
+        }
+    }
+
+    entries[i].offsets = NULL;
+    entries[i].hash = 0;
+    offsets_table.used--;
+    intern_count(-1);
+    intern_unlock();
+}
+
+int
+ndt_offsets_intern_enable(ndt_context_t *ctx)
+{
+    int ret = 0;
+
+    intern_lock();
+    if (offsets_table.size == 0) {
+        ret = offsets_table_resize(INTERN_MINSIZE);
+    }
+    intern_unlock();
+
+    if (ret < 0) {
+        (void)ndt_memory_error(ctx);
+    }
+
+    return ret;
+}
+
+void
+ndt_offsets_intern_disable(void)
+{
+    intern_lock();
+    intern_count(-offsets_table.used);
+    ndt_free(offsets_table.entries);
+    offsets_table.entries = NULL;
+    offsets_table.size = 0;
+    offsets_table.used = 0;
+    intern_unlock();
+}
+
+int64_t
+ndt_offsets_intern_size(void)
+{
+    int64_t used;
+
+    intern_lock();
+    used = offsets_table.used;
+    intern_unlock();
+
+    return used;
+}
+
+/*
+ * Steal a reference to 'offsets' and return a new reference to the shared
+ * offsets struct with the same content.  If interning is disabled or the
+ * table cannot grow, 'offsets' is returned unchanged.  Offsets in owned mode
+ * are never shared.
+ */
 ndt_offsets_t *
-ndt_offsets_new(int32_t size, ndt_context_t  *ctx)
+ndt_offsets_intern(ndt_offsets_t *offsets)
+{
+    int64_t mask;
+    uint64_t hash;
+    int64_t i;
+
+    if (offsets == NULL || offsets->owned) {
+        return offsets;
+    }
+
+    intern_lock();
+    if (offsets_table.size == 0) {
+        intern_unlock();
+        return offsets;
+    }
+
+    if (3 * (offsets_table.used+1) > 2 * offsets_table.size) {
+        if (offsets_table_resize(2 * offsets_table.size) < 0) {
+            intern_unlock();
+            return offsets;
+        }
+    }
+
+    mask = offsets_table.size-1;
+    hash = offsets_hash(offsets);
+    i = (int64_t)(hash & (uint64_t)mask);
+
+    for (; offsets_table.entries[i].offsets != NULL; i = (i+1) & mask) {
+        const intern_entry_t *e = &offsets_table.entries[i];
+        ndt_offsets_t *shared = (ndt_offsets_t *)e->offsets;
+        if (shared == offsets) {
+            intern_unlock();
+            return offsets;
+        }
+        if (e->hash == hash && offsets_content_equal(shared, offsets) &&
+            refcnt_incr_live(&shared->refcnt, shared->owned)) {
+            intern_unlock();
+            ndt_decref_offsets(offsets);
+            return shared;
+        }
+    }
+
+    offsets_table.entries[i].hash = hash;
+    offsets_table.entries[i].offsets = offsets;
+    offsets_table.used++;
+    intern_count(1);
+    intern_unlock();
+
+    return offsets;
+}
+
+static void
+offsets_class_release(void *v)
+{
+    ndt_free_class(NDT_ALLOC_OFFSETS, v);
+}
+
+/* The array comes from the NDT_ALLOC_OFFSETS class and releases itself. */
+static ndt_offsets_t *
+offsets_new(int32_t size, bool zero, ndt_context_t *ctx)
 {
     ndt_offsets_t *offsets;
 
+    if (ndt_limit_offsets(ctx, size) < 0) {
+        return NULL;
+    }
+
     offsets = ndt_alloc(1, sizeof *offsets);
     if (offsets == NULL) {
         return ndt_memory_error(ctx);
     }
 
-    offsets->v = ndt_calloc(size, sizeof *offsets->v);
+    offsets->v = zero ? ndt_calloc_class(NDT_ALLOC_OFFSETS, size, sizeof *offsets->v)
+                      : ndt_alloc_class(NDT_ALLOC_OFFSETS, size, sizeof *offsets->v);
     if (offsets->v == NULL) {
         ndt_free(offsets);
         return ndt_memory_error(ctx);
     }
 
     offsets->refcnt = 1;
+    offsets->owned = false;
     offsets->n = size;
+    offsets->release = offsets_class_release;
+    offsets->owner = (void *)offsets->v;
 
     return offsets;
 }
- 
+
+ndt_offsets_t *
+ndt_offsets_new(int32_t size, ndt_context_t  *ctx)
+{
+    return offsets_new(size, true, ctx);
+}
+
+/* For producers that overwrite every element. */
+ndt_offsets_t *
+ndt_offsets_new_uninit(int32_t size, ndt_context_t  *ctx)
+{
+    return offsets_new(size, false, ctx);
+}
+
 ndt_offsets_t *
 ndt_offsets_from_ptr(int32_t *ptr, int32_t size, ndt_context_t  *ctx)
 {
     ndt_offsets_t *offsets;
 
+    if (ndt_limit_offsets(ctx, size) < 0) {
+        ndt_free(ptr);
+        return NULL;
+    }
+
     offsets = ndt_alloc(1, sizeof *offsets);
     if (offsets == NULL) {
         ndt_free(ptr);
         return ndt_memory_error(ctx);
     }
     offsets->refcnt = 1;
+    offsets->owned = false;
     offsets->n = size;
     offsets->v = ptr;
+    offsets->release = NULL;
+    offsets->owner = NULL;
 
-    return offsets;
+    return ndt_offsets_intern(offsets);
+}
+
+/*
+ * Borrow offsets that live in foreign memory (a NumPy or Arrow buffer, an
+ * mmap'd file, ...).  'release(owner)' is called once the offsets are no
+ * longer referenced.  Like ndt_offsets_from_ptr(), the function steals the
+ * owner: 'release' is also called if the function fails.  The offsets count
+ * against the limits of 'ctx'.
+ */
+ndt_offsets_t *
+ndt_offsets_from_external(const int32_t *ptr, int32_t size, void *owner,
+                          void (*release)(void *owner), ndt_context_t *ctx)
+{
+    ndt_offsets_t *offsets;
+
+    if (release == NULL) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "external offsets require a release function");
+        return NULL;
+    }
+
+    if (size < 0 || (ptr == NULL && size > 0)) {
+        ndt_err_format(ctx, NDT_ValueError, "invalid external offsets");
+        release(owner);
+        return NULL;
+    }
+
+    if (ndt_limit_offsets(ctx, size) < 0) {
+        release(owner);
+        return NULL;
+    }
+
+    offsets = ndt_alloc(1, sizeof *offsets);
+    if (offsets == NULL) {
+        release(owner);
+        return ndt_memory_error(ctx);
+    }
+    offsets->refcnt = 1;
+    offsets->owned = false;
+    offsets->n = size;
+    offsets->v = ptr;
+    offsets->release = release;
+    offsets->owner = owner;
+
+    return ndt_offsets_intern(offsets);
 }
- 
+
 void
 ndt_incref_offsets(const ndt_offsets_t *x)
 {
     ndt_offsets_t *offsets = (ndt_offsets_t *)x;
-#ifdef _MSC_VER
-    (void)InterlockedIncrement64(&offsets->refcnt);
-#else
-    ++offsets->refcnt;
-#endif
+    refcnt_incr(&offsets->refcnt, offsets->owned);
 }
 
 void
@@ -1365,17 +2266,40 @@ ndt_decref_offsets(const ndt_offsets_t *x)
         return;
     }
 
-#ifdef _MSC_VER
-    if (InterlockedDecrement64(&offsets->refcnt) == 0) {
-        ndt_free((void *)offsets->v);
+    if (refcnt_decr(&offsets->refcnt, offsets->owned)) {
+        offsets_table_remove(offsets);
+        if (offsets->release != NULL) {
+            offsets->release(offsets->owner);
+        }
+        else {
+            ndt_free((void *)offsets->v);
+        }
         ndt_free(offsets);
     }
-#else
-    if (--offsets->refcnt == 0) {
-        ndt_free((void *)offsets->v);
-        ndt_free(offsets);
+}
+
+/*
+ * Select non-atomic reference counting for 'x', see ndt_set_owned().  Interned
+ * offsets may be shared with other threads and keep atomic reference counts.
+ */
+void
+ndt_set_owned_offsets(const ndt_offsets_t *x, bool owned)
+{
+    bool interned = false;
+
+    if (x == NULL) {
+        return;
+    }
+
+    if (owned && intern_nonempty()) {
+        intern_lock();
+        interned = offsets_table_find(x) >= 0;
+        intern_unlock();
+    }
+
+    if (!interned) {
+        ((ndt_offsets_t *)x)->owned = owned;
     }
-#endif
 }
 
 
@@ -1547,71 +2471,243 @@ ndt_to_fortran(const ndt_t *t, ndt_context_t *ctx)
     return _ndt_to_fortran(t, 1, ctx);
 }
 
+/* Cached number of elements of a fixed dimension, -1 if unknown. */
+int64_t
+ndt_fixed_dim_nelem(const ndt_t *type, int64_t shape)
+{
+    bool overflow = 0;
+    int64_t n;
+
+    n = ndt_nelem(type);
+    if (n < 0) {
+        return -1;
+    }
+
+    n = MULi64(shape, n, &overflow);
+    return overflow ? -1 : n;
+}
+
 const ndt_t *
 ndt_fixed_dim(const ndt_t *type, int64_t shape, int64_t step, ndt_context_t *ctx)
 {
     ndt_t *t;
     bool overflow = 0;
 
-    if (!check_fixed_invariants(type, ctx)) {
-        return NULL;
-    }
-
-    if (shape < 0) {
-        ndt_err_format(ctx, NDT_ValueError, "shape must be a natural number");
+    if (!check_fixed_invariants(type, ctx)) {
+        return NULL;
+    }
+
+    if (shape < 0) {
+        ndt_err_format(ctx, NDT_ValueError, "shape must be a natural number");
+        return NULL;
+    }
+
+    /* abstract type */
+    t = ndt_new(FixedDim, 0, ctx);
+    if (t == NULL) {
+        return NULL;
+    }
+    t->FixedDim.tag = RequireNA;
+    t->FixedDim.shape = shape;
+
+    ndt_incref(type);
+    t->FixedDim.type = type;
+
+    t->ndim = type->ndim + 1;
+    t->flags |= ndt_dim_flags(type);
+
+    t->Concrete.FixedDim.itemsize = 0;
+    t->Concrete.FixedDim.step = INT64_MAX;
+    t->Concrete.FixedDim.tile = 0;
+    t->Concrete.FixedDim.tile_step = 0;
+    t->Concrete.FixedDim.nelem = -1;
+
+    /* concrete access */
+    t->access = type->access;
+    if (t->access == Concrete) {
+        int64_t itemsize = ndt_itemsize(type);
+        step = fixed_step(type, step, &overflow);
+
+        t->Concrete.FixedDim.itemsize = itemsize;
+        t->Concrete.FixedDim.step = step;
+        t->Concrete.FixedDim.nelem = ndt_fixed_dim_nelem(type, shape);
+        t->datasize = fixed_datasize(type, shape, step, itemsize, &overflow);
+        t->align = type->align;
+    }
+
+    if (overflow) {
+        ndt_err_format(ctx, NDT_ValueError, "data size too large");
+        ndt_decref(t);
+        return NULL;
+    }
+
+    return t;
+}
+
+const ndt_t *
+ndt_fixed_dim_tag(const ndt_t *type, enum ndt_contig tag, int64_t shape, int64_t step,
+                  ndt_context_t *ctx)
+{
+    ndt_t *t = (ndt_t *)ndt_fixed_dim(type, shape, step, ctx);
+    if (t == NULL) {
+        return NULL;
+    }
+    t->FixedDim.tag = tag;
+
+    if (tag != RequireNA) {
+        t->access = Abstract;
+    }
+
+    return t;
+}
+
+/*
+ * Tiled fixed dimension: the logical shape is 'shape', the index 'i' is
+ * stored at the element offset (i / tile) * tile_step + (i % tile) * step.
+ * Matching and broadcasting only see the logical shape, kernels that are
+ * not tile aware see a non-ndarray type.  Tiles may not overlap, so
+ * 'tile_step' must be at least 'tile * step' if there is more than one tile.
+ */
+const ndt_t *
+ndt_fixed_dim_tiled(const ndt_t *type, int64_t shape, int64_t step,
+                    int64_t tile, int64_t tile_step, ndt_context_t *ctx)
+{
+    bool overflow = 0;
+    int64_t index_range;
+    ndt_t *t;
+
+    if (tile == 0) {
+        return ndt_fixed_dim(type, shape, step, ctx);
+    }
+
+    if (ndt_is_abstract(type)) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "tiled dimensions require a concrete element type");
+        return NULL;
+    }
+
+    if (tile < 0 || shape < 0 || shape % tile != 0) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "tile extent must be a positive divisor of the shape");
+        return NULL;
+    }
+
+    if (step < 0 || step == INT64_MAX || tile_step < 0) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "tiled dimensions require explicit non-negative steps");
+        return NULL;
+    }
+
+    /* Distinct tiles must not overlap. */
+    if (shape/tile > 1 && tile_step < MULi64(tile, step, &overflow)) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "tile step must be at least tile * step");
+        return NULL;
+    }
+
+    t = (ndt_t *)ndt_fixed_dim(type, shape, step, ctx);
+    if (t == NULL) {
+        return NULL;
+    }
+
+    t->Concrete.FixedDim.tile = tile;
+    t->Concrete.FixedDim.tile_step = tile_step;
+    t->flags |= NDT_TILED;
+
+    if (shape == 0 || type->datasize == 0) {
+        t->datasize = 0;
+    }
+    else {
+        index_range = MULi64(shape/tile-1, tile_step, &overflow);
+        index_range = ADDi64(index_range, MULi64(tile-1, step, &overflow), &overflow);
+        t->datasize = MULi64(index_range, t->Concrete.FixedDim.itemsize, &overflow);
+        t->datasize = ADDi64(t->datasize, type->datasize, &overflow);
+    }
+
+    if (overflow) {
+        ndt_err_format(ctx, NDT_ValueError, "data size too large");
+        ndt_decref(t);
+        return NULL;
+    }
+
+    return t;
+}
+
+/*
+ * Convert the C-contiguous array 't' to a blocked layout.  The inner 'ntiles'
+ * dimensions are split into tiles of the extents given in 'tiles'.  Tiles
+ * are stored in row-major order and are themselves row-major.
+ */
+const ndt_t *
+ndt_tiled(const ndt_t *type, const int64_t *tiles, int ntiles, ndt_context_t *ctx)
+{
+    const ndt_t *dims[NDT_MAX_DIM];
+    int64_t step[NDT_MAX_DIM];
+    int64_t tile_step[NDT_MAX_DIM];
+    const ndt_t *dtype;
+    const ndt_t *t, *u;
+    bool overflow = 0;
+    int64_t block, ntile_step;
+    int ndim, i, k;
+
+    if (!ndt_is_c_contiguous(type) || type->ndim == 0) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "tiling requires a C-contiguous array with at least one dimension");
         return NULL;
     }
 
-    /* abstract type */
-    t = ndt_new(FixedDim, 0, ctx);
-    if (t == NULL) {
+    if (ntiles < 1 || ntiles > type->ndim) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "number of tiled dimensions must be in [1, %d]", type->ndim);
         return NULL;
     }
-    t->FixedDim.tag = RequireNA;
-    t->FixedDim.shape = shape;
-
-    ndt_incref(type);
-    t->FixedDim.type = type;
 
-    t->ndim = type->ndim + 1;
-    t->flags |= ndt_dim_flags(type);
+    ndim = ndt_dims_dtype(dims, &dtype, type);
 
-    t->Concrete.FixedDim.itemsize = 0;
-    t->Concrete.FixedDim.step = INT64_MAX;
+    for (k = 0; k < ntiles; k++) {
+        i = ndim-ntiles+k;
+        if (tiles[k] <= 0 || dims[i]->FixedDim.shape % tiles[k] != 0) {
+            ndt_err_format(ctx, NDT_ValueError,
+                "tile extent must be a positive divisor of the shape");
+            return NULL;
+        }
+    }
 
-    /* concrete access */
-    t->access = type->access;
-    if (t->access == Concrete) {
-        int64_t itemsize = ndt_itemsize(type);
-        step = fixed_step(type, step, &overflow);
+    /* element steps within a tile */
+    block = 1;
+    for (k = ntiles-1; k >= 0; k--) {
+        step[k] = block;
+        block = MULi64(block, tiles[k], &overflow);
+    }
 
-        t->Concrete.FixedDim.itemsize = itemsize;
-        t->Concrete.FixedDim.step = step;
-        t->datasize = fixed_datasize(type, shape, step, itemsize, &overflow);
-        t->align = type->align;
+    /* element steps between tiles */
+    ntile_step = block;
+    for (k = ntiles-1; k >= 0; k--) {
+        i = ndim-ntiles+k;
+        tile_step[k] = ntile_step;
+        ntile_step = MULi64(ntile_step, dims[i]->FixedDim.shape/tiles[k], &overflow);
     }
 
     if (overflow) {
         ndt_err_format(ctx, NDT_ValueError, "data size too large");
-        ndt_decref(t);
         return NULL;
     }
 
-    return t;
-}
-
-const ndt_t *
-ndt_fixed_dim_tag(const ndt_t *type, enum ndt_contig tag, int64_t shape, int64_t step,
-                  ndt_context_t *ctx)
-{
-    ndt_t *t = (ndt_t *)ndt_fixed_dim(type, shape, step, ctx);
-    if (t == NULL) {
-        return NULL;
-    }
-    t->FixedDim.tag = tag;
+    t = dtype;
+    ndt_incref(t);
 
-    if (tag != RequireNA) {
-        t->access = Abstract;
+    for (i = ndim-1, k = ntiles-1; i >= 0; i--, k--) {
+        if (k >= 0) {
+            u = ndt_fixed_dim_tiled(t, dims[i]->FixedDim.shape, step[k],
+                                    tiles[k], tile_step[k], ctx);
+        }
+        else {
+            u = ndt_fixed_dim(t, dims[i]->FixedDim.shape, INT64_MAX, ctx);
+        }
+        ndt_move(&t, u);
+        if (t == NULL) {
+            return NULL;
+        }
     }
 
     return t;
@@ -1643,6 +2739,8 @@ ndt_abstract_var_dim(const ndt_t *type, bool opt, ndt_context_t *ctx)
     t->Concrete.VarDim.offsets = NULL;
     t->Concrete.VarDim.nslices = 0;
     t->Concrete.VarDim.slices = NULL;
+    t->Concrete.VarDim.nelem = -1;
+    t->Concrete.VarDim.total = -1;
 
     return t;
 }
@@ -1760,7 +2858,7 @@ ndt_var_add_slice(int32_t *nslices, const ndt_t *t,
         return NULL;
     }
 
-    slices = ndt_alloc(n+1, sizeof *slices);
+    slices = ndt_alloc_slices(n+1);
     if (slices == NULL) {
         return ndt_memory_error(ctx);
     }
@@ -1775,11 +2873,46 @@ ndt_var_add_slice(int32_t *nslices, const ndt_t *t,
     return slices;
 }
 
-const ndt_t *
-ndt_var_dim(const ndt_t *type,
-            const ndt_offsets_t *offsets,
-            int32_t nslices, ndt_slice_t *slices,
-            bool opt, ndt_context_t *ctx)
+/* Cached number of dtype elements of a var dimension, -1 if sliced. */
+int64_t
+ndt_var_dim_nelem(const ndt_t *type, const ndt_offsets_t *offsets, int32_t nslices)
+{
+    if (offsets == NULL || nslices != 0 || offsets->v[0] != 0) {
+        return -1;
+    }
+
+    switch (type->tag) {
+    case VarDim:
+        return type->Concrete.VarDim.nelem;
+    case VarDimElem:
+        return -1;
+    default:
+        return offsets->v[offsets->n-1];
+    }
+}
+
+/* Final offset of the innermost var dimension. */
+int64_t
+ndt_var_dim_total(const ndt_t *type, const ndt_offsets_t *offsets)
+{
+    if (offsets == NULL) {
+        return -1;
+    }
+
+    switch (type->tag) {
+    case VarDim: case VarDimElem:
+        return type->Concrete.VarDim.total;
+    default:
+        return offsets->v[offsets->n-1];
+    }
+}
+
+static const ndt_t *
+_ndt_var_dim(const ndt_t *type,
+             const ndt_offsets_t *offsets,
+             int32_t nslices, ndt_slice_t *slices,
+             enum ndt tag, int64_t index,
+             bool opt, ndt_context_t *ctx)
 {
     bool overflow = 0;
     ndt_t *t;
@@ -1826,7 +2959,7 @@ ndt_var_dim(const ndt_t *type,
     }
 
     /* abstract type */
-    t = ndt_new(VarDim, opt, ctx);
+    t = ndt_new(tag, opt, ctx);
     if (t == NULL) {
         goto error;
     }
@@ -1834,6 +2967,9 @@ ndt_var_dim(const ndt_t *type,
     ndt_incref_offsets(offsets);
 
     t->VarDim.type = type;
+    if (tag == VarDimElem) {
+        t->VarDimElem.index = index;
+    }
     t->ndim = type->ndim+1;
     t->flags |= ndt_dim_flags(type);
 
@@ -1845,15 +2981,37 @@ ndt_var_dim(const ndt_t *type,
     t->Concrete.VarDim.offsets = offsets;
     t->Concrete.VarDim.nslices = nslices;
     t->Concrete.VarDim.slices = slices;
+    t->Concrete.VarDim.nelem = ndt_var_dim_nelem(type, offsets, nslices);
+    t->Concrete.VarDim.total = ndt_var_dim_total(type, offsets);
 
     return t;
 
 
 error:
-    ndt_free(slices);
+    ndt_free_slices(slices);
     return NULL;
 }
 
+const ndt_t *
+ndt_var_dim(const ndt_t *type,
+            const ndt_offsets_t *offsets,
+            int32_t nslices, ndt_slice_t *slices,
+            bool opt, ndt_context_t *ctx)
+{
+    return _ndt_var_dim(type, offsets, nslices, slices, VarDim, 0, opt, ctx);
+}
+
+/* Like ndt_var_dim(), but the dimension is indexed with 'index'. */
+const ndt_t *
+ndt_var_dim_elem(const ndt_t *type,
+                 const ndt_offsets_t *offsets,
+                 int32_t nslices, ndt_slice_t *slices,
+                 int64_t index, ndt_context_t *ctx)
+{
+    return _ndt_var_dim(type, offsets, nslices, slices, VarDimElem, index,
+                        false, ctx);
+}
+
 const ndt_t *
 ndt_symbolic_dim(char *name, const ndt_t *type, ndt_context_t *ctx)
 {
@@ -1871,7 +3029,7 @@ ndt_symbolic_dim(char *name, const ndt_t *type, ndt_context_t *ctx)
         return NULL;
     }
     t->SymbolicDim.tag = RequireNA;
-    t->SymbolicDim.name = name;
+    t->SymbolicDim.name = ndt_symbol_intern(name);
 
     ndt_incref(type);
     t->SymbolicDim.type = type;
@@ -1919,7 +3077,7 @@ ndt_ellipsis_dim(char *name, const ndt_t *type, ndt_context_t *ctx)
         return NULL;
     }
     t->EllipsisDim.tag = RequireNA;
-    t->EllipsisDim.name = name;
+    t->EllipsisDim.name = ndt_symbol_intern(name);
 
     ndt_incref(type);
     t->EllipsisDim.type = type;
@@ -2106,7 +3264,7 @@ ndt_tuple(enum ndt_variadic flag, const ndt_field_t *fields, int64_t shape,
                 fields[i].Concrete.explicit_align) {
                 ndt_err_format(ctx, NDT_InvalidArgumentError,
                                "explicit field alignment in abstract tuple");
-                ndt_free(t);
+                ndt_free_class(NDT_ALLOC_NODE, t);
                 return NULL;
             }
         }
@@ -2124,7 +3282,7 @@ ndt_tuple(enum ndt_variadic flag, const ndt_field_t *fields, int64_t shape,
                                  t->Concrete.Tuple.align,
                                  t->Concrete.Tuple.pad,
                                  fields, shape, align, pack, ctx) < 0) {
-            ndt_free(t);
+            ndt_free_class(NDT_ALLOC_NODE, t);
             return NULL;
         }
         for (i = 0; i < shape; i++) {
@@ -2142,6 +3300,7 @@ ndt_record(enum ndt_variadic flag, const ndt_field_t *fields, int64_t shape,
            uint16_opt_t align, uint16_opt_t pack, bool opt, ndt_context_t *ctx)
 {
     ndt_t *t;
+    int64_t namesize = 0;
     int64_t i;
 
     assert((fields == NULL) == (shape == 0));
@@ -2152,8 +3311,12 @@ ndt_record(enum ndt_variadic flag, const ndt_field_t *fields, int64_t shape,
         }
     }
 
+    for (i = 0; i < shape; i++) {
+        namesize += (int64_t)strlen(fields[i].name) + 1;
+    }
+
     /* abstract type */
-    t = ndt_record_new(flag, shape, opt, ctx);
+    t = ndt_record_new(flag, shape, namesize, opt, ctx);
     if (t == NULL) {
         return NULL;
     }
@@ -2173,17 +3336,12 @@ ndt_record(enum ndt_variadic flag, const ndt_field_t *fields, int64_t shape,
                 fields[i].Concrete.explicit_align) {
                 ndt_err_format(ctx, NDT_InvalidArgumentError,
                                "explicit field alignment in abstract tuple");
-                ndt_free(t);
+                ndt_free_class(NDT_ALLOC_NODE, t);
                 return NULL;
             }
         }
         for (i = 0; i < shape; i++) {
-            char *s = ndt_strdup(fields[i].name, ctx);
-            if (s == NULL) {
-                ndt_decref(t);
-                return NULL;
-            }
-            t->Record.names[i] = s;
+            ndt_record_set_name(t, i, fields[i].name);
 
             ndt_incref(fields[i].type);
             t->Record.types[i] = fields[i].type;
@@ -2198,16 +3356,11 @@ ndt_record(enum ndt_variadic flag, const ndt_field_t *fields, int64_t shape,
                                  t->Concrete.Record.align,
                                  t->Concrete.Record.pad,
                                  fields, shape, align, pack, ctx) < 0) {
-            ndt_free(t);
+            ndt_free_class(NDT_ALLOC_NODE, t);
             return NULL;
         }
         for (i = 0; i < shape; i++) {
-            char *s = ndt_strdup(fields[i].name, ctx);
-            if (s == NULL) {
-                ndt_decref(t);
-                return NULL;
-            }
-            t->Record.names[i] = s;
+            ndt_record_set_name(t, i, fields[i].name);
 
             ndt_incref(fields[i].type);
             t->Record.types[i] = fields[i].type;
@@ -2262,7 +3415,7 @@ ndt_union(const ndt_field_t *fields, int64_t ntags, bool opt,
                 fields[i].Concrete.explicit_align) {
                 ndt_err_format(ctx, NDT_InvalidArgumentError,
                                "explicit field alignment in abstract tuple");
-                ndt_free(t);
+                ndt_free_class(NDT_ALLOC_NODE, t);
                 return NULL;
             }
         }
@@ -2283,7 +3436,7 @@ ndt_union(const ndt_field_t *fields, int64_t ntags, bool opt,
     }
     else {
         if (init_concrete_tags(t, fields, ntags, ctx) < 0) {
-            ndt_free(t);
+            ndt_free_class(NDT_ALLOC_NODE, t);
             return NULL;
         }
 
@@ -2304,6 +3457,311 @@ ndt_union(const ndt_field_t *fields, int64_t ntags, bool opt,
     }
 }
 
+
+/******************************************************************************/
+/*                          Tuple and record projection                       */
+/******************************************************************************/
+
+/* Layout-preserving projection: offsets, datasize and align of the parent. */
+static const ndt_t *
+project_view(const ndt_t *t, const bool *select, int64_t shape,
+             ndt_context_t *ctx)
+{
+    const bool opt = ndt_is_optional(t);
+    const bool is_record = t->tag == Record;
+    const ndt_t * const *types = is_record ? t->Record.types : t->Tuple.types;
+    const int64_t *offsets = is_record ? t->Concrete.Record.offset : t->Concrete.Tuple.offset;
+    const uint16_t *align = is_record ? t->Concrete.Record.align : t->Concrete.Tuple.align;
+    int64_t *u_offsets;
+    uint16_t *u_align, *u_pad;
+    int64_t namesize = 0;
+    ndt_t *u;
+    int64_t i, k;
+
+    if (is_record) {
+        for (i = 0; i < t->Record.shape; i++) {
+            if (select[i]) {
+                namesize += (int64_t)strlen(t->Record.names[i]) + 1;
+            }
+        }
+    }
+
+    u = is_record ? ndt_record_new(Nonvariadic, shape, namesize, opt, ctx)
+                  : ndt_tuple_new(Nonvariadic, shape, opt, ctx);
+    if (u == NULL) {
+        return NULL;
+    }
+
+    u_offsets = is_record ? u->Concrete.Record.offset : u->Concrete.Tuple.offset;
+    u_align = is_record ? u->Concrete.Record.align : u->Concrete.Tuple.align;
+    u_pad = is_record ? u->Concrete.Record.pad : u->Concrete.Tuple.pad;
+
+    u->access = Concrete;
+    u->datasize = t->datasize;
+    u->align = t->align;
+
+    for (i = 0, k = 0; k < shape; i++) {
+        if (!select[i]) {
+            continue;
+        }
+
+        if (is_record) {
+            ndt_record_set_name(u, k, t->Record.names[i]);
+        }
+
+        ndt_incref(types[i]);
+        if (is_record) {
+            u->Record.types[k] = types[i];
+        }
+        else {
+            u->Tuple.types[k] = types[i];
+        }
+        u->flags |= ndt_subtree_flags(types[i]);
+
+        u_offsets[k] = offsets[i];
+        u_align[k] = align[i];
+        k++;
+    }
+
+    /* The gap between a field and its successor (or the end) is padding. */
+    for (k = 0; k < shape; k++) {
+        const ndt_t *type = is_record ? u->Record.types[k] : u->Tuple.types[k];
+        int64_t next = k+1 < shape ? u_offsets[k+1] : u->datasize;
+        int64_t gap = next - (u_offsets[k] + type->datasize);
+
+        if (gap > UINT16_MAX) {
+            ndt_err_format(ctx, NDT_ValueError,
+                "projection: gap after field %" PRIi64 " exceeds the maximum "
+                "padding", k);
+            ndt_decref(u);
+            return NULL;
+        }
+        u_pad[k] = (uint16_t)gap;
+    }
+
+    return u;
+}
+
+/* Packed projection: natural layout with the field alignments of the parent. */
+static const ndt_t *
+project_packed(const ndt_t *t, const bool *select, int64_t shape,
+               ndt_context_t *ctx)
+{
+    const uint16_opt_t none = {None, 0};
+    const bool is_record = t->tag == Record;
+    const ndt_t * const *types = is_record ? t->Record.types : t->Tuple.types;
+    const uint16_t *align = is_record ? t->Concrete.Record.align : t->Concrete.Tuple.align;
+    ndt_field_t *fields = NULL;
+    const ndt_t *u;
+    int64_t i, k;
+
+    if (shape > 0) {
+        fields = ndt_calloc(shape, sizeof *fields);
+        if (fields == NULL) {
+            return ndt_memory_error(ctx);
+        }
+    }
+
+    for (i = 0, k = 0; k < shape; i++) {
+        if (!select[i]) {
+            continue;
+        }
+
+        /* The names are borrowed: ndt_record() copies them. */
+        fields[k].name = is_record ? t->Record.names[i] : NULL;
+        fields[k].type = types[i];
+        fields[k].access = Concrete;
+        fields[k].Concrete.align = align[i];
+        fields[k].Concrete.explicit_align = true;
+        fields[k].Concrete.pad = UINT16_MAX;
+        fields[k].Concrete.explicit_pad = false;
+        k++;
+    }
+
+    if (is_record) {
+        u = ndt_record(Nonvariadic, fields, shape, none, none,
+                       ndt_is_optional(t), ctx);
+    }
+    else {
+        u = ndt_tuple(Nonvariadic, fields, shape, none, none,
+                      ndt_is_optional(t), ctx);
+    }
+
+    ndt_free(fields);
+    return u;
+}
+
+static const ndt_t *
+project(const ndt_t *t, const bool *select, int64_t shape,
+        enum ndt_project mode, ndt_context_t *ctx)
+{
+    const ndt_t *type;
+    const ndt_t *u;
+
+    switch (t->tag) {
+    case FixedDim: {
+        type = project(t->FixedDim.type, select, shape, mode, ctx);
+        if (type == NULL) {
+            return NULL;
+        }
+
+        if (mode == ProjectView && t->Concrete.FixedDim.tile != 0) {
+            u = ndt_fixed_dim_tiled(type, t->FixedDim.shape,
+                                    t->Concrete.FixedDim.step,
+                                    t->Concrete.FixedDim.tile,
+                                    t->Concrete.FixedDim.tile_step, ctx);
+        }
+        else {
+            u = ndt_fixed_dim_tag(type, t->FixedDim.tag, t->FixedDim.shape,
+                                  mode == ProjectView ? t->Concrete.FixedDim.step
+                                                      : INT64_MAX,
+                                  ctx);
+        }
+        ndt_decref(type);
+        return u;
+    }
+
+    case VarDim: case VarDimElem: {
+        int32_t nslices = t->Concrete.VarDim.nslices;
+        ndt_slice_t *slices = NULL;
+
+        type = project(t->VarDim.type, select, shape, mode, ctx);
+        if (type == NULL) {
+            return NULL;
+        }
+
+        if (nslices > 0) {
+            slices = ndt_alloc_slices(nslices);
+            if (slices == NULL) {
+                ndt_decref(type);
+                return ndt_memory_error(ctx);
+            }
+            memcpy(slices, t->Concrete.VarDim.slices, nslices * (sizeof *slices));
+        }
+
+        if (t->tag == VarDimElem) {
+            u = ndt_var_dim_elem(type, t->Concrete.VarDim.offsets, nslices,
+                                 slices, t->VarDimElem.index, ctx);
+        }
+        else {
+            u = ndt_var_dim(type, t->Concrete.VarDim.offsets, nslices, slices,
+                            ndt_is_optional(t), ctx);
+        }
+        ndt_decref(type);
+        return u;
+    }
+
+    case Tuple: case Record:
+        if (mode == ProjectView) {
+            return project_view(t, select, shape, ctx);
+        }
+        return project_packed(t, select, shape, ctx);
+
+    default:
+        ndt_err_format(ctx, NDT_TypeError,
+            "projection requires a tuple or record dtype");
+        return NULL;
+    }
+}
+
+/*
+ * Return a tuple or record type that contains the fields of the dtype of 't'
+ * selected by 'indices'.  The fields keep the order of the parent type.
+ *
+ * ProjectView: the result keeps the field offsets, the datasize and the
+ *   alignment of the parent, so that the parent's data can be accessed
+ *   through the result without copying.
+ *
+ * ProjectPacked: the result is laid out from scratch using the field
+ *   alignments of the parent; fixed dimensions become contiguous.
+ */
+const ndt_t *
+ndt_record_project_index(const ndt_t *t, const int64_t *indices, int64_t n,
+                         enum ndt_project mode, ndt_context_t *ctx)
+{
+    const ndt_t *dtype;
+    int64_t shape;
+    bool *select;
+    const ndt_t *u;
+
+    if (ndt_is_abstract(t)) {
+        ndt_err_format(ctx, NDT_ValueError, "projection requires a concrete type");
+        return NULL;
+    }
+
+    dtype = ndt_dtype(t);
+    if (dtype->tag != Tuple && dtype->tag != Record) {
+        ndt_err_format(ctx, NDT_TypeError,
+            "projection requires a tuple or record dtype");
+        return NULL;
+    }
+    shape = dtype->tag == Record ? dtype->Record.shape : dtype->Tuple.shape;
+
+    select = ndt_calloc(shape == 0 ? 1 : shape, sizeof *select);
+    if (select == NULL) {
+        return ndt_memory_error(ctx);
+    }
+
+    for (int64_t i = 0; i < n; i++) {
+        if (indices[i] < 0 || indices[i] >= shape) {
+            ndt_err_format(ctx, NDT_IndexError,
+                "projection: field index %" PRIi64 " out of range", indices[i]);
+            ndt_free(select);
+            return NULL;
+        }
+        if (select[indices[i]]) {
+            ndt_err_format(ctx, NDT_ValueError,
+                "projection: duplicate field index %" PRIi64, indices[i]);
+            ndt_free(select);
+            return NULL;
+        }
+        select[indices[i]] = true;
+    }
+
+    u = project(t, select, n, mode, ctx);
+    ndt_free(select);
+    return u;
+}
+
+const ndt_t *
+ndt_record_project(const ndt_t *t, const char * const names[], int64_t n,
+                   enum ndt_project mode, ndt_context_t *ctx)
+{
+    const ndt_t *dtype = ndt_dtype(t);
+    int64_t *indices;
+    const ndt_t *u;
+
+    if (dtype->tag != Record) {
+        ndt_err_format(ctx, NDT_TypeError, "projection by name requires a record dtype");
+        return NULL;
+    }
+
+    indices = ndt_alloc(n == 0 ? 1 : n, sizeof *indices);
+    if (indices == NULL) {
+        return ndt_memory_error(ctx);
+    }
+
+    for (int64_t i = 0; i < n; i++) {
+        int64_t k;
+        for (k = 0; k < dtype->Record.shape; k++) {
+            if (strcmp(names[i], dtype->Record.names[k]) == 0) {
+                break;
+            }
+        }
+        if (k == dtype->Record.shape) {
+            ndt_err_format(ctx, NDT_ValueError,
+                "projection: record has no field '%s'", names[i]);
+            ndt_free(indices);
+            return NULL;
+        }
+        indices[i] = k;
+    }
+
+    u = ndt_record_project_index(t, indices, n, mode, ctx);
+    ndt_free(indices);
+    return u;
+}
+
 const ndt_t *
 ndt_array(const ndt_t *type, bool opt, ndt_context_t *ctx)
 {
@@ -2682,7 +4140,7 @@ ndt_typevar(char *name, ndt_context_t *ctx)
         ndt_free(name);
         return NULL;
     }
-    t->Typevar.name = name;
+    t->Typevar.name = ndt_symbol_intern(name);
 
     return t;
 }
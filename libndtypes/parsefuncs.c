@@ -41,6 +41,21 @@
 #include "attr.h"
 
 
+/*****************************************************************************/
+/*                               Nesting depth                               */
+/*****************************************************************************/
+
+/*
+ * The lexer enters a nesting level for the '*' of a dimension and for the
+ * '&' or 'ref' of a reference.  The constructors of these types leave it.
+ */
+static inline void
+leave_nested(ndt_context_t *ctx)
+{
+    (void)ndt_limit_depth(ctx, -1);
+}
+
+
 /*****************************************************************************/
 /*                        Functions used in the lexer                        */
 /*****************************************************************************/
@@ -49,7 +64,7 @@ char *
 mk_stringlit(const char *lexeme, ndt_context_t *ctx)
 {
     size_t len;
-    char *s, *result;
+    char *result;
 
     len = strlen(lexeme);
     if (len < 2) {
@@ -57,15 +72,24 @@ mk_stringlit(const char *lexeme, ndt_context_t *ctx)
         return NULL;
     }
 
-    s = ndt_strdup(lexeme, ctx);
-    if (s == NULL) {
+    /* The limit applies to the contents without the quotes. */
+    if (ndt_limit_string(ctx, (int64_t)len-2) < 0) {
         return NULL;
     }
 
-    s[len-1] = '\0';
-    result = ndt_asprintf(ctx, "%s", s+1);
+    result = ndt_alloc_size(len-1);
+    if (result == NULL) {
+        return ndt_memory_error(ctx);
+    }
+
+    memcpy(result, lexeme+1, len-2);
+    result[len-2] = '\0';
+
+    if (ndt_utf8_check(result, -1, ctx) < 0) {
+        ndt_free(result);
+        return NULL;
+    }
 
-    ndt_free(s);
     return result;
 }
 
@@ -83,13 +107,12 @@ encoding_from_string(char *s, ndt_context_t *ctx)
 }
 
 ndt_attr_t *
-mk_attr(char *name, char *value, ndt_context_t *ctx)
+mk_attr(const char *name, char *value, ndt_context_t *ctx)
 {
     ndt_attr_t *attr;
 
     attr = ndt_alloc_size(sizeof *attr);
     if (attr == NULL) {
-        ndt_free(name);
         ndt_free(value);
         return ndt_memory_error(ctx);
     }
@@ -102,23 +125,31 @@ mk_attr(char *name, char *value, ndt_context_t *ctx)
 }
 
 ndt_attr_t *
-mk_attr_from_seq(char *name, ndt_string_seq_t *seq, ndt_context_t *ctx)
+mk_attr_from_seq(const char *name, ndt_string_seq_t *seq, ndt_context_t *ctx)
 {
     ndt_attr_t *attr;
+    char **items;
 
     attr = ndt_alloc_size(sizeof *attr);
     if (attr == NULL) {
-        ndt_free(name);
         ndt_string_seq_del(seq);
         return ndt_memory_error(ctx);
     }
 
+    /* The sequence lives in the scratch space. */
+    items = ndt_alloc(seq->len, sizeof *items);
+    if (items == NULL) {
+        ndt_free(attr);
+        ndt_string_seq_del(seq);
+        return ndt_memory_error(ctx);
+    }
+    memcpy(items, seq->ptr, seq->len * sizeof *items);
+
     attr->tag = AttrList;
     attr->name = name;
     attr->AttrList.len = seq->len;
-    attr->AttrList.items = seq->ptr;
-
-    ndt_free(seq);
+    attr->AttrList.items = items;
+    seq->len = 0;
 
     return attr;
 }
@@ -134,9 +165,18 @@ mk_attr_from_seq(char *name, ndt_string_seq_t *seq, ndt_context_t *ctx)
  */
 
 const ndt_t *
-mk_module(char *name, const ndt_t *type, ndt_context_t *ctx)
+mk_module(const char *name, const ndt_t *type, ndt_context_t *ctx)
 {
-    const ndt_t *t = ndt_module(name, type, ctx);
+    const ndt_t *t;
+    char *s;
+
+    s = ndt_strdup(name, ctx);
+    if (s == NULL) {
+        ndt_decref(type);
+        return NULL;
+    }
+
+    t = ndt_module(s, type, ctx);
     ndt_decref(type);
     return t;
 }
@@ -160,18 +200,16 @@ mk_function(ndt_type_seq_t *in, ndt_type_seq_t *out, ndt_context_t *ctx)
         return NULL;
     }
 
+    /* Move the references. */
     for (i = 0; i < nin; i++) {
         types[i] = in->ptr[i];
-        ndt_incref(types[i]);
     }
 
     for (i = 0; i < nout; i++) {
         types[nin+i] = out->ptr[i];
-        ndt_incref(types[nin+i]);
     }
 
-    ndt_type_seq_del(in);
-    ndt_type_seq_del(out);
+    in->len = out->len = 0;
 
     t = ndt_function(types, nargs, nin, nout, ctx);
 
@@ -180,17 +218,41 @@ mk_function(ndt_type_seq_t *in, ndt_type_seq_t *out, ndt_context_t *ctx)
 }
 
 const ndt_t *
-mk_ellipsis_dim(char *name, const ndt_t *type, ndt_context_t *ctx)
+mk_ellipsis_dim(const char *name, const ndt_t *type, ndt_context_t *ctx)
 {
-    const ndt_t *t = ndt_ellipsis_dim(name, type, ctx);
+    const ndt_t *t;
+    char *s = NULL;
+
+    leave_nested(ctx);
+
+    if (name != NULL) {
+        s = ndt_strdup(name, ctx);
+        if (s == NULL) {
+            ndt_decref(type);
+            return NULL;
+        }
+    }
+
+    t = ndt_ellipsis_dim(s, type, ctx);
     ndt_decref(type);
     return t;
 }
 
 const ndt_t *
-mk_symbolic_dim(char *name, const ndt_t *type, ndt_context_t *ctx)
+mk_symbolic_dim(const char *name, const ndt_t *type, ndt_context_t *ctx)
 {
-    const ndt_t *t = ndt_symbolic_dim(name, type, ctx);
+    const ndt_t *t;
+    char *s;
+
+    leave_nested(ctx);
+
+    s = ndt_strdup(name, ctx);
+    if (s == NULL) {
+        ndt_decref(type);
+        return NULL;
+    }
+
+    t = ndt_symbolic_dim(s, type, ctx);
     ndt_decref(type);
     return t;
 }
@@ -198,23 +260,62 @@ mk_symbolic_dim(char *name, const ndt_t *type, ndt_context_t *ctx)
 const ndt_t *
 mk_array(const ndt_t *type, bool opt, ndt_context_t *ctx)
 {
-    const ndt_t *t = ndt_array(type, opt, ctx);
+    const ndt_t *t;
+
+    leave_nested(ctx);
+
+    t = ndt_array(type, opt, ctx);
     ndt_decref(type);
     return t;
 }
 
 const ndt_t *
-mk_constr(char *name, const ndt_t *type, bool opt, ndt_context_t *ctx)
+mk_constr(const char *name, const ndt_t *type, bool opt, ndt_context_t *ctx)
 {
-    const ndt_t *t = ndt_constr(name, type, opt, ctx);
+    const ndt_t *t;
+    char *s;
+
+    s = ndt_strdup(name, ctx);
+    if (s == NULL) {
+        ndt_decref(type);
+        return NULL;
+    }
+
+    t = ndt_constr(s, type, opt, ctx);
     ndt_decref(type);
     return t;
 }
 
+const ndt_t *
+mk_nominal(const char *name, bool opt, ndt_context_t *ctx)
+{
+    char *s = ndt_strdup(name, ctx);
+    if (s == NULL) {
+        return NULL;
+    }
+
+    return ndt_nominal(s, NULL, opt, ctx);
+}
+
+const ndt_t *
+mk_typevar(const char *name, ndt_context_t *ctx)
+{
+    char *s = ndt_strdup(name, ctx);
+    if (s == NULL) {
+        return NULL;
+    }
+
+    return ndt_typevar(s, ctx);
+}
+
 const ndt_t *
 mk_ref(const ndt_t *type, bool opt, ndt_context_t *ctx)
 {
-    const ndt_t *t = ndt_ref(type, opt, ctx);
+    const ndt_t *t;
+
+    leave_nested(ctx);
+
+    t = ndt_ref(type, opt, ctx);
     ndt_decref(type);
     return t;
 }
@@ -228,7 +329,7 @@ mk_fortran(const ndt_t *type, ndt_context_t *ctx)
 }
 
 const ndt_t *
-mk_contig(char *name, ndt_t *type, ndt_context_t *ctx)
+mk_contig(const char *name, ndt_t *type, ndt_context_t *ctx)
 {
     enum ndt_contig tag = RequireNA;
 
@@ -238,7 +339,6 @@ mk_contig(char *name, ndt_t *type, ndt_context_t *ctx)
     else if (strcmp(name, "F") == 0) {
         tag = RequireF;
     }
-    ndt_free(name);
 
     if (tag == RequireNA) {
         ndt_err_format(ctx, NDT_ParseError,
@@ -295,6 +395,8 @@ mk_fixed_dim_from_shape(char *v, const ndt_t *type, ndt_context_t *ctx)
     const ndt_t *t;
     int64_t shape;
 
+    leave_nested(ctx);
+
     shape = ndt_strtoll(v, 0, INT64_MAX, ctx);
     ndt_free(v);
 
@@ -317,6 +419,8 @@ mk_fixed_dim_from_attrs(ndt_attr_seq_t *attrs, const ndt_t *type, ndt_context_t
     int64_t step = INT64_MAX;
     int ret;
 
+    leave_nested(ctx);
+
     ret = ndt_parse_attr(&kwlist, ctx, attrs, &shape, &step);
     ndt_attr_seq_del(attrs);
     if (ret < 0) {
@@ -329,12 +433,20 @@ mk_fixed_dim_from_attrs(ndt_attr_seq_t *attrs, const ndt_t *type, ndt_context_t
     return t;
 }
 
+static void
+release_offsets(void *v)
+{
+    ndt_free_class(NDT_ALLOC_OFFSETS, v);
+}
+
 const ndt_t *
 mk_var_dim(ndt_attr_seq_t *attrs, const ndt_t *type, bool opt, ndt_context_t *ctx)
 {
     static const attr_spec kwlist = {1, 2, {"offsets", "_noffsets"}, {AttrInt32List, AttrInt64}};
     const ndt_t *t;
 
+    leave_nested(ctx);
+
     if (attrs) {
         ndt_offsets_t *offsets;
         int32_t *ptr;
@@ -350,12 +462,13 @@ mk_var_dim(ndt_attr_seq_t *attrs, const ndt_t *type, bool opt, ndt_context_t *ct
 
         if (n > INT32_MAX) {
             ndt_err_format(ctx, NDT_ValueError, "too many offsets");
-            ndt_free(ptr);
+            ndt_free_class(NDT_ALLOC_OFFSETS, ptr);
             ndt_decref(type);
             return NULL;
         }
 
-        offsets = ndt_offsets_from_ptr(ptr, (int32_t)n, ctx);
+        /* The attribute list is allocated from the offsets class. */
+        offsets = ndt_offsets_from_external(ptr, (int32_t)n, ptr, release_offsets, ctx);
         if (offsets == NULL) {
             ndt_decref(type);
             return NULL;
@@ -378,6 +491,8 @@ mk_var_ellipsis(const ndt_t *type, ndt_context_t *ctx)
     const ndt_t *t;
     char *s;
 
+    leave_nested(ctx);
+
     s = ndt_strdup("var", ctx);
     if (s == NULL) {
         ndt_decref(type);
@@ -395,6 +510,8 @@ mk_array_ellipsis(const ndt_t *type, ndt_context_t *ctx)
     const ndt_t *t;
     char *s;
 
+    leave_nested(ctx);
+
     s = ndt_strdup("array", ctx);
     if (s == NULL) {
         ndt_decref(type);
@@ -407,7 +524,7 @@ mk_array_ellipsis(const ndt_t *type, ndt_context_t *ctx)
 }
 
 ndt_field_t *
-mk_field(char *name, const ndt_t *type, ndt_attr_seq_t *attrs, ndt_context_t *ctx)
+mk_field(const char *name, const ndt_t *type, ndt_attr_seq_t *attrs, ndt_context_t *ctx)
 {
     static const attr_spec kwlist = {0, 2, {"align", "pack"}, {AttrUint16Opt, AttrUint16Opt}};
     uint16_opt_t align = {None, 0};
@@ -420,13 +537,12 @@ mk_field(char *name, const ndt_t *type, ndt_attr_seq_t *attrs, ndt_context_t *ct
         ndt_attr_seq_del(attrs);
 
         if (ret < 0) {
-            ndt_free(name);
             ndt_decref(type);
             return NULL;
         }
     }
 
-    f = ndt_field(name, type, align, pack, pad, ctx);
+    f = ndt_scratch_field(name, type, align, pack, pad, ctx);
     ndt_decref(type);
     return f;
 }
@@ -505,13 +621,19 @@ mk_union(ndt_field_seq_t *fields, bool opt, ndt_context_t *ctx)
 const ndt_t *
 mk_categorical(ndt_value_seq_t *seq, bool opt, ndt_context_t *ctx)
 {
-    const ndt_t *t;
+    int64_t ntypes = seq->len;
+    ndt_value_t *types;
 
-    seq = ndt_value_seq_finalize(seq);
-    t = ndt_categorical(seq->ptr, seq->len, opt, ctx);
+    /* ndt_categorical() steals the array, which must be on the heap. */
+    types = ndt_alloc(ntypes, sizeof *types);
+    if (types == NULL) {
+        ndt_value_seq_del(seq);
+        return ndt_memory_error(ctx);
+    }
+    memcpy(types, seq->ptr, ntypes * sizeof *types);
+    seq->len = 0;
 
-    ndt_free(seq);
-    return t;
+    return ndt_categorical(types, ntypes, opt, ctx);
 }
 
 const ndt_t *
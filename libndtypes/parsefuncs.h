@@ -56,37 +56,39 @@ char *mk_stringlit(const char *lexeme, ndt_context_t *ctx);
 /*****************************************************************************/
 
 enum ndt_encoding encoding_from_string(char *s, ndt_context_t *ctx);
-ndt_attr_t *mk_attr(char *name, char *value, ndt_context_t *ctx);
-ndt_attr_t *mk_attr_from_seq(char *name, ndt_string_seq_t *seq, ndt_context_t *ctx);
+ndt_attr_t *mk_attr(const char *name, char *value, ndt_context_t *ctx);
+ndt_attr_t *mk_attr_from_seq(const char *name, ndt_string_seq_t *seq, ndt_context_t *ctx);
 
 
 /*****************************************************************************/
 /*                    Parser functions for creating types                    */
 /*****************************************************************************/
 
-const ndt_t *mk_module(char *name, const ndt_t *type, ndt_context_t *ctx);
+const ndt_t *mk_module(const char *name, const ndt_t *type, ndt_context_t *ctx);
 const ndt_t *mk_function(ndt_type_seq_t *in, ndt_type_seq_t *out, ndt_context_t *ctx);
 
 const ndt_t *mk_fortran(const ndt_t *type, ndt_context_t *ctx);
-const ndt_t *mk_contig(char *name, ndt_t *type, ndt_context_t *ctx);
+const ndt_t *mk_contig(const char *name, ndt_t *type, ndt_context_t *ctx);
 const ndt_t *mk_fixed_dim_from_shape(char *v, const ndt_t *type, ndt_context_t *ctx);
 const ndt_t *mk_fixed_dim_from_attrs(ndt_attr_seq_t *attrs, const ndt_t *type, ndt_context_t *ctx);
 
 const ndt_t *mk_var_dim(ndt_attr_seq_t *seq, const ndt_t *type, bool opt, ndt_context_t *ctx);
 const ndt_t *mk_var_ellipsis(const ndt_t *type, ndt_context_t *ctx);
 
-const ndt_t *mk_ellipsis_dim(char *name, const ndt_t *type, ndt_context_t *ctx);
-const ndt_t *mk_symbolic_dim(char *name, const ndt_t *type, ndt_context_t *ctx);
+const ndt_t *mk_ellipsis_dim(const char *name, const ndt_t *type, ndt_context_t *ctx);
+const ndt_t *mk_symbolic_dim(const char *name, const ndt_t *type, ndt_context_t *ctx);
 
 const ndt_t *mk_array(const ndt_t *type, bool opt, ndt_context_t *ctx);
 const ndt_t *mk_array_ellipsis(const ndt_t *type, ndt_context_t *ctx);
 
-ndt_field_t *mk_field(char *name, const ndt_t *type, ndt_attr_seq_t *seq, ndt_context_t *ctx);
+ndt_field_t *mk_field(const char *name, const ndt_t *type, ndt_attr_seq_t *seq, ndt_context_t *ctx);
 const ndt_t *mk_tuple(enum ndt_variadic flag, ndt_field_seq_t *fields, ndt_attr_seq_t *attrs, bool opt, ndt_context_t *ctx);
 const ndt_t *mk_record(enum ndt_variadic flag, ndt_field_seq_t *fields, ndt_attr_seq_t *attrs, bool opt, ndt_context_t *ctx);
 const ndt_t * mk_union(ndt_field_seq_t *fields, bool opt, ndt_context_t *ctx);
 
-const ndt_t *mk_constr(char *name, const ndt_t *type, bool opt, ndt_context_t *ctx);
+const ndt_t *mk_constr(const char *name, const ndt_t *type, bool opt, ndt_context_t *ctx);
+const ndt_t *mk_nominal(const char *name, bool opt, ndt_context_t *ctx);
+const ndt_t *mk_typevar(const char *name, ndt_context_t *ctx);
 const ndt_t *mk_ref(const ndt_t *type, bool opt, ndt_context_t *ctx);
 
 const ndt_t *mk_categorical(ndt_value_seq_t *seq, bool opt, ndt_context_t *ctx);
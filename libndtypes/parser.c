@@ -32,12 +32,14 @@
 
 
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 #include <setjmp.h>
 #include "ndtypes.h"
 #include "seq.h"
 #include "grammar.h"
 #include "lexer.h"
+#include "keywords.h"
 
 
 #ifdef YYDEBUG
@@ -45,6 +47,145 @@ int ndt_yydebug = 1;
 #endif
 
 
+/*****************************************************************************/
+/*                                 Keywords                                  */
+/*****************************************************************************/
+
+/*
+ * The table in keywords.h is a perfect hash of the scalar type names in
+ * lexer.l, used by the fast path of ndt_from_string().  It is generated from
+ * the lexer rules with "make parser", so the fast path and the lexer accept
+ * the same names.  All names have distinct slots, so a lookup is a single
+ * comparison.
+ */
+
+/* Return the token of the identifier 's' of length 'n' or -1. */
+static int
+keyword_token(const char *s, size_t n)
+{
+    int i;
+
+    if (n < 2) {
+        return -1;
+    }
+
+    i = KEYWORD_HASH(s, n);
+    if (keywords[i].len == n && memcmp(keywords[i].name, s, n) == 0) {
+        return keywords[i].token;
+    }
+
+    return -1;
+}
+
+static inline int
+is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\f' || c == '\n' || c == '\r';
+}
+
+static inline int
+is_name_char(char c)
+{
+    return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') ||
+           ('0' <= c && c <= '9') || c == '_';
+}
+
+/*
+ * Inputs that are a single scalar type like "float64" or "?<int32" are
+ * classified in one pass over the input, without copying it and without
+ * running the lexer and the parser.  Return 0 if the input needs the full
+ * parser.
+ */
+static int
+scalar_from_string(const ndt_t **t, const char *input, ndt_context_t *ctx)
+{
+    const char *s = input;
+    const char *name;
+    uint32_t option = 0;
+    uint32_t endian = 0;
+    bool has_endian = true;
+    size_t n;
+
+    while (is_space(*s)) s++;
+
+    if (*s == '?') {
+        option = NDT_OPTION;
+        s++;
+    }
+
+    switch (*s) {
+    case '=':
+        endian = NDT_SYS_BIG_ENDIAN ? NDT_BIG_ENDIAN : NDT_LITTLE_ENDIAN;
+        s++;
+        break;
+    case '<':
+        endian = NDT_LITTLE_ENDIAN;
+        s++;
+        break;
+    case '>':
+        endian = NDT_BIG_ENDIAN;
+        s++;
+        break;
+    case '|':
+        s++;
+        break;
+    default:
+        has_endian = false;
+        break;
+    }
+
+    name = s;
+    if ('0' <= *s && *s <= '9') {
+        return 0;
+    }
+    while (is_name_char(*s)) s++;
+    n = s - name;
+
+    while (is_space(*s)) s++;
+    if (*s != '\0') {
+        return 0;
+    }
+
+    switch (keyword_token(name, n)) {
+    case BOOL: *t = ndt_primitive(Bool, option|endian, ctx); return 1;
+
+    case INT8: *t = ndt_primitive(Int8, option|endian, ctx); return 1;
+    case INT16: *t = ndt_primitive(Int16, option|endian, ctx); return 1;
+    case INT32: *t = ndt_primitive(Int32, option|endian, ctx); return 1;
+    case INT64: *t = ndt_primitive(Int64, option|endian, ctx); return 1;
+
+    case UINT8: *t = ndt_primitive(Uint8, option|endian, ctx); return 1;
+    case UINT16: *t = ndt_primitive(Uint16, option|endian, ctx); return 1;
+    case UINT32: *t = ndt_primitive(Uint32, option|endian, ctx); return 1;
+    case UINT64: *t = ndt_primitive(Uint64, option|endian, ctx); return 1;
+
+    case BFLOAT16: *t = ndt_primitive(BFloat16, option|endian, ctx); return 1;
+    case FLOAT16: *t = ndt_primitive(Float16, option|endian, ctx); return 1;
+    case FLOAT32: *t = ndt_primitive(Float32, option|endian, ctx); return 1;
+    case FLOAT64: *t = ndt_primitive(Float64, option|endian, ctx); return 1;
+
+    case BCOMPLEX32: *t = ndt_primitive(BComplex32, option|endian, ctx); return 1;
+    case COMPLEX32: *t = ndt_primitive(Complex32, option|endian, ctx); return 1;
+    case COMPLEX64: *t = ndt_primitive(Complex64, option|endian, ctx); return 1;
+    case COMPLEX128: *t = ndt_primitive(Complex128, option|endian, ctx); return 1;
+
+    case INTPTR: *t = ndt_from_alias(Intptr, option|endian, ctx); return 1;
+    case UINTPTR: *t = ndt_from_alias(Uintptr, option|endian, ctx); return 1;
+    case SIZE: *t = ndt_from_alias(Size, option|endian, ctx); return 1;
+
+    case STRING:
+        if (has_endian) {
+            return 0;
+        }
+        *t = ndt_string(option != 0, ctx);
+        return 1;
+
+    default:
+        return 0;
+    }
+}
+
+
 static FILE *
 ndt_fopen(const char *name, const char *mode)
 {
@@ -70,9 +211,14 @@ _ndt_from_fp(FILE *fp, ndt_context_t *ctx)
     const ndt_t *ast = NULL;
     int ret;
 
+    ndt_limits_begin(ctx);
+    ndt_scratch_enter();
+
     if (setjmp(ndt_lexerror) == 0) {
         if (ndt_yylex_init_extra(ctx, (yyscan_t *)&scanner) != 0) {
             ndt_err_format(ctx, NDT_LexError, "lexer initialization failed");
+            ndt_scratch_leave();
+            ndt_limits_end(ctx);
             return NULL;
         }
 
@@ -82,6 +228,8 @@ _ndt_from_fp(FILE *fp, ndt_context_t *ctx)
 
         ret = ndt_yyparse(scanner, &ast, ctx);
         ndt_yylex_destroy(scanner);
+        ndt_scratch_leave();
+        ndt_limits_end(ctx);
 
         if (ret == 2) {
             ndt_err_format(ctx, NDT_MemoryError, "out of memory");
@@ -93,6 +241,8 @@ _ndt_from_fp(FILE *fp, ndt_context_t *ctx)
         if (scanner) {
             ndt_yylex_destroy(scanner);
         }
+        ndt_scratch_leave();
+        ndt_limits_end(ctx);
         ndt_err_format(ctx, NDT_MemoryError,
             "out of memory (most likely) or internal lexer error");
         return NULL;
@@ -138,6 +288,10 @@ _ndt_from_string(const char *input, ndt_context_t *ctx)
     const ndt_t *ast = NULL;
     int ret;
 
+    if (scalar_from_string(&ast, input, ctx)) {
+        return ast;
+    }
+
     size = strlen(input);
     if (size > INT_MAX / 2) {
         /* The code generated by flex truncates size_t in several places. */
@@ -145,17 +299,28 @@ _ndt_from_string(const char *input, ndt_context_t *ctx)
         return NULL;
     }
 
+    ndt_limits_begin(ctx);
+    if (ndt_limit_bytes(ctx, (int64_t)size+2) < 0) {
+        ndt_limits_end(ctx);
+        return NULL;
+    }
+
     buffer = ndt_alloc_size(size+2);
     if (buffer == NULL) {
+        ndt_limits_end(ctx);
         return ndt_memory_error(ctx);
     }
     memcpy(buffer, input, size);
     buffer[size] = '\0';
     buffer[size+1] = '\0';
 
+    ndt_scratch_enter();
+
     if (setjmp(ndt_lexerror) == 0) {
         if (ndt_yylex_init_extra(ctx, (yyscan_t *)&scanner) != 0) {
             ndt_err_format(ctx, NDT_LexError, "lexer initialization failed");
+            ndt_scratch_leave();
+            ndt_limits_end(ctx);
             ndt_free(buffer);
             return NULL;
         }
@@ -167,6 +332,8 @@ _ndt_from_string(const char *input, ndt_context_t *ctx)
         ret = ndt_yyparse(scanner, &ast, ctx);
         ndt_yy_delete_buffer(state, scanner);
         ndt_yylex_destroy(scanner);
+        ndt_scratch_leave();
+        ndt_limits_end(ctx);
         ndt_free(buffer);
 
         if (ret == 2) {
@@ -182,6 +349,8 @@ _ndt_from_string(const char *input, ndt_context_t *ctx)
         if (scanner) {
             ndt_yylex_destroy(scanner);
         }
+        ndt_scratch_leave();
+        ndt_limits_end(ctx);
         ndt_free(buffer);
         ndt_err_format(ctx, NDT_MemoryError, "flex: internal lexer error");
         return NULL;
@@ -118,13 +118,26 @@ static const ndt_t ndt_##name##_opt_be = {                       \
   .refcnt = 1                                                    \
 };
 
+/* Optional types that are known to contain no missing values. */
+#define NDT_PRIMITIVE_VALID(name, _tag, _access, _flags, _size, _align) \
+   NDT_PRIMITIVE_OPT(name##_valid, _tag, _access, _flags|NDT_ALL_VALID, _size, _align)
+
+#define NDT_PRIMITIVE_VALID_LE(name, _tag, _access, _flags, _size, _align) \
+   NDT_PRIMITIVE_OPT_LE(name##_valid, _tag, _access, _flags|NDT_ALL_VALID, _size, _align)
+
+#define NDT_PRIMITIVE_VALID_BE(name, _tag, _access, _flags, _size, _align) \
+   NDT_PRIMITIVE_OPT_BE(name##_valid, _tag, _access, _flags|NDT_ALL_VALID, _size, _align)
+
 #define NDT_PRIMITIVE_ALL(name, _tag, _size, _align) \
-   NDT_PRIMITIVE(name, _tag, Concrete, 0, _size, _align)        \
-   NDT_PRIMITIVE_LE(name, _tag, Concrete, 0, _size, _align)     \
-   NDT_PRIMITIVE_BE(name, _tag, Concrete, 0, _size, _align)     \
-   NDT_PRIMITIVE_OPT(name, _tag, Concrete, 0, _size, _align)    \
-   NDT_PRIMITIVE_OPT_LE(name, _tag, Concrete, 0, _size, _align) \
-   NDT_PRIMITIVE_OPT_BE(name, _tag, Concrete, 0, _size, _align)
+   NDT_PRIMITIVE(name, _tag, Concrete, 0, _size, _align)          \
+   NDT_PRIMITIVE_LE(name, _tag, Concrete, 0, _size, _align)       \
+   NDT_PRIMITIVE_BE(name, _tag, Concrete, 0, _size, _align)       \
+   NDT_PRIMITIVE_OPT(name, _tag, Concrete, 0, _size, _align)      \
+   NDT_PRIMITIVE_OPT_LE(name, _tag, Concrete, 0, _size, _align)   \
+   NDT_PRIMITIVE_OPT_BE(name, _tag, Concrete, 0, _size, _align)   \
+   NDT_PRIMITIVE_VALID(name, _tag, Concrete, 0, _size, _align)    \
+   NDT_PRIMITIVE_VALID_LE(name, _tag, Concrete, 0, _size, _align) \
+   NDT_PRIMITIVE_VALID_BE(name, _tag, Concrete, 0, _size, _align)
 
 #define NDT_PRIMITIVE_KIND_ALL(name, _tag) \
    NDT_PRIMITIVE(name, _tag, Abstract, 0, 0, UINT16_MAX)        \
@@ -163,6 +176,7 @@ NDT_PRIMITIVE_ALL(complex128, Complex128, sizeof(ndt_complex128_t), alignof(ndt_
 
 NDT_PRIMITIVE(str, String, Concrete, NDT_POINTER, sizeof(char *), alignof(char *))
 NDT_PRIMITIVE_OPT(str, String, Concrete, NDT_POINTER, sizeof(char *), alignof(char *))
+NDT_PRIMITIVE_VALID(str, String, Concrete, NDT_POINTER, sizeof(char *), alignof(char *))
 
 
 const ndt_t *
@@ -392,6 +406,90 @@ ndt_primitive(enum ndt tag, uint32_t flags, ndt_context_t *ctx)
         }
     }
  
+    case NDT_OPTION|NDT_ALL_VALID: {
+        switch(tag) {
+        case Bool: return &ndt_bool_valid_opt;
+
+        case Int8: return &ndt_int8_valid_opt;
+        case Int16: return &ndt_int16_valid_opt;
+        case Int32: return &ndt_int32_valid_opt;
+        case Int64: return &ndt_int64_valid_opt;
+
+        case Uint8: return &ndt_uint8_valid_opt;
+        case Uint16: return &ndt_uint16_valid_opt;
+        case Uint32: return &ndt_uint32_valid_opt;
+        case Uint64: return &ndt_uint64_valid_opt;
+
+        case BFloat16: return &ndt_bfloat16_valid_opt;
+        case Float16: return &ndt_float16_valid_opt;
+        case Float32: return &ndt_float32_valid_opt;
+        case Float64: return &ndt_float64_valid_opt;
+
+        case BComplex32: return &ndt_bcomplex32_valid_opt;
+        case Complex32: return &ndt_complex32_valid_opt;
+        case Complex64: return &ndt_complex64_valid_opt;
+        case Complex128: return &ndt_complex128_valid_opt;
+
+        default: goto value_error_tag;
+        }
+    }
+
+    case NDT_OPTION|NDT_ALL_VALID|NDT_LITTLE_ENDIAN: {
+        switch(tag) {
+        case Bool: return &ndt_bool_valid_opt_le;
+
+        case Int8: return &ndt_int8_valid_opt_le;
+        case Int16: return &ndt_int16_valid_opt_le;
+        case Int32: return &ndt_int32_valid_opt_le;
+        case Int64: return &ndt_int64_valid_opt_le;
+
+        case Uint8: return &ndt_uint8_valid_opt_le;
+        case Uint16: return &ndt_uint16_valid_opt_le;
+        case Uint32: return &ndt_uint32_valid_opt_le;
+        case Uint64: return &ndt_uint64_valid_opt_le;
+
+        case BFloat16: return &ndt_bfloat16_valid_opt_le;
+        case Float16: return &ndt_float16_valid_opt_le;
+        case Float32: return &ndt_float32_valid_opt_le;
+        case Float64: return &ndt_float64_valid_opt_le;
+
+        case BComplex32: return &ndt_bcomplex32_valid_opt_le;
+        case Complex32: return &ndt_complex32_valid_opt_le;
+        case Complex64: return &ndt_complex64_valid_opt_le;
+        case Complex128: return &ndt_complex128_valid_opt_le;
+
+        default: goto value_error_tag;
+        }
+    }
+
+    case NDT_OPTION|NDT_ALL_VALID|NDT_BIG_ENDIAN: {
+        switch(tag) {
+        case Bool: return &ndt_bool_valid_opt_be;
+
+        case Int8: return &ndt_int8_valid_opt_be;
+        case Int16: return &ndt_int16_valid_opt_be;
+        case Int32: return &ndt_int32_valid_opt_be;
+        case Int64: return &ndt_int64_valid_opt_be;
+
+        case Uint8: return &ndt_uint8_valid_opt_be;
+        case Uint16: return &ndt_uint16_valid_opt_be;
+        case Uint32: return &ndt_uint32_valid_opt_be;
+        case Uint64: return &ndt_uint64_valid_opt_be;
+
+        case BFloat16: return &ndt_bfloat16_valid_opt_be;
+        case Float16: return &ndt_float16_valid_opt_be;
+        case Float32: return &ndt_float32_valid_opt_be;
+        case Float64: return &ndt_float64_valid_opt_be;
+
+        case BComplex32: return &ndt_bcomplex32_valid_opt_be;
+        case Complex32: return &ndt_complex32_valid_opt_be;
+        case Complex64: return &ndt_complex64_valid_opt_be;
+        case Complex128: return &ndt_complex128_valid_opt_be;
+
+        default: goto value_error_tag;
+        }
+    }
+
     case NDT_POINTER: {
         switch(tag) {
         case String: return &ndt_str;
@@ -406,6 +504,13 @@ ndt_primitive(enum ndt tag, uint32_t flags, ndt_context_t *ctx)
         }
     }
 
+    case NDT_POINTER|NDT_OPTION|NDT_ALL_VALID: {
+        switch(tag) {
+        case String: return &ndt_str_valid_opt;
+        default: goto value_error_tag;
+        }
+    }
+
     default:
         goto value_error_flags;
     }
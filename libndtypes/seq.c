@@ -33,20 +33,327 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include <assert.h>
 #include "ndtypes.h"
+#include "overflow.h"
 #include "seq.h"
+#include "threadlocal.h"
+
+
+/*****************************************************************************/
+/*                               Scratch space                               */
+/*****************************************************************************/
+
+#define SCRATCH_BLOCK_SIZE 4096
+#define SCRATCH_KEEP_MAX (16 * SCRATCH_BLOCK_SIZE)
+
+typedef struct scratch_block {
+    struct scratch_block *prev;
+    int64_t size;
+    int64_t used;
+    alignas(MAX_ALIGN) char data[];
+} scratch_block_t;
+
+/*
+ * Blocks double in size, so the top block is the largest.  'last' is the
+ * most recent allocation in the top block, which can be resized in place.
+ */
+static NDT_THREAD_LOCAL struct {
+    scratch_block_t *top;
+    char *last;
+    int depth;
+} scratch = {NULL, NULL, 0};
+
+static inline int64_t
+scratch_size(int64_t nmemb, int64_t size, bool *overflow)
+{
+    int64_t req;
+
+    req = MULi64(nmemb, size, overflow);
+    req = ADDi64(req, (int64_t)MAX_ALIGN-1, overflow);
+    req &= ~((int64_t)MAX_ALIGN-1);
+
+    return req == 0 ? (int64_t)MAX_ALIGN : req;
+}
+
+static void
+scratch_free_blocks(scratch_block_t *b)
+{
+    scratch_block_t *prev;
+
+    while (b != NULL) {
+        prev = b->prev;
+        ndt_free_class(NDT_ALLOC_SCRATCH, b);
+        b = prev;
+    }
+}
+
+void
+ndt_scratch_enter(void)
+{
+    scratch.depth++;
+}
+
+/*
+ * Release all memory of the scope.  Keep the top block for reuse unless it
+ * has grown beyond a small bound, so that an occasional large parse does not
+ * pin memory for the lifetime of the thread.
+ */
+void
+ndt_scratch_leave(void)
+{
+    scratch_block_t *b = scratch.top;
+
+    assert(scratch.depth > 0);
+
+    if (--scratch.depth > 0 || b == NULL) {
+        return;
+    }
+
+    scratch_free_blocks(b->prev);
+    b->prev = NULL;
+    b->used = 0;
+    scratch.last = NULL;
+
+    if (b->size > SCRATCH_KEEP_MAX) {
+        ndt_free_class(NDT_ALLOC_SCRATCH, b);
+        scratch.top = NULL;
+    }
+}
+
+/* Release the scratch space of the calling thread. */
+void
+ndt_scratch_clear(void)
+{
+    if (scratch.depth == 0) {
+        scratch_free_blocks(scratch.top);
+        scratch.top = NULL;
+        scratch.last = NULL;
+    }
+}
+
+void *
+ndt_scratch_alloc(int64_t nmemb, int64_t size, ndt_context_t *ctx)
+{
+    scratch_block_t *b = scratch.top;
+    bool overflow = 0;
+    int64_t req, bsize;
+    char *ptr;
+
+    assert(scratch.depth > 0);
+
+    req = scratch_size(nmemb, size, &overflow);
+    if (overflow) {
+        return ndt_memory_error(ctx);
+    }
+
+    if (ndt_limit_bytes(ctx, req) < 0) {
+        return NULL;
+    }
+
+    if (b == NULL || b->size - b->used < req) {
+        bsize = b == NULL ? SCRATCH_BLOCK_SIZE : MULi64(b->size, 2, &overflow);
+        if (bsize < req) {
+            bsize = req;
+        }
+
+        b = ndt_alloc_class(NDT_ALLOC_SCRATCH, 1,
+                            ADDi64((int64_t)sizeof *b, bsize, &overflow));
+        if (overflow || b == NULL) {
+            ndt_free_class(NDT_ALLOC_SCRATCH, b);
+            return ndt_memory_error(ctx);
+        }
+
+        b->prev = scratch.top;
+        b->size = bsize;
+        b->used = 0;
+        scratch.top = b;
+    }
+
+    ptr = b->data + b->used;
+    b->used += req;
+    scratch.last = ptr;
+
+    return ptr;
+}
+
+/*
+ * Return an array with room for at least twice the 'nmemb' elements of 'ptr'.
+ * The most recent allocation grows in place.
+ */
+void *
+ndt_scratch_grow(void *ptr, int64_t nmemb, int64_t size, ndt_context_t *ctx)
+{
+    scratch_block_t *b = scratch.top;
+    bool overflow = 0;
+    int64_t n, old, req;
+    void *p;
+
+    n = nmemb == 0 ? 2 : MULi64(nmemb, 2, &overflow);
+    old = scratch_size(nmemb, size, &overflow);
+    req = scratch_size(n, size, &overflow);
+    if (overflow) {
+        return ndt_memory_error(ctx);
+    }
+
+    if (ptr != NULL && ptr == scratch.last && b->size - b->used >= req - old) {
+        if (ndt_limit_bytes(ctx, req - old) < 0) {
+            return NULL;
+        }
+        b->used += req - old;
+        return ptr;
+    }
+
+    p = ndt_scratch_alloc(n, size, ctx);
+    if (p == NULL) {
+        return NULL;
+    }
+
+    if (nmemb > 0) {
+        memcpy(p, ptr, (size_t)(nmemb * size));
+    }
+
+    return p;
+}
+
+/* Shrink an array to 'newmemb' elements.  Only the most recent allocation
+   gives memory back. */
+void
+ndt_scratch_shrink(void *ptr, int64_t nmemb, int64_t newmemb, int64_t size)
+{
+    bool overflow = 0;
+    int64_t old, req;
+
+    assert(newmemb <= nmemb);
+
+    if (ptr == NULL || ptr != scratch.last) {
+        return;
+    }
+
+    old = scratch_size(nmemb, size, &overflow);
+    req = scratch_size(newmemb, size, &overflow);
+    assert(!overflow);
+
+    scratch.top->used -= old - req;
+}
+
+
+char *
+ndt_scratch_strdup(const char *s, ndt_context_t *ctx)
+{
+    size_t len = strlen(s);
+    char *cp;
+
+    if (ndt_limit_string(ctx, (int64_t)len) < 0) {
+        return NULL;
+    }
+
+    cp = ndt_scratch_alloc(1, (int64_t)len+1, ctx);
+    if (cp == NULL) {
+        return NULL;
+    }
+
+    memcpy(cp, s, len+1);
+    return cp;
+}
 
 
 /*****************************************************************************/
 /*                              Field sequences                              */
 /*****************************************************************************/
 
-NDT_SEQ_NEW(ndt_field)
-NDT_SEQ_DEL(ndt_field)
-NDT_SEQ_GROW(ndt_field)
-NDT_SEQ_APPEND(ndt_field)
-NDT_SEQ_FINALIZE(ndt_field)
+/* The fields and their names are in the scratch space.  Only the type
+   references are owned. */
+ndt_field_seq_t *
+ndt_field_seq_new(ndt_field_t *elt, ndt_context_t *ctx)
+{
+    ndt_field_seq_t *seq;
+    ndt_field_t *ptr;
+
+    seq = ndt_scratch_alloc(1, sizeof *seq, ctx);
+    if (seq == NULL) {
+        ndt_decref(elt->type);
+        return NULL;
+    }
+
+    ptr = ndt_scratch_alloc(2, sizeof *ptr, ctx);
+    if (ptr == NULL) {
+        ndt_decref(elt->type);
+        return NULL;
+    }
+
+    ptr[0] = *elt;
+    seq->len = 1;
+    seq->reserved = 2;
+    seq->ptr = ptr;
+
+    return seq;
+}
+
+void
+ndt_field_seq_del(ndt_field_seq_t *seq)
+{
+    int64_t i;
+
+    if (seq != NULL) {
+        for (i = 0; i < seq->len; i++) {
+            ndt_decref(seq->ptr[i].type);
+        }
+        seq->len = 0;
+    }
+}
+
+static int
+ndt_field_seq_grow(ndt_field_seq_t *seq, ndt_context_t *ctx)
+{
+    ndt_field_t *ptr;
+
+    ptr = ndt_scratch_grow(seq->ptr, seq->reserved, sizeof *ptr, ctx);
+    if (ptr == NULL) {
+        return -1;
+    }
+
+    seq->ptr = ptr;
+    seq->reserved = 2 * seq->reserved;
+
+    return 0;
+}
+
+ndt_field_seq_t *
+ndt_field_seq_append(ndt_field_seq_t *seq, ndt_field_t *elt, ndt_context_t *ctx)
+{
+    assert(seq->len <= seq->reserved);
+
+    if (seq->len == seq->reserved) {
+        if (ndt_field_seq_grow(seq, ctx) < 0) {
+            ndt_field_seq_del(seq);
+            ndt_decref(elt->type);
+            return NULL;
+        }
+    }
+
+    seq->ptr[seq->len] = *elt;
+    seq->len++;
+
+    return seq;
+}
+
+ndt_field_seq_t *
+ndt_field_seq_finalize(ndt_field_seq_t *seq)
+{
+    if (seq == NULL) {
+        return NULL;
+    }
+
+    assert(seq->len <= seq->reserved);
+
+    ndt_scratch_shrink(seq->ptr, seq->reserved, seq->len, sizeof *seq->ptr);
+    seq->reserved = seq->len;
+
+    return seq;
+}
 
 
 /*****************************************************************************/
@@ -59,17 +366,16 @@ ndt_string_seq_new(char *elt, ndt_context_t *ctx)
     ndt_string_seq_t *seq;
     char **ptr;
 
-    seq = ndt_alloc_size(sizeof *seq);
+    seq = ndt_scratch_alloc(1, sizeof *seq, ctx);
     if (seq == NULL) {
         ndt_free(elt);
-        return ndt_memory_error(ctx);
+        return NULL;
     }
 
-    ptr = ndt_alloc_size(2 * (sizeof *ptr));
+    ptr = ndt_scratch_alloc(2, sizeof *ptr, ctx);
     if (ptr == NULL) {
-        ndt_free(seq);
         ndt_free(elt);
-        return ndt_memory_error(ctx);
+        return NULL;
     }
 
     ptr[0] = elt;
@@ -89,8 +395,7 @@ ndt_string_seq_del(ndt_string_seq_t *seq)
         for (i = 0; i < seq->len; i++) {
             ndt_free(seq->ptr[i]);
         }
-        ndt_free(seq->ptr);
-        ndt_free(seq);
+        seq->len = 0;
     }
 }
 
@@ -99,9 +404,8 @@ ndt_string_seq_grow(ndt_string_seq_t *seq, ndt_context_t *ctx)
 {
     char **ptr;
 
-    ptr = ndt_realloc(seq->ptr, seq->reserved, 2 * (sizeof *ptr));
+    ptr = ndt_scratch_grow(seq->ptr, seq->reserved, sizeof *ptr, ctx);
     if (ptr == NULL) {
-        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
         return -1;
     }
 
@@ -133,20 +437,13 @@ ndt_string_seq_append(ndt_string_seq_t *seq, char *elt, ndt_context_t *ctx)
 ndt_string_seq_t *
 ndt_string_seq_finalize(ndt_string_seq_t *seq)
 {
-    char **ptr;
-
     if (seq == NULL) {
         return NULL;
     }
 
     assert(seq->len <= seq->reserved);
 
-    ptr = ndt_realloc(seq->ptr, seq->len, sizeof *ptr);
-    if (ptr == NULL) {
-        return seq; /* seq is still valid */
-    }
-
-    seq->ptr = ptr;
+    ndt_scratch_shrink(seq->ptr, seq->reserved, seq->len, sizeof *seq->ptr);
     seq->reserved = seq->len;
 
     return seq;
@@ -162,9 +459,9 @@ ndt_type_seq_empty(ndt_context_t *ctx)
 {
     ndt_type_seq_t *seq;
 
-    seq = ndt_alloc_size(sizeof *seq);
+    seq = ndt_scratch_alloc(1, sizeof *seq, ctx);
     if (seq == NULL) {
-        return ndt_memory_error(ctx);
+        return NULL;
     }
 
     seq->len = 0;
@@ -180,17 +477,16 @@ ndt_type_seq_new(ndt_t *elt, ndt_context_t *ctx)
     ndt_type_seq_t *seq;
     const ndt_t **ptr;
 
-    seq = ndt_alloc_size(sizeof *seq);
+    seq = ndt_scratch_alloc(1, sizeof *seq, ctx);
     if (seq == NULL) {
         ndt_decref(elt);
-        return ndt_memory_error(ctx);
+        return NULL;
     }
 
-    ptr = ndt_alloc_size(2 * (sizeof *ptr));
+    ptr = ndt_scratch_alloc(2, sizeof *ptr, ctx);
     if (ptr == NULL) {
-        ndt_free(seq);
         ndt_decref(elt);
-        return ndt_memory_error(ctx);
+        return NULL;
     }
 
     ptr[0] = elt;
@@ -206,8 +502,8 @@ void
 ndt_type_seq_del(ndt_type_seq_t *seq)
 {
     if (seq != NULL) {
-        ndt_type_array_del(seq->ptr, seq->len);
-        ndt_free(seq);
+        ndt_type_array_clear(seq->ptr, seq->len);
+        seq->len = 0;
     }
 }
 
@@ -216,14 +512,13 @@ ndt_type_seq_grow(ndt_type_seq_t *seq, ndt_context_t *ctx)
 {
     const ndt_t **ptr;
 
-    ptr = ndt_realloc((void *)seq->ptr, seq->reserved, 2 * (sizeof *ptr));
+    ptr = ndt_scratch_grow((void *)seq->ptr, seq->reserved, sizeof *ptr, ctx);
     if (ptr == NULL) {
-        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
         return -1;
     }
 
     seq->ptr = ptr;
-    seq->reserved = 2 * seq->reserved;
+    seq->reserved = seq->reserved == 0 ? 2 : 2 * seq->reserved;
 
     return 0;
 }
@@ -236,6 +531,7 @@ ndt_type_seq_append(ndt_type_seq_t *seq, ndt_t *elt, ndt_context_t *ctx)
     if (seq->len == seq->reserved) {
         if (ndt_type_seq_grow(seq, ctx) < 0) {
             ndt_type_seq_del(seq);
+            ndt_decref(elt);
             return NULL;
         }
     }
@@ -249,20 +545,13 @@ ndt_type_seq_append(ndt_type_seq_t *seq, ndt_t *elt, ndt_context_t *ctx)
 ndt_type_seq_t *
 ndt_type_seq_finalize(ndt_type_seq_t *seq)
 {
-    const ndt_t **ptr;
-
     if (seq == NULL) {
         return NULL;
     }
 
     assert(seq->len <= seq->reserved);
 
-    ptr = ndt_realloc((void *)seq->ptr, seq->len, sizeof *ptr);
-    if (ptr == NULL) {
-        return seq; /* seq is still valid */
-    }
-
-    seq->ptr = ptr;
+    ndt_scratch_shrink((void *)seq->ptr, seq->reserved, seq->len, sizeof *seq->ptr);
     seq->reserved = seq->len;
 
     return seq;
@@ -38,68 +38,100 @@
 #include "ndtypes.h"
 
 
+/*****************************************************************************/
+/*                               Scratch space                               */
+/*****************************************************************************/
+
+/*
+ * Per-thread bump allocator for the temporary sequences of the parsers.  The
+ * memory is released in bulk when the outermost scope is left, so the data
+ * structures must not outlive the scope.  The largest block is kept for the
+ * next scope if it is small.  ndt_finalize_thread() releases it.
+ */
+void ndt_scratch_enter(void);
+void ndt_scratch_leave(void);
+void ndt_scratch_clear(void);
+
+void *ndt_scratch_alloc(int64_t nmemb, int64_t size, ndt_context_t *ctx);
+void *ndt_scratch_grow(void *ptr, int64_t nmemb, int64_t size, ndt_context_t *ctx);
+void ndt_scratch_shrink(void *ptr, int64_t nmemb, int64_t newmemb, int64_t size);
+char *ndt_scratch_strdup(const char *s, ndt_context_t *ctx);
+
+/*
+ * The parsers allocate names and fields in the scratch space.  Records copy
+ * the names into the type node.
+ */
+ndt_field_t *ndt_scratch_field(const char *name, const ndt_t *type,
+                               uint16_opt_t align, uint16_opt_t pack,
+                               uint16_opt_t pad, ndt_context_t *ctx);
+
+
 /*****************************************************************************/
 /*                         Strongly typed sequences                          */
 /*****************************************************************************/
 
+/*
+ * The sequences and their arrays live in the scratch space.  Elements are
+ * moved in and owned by the sequence.  Consumers that keep the array must
+ * copy it.  Field sequences only own the type references of their fields.
+ */
+
 /* Create a new sequence with one initial element.  Steal the element. */
 #define NDT_SEQ_NEW(elem) \
-elem##_seq_t *                                                 \
-elem##_seq_new(elem##_t *elt, ndt_context_t *ctx)              \
-{                                                              \
-    elem##_seq_t *seq;                                         \
-    elem##_t *ptr;                                             \
-                                                               \
-    seq = ndt_alloc(1, sizeof *seq);                           \
-    if (seq == NULL) {                                         \
-        elem##_del(elt);                                       \
-        return ndt_memory_error(ctx);                          \
-    }                                                          \
-                                                               \
-    ptr = ndt_alloc(2, sizeof *ptr);                           \
-    if (ptr == NULL) {                                         \
-        ndt_free(seq);                                         \
-        elem##_del(elt);                                       \
-        return ndt_memory_error(ctx);                          \
-    }                                                          \
-                                                               \
-    ptr[0] = *elt;                                             \
-    seq->len = 1;                                              \
-    seq->reserved = 2;                                         \
-    seq->ptr = ptr;                                            \
-                                                               \
-    ndt_free(elt);                                             \
-    return seq;                                                \
+elem##_seq_t *                                    \
+elem##_seq_new(elem##_t *elt, ndt_context_t *ctx) \
+{                                                 \
+    elem##_seq_t *seq;                            \
+    elem##_t *ptr;                                \
+                                                  \
+    seq = ndt_scratch_alloc(1, sizeof *seq, ctx); \
+    if (seq == NULL) {                            \
+        elem##_del(elt);                          \
+        return NULL;                              \
+    }                                             \
+                                                  \
+    ptr = ndt_scratch_alloc(2, sizeof *ptr, ctx); \
+    if (ptr == NULL) {                            \
+        elem##_del(elt);                          \
+        return NULL;                              \
+    }                                             \
+                                                  \
+    ptr[0] = *elt;                                \
+    seq->len = 1;                                 \
+    seq->reserved = 2;                            \
+    seq->ptr = ptr;                               \
+                                                  \
+    ndt_free(elt);                                \
+    return seq;                                   \
 }
 
-/* Delete a sequence */
+/* Delete a sequence.  The memory is reclaimed with the scratch space. */
 #define NDT_SEQ_DEL(elem) \
-void                                          \
-elem##_seq_del(elem##_seq_t *seq)             \
-{                                             \
-    if (seq != NULL) {                        \
-        elem##_array_del(seq->ptr, seq->len); \
-        ndt_free(seq);                        \
-    }                                         \
+void                                            \
+elem##_seq_del(elem##_seq_t *seq)               \
+{                                               \
+    if (seq != NULL) {                          \
+        elem##_array_clear(seq->ptr, seq->len); \
+        seq->len = 0;                           \
+    }                                           \
 }
 
 /* Grow a sequence */
 #define NDT_SEQ_GROW(elem) \
-static int                                                         \
-elem##_seq_grow(elem##_seq_t *seq, ndt_context_t *ctx)             \
-{                                                                  \
-    elem##_t *ptr;                                                 \
-                                                                   \
-    ptr = ndt_realloc(seq->ptr, seq->reserved, 2 * (sizeof *ptr)); \
-    if (ptr == NULL) {                                             \
-        ndt_err_format(ctx, NDT_MemoryError, "out of memory");     \
-        return -1;                                                 \
-    }                                                              \
-                                                                   \
-    seq->ptr = ptr;                                                \
-    seq->reserved = 2 * seq->reserved;                             \
-                                                                   \
-    return 0;                                                      \
+static int                                                             \
+elem##_seq_grow(elem##_seq_t *seq, ndt_context_t *ctx)                 \
+{                                                                      \
+    elem##_t *ptr;                                                     \
+                                                                       \
+    ptr = ndt_scratch_grow(seq->ptr, seq->reserved, sizeof *ptr, ctx); \
+    if (ptr == NULL) {                                                 \
+        return -1;                                                     \
+    }                                                                  \
+                                                                       \
+    seq->ptr = ptr;                                                    \
+    seq->reserved = 2 * seq->reserved;                                 \
+                                                                       \
+    return 0;                                                          \
 }
 
 /* Append an element to a sequence */
@@ -124,27 +156,21 @@ elem##_seq_append(elem##_seq_t *seq, elem##_t *elt, ndt_context_t *ctx) \
     return seq;                                                         \
 }
 
+/* Return the unused part of the array to the scratch space. */
 #define NDT_SEQ_FINALIZE(elem) \
-elem##_seq_t *                                          \
-elem##_seq_finalize(elem##_seq_t *seq)                  \
-{                                                       \
-    elem##_t *ptr;                                      \
-                                                        \
-    if (seq == NULL) {                                  \
-        return NULL;                                    \
-    }                                                   \
-                                                        \
-    assert(seq->len <= seq->reserved);                  \
-                                                        \
-    ptr = ndt_realloc(seq->ptr, seq->len, sizeof *ptr); \
-    if (ptr == NULL) {                                  \
-        return seq; /* seq is still valid */            \
-    }                                                   \
-                                                        \
-    seq->ptr = ptr;                                     \
-    seq->reserved = seq->len;                           \
-                                                        \
-    return seq;                                         \
+elem##_seq_t *                                                               \
+elem##_seq_finalize(elem##_seq_t *seq)                                       \
+{                                                                            \
+    if (seq == NULL) {                                                       \
+        return NULL;                                                         \
+    }                                                                        \
+                                                                             \
+    assert(seq->len <= seq->reserved);                                       \
+                                                                             \
+    ndt_scratch_shrink(seq->ptr, seq->reserved, seq->len, sizeof *seq->ptr); \
+    seq->reserved = seq->len;                                                \
+                                                                             \
+    return seq;                                                              \
 }
 
 typedef struct {
@@ -31,13 +31,17 @@
  */
 
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <inttypes.h>
 #include <string.h>
 #include <assert.h>
 #include "ndtypes.h"
+#include "intern.h"
+#include "nelem.h"
 #include "overflow.h"
+#include "symtable.h"
 
 
 static const ndt_t *read_type(const char * const ptr, int64_t offset,
@@ -102,6 +106,17 @@ array_size(const int64_t nmemb, const size_t size, ndt_context_t *ctx)
     return array_size;
 }
 
+/* Account for an array of 'nmemb' elements in a limited context. */
+static inline int
+limit_array(const int64_t nmemb, const size_t size, ndt_context_t *ctx)
+{
+    bool overflow = 0;
+    int64_t n;
+
+    n = MULi64(nmemb, (int64_t)size, &overflow);
+    return ndt_limit_bytes(ctx, overflow ? INT64_MAX : n);
+}
+
 static inline int64_t
 string_size(const char * const ptr, const int64_t offset, const int64_t len,
             ndt_context_t *ctx)
@@ -292,6 +307,39 @@ read_string_array(char *s[], int64_t shape, const char * const ptr,
     return offset;
 }
 
+/*
+ * Return the total size of 'shape' consecutive strings including the NUL
+ * bytes.  The strings are only validated, not copied.
+ */
+static int64_t
+string_array_size(int64_t shape, const char * const ptr, int64_t offset,
+                  const int64_t len, ndt_context_t *ctx)
+{
+    int64_t total = 0;
+
+    for (int64_t i = 0; i < shape; i++) {
+        if (offset >= len) {
+            ndt_err_format(ctx, NDT_ValueError,
+                "buffer overflow in type deserialization");
+            return -1;
+        }
+
+        const int64_t size = string_size(ptr, offset, len, ctx);
+        if (size < 0) {
+            return -1;
+        }
+
+        if (ndt_limit_string(ctx, size-1) < 0) {
+            return -1;
+        }
+
+        total += size;
+        offset += size;
+    }
+
+    return total;
+}
+
 static inline int64_t
 read_ndt_value_array(ndt_value_t *v, const int64_t nmemb,
                      const char * const ptr,
@@ -433,6 +481,8 @@ read_fixed_dim(const common_t *fields, const char * const ptr, int64_t offset,
     int64_t shape;
     int64_t step;
     int64_t itemsize;
+    int64_t tile = 0;
+    int64_t tile_step = 0;
     const ndt_t *type;
     ndt_t *t;
 
@@ -448,6 +498,26 @@ read_fixed_dim(const common_t *fields, const char * const ptr, int64_t offset,
     offset = read_pos_int64(&itemsize, ptr, offset, len, ctx);
     if (offset < 0) return NULL;
 
+    if (fields->flags & NDT_TILED) {
+        offset = read_pos_int64(&tile, ptr, offset, len, ctx);
+        if (offset < 0) return NULL;
+
+        offset = read_pos_int64(&tile_step, ptr, offset, len, ctx);
+        if (offset < 0) return NULL;
+
+        if (tile != 0 && shape % tile != 0) {
+            ndt_err_format(ctx, NDT_ValueError,
+                "invalid tile extent in deserialization (corrupt data?)");
+            return NULL;
+        }
+
+        if (tile != 0 && shape/tile > 1 && tile_step/tile < step) {
+            ndt_err_format(ctx, NDT_ValueError,
+                "overlapping tiles in deserialization (corrupt data?)");
+            return NULL;
+        }
+    }
+
     type = read_type(ptr, offset, len, ctx);
     if (type == NULL) {
         return NULL;
@@ -463,6 +533,9 @@ read_fixed_dim(const common_t *fields, const char * const ptr, int64_t offset,
     t->FixedDim.type = type;
     t->Concrete.FixedDim.step = step;
     t->Concrete.FixedDim.itemsize = itemsize;
+    t->Concrete.FixedDim.tile = tile;
+    t->Concrete.FixedDim.tile_step = tile_step;
+    t->Concrete.FixedDim.nelem = ndt_fixed_dim_nelem(type, shape);
 
     return t;
 }
@@ -499,7 +572,7 @@ read_symbolic_dim(const common_t *fields, const char * const ptr, int64_t offset
         return NULL;
     }
     t->SymbolicDim.tag = tag;
-    t->SymbolicDim.name = name;
+    t->SymbolicDim.name = ndt_symbol_intern(name);
     t->SymbolicDim.type = type;
 
     return t;
@@ -541,7 +614,7 @@ read_ellipsis_dim(const common_t *fields, const char * const ptr, int64_t offset
         return NULL;
     }
     t->EllipsisDim.tag = tag;
-    t->EllipsisDim.name = name;
+    t->EllipsisDim.name = ndt_symbol_intern(name);
     t->EllipsisDim.type = type;
 
     return t;
@@ -569,7 +642,7 @@ read_var_dim(const common_t *fields, const char * const ptr, int64_t offset,
     if (offset < 0) return NULL;
 
     if (noffsets > 0) {
-        offsets = ndt_offsets_new(noffsets, ctx);
+        offsets = ndt_offsets_new_uninit(noffsets, ctx);
         if (offsets == NULL) {
             return NULL;
         }
@@ -579,9 +652,16 @@ read_var_dim(const common_t *fields, const char * const ptr, int64_t offset,
             ndt_decref_offsets(offsets);
             return NULL;
         }
+
+        offsets = ndt_offsets_intern(offsets);
+    }
+
+    if (limit_array(nslices, sizeof *slices, ctx) < 0) {
+        ndt_decref_offsets(offsets);
+        return NULL;
     }
 
-    slices = ndt_alloc(nslices, sizeof *slices);
+    slices = ndt_alloc_slices(nslices);
     if (slices == NULL) {
         ndt_decref_offsets(offsets);
         return ndt_memory_error(ctx);
@@ -590,26 +670,26 @@ read_var_dim(const common_t *fields, const char * const ptr, int64_t offset,
     offset = read_ndt_slice_array(slices, nslices, ptr, offset, len, ctx);
     if (offset < 0) {
         ndt_decref_offsets(offsets);
-        ndt_free(slices);
+        ndt_free_slices(slices);
         return NULL;
     }
 
     if (nslices == 0) {
-        ndt_free(slices);
+        ndt_free_slices(slices);
         slices = NULL;
     }
 
     type = read_type(ptr, offset, len, ctx);
     if (type == NULL) {
         ndt_decref_offsets(offsets);
-        ndt_free(slices);
+        ndt_free_slices(slices);
         return NULL;
     }
 
     t = new_copy_common(fields, ctx);
     if (t == NULL) {
         ndt_decref_offsets(offsets);
-        ndt_free(slices);
+        ndt_free_slices(slices);
         ndt_decref(type);
         return NULL;
     }
@@ -618,6 +698,8 @@ read_var_dim(const common_t *fields, const char * const ptr, int64_t offset,
     t->Concrete.VarDim.offsets = offsets;
     t->Concrete.VarDim.nslices = nslices;
     t->Concrete.VarDim.slices = slices;
+    t->Concrete.VarDim.nelem = ndt_var_dim_nelem(type, offsets, nslices);
+    t->Concrete.VarDim.total = ndt_var_dim_total(type, offsets);
 
     return t;
 }
@@ -721,8 +803,10 @@ static const ndt_t *
 read_record(const common_t *fields, const char * const ptr, int64_t offset,
             const int64_t len, ndt_context_t *ctx)
 {
+    const int64_t arrays = sizeof(int64_t) + 2 * sizeof(uint16_t);
     int64_t metaoffset;
     enum ndt_variadic flag;
+    int64_t namesize;
     int64_t shape;
     ndt_t *t;
 
@@ -732,7 +816,17 @@ read_record(const common_t *fields, const char * const ptr, int64_t offset,
     offset = read_pos_int64(&shape, ptr, offset, len, ctx);
     if (offset < 0) return NULL;
 
-    t = ndt_record_new(flag, shape, 0, ctx);
+    /* The names follow the offset, align and pad arrays. */
+    if (shape > (len-offset) / arrays) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "buffer overflow in type deserialization");
+        return NULL;
+    }
+
+    namesize = string_array_size(shape, ptr, offset + shape * arrays, len, ctx);
+    if (namesize < 0) return NULL;
+
+    t = ndt_record_new(flag, shape, namesize, 0, ctx);
     if (t == NULL) {
         return NULL;
     }
@@ -747,8 +841,10 @@ read_record(const common_t *fields, const char * const ptr, int64_t offset,
     offset = read_uint16_array(t->Concrete.Tuple.pad, shape, ptr, offset, len, ctx);
     if (offset < 0) goto error;
 
-    offset = read_string_array(t->Record.names, shape, ptr, offset, len, ctx);
-    if (offset < 0) goto error;
+    for (int64_t i = 0; i < shape; i++) {
+        ndt_record_set_name(t, i, ptr+offset);
+        offset += strlen(ptr+offset) + 1;
+    }
 
     metaoffset = offset;
     for (int64_t i = 0; i < shape; i++) {
@@ -906,6 +1002,10 @@ read_categorical(const common_t *fields, const char * const ptr, int64_t offset,
     offset = read_pos_int64(&ntypes, ptr, offset, len, ctx);
     if (offset < 0) return NULL;
 
+    if (limit_array(ntypes, sizeof *types, ctx) < 0) {
+        return NULL;
+    }
+
     types = ndt_calloc(ntypes, sizeof *types);
     if (types == NULL) {
         return ndt_memory_error(ctx);
@@ -1029,14 +1129,14 @@ read_typevar(const common_t *fields, const char * const ptr, int64_t offset,
         ndt_free(name);
         return NULL;
     }
-    t->Typevar.name = name;
+    t->Typevar.name = ndt_symbol_intern(name);
 
     return t;
 }
 
 static const ndt_t *
-read_type(const char * const ptr, int64_t offset, const int64_t len,
-          ndt_context_t *ctx)
+read_type_tag(const char * const ptr, int64_t offset, const int64_t len,
+              ndt_context_t *ctx)
 {
     common_t fields;
 
@@ -1084,8 +1184,219 @@ read_type(const char * const ptr, int64_t offset, const int64_t len,
     return NULL;
 }
 
+/*
+ * The nesting depth is the number of enclosing types, as in the parser, so
+ * the root is read with read_type_tag().  It is checked before any child is
+ * read.
+ */
+static const ndt_t *
+read_type(const char * const ptr, int64_t offset, const int64_t len,
+          ndt_context_t *ctx)
+{
+    const ndt_t *t;
+
+    if (ndt_limit_depth(ctx, 1) < 0) {
+        return NULL;
+    }
+
+    t = read_type_tag(ptr, offset, len, ctx);
+    (void)ndt_limit_depth(ctx, -1);
+
+    return t;
+}
+
 const ndt_t *
 ndt_deserialize(const char * const ptr, int64_t len, ndt_context_t *ctx)
 {
-    return read_type(ptr, 0, len, ctx);
+    const ndt_t *t;
+
+    ndt_limits_begin(ctx);
+    t = read_type_tag(ptr, 0, len, ctx);
+    ndt_limits_end(ctx);
+
+    return t;
+}
+
+
+/*****************************************************************************/
+/*                          Load typedef bundles                             */
+/*****************************************************************************/
+
+static int64_t
+read_typedef_bundle_header(int64_t *ndefs, const char * const ptr,
+                           const int64_t len, ndt_context_t *ctx)
+{
+    uint32_t magic;
+    uint32_t version;
+    int64_t offset = 0;
+
+    offset = read_uint32(&magic, ptr, offset, len, ctx);
+    if (offset < 0) return -1;
+
+    if (magic != NDT_TYPEDEF_BUNDLE_MAGIC) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "invalid magic number in typedef bundle (wrong byte order?)");
+        return -1;
+    }
+
+    offset = read_uint32(&version, ptr, offset, len, ctx);
+    if (offset < 0) return -1;
+
+    if (version != NDT_TYPEDEF_BUNDLE_VERSION) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "unsupported typedef bundle version: expected %u, got %u",
+            NDT_TYPEDEF_BUNDLE_VERSION, version);
+        return -1;
+    }
+
+    return read_pos_int64(ndefs, ptr, offset, len, ctx);
+}
+
+static int64_t
+read_typedef_bundle_entry(const char **name, int64_t *typelen,
+                          const char * const ptr, int64_t offset,
+                          const int64_t len, ndt_context_t *ctx)
+{
+    const int64_t size = string_size(ptr, offset, len, ctx);
+    if (size < 0) {
+        return -1;
+    }
+    *name = ptr+offset;
+
+    offset = read_pos_int64(typelen, ptr, offset+size, len, ctx);
+    if (offset < 0) {
+        return -1;
+    }
+
+    return next_offset(offset, (size_t)*typelen, len, ctx);
+}
+
+/* Remove the first 'n' definitions of a validated bundle. */
+static void
+typedef_bundle_rollback(int64_t n, const char * const ptr, int64_t offset,
+                        const int64_t len)
+{
+    NDT_STATIC_CONTEXT(ctx);
+    const char *name;
+    int64_t typelen;
+
+    for (int64_t i = 0; i < n; i++) {
+        offset = read_typedef_bundle_entry(&name, &typelen, ptr, offset, len, &ctx);
+        assert(offset >= 0);
+        ndt_typedef_remove(name);
+    }
+}
+
+/*
+ * Register all definitions of a bundle created by ndt_serialize_typedefs().
+ * The entry table is validated before anything is registered.  If a
+ * definition fails, the ones registered before it are removed again, so a
+ * failed load leaves the typedef map unchanged.  Names are passed to
+ * ndt_typedef_add() directly from the buffer.
+ */
+int
+ndt_typedef_bundle_load(const char * const ptr, int64_t len, ndt_context_t *ctx)
+{
+    const ndt_t *t;
+    const char *name;
+    int64_t ndefs;
+    int64_t start;
+    int64_t offset;
+    int64_t typelen;
+    int ret;
+
+    if (len < 0) {
+        ndt_err_format(ctx, NDT_ValueError, "negative typedef bundle length");
+        return -1;
+    }
+
+    start = read_typedef_bundle_header(&ndefs, ptr, len, ctx);
+    if (start < 0) return -1;
+
+    offset = start;
+    for (int64_t i = 0; i < ndefs; i++) {
+        offset = read_typedef_bundle_entry(&name, &typelen, ptr, offset, len, ctx);
+        if (offset < 0) return -1;
+    }
+
+    if (offset != len) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "trailing data in typedef bundle (corrupted data?)");
+        return -1;
+    }
+
+    /* Limits apply to the bundle as a whole. */
+    ndt_limits_begin(ctx);
+
+    offset = start;
+    for (int64_t i = 0; i < ndefs; i++) {
+        offset = read_typedef_bundle_entry(&name, &typelen, ptr, offset, len, ctx);
+        assert(offset >= 0);
+
+        t = read_type_tag(ptr+offset-typelen, 0, typelen, ctx);
+        if (t == NULL) {
+            typedef_bundle_rollback(i, ptr, start, len);
+            ndt_limits_end(ctx);
+            return -1;
+        }
+
+        ret = ndt_typedef_add(name, t, NULL, ctx);
+        ndt_decref(t);
+        if (ret < 0) {
+            typedef_bundle_rollback(i, ptr, start, len);
+            ndt_limits_end(ctx);
+            return -1;
+        }
+    }
+
+    ndt_limits_end(ctx);
+    return 0;
+}
+
+/*
+ * Read a bundle file with a single fread() and register its definitions.
+ * Intended to be called directly after ndt_init().
+ */
+int
+ndt_typedef_bundle_load_file(const char *path, ndt_context_t *ctx)
+{
+    FILE *fp;
+    char *bytes;
+    long len;
+    int ret;
+
+    fp = fopen(path, "rb");
+    if (fp == NULL) {
+        ndt_err_format(ctx, NDT_OSError,
+            "could not open typedef bundle '%s'", path);
+        return -1;
+    }
+
+    if (fseek(fp, 0, SEEK_END) < 0 || (len = ftell(fp)) < 0 ||
+        fseek(fp, 0, SEEK_SET) < 0) {
+        ndt_err_format(ctx, NDT_OSError,
+            "could not determine size of typedef bundle '%s'", path);
+        fclose(fp);
+        return -1;
+    }
+
+    bytes = ndt_alloc(len == 0 ? 1 : len, 1);
+    if (bytes == NULL) {
+        fclose(fp);
+        (void)ndt_memory_error(ctx);
+        return -1;
+    }
+
+    if (fread(bytes, 1, (size_t)len, fp) != (size_t)len) {
+        ndt_err_format(ctx, NDT_OSError,
+            "could not read typedef bundle '%s'", path);
+        ndt_free(bytes);
+        fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+
+    ret = ndt_typedef_bundle_load(bytes, (int64_t)len, ctx);
+    ndt_free(bytes);
+    return ret;
 }
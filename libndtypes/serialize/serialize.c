@@ -205,6 +205,10 @@ write_fixed_dim(char * const ptr, int64_t offset, const ndt_t * const t,
     offset = write_int64(ptr, offset, t->FixedDim.shape, overflow);
     offset = write_int64(ptr, offset, t->Concrete.FixedDim.step, overflow);
     offset = write_int64(ptr, offset, t->Concrete.FixedDim.itemsize, overflow);
+    if (t->flags & NDT_TILED) {
+        offset = write_int64(ptr, offset, t->Concrete.FixedDim.tile, overflow);
+        offset = write_int64(ptr, offset, t->Concrete.FixedDim.tile_step, overflow);
+    }
     return write_type(ptr, offset, t->FixedDim.type, overflow);
 }
 
@@ -482,3 +486,90 @@ ndt_serialize(char **dest, const ndt_t * const t, ndt_context_t *ctx)
     *dest = bytes;
     return len;
 }
+
+
+/******************************************************************************/
+/*                          Serialize typedef bundles                         */
+/******************************************************************************/
+
+/*
+ * Bundle layout (native byte order):
+ *
+ *   uint32 magic, uint32 version, int64 ndefs,
+ *   ndefs * (name '\0', int64 typelen, char type[typelen])
+ *
+ * Each type is an ndt_serialize() blob that starts at offset 0 of its own
+ * slice, so the blobs can be handed to ndt_deserialize() unchanged.
+ */
+static int64_t
+write_typedef_bundle(char * const ptr, const char *names[],
+                     const ndt_t *types[], int64_t ndefs, bool *overflow)
+{
+    int64_t offset = 0;
+    int64_t typelen;
+
+    offset = write_uint32(ptr, offset, NDT_TYPEDEF_BUNDLE_MAGIC, overflow);
+    offset = write_uint32(ptr, offset, NDT_TYPEDEF_BUNDLE_VERSION, overflow);
+    offset = write_int64(ptr, offset, ndefs, overflow);
+
+    for (int64_t i = 0; i < ndefs; i++) {
+        offset = write_string(ptr, offset, (char *)names[i], overflow);
+        typelen = write_type(NULL, 0, types[i], overflow);
+        offset = write_int64(ptr, offset, typelen, overflow);
+        if (*overflow) {
+            return -1;
+        }
+        (void)write_type(ptr ? ptr+offset : NULL, 0, types[i], overflow);
+        offset = ADDi64(offset, typelen, overflow);
+    }
+
+    return offset;
+}
+
+/*
+ * Serialize a list of typedefs into a single bundle that can be registered
+ * with ndt_typedef_bundle_load().  Nominal types are resolved by name when
+ * the bundle is loaded, so a definition must precede all of its uses.
+ */
+int64_t
+ndt_serialize_typedefs(char **dest, const char *names[], const ndt_t *types[],
+                       int64_t ndefs, ndt_context_t *ctx)
+{
+    bool overflow = 0;
+    int64_t len;
+    char *bytes;
+
+    *dest = NULL;
+
+    if (ndefs < 0) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "number of typedefs must be non-negative");
+        return -1;
+    }
+
+    len = write_typedef_bundle(NULL, names, types, ndefs, &overflow);
+    if (overflow) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "overflow during typedef bundle serialization");
+        return -1;
+    }
+
+    bytes = ndt_alloc(len, 1);
+    if (bytes == NULL) {
+        (void)ndt_memory_error(ctx);
+        return -1;
+    }
+
+    overflow = 0;
+    int64_t n = write_typedef_bundle(bytes, names, types, ndefs, &overflow);
+    if (overflow || n != len) {
+        ndt_err_format(ctx, NDT_RuntimeError,
+            "unexpected overflow or different length in second pass "
+            "of serialization");
+        ndt_free(bytes);
+        return -1;
+    }
+
+    *dest = bytes;
+    return len;
+}
@@ -110,6 +110,97 @@ substitute_named_ellipsis(const ndt_t *t, const symtable_t *tbl, ndt_context_t *
     }
 }
 
+/*
+ * Substitute the member types of a tuple, record or union.  The members of
+ * abstract types cannot have explicit alignment, so the result has the
+ * natural layout of the substituted members.
+ */
+static const ndt_t *
+substitute_fields(const ndt_t *t, const symtable_t *tbl, const bool req_concrete,
+                  const bool opt, ndt_context_t *ctx)
+{
+    const uint16_opt_t none = {None, 0};
+    const ndt_t * const *types;
+    char * const *names;
+    ndt_field_t *fields = NULL;
+    const ndt_t *u, *w;
+    int64_t shape, i;
+
+    switch (t->tag) {
+    case Tuple:
+        types = t->Tuple.types;
+        names = NULL;
+        shape = t->Tuple.shape;
+        break;
+    case Record:
+        types = t->Record.types;
+        names = t->Record.names;
+        shape = t->Record.shape;
+        break;
+    case Union:
+        types = t->Union.types;
+        names = t->Union.tags;
+        shape = t->Union.ntags;
+        break;
+    default:
+        ndt_err_format(ctx, NDT_RuntimeError,
+            "substitute_fields: expected tuple, record or union");
+        return NULL;
+    }
+
+    if (req_concrete &&
+        ((t->tag == Tuple && t->Tuple.flag == Variadic) ||
+         (t->tag == Record && t->Record.flag == Variadic))) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "variadic tuples or records cannot be substituted");
+        return NULL;
+    }
+
+    if (shape > 0) {
+        fields = ndt_calloc(shape, sizeof *fields);
+        if (fields == NULL) {
+            return ndt_memory_error(ctx);
+        }
+    }
+
+    for (i = 0; i < shape; i++) {
+        u = ndt_substitute(types[i], tbl, req_concrete, ctx);
+        if (u == NULL) {
+            w = NULL;
+            goto out;
+        }
+
+        fields[i].name = names ? names[i] : NULL;
+        fields[i].type = u;
+        fields[i].access = u->access;
+        if (u->access == Concrete) {
+            fields[i].Concrete.align = u->align;
+            fields[i].Concrete.explicit_align = false;
+            fields[i].Concrete.pad = UINT16_MAX;
+            fields[i].Concrete.explicit_pad = false;
+        }
+    }
+
+    switch (t->tag) {
+    case Tuple:
+        w = ndt_tuple(t->Tuple.flag, fields, shape, none, none, opt, ctx);
+        break;
+    case Record:
+        w = ndt_record(t->Record.flag, fields, shape, none, none, opt, ctx);
+        break;
+    default:
+        w = ndt_union(fields, shape, opt, ctx);
+        break;
+    }
+
+out:
+    for (int64_t k = 0; k < i; k++) {
+        ndt_decref(fields[k].type);
+    }
+    ndt_free(fields);
+    return w;
+}
+
 const ndt_t *
 ndt_substitute(const ndt_t *t, const symtable_t *tbl, const bool req_concrete,
                ndt_context_t *ctx)
@@ -238,6 +329,10 @@ ndt_substitute(const ndt_t *t, const symtable_t *tbl, const bool req_concrete,
         return w;
     }
 
+    case Tuple: case Record: case Union: {
+        return substitute_fields(t, tbl, req_concrete, opt, ctx);
+    }
+
     case Ref: {
         u = ndt_substitute(t->Ref.type, tbl, req_concrete, ctx);
         if (u == NULL) {
@@ -36,6 +36,7 @@
 #include <stddef.h>
 #include "ndtypes.h"
 #include "symtable.h"
+#include "seq.h"
 
 
 /*****************************************************************************/
@@ -158,6 +159,32 @@ ndt_typedef_add(const char *key, const ndt_t *type, const ndt_methods_t *m, ndt_
     return 0;
 }
 
+/*
+ * Remove a definition.  The trie nodes are kept, since nominal types point
+ * to the methods of their definition.  Unknown keys are ignored.
+ */
+void
+ndt_typedef_remove(const char *key)
+{
+    typedef_trie_t *t = typedef_map;
+    const unsigned char *cp;
+    int i;
+
+    for (cp = (const unsigned char *)key; *cp != '\0'; cp++) {
+        i = code[*cp];
+        if (i == UCHAR_MAX || t->next[i] == NULL) {
+            return;
+        }
+        t = t->next[i];
+    }
+
+    ndt_decref(t->def.type);
+    t->def.type = NULL;
+    t->def.meth.init = NULL;
+    t->def.meth.constraint = NULL;
+    t->def.meth.repr = NULL;
+}
+
 const ndt_typedef_t *
 ndt_typedef_find(const char *key, ndt_context_t *ctx)
 {
@@ -213,6 +240,22 @@ ndt_finalize(void)
 {
     typedef_trie_del(typedef_map);
     typedef_map = NULL;
+    ndt_offsets_intern_disable();
+    ndt_symbol_intern_disable();
+    ndt_finalize_thread();
+}
+
+/*
+ * Release the per-thread caches, the scratch space and the dynamic message
+ * of the default context of the calling thread.
+ */
+void
+ndt_finalize_thread(void)
+{
+    ndt_nb_signature_cache_clear();
+    ndt_typecheck_specialize_disable();
+    ndt_scratch_clear();
+    ndt_context_reset(ndt_context_default());
 }
 
 
@@ -256,6 +299,23 @@ symtable_del(symtable_t *t)
     ndt_free(t);
 }
 
+/* Unbind all entries, keeping the trie nodes for reuse. */
+void
+symtable_clear(symtable_t *t)
+{
+    int i;
+
+    if (t == NULL) {
+        return;
+    }
+
+    t->entry.tag = Unbound;
+
+    for (i = 0; i < ALPHABET_LEN; i++) {
+        symtable_clear(t->next[i]);
+    }
+}
+
 int
 symtable_add(symtable_t *t, const char *key, const symtable_entry_t entry,
              ndt_context_t *ctx)
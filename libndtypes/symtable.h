@@ -92,6 +92,7 @@ NDT_PRAGMA(NDT_HIDE_SYMBOLS_START)
 symtable_t *symtable_new(ndt_context_t *ctx);
 void symtable_free_entry(symtable_entry_t entry);
 void symtable_del(symtable_t *t);
+void symtable_clear(symtable_t *t);
 int symtable_add(symtable_t *t, const char *key, const symtable_entry_t entry,
                  ndt_context_t *ctx);
 symtable_entry_t symtable_find(const symtable_t *t, const char *key);
@@ -100,6 +101,9 @@ int64_t symtable_find_shape(const symtable_t *tbl, const char *key, ndt_context_
 const ndt_t *symtable_find_typevar(const symtable_t *tbl, const char *key, ndt_context_t *ctx);
 const ndt_t *symtable_find_var_dim(const symtable_t *tbl, int ndim, ndt_context_t *ctx);
 
+/* Global typedef map */
+void ndt_typedef_remove(const char *key);
+
 
 /* END LOCAL SCOPE */
 NDT_PRAGMA(NDT_HIDE_SYMBOLS_END)
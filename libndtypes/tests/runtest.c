@@ -68,6 +68,9 @@ init_tests(void)
         return -1;
     }
 
+    /* Several tests inspect the allocation statistics. */
+    ndt_alloc_stats_enable(true);
+
     t = ndt_from_string("{a: size_t, b: ref(string)}", ctx);
     if (t == NULL) {
         ndt_err_fprint(stderr, ctx);
@@ -1082,265 +1085,2987 @@ error:
 }
 
 static int
-test_static_context(void)
+test_nb_signature(void)
 {
-    const char **c;
     NDT_STATIC_CONTEXT(ctx);
-    const ndt_t *t;
-    char *s;
+    const numba_testcase_t *test;
+    const ndt_nb_signature_t *s = NULL;
+    const ndt_nb_signature_t *r = NULL;
+    const ndt_t *t = NULL;
     int count = 0;
+    int ret = -1;
+
+    for (test = numba_tests; test->signature != NULL; test++) {
+        t = ndt_from_string(test->signature, &ctx);
+        if (t == NULL) {
+            ndt_err_format(&ctx, NDT_RuntimeError,
+                "test_nb_signature: could not parse \"%s\"\n", test->signature);
+            goto error;
+        }
 
-    for (c = parse_tests; *c != NULL; c++) {
         for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
             ndt_err_clear(&ctx);
 
             ndt_set_alloc_fail();
-            t = ndt_from_string(*c, &ctx);
+            s = ndt_to_nb_signature(t, &ctx);
             ndt_set_alloc();
 
             if (ctx.err != NDT_MemoryError) {
                 break;
             }
 
-            if (t != NULL) {
-                ndt_decref(t);
-                fprintf(stderr, "test_static_context: FAIL: t != NULL after MemoryError\n");
-                fprintf(stderr, "test_static_context: FAIL: %s\n", *c);
-                return -1;
+            if (s != NULL) {
+                ndt_err_format(&ctx, NDT_RuntimeError,
+                    "test_nb_signature: expect s == NULL after MemoryError\n");
+                goto error;
             }
         }
-        if (t == NULL) {
-            fprintf(stderr, "test_static_context: FAIL: expected success: \"%s\"\n", *c);
-            fprintf(stderr, "test_static_context: FAIL: got: %s: %s\n\n",
-                    ndt_err_as_string(ctx.err),
-                    ndt_context_msg(&ctx));
-            ndt_context_del(&ctx);
-            return -1;
-        }
 
-        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
-            ndt_err_clear(&ctx);
+        if (s == NULL) {
+            goto error;
+        }
 
-            ndt_set_alloc_fail();
-            s = ndt_as_string(t, &ctx);
-            ndt_set_alloc();
+        if (strcmp(s->sig, test->sig) != 0 || strcmp(s->core, test->core) != 0 ||
+            s->nargs != t->Function.nargs) {
+            ndt_err_format(&ctx, NDT_RuntimeError,
+                "test_nb_signature: unexpected result for \"%s\"\n", test->signature);
+            goto error;
+        }
 
-            if (ctx.err != NDT_MemoryError) {
-                break;
-            }
+        for (int64_t i = 0; i < s->nargs; i++) {
+            const ndt_t *arg = t->Function.types[i];
+            const ndt_t *dtype = ndt_dtype(arg);
 
-            if (s != NULL) {
-                ndt_free(s);
-                ndt_decref(t);
-                fprintf(stderr, "test_static_context: FAIL: s != NULL after MemoryError\n");
-                fprintf(stderr, "test_static_context: FAIL: %s\n", *c);
-                ndt_context_del(&ctx);
-                return -1;
+            if (s->args[i].tag != dtype->tag ||
+                s->args[i].itemsize != dtype->datasize ||
+                s->args[i].ndims != arg->ndim-1 ||
+                s->args[i].layout != 'A') {
+                ndt_err_format(&ctx, NDT_RuntimeError,
+                    "test_nb_signature: unexpected argument for \"%s\"\n",
+                    test->signature);
+                goto error;
             }
         }
-        if (s == NULL) {
-            fprintf(stderr, "test_static_context: FAIL: expected success: \"%s\"\n", *c);
-            fprintf(stderr, "test_static_context: FAIL: got: %s: %s\n\n",
-                    ndt_err_as_string(ctx.err),
-                    ndt_context_msg(&ctx));
-            ndt_decref(t);
-            ndt_context_del(&ctx);
-            return -1;
+
+        /* Repeated lookups return the memoized descriptor. */
+        r = ndt_to_nb_signature(t, &ctx);
+        if (r != s) {
+            ndt_err_format(&ctx, NDT_RuntimeError,
+                "test_nb_signature: descriptor is not memoized\n");
+            goto error;
         }
 
-        ndt_free(s);
-        ndt_decref(t);
+        ndt_nb_signature_decref(r); r = NULL;
+        ndt_nb_signature_decref(s); s = NULL;
+        ndt_decref(t); t = NULL;
         count++;
     }
 
-    s = "2 * 1000000000000000000000000000 * complex128";
-    t = ndt_from_string(s, &ctx);
+    /* Core dimension names and contiguity */
+    t = ndt_from_string("... * C[N * M * float64] -> ... * F[N * M * int32]", &ctx);
+    if (t == NULL) {
+        goto error;
+    }
+
+    s = ndt_to_nb_signature(t, &ctx);
     if (s == NULL) {
-        fprintf(stderr, "test_static_context: FAIL: expected failure: \"%s\"\n", s);
-        ndt_decref(t);
-        ndt_context_del(&ctx);
-        return -1;
+        goto error;
     }
-    count++;
 
-    ndt_context_del(&ctx);
-    fprintf(stderr, "test_static_context (%d test cases)\n", count);
+    if (s->args[0].layout != 'C' || s->args[1].layout != 'F' ||
+        strcmp(s->args[0].dims[0], "N") != 0 ||
+        strcmp(s->args[1].dims[1], "M") != 0) {
+        ndt_err_format(&ctx, NDT_RuntimeError,
+            "test_nb_signature: unexpected layout or dimension names\n");
+        goto error;
+    }
 
-    return 0;
-}
+    /* The descriptor keeps the type alive after the cache is cleared. */
+    ndt_decref(t); t = NULL;
+    ndt_nb_signature_cache_clear();
+    if (s->type->tag != Function || strcmp(s->args[1].dims[0], "N") != 0) {
+        ndt_err_format(&ctx, NDT_RuntimeError,
+            "test_nb_signature: descriptor does not own its type\n");
+        goto error;
+    }
+    count++;
 
-typedef struct {
-    const char *str;
-    ndt_ssize_t hash;
-} hash_testcase_t;
+    /* ndt_finalize_thread() clears the cache and releases the cached type. */
+    t = ndt_from_string("N * int64 -> N * float64", &ctx);
+    if (t == NULL) {
+        goto error;
+    }
 
-static int
-cmp_hash_testcase(const void *x, const void *y)
-{
-    const hash_testcase_t *p = (const hash_testcase_t *)x;
-    const hash_testcase_t *q = (const hash_testcase_t *)y;
+    ndt_nb_signature_decref(r);
+    r = ndt_to_nb_signature(t, &ctx);
+    if (r == NULL) {
+        goto error;
+    }
+    ndt_nb_signature_decref(r); r = NULL;
 
-    if (p->hash < q->hash) {
-        return -1;
+    if (t->refcnt != 2) {
+        ndt_err_format(&ctx, NDT_RuntimeError,
+            "test_nb_signature: descriptor not cached\n");
+        goto error;
     }
-    else if (p->hash == q->hash) {
-        return 0;
+
+    ndt_finalize_thread();
+    if (t->refcnt != 1) {
+        ndt_err_format(&ctx, NDT_RuntimeError,
+            "test_nb_signature: cache not cleared by ndt_finalize_thread()\n");
+        goto error;
     }
+    count++;
 
-    return 1;
+    ret = 0;
+    fprintf(stderr, "test_nb_signature (%d test cases)\n", count);
+
+
+out:
+    ndt_nb_signature_decref(r);
+    ndt_nb_signature_decref(s);
+    ndt_decref(t);
+    ndt_context_del(&ctx);
+    return ret;
+
+error:
+   ret = -1;
+   ndt_err_fprint(stderr, &ctx);
+   goto out;
 }
 
 static int
-test_hash(void)
+test_graph_typecheck(void)
 {
-    NDT_STATIC_CONTEXT(ctx);
-    hash_testcase_t buf[1000];
-    ptrdiff_t n = 1;
-    const char **c;
+    const ndt_graph_edge_t matmul_in[2] = {{-1, 0}, {-1, 1}};
+    const ndt_graph_edge_t unary_in[1] = {{0, 0}};
+    const ndt_graph_edge_t bad_in[1] = {{1, 0}};
+    const ndt_graph_edge_t second_in[2] = {{0, 0}, {-1, 1}};
+    const ndt_graph_edge_t first_input[1] = {{-1, 0}};
+    const ndt_graph_edge_t second_input[1] = {{-1, 1}};
+    ndt_apply_spec_t specs[2];
+    ndt_graph_node_t nodes[2];
+    const ndt_t *inputs[2] = {NULL, NULL};
+    const ndt_t *matmul = NULL, *unary = NULL, *expected = NULL;
+    const ndt_t *rows = NULL, *cols = NULL, *vector = NULL, *pair = NULL;
+    const ndt_t *vectors[2] = {NULL, NULL};
     const ndt_t *t;
-    hash_testcase_t x;
-    int i;
+    ndt_context_t *ctx;
+    int count = 0;
+    int ret = -1;
 
-    for (c = parse_roundtrip_tests; *c != NULL; c++) {
-        n = c - parse_roundtrip_tests;
-        if (n >= 1000) {
-            break;
-        }
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
 
-        ndt_err_clear(&ctx);
+    matmul = ndt_from_string("... * N * M * float64, ... * M * P * float64 -> ... * N * P * float64", ctx);
+    unary = ndt_from_string("... * float64 -> ... * float64", ctx);
+    inputs[0] = ndt_from_string("10 * 3 * float64", ctx);
+    inputs[1] = ndt_from_string("3 * 4 * float64", ctx);
+    expected = ndt_from_string("10 * 4 * float64", ctx);
+    rows = ndt_from_string("N * M * float64 -> N * float64", ctx);
+    cols = ndt_from_string("M * P * float64 -> P * float64", ctx);
+    vector = ndt_from_string("N * float64 -> N * float64", ctx);
+    pair = ndt_from_string("N * float64, N * float64 -> N * float64", ctx);
+    vectors[0] = ndt_from_string("2 * float64", ctx);
+    vectors[1] = ndt_from_string("3 * float64", ctx);
+    if (matmul == NULL || unary == NULL || inputs[0] == NULL || inputs[1] == NULL ||
+        expected == NULL || rows == NULL || cols == NULL || vector == NULL || pair == NULL ||
+        vectors[0] == NULL || vectors[1] == NULL) {
+        fprintf(stderr, "test_graph_typecheck: FAIL: unexpected failure in from_string\n");
+        goto out;
+    }
 
-        t = ndt_from_string(*c, &ctx);
-        if (t == NULL) {
-            fprintf(stderr, "test_hash: FAIL: expected success: \"%s\"\n", *c);
-            fprintf(stderr, "test_hash: FAIL: got: %s: %s\n\n",
-                    ndt_err_as_string(ctx.err),
-                    ndt_context_msg(&ctx));
-            ndt_context_del(&ctx);
-            return -1;
-        }
+    nodes[0].sig = matmul;
+    nodes[0].in = matmul_in;
+    nodes[1].sig = unary;
+    nodes[1].in = unary_in;
 
-        x.hash = ndt_hash(t, &ctx);
-        x.str = *c;
-        ndt_decref(t);
+    for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+        ndt_err_clear(ctx);
 
-        if (x.hash == -1) {
-            fprintf(stderr, "test_hash: FAIL: hash==-1\n\n");
-            ndt_context_del(&ctx);
-            return -1;
+        ndt_set_alloc_fail();
+        ret = ndt_graph_typecheck(specs, nodes, 2, inputs, 2, ctx);
+        ndt_set_alloc();
+
+        if (ctx->err != NDT_MemoryError) {
+            break;
         }
 
-        buf[n] = x;
+        if (ret != -1 || specs[0].nargs != 0) {
+            fprintf(stderr, "test_graph_typecheck: FAIL: specs not cleared after MemoryError\n");
+            ret = -1;
+            goto out;
+        }
     }
 
-    qsort(buf, n, sizeof *buf, cmp_hash_testcase);
-    for (i = 0; i < n-1; i++) {
-        if (buf[i].hash == buf[i+1].hash) {
-            fprintf(stderr,
-                "test_hash: duplicate hash for %s: %" PRI_ndt_ssize "\n\n",
-                buf[i].str, buf[i].hash);
-        }
+    if (ret < 0) {
+        fprintf(stderr, "test_graph_typecheck: FAIL: unexpected failure: %s\n",
+                ndt_context_msg(ctx));
+        goto out;
     }
+    ret = -1;
+
+    t = specs[1].types[1];
+    if (specs[0].nargs != 3 || specs[1].nargs != 2 ||
+        !ndt_equal(specs[1].types[0], specs[0].types[2]) ||
+        !ndt_equal(t, expected) || t->datasize != 320 || t->align != 8) {
+        fprintf(stderr, "test_graph_typecheck: FAIL: unexpected intermediate types\n");
+        ndt_apply_spec_clear(&specs[0]);
+        ndt_apply_spec_clear(&specs[1]);
+        goto out;
+    }
+    ndt_apply_spec_clear(&specs[0]);
+    ndt_apply_spec_clear(&specs[1]);
+    count++;
 
-    t = ndt_from_string("var * {a: float64, b: string}", &ctx);
-    if (t == NULL) {
-        fprintf(stderr, "test_hash: FAIL: expected success\n\n");
-        ndt_context_del(&ctx);
-        return -1;
+    /* Edges must respect the topological order. */
+    nodes[0].sig = unary;
+    nodes[0].in = bad_in;
+    if (ndt_graph_typecheck(specs, nodes, 2, inputs, 2, ctx) != -1 ||
+        ctx->err != NDT_ValueError) {
+        fprintf(stderr, "test_graph_typecheck: FAIL: expected ValueError\n");
+        goto out;
     }
+    ndt_err_clear(ctx);
+    count++;
 
-    alloc_fail = 1;
-    ndt_set_alloc_fail();
-    x.hash = ndt_hash(t, &ctx);
-    ndt_set_alloc();
+    /* (10 * 4) x (3 * 4) fails in the second node and clears all specs. */
+    nodes[0].sig = matmul;
+    nodes[0].in = matmul_in;
+    nodes[1].sig = matmul;
+    nodes[1].in = second_in;
+    if (ndt_graph_typecheck(specs, nodes, 2, inputs, 2, ctx) != -1 ||
+        ctx->err != NDT_TypeError || specs[0].nargs != 0) {
+        fprintf(stderr, "test_graph_typecheck: FAIL: expected TypeError\n");
+        goto out;
+    }
+    ndt_err_clear(ctx);
+    count++;
 
-    ndt_decref(t);
+    /* Independent nodes with consistent bindings. */
+    nodes[0].sig = rows;
+    nodes[0].in = first_input;
+    nodes[1].sig = cols;
+    nodes[1].in = second_input;
+    if (ndt_graph_typecheck(specs, nodes, 2, inputs, 2, ctx) < 0) {
+        fprintf(stderr, "test_graph_typecheck: FAIL: unexpected failure: %s\n",
+                ndt_context_msg(ctx));
+        goto out;
+    }
+    ndt_apply_spec_clear(&specs[0]);
+    ndt_apply_spec_clear(&specs[1]);
+    count++;
 
-    if (x.hash != -1 || ctx.err != NDT_MemoryError) {
-        fprintf(stderr, "test_hash: FAIL: expected failure, got %" PRI_ndt_ssize "\n\n", x.hash);
-        ndt_context_del(&ctx);
-        return -1;
+    /* Unrelated nodes may bind the same symbol to different shapes. */
+    nodes[0].sig = vector;
+    nodes[0].in = first_input;
+    nodes[1].sig = vector;
+    nodes[1].in = second_input;
+    if (ndt_graph_typecheck(specs, nodes, 2, vectors, 2, ctx) < 0) {
+        fprintf(stderr, "test_graph_typecheck: FAIL: unexpected failure: %s\n",
+                ndt_context_msg(ctx));
+        goto out;
+    }
+    if (!ndt_equal(specs[0].types[1], vectors[0]) ||
+        !ndt_equal(specs[1].types[1], vectors[1])) {
+        fprintf(stderr, "test_graph_typecheck: FAIL: unexpected independent bindings\n");
+        ndt_apply_spec_clear(&specs[0]);
+        ndt_apply_spec_clear(&specs[1]);
+        goto out;
     }
+    ndt_apply_spec_clear(&specs[0]);
+    ndt_apply_spec_clear(&specs[1]);
+    count++;
 
-    ndt_context_del(&ctx);
-    fprintf(stderr, "test_hash (%d test cases)\n", (int)n);
+    /* Along an edge the consumer sees the shape bound by the producer:
+       N is 2 on the edge, so the 3 element input cannot bind it. */
+    nodes[1].sig = pair;
+    nodes[1].in = second_in;
+    if (ndt_graph_typecheck(specs, nodes, 2, vectors, 2, ctx) != -1 ||
+        ctx->err != NDT_TypeError || specs[0].nargs != 0) {
+        fprintf(stderr, "test_graph_typecheck: FAIL: expected TypeError along edge\n");
+        goto out;
+    }
+    ndt_err_clear(ctx);
+    count++;
 
-    return 0;
+    fprintf(stderr, "test_graph_typecheck (%d test cases)\n", count);
+    ret = 0;
+
+out:
+    ndt_decref(matmul);
+    ndt_decref(unary);
+    ndt_decref(inputs[0]);
+    ndt_decref(inputs[1]);
+    ndt_decref(expected);
+    ndt_decref(rows);
+    ndt_decref(cols);
+    ndt_decref(vector);
+    ndt_decref(pair);
+    ndt_decref(vectors[0]);
+    ndt_decref(vectors[1]);
+    ndt_context_del(ctx);
+    return ret;
 }
 
 static int
-test_copy(void)
+test_tiled(void)
 {
-    NDT_STATIC_CONTEXT(ctx);
-    const char **c;
-    const ndt_t *t, *u;
+    const int64_t tiles[2] = {2, 3};
+    const int64_t li[1] = {0};
+    const ndt_t *types[2] = {NULL, NULL};
+    const ndt_t *base = NULL, *sig = NULL, *pattern = NULL;
+    const ndt_t *t = NULL, *u = NULL;
+    const ndt_t *inner;
+    ndt_apply_spec_t spec = ndt_apply_spec_empty;
+    ndt_context_t *ctx;
+    char *bytes = NULL;
+    int64_t len;
     int count = 0;
+    int ret = -1;
 
-    for (c = parse_tests; *c != NULL; c++) {
-        t = ndt_from_string(*c, &ctx);
-        if (t == NULL) {
-            fprintf(stderr, "test_copy: FAIL: from_string: \"%s\"\n", *c);
-            fprintf(stderr, "test_copy: FAIL: got: %s: %s\n\n",
-                    ndt_err_as_string(ctx.err),
-                    ndt_context_msg(&ctx));
-            ndt_context_del(&ctx);
-            return -1;
-        }
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
 
-        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
-            ndt_err_clear(&ctx);
+    base = ndt_from_string("5 * 4 * 6 * float64", ctx);
+    sig = ndt_from_string("... * N * M * float64 -> ... * N * M * float64", ctx);
+    pattern = ndt_from_string("N * M * float64", ctx);
+    if (base == NULL || sig == NULL || pattern == NULL) {
+        fprintf(stderr, "test_tiled: FAIL: unexpected failure in from_string\n");
+        goto out;
+    }
 
-            ndt_set_alloc_fail();
-            u = ndt_copy(t, &ctx);
-            ndt_set_alloc();
+    for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+        ndt_err_clear(ctx);
 
-            if (ctx.err != NDT_MemoryError) {
-                break;
-            }
+        ndt_set_alloc_fail();
+        t = ndt_tiled(base, tiles, 2, ctx);
+        ndt_set_alloc();
 
-            if (u != NULL) {
-                fprintf(stderr, "test_copy: FAIL: unexpected success: \"%s\"\n", *c);
-                ndt_decref(u);
-                ndt_decref(t);
-                ndt_context_del(&ctx);
-                return -1;
-            }
+        if (ctx->err != NDT_MemoryError) {
+            break;
         }
-        if (u == NULL) {
-            fprintf(stderr, "test_copy: FAIL: copying failed: \"%s\"\n", *c);
-            fprintf(stderr, "test_copy: FAIL: got: %s: %s\n\n",
-                    ndt_err_as_string(ctx.err),
-                    ndt_context_msg(&ctx));
-            ndt_decref(t);
-            ndt_context_del(&ctx);
-            return -1;
+
+        if (t != NULL) {
+            fprintf(stderr, "test_tiled: FAIL: t != NULL after MemoryError\n");
+            goto out;
         }
+    }
 
-        if (!ndt_equal(t, u)) {
-            fprintf(stderr, "test_copy: FAIL: copy: not equal\n\n");
-            ndt_decref(t);
+    if (t == NULL) {
+        fprintf(stderr, "test_tiled: FAIL: unexpected failure: %s\n",
+                ndt_context_msg(ctx));
+        goto out;
+    }
+
+    /* 4 x 6 blocks of 2 x 3 tiles: 4 tiles of 6 elements per block. */
+    inner = t->FixedDim.type;
+    if (t->datasize != base->datasize || !(t->flags & NDT_TILED) ||
+        t->Concrete.FixedDim.tile != 0 || t->Concrete.FixedDim.step != 24 ||
+        inner->Concrete.FixedDim.tile != 2 || inner->Concrete.FixedDim.step != 3 ||
+        inner->Concrete.FixedDim.tile_step != 12 ||
+        inner->FixedDim.type->Concrete.FixedDim.tile != 3 ||
+        inner->FixedDim.type->Concrete.FixedDim.step != 1 ||
+        inner->FixedDim.type->Concrete.FixedDim.tile_step != 6) {
+        fprintf(stderr, "test_tiled: FAIL: unexpected tile geometry\n");
+        goto out;
+    }
+    count++;
+
+    if (ndt_is_ndarray(t) || ndt_is_c_contiguous(t) || ndt_equal(t, base) ||
+        ndt_match(pattern, inner, ctx) != 1) {
+        fprintf(stderr, "test_tiled: FAIL: unexpected predicate result\n");
+        goto out;
+    }
+    count++;
+
+    if (ndt_tiled(base, (const int64_t[]){4}, 1, ctx) != NULL ||
+        ctx->err != NDT_ValueError) {
+        fprintf(stderr, "test_tiled: FAIL: expected ValueError\n");
+        goto out;
+    }
+    ndt_err_clear(ctx);
+    count++;
+
+    /* Overlapping tiles: 3 tiles of 2 elements, but tiles are 1 element apart. */
+    if (ndt_fixed_dim_tiled(ndt_primitive(Float64, 0, ctx), 6, 1, 2, 1, ctx) != NULL ||
+        ctx->err != NDT_ValueError) {
+        fprintf(stderr, "test_tiled: FAIL: expected ValueError for overlapping tiles\n");
+        goto out;
+    }
+    ndt_err_clear(ctx);
+    count++;
+
+    /* The outer dimension is broadcast, the tiled inner dimensions are kept. */
+    types[0] = t;
+    if (ndt_typecheck(&spec, sig, types, li, 1, 0, false, NULL, NULL, ctx) < 0) {
+        fprintf(stderr, "test_tiled: FAIL: unexpected failure in typecheck: %s\n",
+                ndt_context_msg(ctx));
+        goto out;
+    }
+
+    if (spec.outer_dims != 1 || spec.flags != (NDT_INNER_TILED|NDT_INNER_XND) ||
+        !ndt_equal(spec.types[0], t) ||
+        strcmp(ndt_apply_flags_as_string(&spec), "Tiled|Xnd") != 0) {
+        fprintf(stderr, "test_tiled: FAIL: unexpected kernel strategy: %s\n",
+                ndt_apply_flags_as_string(&spec));
+        ndt_apply_spec_clear(&spec);
+        goto out;
+    }
+    ndt_apply_spec_clear(&spec);
+    count++;
+
+    /* Tiled outer dimensions exclude blocked kernels. */
+    types[0] = inner;
+    types[1] = inner;
+    spec.nin = 2;
+    spec.nargs = 2;
+    spec.outer_dims = 1;
+    spec.types[0] = types[0];
+    spec.types[1] = types[1];
+    if (ndt_select_kernel_strategy(&spec, ctx) < 0 || spec.flags != NDT_INNER_XND) {
+        fprintf(stderr, "test_tiled: FAIL: unexpected kernel strategy for tiled outer dims\n");
+        goto out;
+    }
+    spec = ndt_apply_spec_empty;
+    count++;
+
+    len = ndt_serialize(&bytes, t, ctx);
+    if (len < 0) {
+        fprintf(stderr, "test_tiled: FAIL: unexpected failure in serialize\n");
+        goto out;
+    }
+
+    u = ndt_deserialize(bytes, len, ctx);
+    if (u == NULL || !ndt_equal(u, t)) {
+        fprintf(stderr, "test_tiled: FAIL: serialize roundtrip\n");
+        goto out;
+    }
+    count++;
+
+    fprintf(stderr, "test_tiled (%d test cases)\n", count);
+    ret = 0;
+
+out:
+    ndt_free(bytes);
+    ndt_decref(base);
+    ndt_decref(sig);
+    ndt_decref(pattern);
+    ndt_decref(t);
+    ndt_decref(u);
+    ndt_context_del(ctx);
+    return ret;
+}
+
+static int
+test_all_valid(void)
+{
+    const int64_t li[2] = {0, 0};
+    const ndt_t *types[2] = {NULL, NULL};
+    const ndt_t *base = NULL, *rec = NULL, *opt = NULL;
+    const ndt_t *t = NULL, *u = NULL, *v = NULL;
+    ndt_apply_spec_t spec = ndt_apply_spec_empty;
+    ndt_ndarray_t args[2];
+    ndt_ndarray_spec_t nd = { .args=args };
+    ndt_context_t *ctx;
+    char *bytes = NULL;
+    int64_t len;
+    int count = 0;
+    int ret = -1;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    base = ndt_from_string("10 * 2 * ?float64", ctx);
+    rec = ndt_from_string("{a: ?int64, b: string}", ctx);
+    opt = ndt_from_string("... * ?float64 -> ... * ?float64", ctx);
+    if (base == NULL || rec == NULL || opt == NULL) {
+        fprintf(stderr, "test_all_valid: FAIL: unexpected failure in from_string\n");
+        goto out;
+    }
+
+    for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+        ndt_err_clear(ctx);
+
+        ndt_set_alloc_fail();
+        t = ndt_all_valid(base, ctx);
+        ndt_set_alloc();
+
+        if (ctx->err != NDT_MemoryError) {
+            break;
+        }
+
+        if (t != NULL) {
+            fprintf(stderr, "test_all_valid: FAIL: t != NULL after MemoryError\n");
+            goto out;
+        }
+    }
+
+    if (t == NULL) {
+        fprintf(stderr, "test_all_valid: FAIL: unexpected failure: %s\n",
+                ndt_context_msg(ctx));
+        goto out;
+    }
+
+    if (ndt_is_all_valid(base) || !ndt_is_all_valid(t) ||
+        !(ndt_dtype(t)->flags & NDT_ALL_VALID) || !ndt_is_optional(ndt_dtype(t)) ||
+        !ndt_equal(t, base) || !ndt_equal(base, t) || ndt_match(base, t, ctx) != 1) {
+        fprintf(stderr, "test_all_valid: FAIL: unexpected hint\n");
+        goto out;
+    }
+    count++;
+
+    /* Record fields are not visited. */
+    u = ndt_all_valid(rec, ctx);
+    if (u == NULL || u != rec || ndt_is_all_valid(u)) {
+        fprintf(stderr, "test_all_valid: FAIL: unexpected record hint\n");
+        goto out;
+    }
+    ndt_decref(u);
+    count++;
+
+    u = ndt_copy_contiguous(t, 0, ctx);
+    if (u == NULL || !ndt_is_all_valid(u)) {
+        fprintf(stderr, "test_all_valid: FAIL: hint not preserved by copy_contiguous\n");
+        goto out;
+    }
+    ndt_decref(u);
+    count++;
+
+    /* Explicit output types keep the hint. */
+    types[0] = t;
+    types[1] = t;
+    if (ndt_typecheck(&spec, opt, types, li, 1, 1, true, NULL, NULL, ctx) < 0) {
+        fprintf(stderr, "test_all_valid: FAIL: unexpected failure in typecheck: %s\n",
+                ndt_context_msg(ctx));
+        goto out;
+    }
+
+    if (!(spec.flags & NDT_INNER_VALID) || !ndt_is_all_valid(spec.types[1]) ||
+        strcmp(ndt_apply_flags_as_string(&spec), "unknown flags") == 0) {
+        fprintf(stderr, "test_all_valid: FAIL: hint not propagated by typecheck\n");
+        ndt_apply_spec_clear(&spec);
+        goto out;
+    }
+    ndt_apply_spec_clear(&spec);
+    count++;
+
+    /*
+     * ?float64 -> ?float64: the flag only depends on the inputs.  Inferred
+     * outputs may contain missing values and do not carry the hint.
+     */
+    if (ndt_typecheck(&spec, opt, types, li, 1, 0, false, NULL, NULL, ctx) < 0) {
+        fprintf(stderr, "test_all_valid: FAIL: unexpected failure in typecheck: %s\n",
+                ndt_context_msg(ctx));
+        goto out;
+    }
+
+    if (!(spec.flags & NDT_INNER_VALID) || ndt_is_all_valid(spec.types[1])) {
+        fprintf(stderr, "test_all_valid: FAIL: unexpected valid flag for inferred output\n");
+        ndt_apply_spec_clear(&spec);
+        goto out;
+    }
+    ndt_apply_spec_clear(&spec);
+    count++;
+
+    /* A hinted input checks against an explicit output without the hint. */
+    types[0] = t;
+    types[1] = base;
+    if (ndt_typecheck(&spec, opt, types, li, 1, 1, true, NULL, NULL, ctx) < 0) {
+        fprintf(stderr, "test_all_valid: FAIL: unexpected failure in typecheck: %s\n",
+                ndt_context_msg(ctx));
+        goto out;
+    }
+
+    if (!(spec.flags & NDT_INNER_VALID) || ndt_is_all_valid(spec.types[1])) {
+        fprintf(stderr, "test_all_valid: FAIL: unexpected flags for plain output\n");
+        ndt_apply_spec_clear(&spec);
+        goto out;
+    }
+    ndt_apply_spec_clear(&spec);
+    count++;
+
+    if (ndt_typecheck_ndarray(&nd, opt, types, 1, 0, ctx) < 0 ||
+        !(nd.flags & NDT_INNER_VALID)) {
+        fprintf(stderr, "test_all_valid: FAIL: unexpected failure in typecheck_ndarray: %s\n",
+                ndt_context_msg(ctx));
+        goto out;
+    }
+    count++;
+
+    /* Inputs without the hint never set the flag. */
+    types[0] = base;
+    types[1] = t;
+    if (ndt_typecheck(&spec, opt, types, li, 1, 1, true, NULL, NULL, ctx) == 0 &&
+        (spec.flags & NDT_INNER_VALID)) {
+        fprintf(stderr, "test_all_valid: FAIL: unexpected valid flag for plain input\n");
+        ndt_apply_spec_clear(&spec);
+        goto out;
+    }
+    ndt_apply_spec_clear(&spec);
+    ndt_err_clear(ctx);
+    count++;
+
+    len = ndt_serialize(&bytes, t, ctx);
+    if (len < 0) {
+        fprintf(stderr, "test_all_valid: FAIL: unexpected failure in serialize\n");
+        goto out;
+    }
+
+    v = ndt_deserialize(bytes, len, ctx);
+    if (v == NULL || !ndt_equal(v, t) || !ndt_is_all_valid(v)) {
+        fprintf(stderr, "test_all_valid: FAIL: serialize roundtrip\n");
+        goto out;
+    }
+    count++;
+
+    fprintf(stderr, "test_all_valid (%d test cases)\n", count);
+    ret = 0;
+
+out:
+    ndt_free(bytes);
+    ndt_decref(base);
+    ndt_decref(rec);
+    ndt_decref(opt);
+    ndt_decref(t);
+    ndt_decref(v);
+    ndt_context_del(ctx);
+    return ret;
+}
+
+static int
+test_symbol_intern(void)
+{
+    const char *s = "... * N * M * float64, ... * M * P * float64 -> ... * N * P * float64";
+    const ndt_t *t = NULL, *u = NULL, *v = NULL;
+    const ndt_t *a0, *a1;
+    ndt_context_t *ctx;
+    char *bytes = NULL;
+    int64_t len;
+    int count = 0;
+    int ret = -1;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    if (ndt_symbol_intern_enable(ctx) < 0) {
+        fprintf(stderr, "test_symbol_intern: FAIL: could not enable interning\n");
+        ndt_context_del(ctx);
+        return -1;
+    }
+
+    for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+        ndt_err_clear(ctx);
+
+        ndt_set_alloc_fail();
+        t = ndt_from_string(s, ctx);
+        ndt_set_alloc();
+
+        if (ctx->err != NDT_MemoryError) {
+            break;
+        }
+
+        if (t != NULL || ndt_symbol_intern_size() != 0) {
+            fprintf(stderr, "test_symbol_intern: FAIL: leftover entries after MemoryError\n");
+            goto out;
+        }
+    }
+
+    if (t == NULL) {
+        fprintf(stderr, "test_symbol_intern: FAIL: unexpected failure: %s\n",
+                ndt_context_msg(ctx));
+        goto out;
+    }
+
+    /* "M" is shared by both arguments. */
+    a0 = t->Function.types[0]->EllipsisDim.type;
+    a1 = t->Function.types[1]->EllipsisDim.type;
+    if (ndt_symbol_intern_size() != 3 ||
+        a0->SymbolicDim.type->SymbolicDim.name != a1->SymbolicDim.name) {
+        fprintf(stderr, "test_symbol_intern: FAIL: names are not shared\n");
+        goto out;
+    }
+    count++;
+
+    u = ndt_from_string("N * M * int64", ctx);
+    if (u == NULL || ndt_symbol_intern_size() != 3 ||
+        u->SymbolicDim.name != a0->SymbolicDim.name) {
+        fprintf(stderr, "test_symbol_intern: FAIL: names are not shared across types\n");
+        goto out;
+    }
+    count++;
+
+    len = ndt_serialize(&bytes, t, ctx);
+    if (len < 0) {
+        fprintf(stderr, "test_symbol_intern: FAIL: unexpected failure in serialize\n");
+        goto out;
+    }
+
+    v = ndt_deserialize(bytes, len, ctx);
+    if (v == NULL || !ndt_equal(v, t) ||
+        v->Function.types[0]->EllipsisDim.type->SymbolicDim.name != a0->SymbolicDim.name) {
+        fprintf(stderr, "test_symbol_intern: FAIL: names are not shared after deserializing\n");
+        goto out;
+    }
+    count++;
+
+    /* Shared names stay valid after interning is disabled. */
+    ndt_symbol_intern_disable();
+    ndt_decref(t); t = NULL;
+    ndt_decref(v); v = NULL;
+
+    if (ndt_symbol_intern_size() != 2 || strcmp(u->SymbolicDim.name, "N") != 0) {
+        fprintf(stderr, "test_symbol_intern: FAIL: unexpected entries after disabling\n");
+        goto out;
+    }
+
+    ndt_decref(u); u = NULL;
+
+    if (ndt_symbol_intern_size() != 0) {
+        fprintf(stderr, "test_symbol_intern: FAIL: entries not removed after decref\n");
+        goto out;
+    }
+    count++;
+
+    fprintf(stderr, "test_symbol_intern (%d test cases)\n", count);
+    ret = 0;
+
+out:
+    ndt_free(bytes);
+    ndt_decref(t);
+    ndt_decref(u);
+    ndt_decref(v);
+    ndt_symbol_intern_disable();
+    ndt_context_del(ctx);
+    return ret;
+}
+
+static int
+test_match_batch(void)
+{
+    const char *s[5] = {"3 * int64", "3 * float64", "5 * int64", "{a: int64}", "N * int64"};
+    const int idx[10] = {0, 0, 1, 2, 3, 0, 4, 2, 2, 1};
+    const ndt_t *t[5] = {NULL, NULL, NULL, NULL, NULL};
+    const ndt_t *types[10];
+    const ndt_t *p = NULL, *eq = NULL;
+    ndt_context_t *ctx;
+    uint8_t bitmap[2];
+    int64_t n = -1;
+    int count = 0;
+    int ret = -1;
+    int i;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (i = 0; i < 5; i++) {
+        t[i] = ndt_from_string(s[i], ctx);
+        if (t[i] == NULL) {
+            fprintf(stderr, "test_match_batch: FAIL: unexpected failure in from_string\n");
+            goto out;
+        }
+    }
+
+    p = ndt_from_string("N * int64", ctx);
+    eq = ndt_from_string("3 * int64", ctx);
+    if (p == NULL || eq == NULL) {
+        fprintf(stderr, "test_match_batch: FAIL: unexpected failure in from_string\n");
+        goto out;
+    }
+
+    for (i = 0; i < 10; i++) {
+        types[i] = t[idx[i]];
+    }
+
+    for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+        ndt_err_clear(ctx);
+
+        ndt_set_alloc_fail();
+        n = ndt_match_batch(bitmap, p, types, 10, ctx);
+        ndt_set_alloc();
+
+        if (ctx->err != NDT_MemoryError) {
+            break;
+        }
+
+        if (n != -1) {
+            fprintf(stderr, "test_match_batch: FAIL: n != -1 after MemoryError\n");
+            goto out;
+        }
+    }
+
+    if (n != 6 || bitmap[0] != 0xab || bitmap[1] != 0x01) {
+        fprintf(stderr, "test_match_batch: FAIL: unexpected match bitmap\n");
+        goto out;
+    }
+    count++;
+
+    for (i = 0; i < 10; i++) {
+        if (ndt_match(p, types[i], ctx) != !!(bitmap[i/8] & (1U << (i%8)))) {
+            fprintf(stderr, "test_match_batch: FAIL: batch and single results differ\n");
+            goto out;
+        }
+    }
+    count++;
+
+    n = ndt_equal_batch(bitmap, eq, types, 10);
+    if (n != 3 || bitmap[0] != 0x23 || bitmap[1] != 0x00) {
+        fprintf(stderr, "test_match_batch: FAIL: unexpected equal bitmap\n");
+        goto out;
+    }
+    count++;
+
+    fprintf(stderr, "test_match_batch (%d test cases)\n", count);
+    ret = 0;
+
+out:
+    for (i = 0; i < 5; i++) {
+        ndt_decref(t[i]);
+    }
+    ndt_decref(p);
+    ndt_decref(eq);
+    ndt_context_del(ctx);
+    return ret;
+}
+
+static int
+check_specialized(const ndt_t *sig, const ndt_t *types[], int nin,
+                  ndt_context_t *ctx)
+{
+    const int64_t li[NDT_MAX_ARGS] = {0};
+    ndt_apply_spec_t spec = ndt_apply_spec_empty;
+    ndt_apply_spec_t expected = ndt_apply_spec_empty;
+    ndt_typecheck_stats_t stats;
+    int ret = -1;
+
+    ndt_typecheck_specialize_disable();
+    if (ndt_typecheck(&expected, sig, types, li, nin, 0, false, NULL, NULL, ctx) < 0) {
+        goto out;
+    }
+    if (ndt_typecheck_specialize_enable(1, ctx) < 0) {
+        goto out;
+    }
+    if (ndt_typecheck(&spec, sig, types, li, nin, 0, false, NULL, NULL, ctx) < 0) {
+        goto out;
+    }
+    ndt_apply_spec_clear(&spec);
+
+    for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+        ndt_err_clear(ctx);
+
+        ndt_set_alloc_fail();
+        ret = ndt_typecheck(&spec, sig, types, li, nin, 0, false, NULL, NULL, ctx);
+        ndt_set_alloc();
+
+        if (ctx->err != NDT_MemoryError) {
+            break;
+        }
+
+        if (ret != -1 || spec.nargs != 0) {
+            ret = -1;
+            goto out;
+        }
+    }
+
+    ndt_typecheck_specialize_stats(&stats);
+    if (ret < 0 || stats.hits == 0 || spec.flags != expected.flags ||
+        spec.outer_dims != expected.outer_dims ||
+        spec.nin != expected.nin || spec.nout != expected.nout ||
+        spec.nargs != expected.nargs) {
+        ret = -1;
+        goto out;
+    }
+
+    for (int i = 0; i < spec.nargs; i++) {
+        if (!ndt_equal(spec.types[i], expected.types[i])) {
+            ret = -1;
+            goto out;
+        }
+    }
+
+out:
+    ndt_apply_spec_clear(&spec);
+    ndt_apply_spec_clear(&expected);
+    return ret;
+}
+
+static int
+test_typecheck_specialize(void)
+{
+    const int64_t li[NDT_MAX_ARGS] = {0};
+    const char *s[4] = {"2 * 3 * float64", "4 * 5 * float64", "1 * 5 * float64", "4 * 5 * int64"};
+    const ndt_t *t[4] = {NULL, NULL, NULL, NULL};
+    const ndt_t *types[2];
+    const ndt_t *sig = NULL, *transpose = NULL;
+    ndt_apply_spec_t spec = ndt_apply_spec_empty;
+    ndt_typecheck_stats_t stats;
+    ndt_context_t *ctx;
+    char buf[128];
+    int count = 0;
+    int ret = -1;
+    int i;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (i = 0; i < 4; i++) {
+        t[i] = ndt_from_string(s[i], ctx);
+        if (t[i] == NULL) {
+            fprintf(stderr, "test_typecheck_specialize: FAIL: unexpected failure in from_string\n");
+            goto out;
+        }
+    }
+
+    sig = ndt_from_string("... * float64, ... * float64 -> ... * float64", ctx);
+    transpose = ndt_from_string("N * M * float64 -> M * N * float64", ctx);
+    if (sig == NULL || transpose == NULL) {
+        fprintf(stderr, "test_typecheck_specialize: FAIL: unexpected failure in from_string\n");
+        goto out;
+    }
+
+    if (ndt_typecheck_specialize_enable(0, ctx) != -1 || ctx->err != NDT_ValueError) {
+        fprintf(stderr, "test_typecheck_specialize: FAIL: expected ValueError\n");
+        goto out;
+    }
+    ndt_err_clear(ctx);
+    count++;
+
+    if (ndt_typecheck_specialize_enable(2, ctx) < 0) {
+        fprintf(stderr, "test_typecheck_specialize: FAIL: unexpected failure in enable\n");
+        goto out;
+    }
+
+    /* The class is installed after two calls and serves all further calls. */
+    types[0] = types[1] = t[0];
+    for (i = 0; i < 3; i++) {
+        if (ndt_typecheck(&spec, sig, types, li, 2, 0, false, NULL, NULL, ctx) < 0) {
+            fprintf(stderr, "test_typecheck_specialize: FAIL: unexpected failure: %s\n",
+                    ndt_context_msg(ctx));
+            goto out;
+        }
+        ndt_apply_spec_clear(&spec);
+    }
+
+    types[0] = types[1] = t[1];
+    if (ndt_typecheck(&spec, sig, types, li, 2, 0, false, NULL, NULL, ctx) < 0 ||
+        !ndt_equal(spec.types[2], t[1])) {
+        fprintf(stderr, "test_typecheck_specialize: FAIL: unexpected specialized result\n");
+        goto out;
+    }
+    ndt_apply_spec_clear(&spec);
+
+    ndt_typecheck_specialize_stats(&stats);
+    if (stats.calls != 4 || stats.hits != 2 || stats.installed != 1) {
+        fprintf(stderr, "test_typecheck_specialize: FAIL: unexpected statistics\n");
+        goto out;
+    }
+    count++;
+
+    /* Other classes and non-elementwise signatures take the general path. */
+    types[0] = t[2];
+    types[1] = t[1];
+    if (ndt_typecheck(&spec, sig, types, li, 2, 0, false, NULL, NULL, ctx) < 0 ||
+        !ndt_equal(spec.types[2], t[1])) {
+        fprintf(stderr, "test_typecheck_specialize: FAIL: unexpected broadcast result\n");
+        goto out;
+    }
+    ndt_apply_spec_clear(&spec);
+
+    for (i = 0; i < 3; i++) {
+        if (ndt_typecheck(&spec, transpose, types, li, 1, 0, false, NULL, NULL, ctx) < 0) {
+            fprintf(stderr, "test_typecheck_specialize: FAIL: unexpected failure: %s\n",
+                    ndt_context_msg(ctx));
+            goto out;
+        }
+        ndt_apply_spec_clear(&spec);
+    }
+
+    types[0] = types[1] = t[3];
+    if (ndt_typecheck(&spec, sig, types, li, 2, 0, false, NULL, NULL, ctx) != -1 ||
+        ctx->err != NDT_TypeError) {
+        fprintf(stderr, "test_typecheck_specialize: FAIL: expected TypeError\n");
+        goto out;
+    }
+    ndt_err_clear(ctx);
+
+    ndt_typecheck_specialize_stats(&stats);
+    if (stats.calls != 9 || stats.hits != 2 || stats.installed != 1) {
+        fprintf(stderr, "test_typecheck_specialize: FAIL: unexpected statistics\n");
+        goto out;
+    }
+    count++;
+
+    /* Cold candidates are recycled when more classes are seen than fit. */
+    if (ndt_typecheck_specialize_enable(2, ctx) < 0) {
+        fprintf(stderr, "test_typecheck_specialize: FAIL: unexpected failure in enable\n");
+        goto out;
+    }
+
+    for (int m = 0; m < 64; m++) {
+        const ndt_t *u;
+        int n = 0;
+
+        /* Each mask of non-trivial dimensions is a separate class. */
+        for (int k = 0; k < 6; k++) {
+            n += snprintf(buf+n, sizeof buf - n, "%d * ", (m >> k) & 1 ? 2 : 1);
+        }
+        snprintf(buf+n, sizeof buf - n, "float64");
+
+        u = ndt_from_string(buf, ctx);
+        if (u == NULL) {
+            fprintf(stderr, "test_typecheck_specialize: FAIL: unexpected failure in from_string\n");
+            goto out;
+        }
+
+        types[0] = types[1] = u;
+        for (i = 0; i < (m == 63 ? 3 : 1); i++) {
+            if (ndt_typecheck(&spec, sig, types, li, 2, 0, false, NULL, NULL, ctx) < 0) {
+                fprintf(stderr, "test_typecheck_specialize: FAIL: unexpected failure: %s\n",
+                        ndt_context_msg(ctx));
+                ndt_decref(u);
+                goto out;
+            }
+            ndt_apply_spec_clear(&spec);
+        }
+        ndt_decref(u);
+    }
+
+    ndt_typecheck_specialize_stats(&stats);
+    if (stats.calls != 66 || stats.hits != 1 || stats.installed != 1) {
+        fprintf(stderr, "test_typecheck_specialize: FAIL: unexpected statistics\n");
+        goto out;
+    }
+    count++;
+
+    for (i = 0; i < 2; i++) {
+        types[0] = types[1] = t[i];
+        if (check_specialized(sig, types, 2, ctx) < 0) {
+            fprintf(stderr, "test_typecheck_specialize: FAIL: specialized result differs\n");
+            goto out;
+        }
+        count++;
+    }
+
+    ret = 0;
+    fprintf(stderr, "test_typecheck_specialize (%d test cases)\n", count);
+
+out:
+    ndt_typecheck_specialize_disable();
+    ndt_apply_spec_clear(&spec);
+    for (i = 0; i < 4; i++) {
+        ndt_decref(t[i]);
+    }
+    ndt_decref(sig);
+    ndt_decref(transpose);
+    ndt_context_del(ctx);
+    return ret;
+}
+
+static int
+test_context_default(void)
+{
+    NDT_STATIC_CONTEXT(local);
+    char buffer[64];
+    char longname[512];
+    ndt_context_t *ctx;
+    const ndt_t *t;
+    int count = 0;
+
+    ctx = ndt_context_default();
+    if (ctx == NULL || ctx != ndt_context_default() || ctx->buffer == NULL) {
+        fprintf(stderr, "test_context_default: FAIL: invalid default context\n");
+        return -1;
+    }
+    count++;
+
+    /* Messages that fit into the buffer do not allocate. */
+    alloc_fail = 1;
+    ndt_set_alloc_fail();
+    ndt_err_format(ctx, NDT_ValueError, "invalid value: %d", 10);
+    ndt_set_alloc();
+
+    if (ctx->err != NDT_ValueError ||
+        strcmp(ndt_context_msg(ctx), "invalid value: 10") != 0) {
+        fprintf(stderr, "test_context_default: FAIL: unexpected error message\n");
+        return -1;
+    }
+    count++;
+
+    ndt_context_reset(ctx);
+    if (ndt_err_occurred(ctx) || strcmp(ndt_context_msg(ctx), "Success") != 0) {
+        fprintf(stderr, "test_context_default: FAIL: context not reset\n");
+        return -1;
+    }
+    count++;
+
+    /* Longer messages fall back to a dynamic message. */
+    memset(longname, 'x', sizeof longname - 1);
+    longname[sizeof longname - 1] = '\0';
+    ndt_err_format(ctx, NDT_ValueError, "%s", longname);
+    if (ctx->err != NDT_ValueError || ctx->msg != DynamicMsg ||
+        strcmp(ndt_context_msg(ctx), longname) != 0) {
+        fprintf(stderr, "test_context_default: FAIL: unexpected long error message\n");
+        ndt_context_reset(ctx);
+        return -1;
+    }
+    ndt_context_reset(ctx);
+    count++;
+
+    /* The current message can be used as an argument without allocating. */
+    ndt_err_format(ctx, NDT_ValueError, "invalid value: %d", 10);
+    alloc_fail = 1;
+    ndt_set_alloc_fail();
+    ndt_err_format(ctx, NDT_TypeError, "%s: %s", ndt_context_msg(ctx), "in argument");
+    ndt_set_alloc();
+    if (ctx->err != NDT_TypeError || ndt_context_msg(ctx) != ctx->buffer ||
+        strcmp(ndt_context_msg(ctx), "invalid value: 10: in argument") != 0) {
+        fprintf(stderr, "test_context_default: FAIL: unexpected prefixed message\n");
+        ndt_context_reset(ctx);
+        return -1;
+    }
+    count++;
+
+    ndt_err_format(ctx, NDT_ValueError, "%s", longname);
+    ndt_err_format(ctx, NDT_ValueError, "%s%s", ndt_context_msg(ctx), "y");
+    if (ctx->msg != DynamicMsg || strlen(ndt_context_msg(ctx)) != sizeof longname ||
+        strncmp(ndt_context_msg(ctx), longname, sizeof longname - 1) != 0) {
+        fprintf(stderr, "test_context_default: FAIL: unexpected long prefixed message\n");
+        ndt_context_reset(ctx);
+        return -1;
+    }
+    count++;
+
+    /* ndt_finalize_thread() releases the dynamic message. */
+    ndt_finalize_thread();
+    if (ndt_err_occurred(ctx) || ctx->msg != ConstMsg) {
+        fprintf(stderr, "test_context_default: FAIL: dynamic message not released\n");
+        ndt_context_reset(ctx);
+        return -1;
+    }
+    count++;
+
+    /* A static context with a caller supplied buffer. */
+    ndt_context_set_buffer(&local, buffer, sizeof buffer);
+    t = ndt_from_string("10 * 2 * ", &local);
+    if (t != NULL || local.err != NDT_ParseError ||
+        ndt_context_msg(&local) != buffer) {
+        ndt_decref(t);
+        fprintf(stderr, "test_context_default: FAIL: expected ParseError in buffer\n");
+        ndt_context_del(&local);
+        return -1;
+    }
+    ndt_context_del(&local);
+    count++;
+
+    fprintf(stderr, "test_context_default (%d test cases)\n", count);
+
+    return 0;
+}
+
+static int
+equal_ndarray_spec(const ndt_ndarray_spec_t *spec, const ndt_apply_spec_t *expected)
+{
+    NDT_STATIC_CONTEXT(ctx);
+    ndt_ndarray_t x;
+
+    if (spec->flags != expected->flags || spec->outer_dims != expected->outer_dims ||
+        spec->nin != expected->nin || spec->nout != expected->nout ||
+        spec->nargs != expected->nargs) {
+        return 0;
+    }
+
+    for (int i = 0; i < spec->nargs; i++) {
+        const ndt_ndarray_t *a = &spec->args[i];
+
+        if (ndt_as_ndarray(&x, expected->types[i], &ctx) < 0) {
+            ndt_context_del(&ctx);
+            return 0;
+        }
+
+        if (a->ndim != x.ndim || a->itemsize != x.itemsize) {
+            return 0;
+        }
+
+        for (int k = 0; k < x.ndim; k++) {
+            if (a->shape[k] != x.shape[k] || a->strides[k] != x.strides[k] ||
+                a->steps[k] != x.steps[k]) {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+static int
+test_typecheck_ndarray(void)
+{
+    const struct {
+        const char *sig;
+        const char *args[3];
+        int nin;
+        int nout;
+    } tests[] = {
+      { "... * float64, ... * float64 -> ... * float64", {"2 * 3 * float64", "3 * float64"}, 2, 0 },
+      { "... * float64, ... * float64 -> ... * float64", {"2 * 1 * float64", "5 * float64"}, 2, 0 },
+      { "... * N * M * float64, ... * M * P * float64 -> ... * N * P * float64",
+        {"10 * 2 * 3 * float64", "3 * 4 * float64"}, 2, 0 },
+      { "N * T -> N * T", {"5 * int32"}, 1, 0 },
+      { "... * ?float64 -> ... * ?float64", {"2 * 3 * ?float64"}, 1, 0 },
+      { "... * float64 -> ... * float64", {"2 * 3 * float64", "2 * 3 * float64"}, 1, 1 },
+    };
+    const struct {
+        const char *sig;
+        const char *args[3];
+        int nin;
+        int nout;
+        enum ndt_error err;
+    } errors[] = {
+      { "... * float64, ... * float64 -> ... * float64", {"2 * 3 * float64", "4 * 3 * float64"}, 2, 0, NDT_TypeError },
+      { "... * float64, ... * float64 -> ... * float64", {"3 * float64", "3 * int64"}, 2, 0, NDT_TypeError },
+      { "N * N * float64 -> N * float64", {"2 * 3 * float64"}, 1, 0, NDT_TypeError },
+      { "... * float64 -> ... * float64", {"2 * 3 * float64", "3 * float64"}, 1, 1, NDT_ValueError },
+      { "var * float64 -> var * float64", {"var(offsets=[0,2]) * float64"}, 1, 0, NDT_NotImplementedError },
+      { "Dims... * float64 -> Dims... * float64", {"2 * float64"}, 1, 0, NDT_NotImplementedError },
+      { "... * float64 -> ... * float64", {"var(offsets=[0,2]) * float64"}, 1, 0, NDT_NotImplementedError },
+      { "... * float64 -> ... * float64", {"2 * float64", "var(offsets=[0,2]) * float64"}, 1, 1, NDT_NotImplementedError },
+    };
+    const int64_t li[NDT_MAX_ARGS] = {0};
+    ndt_ndarray_t args[3];
+    ndt_ndarray_spec_t spec = { .args=args };
+    ndt_apply_spec_t expected = ndt_apply_spec_empty;
+    const ndt_t *types[3] = {NULL, NULL, NULL};
+    const ndt_t *sig = NULL;
+    ndt_context_t *ctx;
+    size_t i;
+    int count = 0;
+    int ret = -1;
+    int k, n;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (i = 0; i < sizeof tests / sizeof tests[0]; i++) {
+        n = tests[i].nin + tests[i].nout;
+
+        sig = ndt_from_string(tests[i].sig, ctx);
+        for (k = 0; k < n; k++) {
+            types[k] = ndt_from_string(tests[i].args[k], ctx);
+        }
+        if (ndt_err_occurred(ctx)) {
+            fprintf(stderr, "test_typecheck_ndarray: FAIL: unexpected failure in from_string\n");
+            goto out;
+        }
+
+        if (ndt_typecheck(&expected, sig, types, li, tests[i].nin, tests[i].nout,
+                          false, NULL, NULL, ctx) < 0) {
+            fprintf(stderr, "test_typecheck_ndarray: FAIL: unexpected failure: %s\n",
+                    ndt_context_msg(ctx));
+            goto out;
+        }
+
+        /* No types are constructed, so memory allocation never fails. */
+        alloc_fail = 1;
+        ndt_set_alloc_fail();
+        ret = ndt_typecheck_ndarray(&spec, sig, types, tests[i].nin, tests[i].nout, ctx);
+        ndt_set_alloc();
+
+        if (ret < 0 || !equal_ndarray_spec(&spec, &expected)) {
+            fprintf(stderr, "test_typecheck_ndarray: FAIL: unexpected result: \"%s\"\n",
+                    tests[i].sig);
+            ret = -1;
+            goto out;
+        }
+        ret = -1;
+
+        ndt_apply_spec_clear(&expected);
+        ndt_decref(sig);
+        sig = NULL;
+        for (k = 0; k < n; k++) {
+            ndt_decref(types[k]);
+            types[k] = NULL;
+        }
+        count++;
+    }
+
+    for (i = 0; i < sizeof errors / sizeof errors[0]; i++) {
+        n = errors[i].nin + errors[i].nout;
+
+        sig = ndt_from_string(errors[i].sig, ctx);
+        for (k = 0; k < n; k++) {
+            types[k] = ndt_from_string(errors[i].args[k], ctx);
+        }
+        if (ndt_err_occurred(ctx)) {
+            fprintf(stderr, "test_typecheck_ndarray: FAIL: unexpected failure in from_string\n");
+            goto out;
+        }
+
+        if (ndt_typecheck_ndarray(&spec, sig, types, errors[i].nin, errors[i].nout, ctx) != -1 ||
+            ctx->err != errors[i].err) {
+            fprintf(stderr, "test_typecheck_ndarray: FAIL: expected %s: \"%s\"\n",
+                    ndt_err_as_string(errors[i].err), errors[i].sig);
+            goto out;
+        }
+        ndt_err_clear(ctx);
+
+        ndt_decref(sig);
+        sig = NULL;
+        for (k = 0; k < n; k++) {
+            ndt_decref(types[k]);
+            types[k] = NULL;
+        }
+        count++;
+    }
+
+    fprintf(stderr, "test_typecheck_ndarray (%d test cases)\n", count);
+    ret = 0;
+
+out:
+    ndt_apply_spec_clear(&expected);
+    ndt_decref(sig);
+    for (k = 0; k < 3; k++) {
+        ndt_decref(types[k]);
+    }
+    ndt_context_del(ctx);
+    return ret;
+}
+
+static int
+test_copy_contiguous_at(void)
+{
+    const struct {
+        const char *type;
+        int n;
+        const char *dtype;
+        const char *expected;
+        bool shared;
+    } tests[] = {
+      { "10 * 2 * float64", 1, NULL, "2 * float64", false },
+      { "10 * 2 * float64", 1, "int8", "2 * int8", false },
+      { "var(offsets=[0,2]) * var(offsets=[0,3,5]) * float64", 0, NULL,
+        "var(offsets=[0,2]) * var(offsets=[0,3,5]) * float64", true },
+      { "var(offsets=[0,2]) * var(offsets=[0,3,5]) * float64", 1, NULL,
+        "var(offsets=[0,3,5]) * float64", true },
+      { "var(offsets=[0,2]) * var(offsets=[0,3,5]) * float64", 1, "int8",
+        "var(offsets=[0,3,5]) * int8", true },
+      { "var(offsets=[0,2]) * var(offsets=[0,1,3]) * var(offsets=[0,2,4,7]) * int32", 1, "float64",
+        "var(offsets=[0,1,3]) * var(offsets=[0,2,4,7]) * float64", true },
+      { "var(offsets=[0,2]) * var(offsets=[0,1,3]) * var(offsets=[0,2,4,7]) * int32", 2, NULL,
+        "var(offsets=[0,2,4,7]) * int32", true },
+      { "var(offsets=[0,2]) * var(offsets=[0,1,3]) * var(offsets=[0,2,4,7]) * int32", 3, "float64",
+        "float64", false },
+      { "var(offsets=[0,2]) * var(offsets=[1,3,5]) * float64", 1, NULL,
+        "var(offsets=[0,2,4]) * float64", false },
+      { "var(offsets=[0,1]) * var(offsets=[0,2]) * var(offsets=[1,3,5]) * int32", 1, "uint8",
+        "var(offsets=[0,2]) * var(offsets=[0,2,4]) * uint8", false },
+    };
+    ndt_context_t *ctx;
+    const ndt_t *t = NULL, *dtype = NULL, *expected = NULL, *r = NULL;
+    const ndt_t *u;
+    size_t i;
+    int count = 0;
+    int ret = -1;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (i = 0; i < sizeof tests / sizeof tests[0]; i++) {
+        t = ndt_from_string(tests[i].type, ctx);
+        expected = ndt_from_string(tests[i].expected, ctx);
+        dtype = tests[i].dtype ? ndt_from_string(tests[i].dtype, ctx) : NULL;
+        if (t == NULL || expected == NULL || ndt_err_occurred(ctx)) {
+            fprintf(stderr, "test_copy_contiguous_at: FAIL: unexpected failure in from_string\n");
+            goto out;
+        }
+
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            ndt_set_alloc_fail();
+            r = ndt_copy_contiguous_at(t, tests[i].n, dtype, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (r != NULL) {
+                fprintf(stderr, "test_copy_contiguous_at: FAIL: r != NULL after MemoryError\n");
+                goto out;
+            }
+        }
+
+        if (r == NULL || !ndt_equal(r, expected)) {
+            fprintf(stderr, "test_copy_contiguous_at: FAIL: unexpected result for \"%s\"\n",
+                    tests[i].type);
+            goto out;
+        }
+
+        if (tests[i].shared) {
+            u = ndt_logical_dim_at(t, tests[i].n);
+            if (r->Concrete.VarDim.offsets != u->Concrete.VarDim.offsets) {
+                fprintf(stderr, "test_copy_contiguous_at: FAIL: offsets not shared\n");
+                goto out;
+            }
+        }
+
+        ndt_decref(t);
+        ndt_decref(dtype);
+        ndt_decref(expected);
+        ndt_decref(r);
+        t = dtype = expected = r = NULL;
+        count++;
+    }
+
+    t = ndt_from_string("var(offsets=[0,2]) * var(offsets=[0,3,5]) * float64", ctx);
+    if (t == NULL) {
+        fprintf(stderr, "test_copy_contiguous_at: FAIL: unexpected failure in from_string\n");
+        goto out;
+    }
+
+    r = ndt_copy_contiguous_at(t, 3, NULL, ctx);
+    if (r != NULL || ctx->err != NDT_ValueError) {
+        fprintf(stderr, "test_copy_contiguous_at: FAIL: expected ValueError\n");
+        goto out;
+    }
+    ndt_err_clear(ctx);
+    count++;
+
+    fprintf(stderr, "test_copy_contiguous_at (%d test cases)\n", count);
+    ret = 0;
+
+out:
+    ndt_decref(t);
+    ndt_decref(dtype);
+    ndt_decref(expected);
+    ndt_decref(r);
+    ndt_context_del(ctx);
+    return ret;
+}
+
+static int
+test_typecheck_reduce(void)
+{
+    const struct {
+        const char *type;
+        int axes[3];
+        int naxes; /* -1: reduce all */
+        bool keepdims;
+        const char *out;
+        const char *inner; /* output in loop order */
+        int outer_dims;
+        uint32_t flags;
+    } tests[] = {
+      { "2 * 3 * 4 * float64", {2}, 1, false, "2 * 3 * float64", "2 * 3 * float64", 2,
+        NDT_INNER_C|NDT_INNER_F|NDT_INNER_STRIDED|NDT_EXT_C|NDT_EXT_ZERO|NDT_EXT_STRIDED|NDT_INNER_XND },
+      { "2 * 3 * 4 * float64", {-1}, 1, true, "2 * 3 * 1 * float64", "2 * 3 * float64", 2,
+        NDT_INNER_C|NDT_INNER_F|NDT_INNER_STRIDED|NDT_EXT_C|NDT_EXT_ZERO|NDT_EXT_STRIDED|NDT_INNER_XND },
+      { "2 * 3 * 4 * float64", {1}, 1, false, "2 * 4 * float64", "2 * 4 * float64", 2,
+        NDT_INNER_STRIDED|NDT_EXT_STRIDED|NDT_INNER_XND },
+      { "2 * 3 * 4 * float64", {0, 2}, 2, true, "1 * 3 * 1 * float64", "3 * float64", 1,
+        NDT_INNER_STRIDED|NDT_EXT_STRIDED|NDT_INNER_XND },
+      { "2 * 3 * 4 * float64", {0}, -1, false, "float64", "float64", 0,
+        NDT_INNER_C|NDT_INNER_STRIDED|NDT_INNER_XND },
+      { "var(offsets=[0,2]) * var(offsets=[0,3,5]) * float64", {1}, 1, false,
+        "var(offsets=[0,2]) * float64", "var(offsets=[0,2]) * float64", 1, NDT_INNER_XND },
+      { "var(offsets=[0,2]) * var(offsets=[0,3,5]) * float64", {1}, 1, true,
+        "var(offsets=[0,2]) * var(offsets=[0,1,2]) * float64", "var(offsets=[0,2]) * float64", 1,
+        NDT_INNER_XND },
+      { "var(offsets=[0,2]) * var(offsets=[0,3,5]) * float64", {0}, -1, true,
+        "var(offsets=[0,1]) * var(offsets=[0,1]) * float64", "float64", 0, NDT_INNER_XND },
+      { "var(offsets=[0,2]) * var(offsets=[1,3,5]) * var(offsets=[0,1,2,3,4,5]) * int8", {2}, 1, false,
+        "var(offsets=[0,2]) * var(offsets=[0,2,4]) * int8", "var(offsets=[0,2]) * var(offsets=[0,2,4]) * int8", 2,
+        NDT_INNER_XND },
+    };
+    ndt_apply_spec_t spec = ndt_apply_spec_empty;
+    ndt_context_t *ctx;
+    const ndt_t *t = NULL, *out = NULL, *inner = NULL, *r = NULL;
+    size_t i;
+    int count = 0;
+    int ret = -1;
+    int n = -1;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (i = 0; i < sizeof tests / sizeof tests[0]; i++) {
+        t = ndt_from_string(tests[i].type, ctx);
+        out = ndt_from_string(tests[i].out, ctx);
+        inner = ndt_from_string(tests[i].inner, ctx);
+        if (t == NULL || out == NULL || inner == NULL) {
+            fprintf(stderr, "test_typecheck_reduce: FAIL: unexpected failure in from_string\n");
+            goto out;
+        }
+
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            ndt_set_alloc_fail();
+            n = ndt_typecheck_reduce(&spec, &r, t,
+                                     tests[i].naxes < 0 ? NULL : tests[i].axes,
+                                     tests[i].naxes, tests[i].keepdims, NULL, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (n != -1 || r != NULL || spec.nargs != 0) {
+                fprintf(stderr, "test_typecheck_reduce: FAIL: invalid result after MemoryError\n");
+                goto out;
+            }
+        }
+
+        if (n < 0) {
+            fprintf(stderr, "test_typecheck_reduce: FAIL: unexpected error: %s\n",
+                    ndt_context_msg(ctx));
+            goto out;
+        }
+
+        if (!ndt_equal(r, out) || !ndt_equal(spec.types[1], inner) ||
+            spec.outer_dims != tests[i].outer_dims || spec.flags != tests[i].flags ||
+            spec.nin != 1 || spec.nout != 1) {
+            fprintf(stderr, "test_typecheck_reduce: FAIL: unexpected result for \"%s\"\n",
+                    tests[i].type);
+            goto out;
+        }
+
+        ndt_apply_spec_clear(&spec);
+        ndt_decref(t);
+        ndt_decref(out);
+        ndt_decref(inner);
+        ndt_decref(r);
+        t = out = inner = r = NULL;
+        count++;
+    }
+
+    /* The reduced axes are moved innermost. */
+    t = ndt_from_string("2 * 3 * 4 * float64", ctx);
+    inner = ndt_from_string("2 * 4 * 3 * float64", ctx);
+    if (t == NULL || inner == NULL) {
+        fprintf(stderr, "test_typecheck_reduce: FAIL: unexpected failure in from_string\n");
+        goto out;
+    }
+
+    n = ndt_typecheck_reduce(&spec, &r, t, (int[]){1}, 1, false, inner, ctx);
+    if (n != -1 || ctx->err != NDT_ValueError) {
+        fprintf(stderr, "test_typecheck_reduce: FAIL: expected ValueError for dtype\n");
+        goto out;
+    }
+    ndt_err_clear(ctx);
+    count++;
+
+    n = ndt_typecheck_reduce(&spec, &r, t, (int[]){1}, 1, false, NULL, ctx);
+    if (n < 0 || spec.types[0]->ndim != 3 ||
+        spec.types[0]->FixedDim.shape != 2 ||
+        spec.types[0]->FixedDim.type->FixedDim.shape != 4 ||
+        spec.types[0]->FixedDim.type->FixedDim.type->FixedDim.shape != 3 ||
+        spec.types[0]->FixedDim.type->FixedDim.type->Concrete.FixedDim.step != 4) {
+        fprintf(stderr, "test_typecheck_reduce: FAIL: unexpected loop order\n");
+        goto out;
+    }
+    ndt_apply_spec_clear(&spec);
+    ndt_decref(r);
+    r = NULL;
+    count++;
+
+    n = ndt_typecheck_reduce(&spec, &r, t, (int[]){1, -2}, 2, false, NULL, ctx);
+    if (n != -1 || ctx->err != NDT_ValueError) {
+        fprintf(stderr, "test_typecheck_reduce: FAIL: expected ValueError for axes\n");
+        goto out;
+    }
+    ndt_err_clear(ctx);
+    count++;
+
+    ndt_decref(t);
+    t = ndt_from_string("var(offsets=[0,2]) * var(offsets=[0,3,5]) * float64", ctx);
+    if (t == NULL) {
+        fprintf(stderr, "test_typecheck_reduce: FAIL: unexpected failure in from_string\n");
+        goto out;
+    }
+
+    n = ndt_typecheck_reduce(&spec, &r, t, (int[]){0}, 1, false, NULL, ctx);
+    if (n != -1 || ctx->err != NDT_NotImplementedError) {
+        fprintf(stderr, "test_typecheck_reduce: FAIL: expected NotImplementedError\n");
+        goto out;
+    }
+    ndt_err_clear(ctx);
+    count++;
+
+    n = ndt_typecheck_reduce(&spec, &r, t, (int[]){1}, 1, false, NULL, ctx);
+    if (n < 0 || spec.types[0] != t ||
+        r->Concrete.VarDim.offsets != t->Concrete.VarDim.offsets) {
+        fprintf(stderr, "test_typecheck_reduce: FAIL: offsets not shared\n");
+        goto out;
+    }
+    count++;
+
+    fprintf(stderr, "test_typecheck_reduce (%d test cases)\n", count);
+    ret = 0;
+
+out:
+    ndt_apply_spec_clear(&spec);
+    ndt_decref(t);
+    ndt_decref(out);
+    ndt_decref(inner);
+    ndt_decref(r);
+    ndt_context_del(ctx);
+    return ret;
+}
+
+static int
+test_utf8(void)
+{
+    const struct {
+        const char *s;
+        enum ndt_encoding encoding;
+        int64_t expected;
+    } tests[] = {
+      { "", Utf8, 0 },
+      { "abcdefghijklmnopqrstuvwxyz", Ascii, 26 },
+      { "abcdefghijklmnopqrstuvwxyz", Utf32, 26 },
+      { "abcdefgh\xc3\xa9ijklmnop", Ascii, -1 },
+      { "abcdefgh\xc3\xa9ijklmnop", Utf8, 18 },
+      { "abcdefgh\xc3\xa9ijklmnop", Utf32, 17 },
+      { "\xe2\x82\xac\xf0\x9f\x98\x80", Utf8, 7 },
+      { "\xe2\x82\xac\xf0\x9f\x98\x80", Ucs2, -1 },
+      { "\xe2\x82\xac\xf0\x9f\x98\x80", Utf16, 3 },
+      { "\xe2\x82\xac\xf0\x9f\x98\x80", Utf32, 2 },
+      { "\xc0\x80", Utf8, -1 },                 /* overlong */
+      { "\xe0\x80\xaf", Utf8, -1 },            /* overlong */
+      { "\xed\xa0\x80", Utf8, -1 },            /* surrogate */
+      { "\xf4\x90\x80\x80", Utf8, -1 },        /* > U+10FFFF */
+      { "abcdefgh\xe2\x82", Utf8, -1 },         /* truncated */
+      { "\x80" "abc", Utf8, -1 },
+    };
+    const char *strings[5] = {"abc", "abcd", "\xc3\xa9\xc3\xa9\xc3\xa9", "\xff", "\xf0\x9f\x98\x80\xf0\x9f\x98\x80"};
+    const int64_t lengths[5] = {3, 3, 6, 1, 8};
+    NDT_STATIC_CONTEXT(ctx);
+    const ndt_t *t;
+    uint8_t bitmap[1];
+    int64_t n;
+    size_t i;
+    int count = 0;
+
+    for (i = 0; i < sizeof tests / sizeof tests[0]; i++) {
+        n = ndt_utf8_length(tests[i].s, -1, tests[i].encoding, &ctx);
+        if (n != tests[i].expected ||
+            (n < 0 && ctx.err != NDT_ValueError)) {
+            fprintf(stderr, "test_utf8: FAIL: unexpected length for case %zu\n", i);
+            ndt_context_del(&ctx);
+            return -1;
+        }
+        ndt_err_clear(&ctx);
+        count++;
+    }
+
+    /* Batch fit checks. */
+    t = ndt_fixed_string(3, Utf32, false, &ctx);
+    if (t == NULL) {
+        fprintf(stderr, "test_utf8: FAIL: unexpected failure in ndt_fixed_string\n");
+        ndt_context_del(&ctx);
+        return -1;
+    }
+
+    n = ndt_fixed_string_fits(bitmap, t, strings, lengths, 5, &ctx);
+    ndt_decref(t);
+    if (n != 4 || bitmap[0] != 0x17) {
+        fprintf(stderr, "test_utf8: FAIL: unexpected fixed_string fits\n");
+        return -1;
+    }
+    count++;
+
+    t = ndt_fixed_string(3, Utf16, false, &ctx);
+    if (t == NULL) {
+        fprintf(stderr, "test_utf8: FAIL: unexpected failure in ndt_fixed_string\n");
+        ndt_context_del(&ctx);
+        return -1;
+    }
+
+    n = ndt_fixed_string_fits(bitmap, t, strings, NULL, 5, &ctx);
+    ndt_decref(t);
+    if (n != 2 || bitmap[0] != 0x05) {
+        fprintf(stderr, "test_utf8: FAIL: unexpected fixed_string fits\n");
+        return -1;
+    }
+    count++;
+
+    /* String literals and categorical values are validated. */
+    t = ndt_from_string("categorical('\xc3\xa9t\xc3\xa9', 'hiver')", &ctx);
+    if (t == NULL) {
+        fprintf(stderr, "test_utf8: FAIL: unexpected failure in from_string\n");
+        ndt_context_del(&ctx);
+        return -1;
+    }
+    ndt_decref(t);
+    count++;
+
+    t = ndt_from_string("categorical('\xff', 'hiver')", &ctx);
+    if (t != NULL || !ndt_err_occurred(&ctx)) {
+        ndt_decref(t);
+        fprintf(stderr, "test_utf8: FAIL: expected error for invalid utf-8\n");
+        return -1;
+    }
+    ndt_context_del(&ctx);
+    count++;
+
+    fprintf(stderr, "test_utf8 (%d test cases)\n", count);
+
+    return 0;
+}
+
+static int
+test_nelem(void)
+{
+    const struct {
+        const char *type;
+        int64_t nelem;
+        int64_t total;
+        int ndim;
+        int64_t shape[3];
+    } tests[] = {
+      { "int64", 1, 1, 0, {0} },
+      { "2 * 3 * float64", 6, 6, 2, {2, 3} },
+      { "10 * {a: 2 * int64}", 10, 10, 1, {10} },
+      { "0 * 1000 * int8", 0, 0, 2, {0, 1000} },
+      { "N * int64", -1, -1, -1, {0} },
+      { "var(offsets=[0,2]) * var(offsets=[0,3,5]) * float64", 5, 5, 2, {-1, -1} },
+      { "var(offsets=[0,2]) * var(offsets=[1,3,5]) * float64", -1, 5, 2, {-1, -1} },
+      { "var(offsets=[0,3]) * var(offsets=[0,1,1,4]) * var(offsets=[0,2,2,3,7]) * int8", 7, 7, 3,
+        {-1, -1, -1} },
+    };
+    NDT_STATIC_CONTEXT(ctx);
+    int64_t shape[NDT_MAX_DIM];
+    const ndt_t *t, *u;
+    char *bytes;
+    int64_t len;
+    size_t i;
+    int count = 0;
+    int n, k;
+
+    for (i = 0; i < sizeof tests / sizeof tests[0]; i++) {
+        t = ndt_from_string(tests[i].type, &ctx);
+        if (t == NULL) {
+            fprintf(stderr, "test_nelem: FAIL: unexpected failure in from_string\n");
+            ndt_context_del(&ctx);
+            return -1;
+        }
+
+        n = ndt_logical_shape(shape, t);
+        if (ndt_nelem(t) != tests[i].nelem ||
+            ndt_var_total_nelem(t) != tests[i].total ||
+            n != tests[i].ndim) {
+            fprintf(stderr, "test_nelem: FAIL: unexpected result for \"%s\"\n",
+                    tests[i].type);
+            ndt_decref(t);
+            return -1;
+        }
+
+        for (k = 0; k < n; k++) {
+            if (shape[k] != tests[i].shape[k]) {
+                fprintf(stderr, "test_nelem: FAIL: unexpected shape for \"%s\"\n",
+                        tests[i].type);
+                ndt_decref(t);
+                return -1;
+            }
+        }
+        count++;
+
+        /* The cached values survive serialization. */
+        len = ndt_serialize(&bytes, t, &ctx);
+        if (len < 0) {
+            fprintf(stderr, "test_nelem: FAIL: unexpected failure in serialize\n");
+            ndt_decref(t);
+            ndt_context_del(&ctx);
+            return -1;
+        }
+
+        u = ndt_deserialize(bytes, len, &ctx);
+        ndt_free(bytes);
+        if (u == NULL) {
+            fprintf(stderr, "test_nelem: FAIL: unexpected failure in deserialize\n");
+            ndt_decref(t);
+            ndt_context_del(&ctx);
+            return -1;
+        }
+
+        if (ndt_nelem(u) != tests[i].nelem ||
+            ndt_var_total_nelem(u) != tests[i].total) {
+            fprintf(stderr, "test_nelem: FAIL: unexpected result after deserialize\n");
+            ndt_decref(t);
+            ndt_decref(u);
+            return -1;
+        }
+        ndt_decref(u);
+        ndt_decref(t);
+        count++;
+    }
+
+    /* Indexed var dimensions. */
+    t = ndt_from_string("var(offsets=[0,2]) * var(offsets=[0,3,5]) * float64", &ctx);
+    if (t == NULL) {
+        fprintf(stderr, "test_nelem: FAIL: unexpected failure in from_string\n");
+        ndt_context_del(&ctx);
+        return -1;
+    }
+
+    u = ndt_convert_to_var_elem(t, t->VarDim.type, 1, &ctx);
+    ndt_decref(t);
+    if (u == NULL) {
+        fprintf(stderr, "test_nelem: FAIL: unexpected failure in convert_to_var_elem\n");
+        ndt_context_del(&ctx);
+        return -1;
+    }
+
+    n = ndt_logical_shape(shape, u);
+    if (ndt_nelem(u) != -1 || ndt_var_total_nelem(u) != 5 ||
+        n != 1 || shape[0] != -1) {
+        fprintf(stderr, "test_nelem: FAIL: unexpected result for var elem\n");
+        ndt_decref(u);
+        return -1;
+    }
+    ndt_decref(u);
+    count++;
+
+    fprintf(stderr, "test_nelem (%d test cases)\n", count);
+
+    return 0;
+}
+
+static int
+test_owned_refcnt(void)
+{
+    NDT_STATIC_CONTEXT(ctx);
+    const ndt_t *t, *u;
+    ndt_offsets_t *offsets;
+    int count = 0;
+    int i;
+
+    t = ndt_from_string("10 * {a: int64, b: string}", &ctx);
+    if (t == NULL) {
+        fprintf(stderr, "test_owned_refcnt: FAIL: unexpected failure in from_string\n");
+        ndt_context_del(&ctx);
+        return -1;
+    }
+
+    ndt_set_owned(t, true);
+    for (i = 0; i < 100; i++) {
+        ndt_incref(t);
+    }
+    for (i = 0; i < 100; i++) {
+        ndt_decref(t);
+    }
+
+    if (t->refcnt != 1 || !t->owned) {
+        fprintf(stderr, "test_owned_refcnt: FAIL: unexpected owned type refcount\n");
+        ndt_decref(t);
+        return -1;
+    }
+    count++;
+
+    /* Types derived from an owned type are shared by default. */
+    u = ndt_copy(t, &ctx);
+    if (u == NULL) {
+        fprintf(stderr, "test_owned_refcnt: FAIL: unexpected failure in ndt_copy\n");
+        ndt_decref(t);
+        ndt_context_del(&ctx);
+        return -1;
+    }
+    if (u->owned) {
+        fprintf(stderr, "test_owned_refcnt: FAIL: copy inherited owned mode\n");
+        ndt_decref(u);
+        ndt_decref(t);
+        return -1;
+    }
+    ndt_decref(u);
+    count++;
+
+    /* The last decref in owned mode deletes the type. */
+    ndt_decref(t);
+    count++;
+
+    offsets = ndt_offsets_new(3, &ctx);
+    if (offsets == NULL) {
+        fprintf(stderr, "test_owned_refcnt: FAIL: unexpected failure in ndt_offsets_new\n");
+        ndt_context_del(&ctx);
+        return -1;
+    }
+
+    ndt_set_owned_offsets(offsets, true);
+    ndt_incref_offsets(offsets);
+    ndt_incref_offsets(offsets);
+    ndt_decref_offsets(offsets);
+    if (offsets->refcnt != 2) {
+        fprintf(stderr, "test_owned_refcnt: FAIL: unexpected owned offsets refcount\n");
+        ndt_decref_offsets(offsets);
+        ndt_decref_offsets(offsets);
+        return -1;
+    }
+
+    ndt_set_owned_offsets(offsets, false);
+    ndt_decref_offsets(offsets);
+    ndt_decref_offsets(offsets);
+    count++;
+
+    /* Static types are not reference counted. */
+    t = ndt_primitive(Int64, 0, &ctx);
+    if (t == NULL) {
+        fprintf(stderr, "test_owned_refcnt: FAIL: unexpected failure in ndt_primitive\n");
+        ndt_context_del(&ctx);
+        return -1;
+    }
+    ndt_set_owned(t, true);
+    if (t->owned) {
+        fprintf(stderr, "test_owned_refcnt: FAIL: static type changed\n");
+        return -1;
+    }
+    count++;
+
+    fprintf(stderr, "test_owned_refcnt (%d test cases)\n", count);
+
+    return 0;
+}
+
+static int64_t heap_nalloc = 0;
+static void *(* heap_mallocfunc)(size_t size) = NULL;
+
+static void *
+counting_malloc(size_t size)
+{
+    heap_nalloc++;
+    return heap_mallocfunc(size);
+}
+
+/* Count the heap allocations of one parse. */
+static int64_t
+parse_heap_allocs(const char *input, ndt_context_t *ctx)
+{
+    const ndt_t *t;
+    int64_t n;
+
+    heap_mallocfunc = ndt_mallocfunc;
+    heap_nalloc = 0;
+    ndt_mallocfunc = counting_malloc;
+    t = ndt_from_string(input, ctx);
+    ndt_mallocfunc = heap_mallocfunc;
+    n = heap_nalloc;
+
+    if (t == NULL) {
+        return -1;
+    }
+    ndt_decref(t);
+
+    return n;
+}
+
+static int
+test_parse_scratch(void)
+{
+    NDT_STATIC_CONTEXT(ctx);
+    const int nfields = 500;
+    const int nlarge = 10000;
+    ndt_alloc_stats_t stats;
+    int64_t narrow, wide;
+    const ndt_t *t;
+    char *s, *p;
+    int count = 0;
+    int i;
+
+    s = ndt_alloc(nfields, 32);
+    if (s == NULL) {
+        fprintf(stderr, "test_parse_scratch: FAIL: out of memory\n");
+        return -1;
+    }
+
+    p = s;
+    p += sprintf(p, "{");
+    for (i = 0; i < nfields; i++) {
+        p += sprintf(p, "%sf%d : int64", i == 0 ? "" : ", ", i);
+    }
+    sprintf(p, "}");
+
+    /* The first parse allocates the scratch space. */
+    for (i = 0; i < 2; i++) {
+        t = ndt_from_string(s, &ctx);
+        if (t == NULL) {
+            fprintf(stderr, "test_parse_scratch: FAIL: unexpected failure in from_string\n");
+            ndt_free(s);
+            ndt_context_del(&ctx);
+            return -1;
+        }
+        if (t->tag != Record || t->Record.shape != nfields ||
+            strcmp(t->Record.names[nfields-1], "f499") != 0) {
+            fprintf(stderr, "test_parse_scratch: FAIL: unexpected record\n");
+            ndt_decref(t);
+            ndt_free(s);
+            return -1;
+        }
+        ndt_decref(t);
+        count++;
+    }
+
+    ndt_alloc_stats_reset();
+    t = ndt_from_string("{a : int64}", &ctx);
+    ndt_decref(t);
+    ndt_alloc_stats(&stats, NDT_ALLOC_SCRATCH);
+    narrow = stats.nalloc;
+
+    ndt_alloc_stats_reset();
+    t = ndt_from_string(s, &ctx);
+    ndt_decref(t);
+    ndt_alloc_stats(&stats, NDT_ALLOC_SCRATCH);
+    wide = stats.nalloc;
+
+    if (wide != narrow) {
+        fprintf(stderr,
+            "test_parse_scratch: FAIL: scratch allocations: wide: %" PRIi64 ", narrow: %" PRIi64 "\n",
+            wide, narrow);
+        ndt_free(s);
+        return -1;
+    }
+    count++;
+
+    /* Field names and fields are in the scratch space and the names are
+       stored in the record node. */
+    narrow = parse_heap_allocs("{a : int64}", &ctx);
+    wide = parse_heap_allocs(s, &ctx);
+    ndt_free(s);
+
+    if (narrow < 0 || wide != narrow) {
+        fprintf(stderr,
+            "test_parse_scratch: FAIL: heap allocations: wide: %" PRIi64 ", narrow: %" PRIi64 "\n",
+            wide, narrow);
+        return -1;
+    }
+    count++;
+
+    /* The kept block is released by ndt_finalize_thread(). */
+    ndt_alloc_stats_reset();
+    ndt_finalize_thread();
+    ndt_alloc_stats(&stats, NDT_ALLOC_SCRATCH);
+    if (stats.nfree != 1) {
+        fprintf(stderr, "test_parse_scratch: FAIL: scratch space not released\n");
+        return -1;
+    }
+    count++;
+
+    /* Large blocks are not kept after the parse. */
+    s = ndt_alloc(nlarge, 32);
+    if (s == NULL) {
+        fprintf(stderr, "test_parse_scratch: FAIL: out of memory\n");
+        return -1;
+    }
+
+    p = s;
+    p += sprintf(p, "{");
+    for (i = 0; i < nlarge; i++) {
+        p += sprintf(p, "%sf%d : int64", i == 0 ? "" : ", ", i);
+    }
+    sprintf(p, "}");
+
+    t = ndt_from_string(s, &ctx);
+    ndt_free(s);
+    if (t == NULL || t->Record.shape != nlarge) {
+        fprintf(stderr, "test_parse_scratch: FAIL: unexpected failure in from_string\n");
+        ndt_decref(t);
+        ndt_context_del(&ctx);
+        return -1;
+    }
+    ndt_decref(t);
+
+    ndt_alloc_stats_reset();
+    ndt_finalize_thread();
+    ndt_alloc_stats(&stats, NDT_ALLOC_SCRATCH);
+    if (stats.nfree != 0) {
+        fprintf(stderr, "test_parse_scratch: FAIL: large scratch block kept\n");
+        return -1;
+    }
+    count++;
+
+    fprintf(stderr, "test_parse_scratch (%d test cases)\n", count);
+
+    return 0;
+}
+
+static int
+test_parse_scalar(void)
+{
+    static const struct {
+        const char *input;
+        bool lexer;
+    } tests[] = {
+      {"bool", false},
+      {"int8", false},
+      {"int16", false},
+      {"int32", false},
+      {"int64", false},
+      {"uint8", false},
+      {"uint16", false},
+      {"uint32", false},
+      {"uint64", false},
+      {"bfloat16", false},
+      {"float16", false},
+      {"float32", false},
+      {"float64", false},
+      {"bcomplex32", false},
+      {"complex32", false},
+      {"complex64", false},
+      {"complex128", false},
+      {"intptr", false},
+      {"uintptr", false},
+      {"size_t", false},
+      {"string", false},
+      {"?int64", false},
+      {"<int32", false},
+      {">float64", false},
+      {"=uint16", false},
+      {"|int8", false},
+      {"?<complex64", false},
+      {"?size_t", false},
+      {"?string", false},
+      {"  float32\n", false},
+      {"? int64", true},
+      {"int64abc", true},
+      {"Int64", true},
+      {"<string", true},
+      {"<?int64", true},
+      {"float", true},
+      {"categorical", true},
+      {"Any", true},
+      {"Scalar", true},
+      {"void", true},
+      {"signed", true},
+      {"unsigned", true},
+      {"complex", true},
+      {"char", true},
+      {"bytes", true},
+      {"FixedString", true},
+      {"fixed_string", true},
+      {"FixedBytes", true},
+      {"fixed_bytes", true},
+      {"NA", true},
+      {"ref", true},
+      {"fixed", true},
+      {"var", true},
+      {"array", true},
+      {"of", true},
+      {"10 * int64", true},
+      {"_", true},
+      {"", true},
+    };
+    NDT_STATIC_CONTEXT(ctx);
+    ndt_alloc_stats_t stats;
+    char buf[64];
+    const ndt_t *t, *u;
+    size_t i;
+
+    for (i = 0; i < sizeof tests / sizeof tests[0]; i++) {
+        ndt_alloc_stats_reset();
+        t = ndt_from_string(tests[i].input, &ctx);
+        ndt_alloc_stats(&stats, NDT_ALLOC_SCRATCH);
+        ndt_err_clear(&ctx);
+
+        if ((stats.nalloc != 0) != tests[i].lexer) {
+            fprintf(stderr, "test_parse_scalar: FAIL: unexpected lexer use: \"%s\"\n",
+                    tests[i].input);
+            ndt_decref(t);
+            return -1;
+        }
+
+        /* The comment forces the full parser. */
+        snprintf(buf, sizeof buf, "%s # full parser", tests[i].input);
+        u = ndt_from_string(buf, &ctx);
+        ndt_err_clear(&ctx);
+
+        if ((t == NULL) != (u == NULL) || (t != NULL && !ndt_equal(t, u))) {
+            fprintf(stderr, "test_parse_scalar: FAIL: result differs from parser: \"%s\"\n",
+                    tests[i].input);
+            ndt_decref(t);
+            ndt_decref(u);
+            return -1;
+        }
+
+        ndt_decref(t);
+        ndt_decref(u);
+    }
+
+    fprintf(stderr, "test_parse_scalar (%zu test cases)\n", i);
+
+    return 0;
+}
+
+static int
+test_limits(void)
+{
+    static const struct {
+        const char *input;
+        ndt_limits_t limits;
+        const char *msg; /* NULL: success */
+    } tests[] = {
+      { "((((((((((int64))))))))))", {.depth=10}, NULL },
+      { "((((((((((int64))))))))))", {.depth=8}, "maximum depth is 8" },
+      { "{a : {b : {c : (int64)}}}", {.depth=4}, NULL },
+      { "{a : {b : {c : (int64)}}}", {.depth=3}, "maximum depth is 3" },
+      { "&&&&int64", {.depth=4}, NULL },
+      { "&&&&&int64", {.depth=4}, "maximum depth is 4" },
+      { "ref(ref(int64))", {.depth=4}, NULL },
+      { "ref(ref(int64))", {.depth=3}, "maximum depth is 3" },
+      { "2 * 3 * 4 * int64", {.depth=3}, NULL },
+      { "2 * 3 * 4 * 5 * int64", {.depth=3}, "maximum depth is 3" },
+      { "... * N * &?int64", {.depth=3}, NULL },
+      { "... * N * &?int64", {.depth=2}, "maximum depth is 2" },
+      { "10 * {a : int64, b : float64}", {.nodes=4}, NULL },
+      { "2 * 2 * 2 * 2 * 2 * int64", {.nodes=4}, "maximum number of nodes is 4" },
+      { "{abcdefgh : int64}", {.string=8}, NULL },
+      { "{abcdefghi : int64}", {.string=8}, "maximum string length is 8" },
+      { "categorical('abcdefgh')", {.string=8}, NULL },
+      { "categorical('abcdefghi')", {.string=8}, "maximum string length is 8" },
+      { "var(offsets=[0,2]) * var(offsets=[0,3,5]) * float64", {.offsets=5}, NULL },
+      { "var(offsets=[0,2]) * var(offsets=[0,3,5]) * float64", {.offsets=4}, "maximum number of offsets is 4" },
+      { "{a : int64, b : int64, c : int64, d : int64}", {.bytes=256}, "maximum number of bytes is 256" },
+    };
+    NDT_STATIC_CONTEXT(ctx);
+    const ndt_limits_t deep = {.depth=4};
+    const ndt_limits_t refs = {.depth=64};
+    const ndt_t *t, *u;
+    char chain[128];
+    char *bytes;
+    int64_t len;
+    int count = 0;
+    size_t i;
+
+    for (i = 0; i < sizeof tests / sizeof tests[0]; i++) {
+        ndt_context_set_limits(&ctx, &tests[i].limits);
+        t = ndt_from_string(tests[i].input, &ctx);
+
+        if (tests[i].msg == NULL) {
+            if (t == NULL) {
+                fprintf(stderr, "test_limits: FAIL: unexpected failure for \"%s\": %s\n",
+                        tests[i].input, ndt_context_msg(&ctx));
+                ndt_context_del(&ctx);
+                return -1;
+            }
+            ndt_decref(t);
+        }
+        else {
+            if (t != NULL) {
+                fprintf(stderr, "test_limits: FAIL: expected failure for \"%s\"\n",
+                        tests[i].input);
+                ndt_decref(t);
+                return -1;
+            }
+            if (ctx.err != NDT_ValueError ||
+                strstr(ndt_context_msg(&ctx), tests[i].msg) == NULL) {
+                fprintf(stderr, "test_limits: FAIL: unexpected error for \"%s\": %s\n",
+                        tests[i].input, ndt_context_msg(&ctx));
+                ndt_context_del(&ctx);
+                return -1;
+            }
+            ndt_context_reset(&ctx);
+        }
+        count++;
+    }
+
+    /* Without limits the same inputs are accepted. */
+    ndt_context_set_limits(&ctx, NULL);
+    for (i = 0; i < sizeof tests / sizeof tests[0]; i++) {
+        t = ndt_from_string(tests[i].input, &ctx);
+        if (t == NULL) {
+            fprintf(stderr, "test_limits: FAIL: unexpected failure for \"%s\": %s\n",
+                    tests[i].input, ndt_context_msg(&ctx));
+            ndt_context_del(&ctx);
+            return -1;
+        }
+        ndt_decref(t);
+        count++;
+    }
+
+    /* The deserializer checks the depth before reading a child. */
+    t = ndt_from_string("2 * 3 * {a : (int64, (float64, (int8)))}", &ctx);
+    if (t == NULL) {
+        fprintf(stderr, "test_limits: FAIL: unexpected failure in from_string\n");
+        ndt_context_del(&ctx);
+        return -1;
+    }
+
+    len = ndt_serialize(&bytes, t, &ctx);
+    ndt_decref(t);
+    if (len < 0) {
+        fprintf(stderr, "test_limits: FAIL: unexpected failure in serialize\n");
+        ndt_context_del(&ctx);
+        return -1;
+    }
+
+    ndt_context_set_limits(&ctx, &deep);
+    u = ndt_deserialize(bytes, len, &ctx);
+    if (u != NULL || ctx.err != NDT_ValueError ||
+        strstr(ndt_context_msg(&ctx), "maximum depth is 4") == NULL) {
+        fprintf(stderr, "test_limits: FAIL: expected depth limit in deserialize\n");
+        if (u != NULL) {
+            ndt_decref(u);
+        }
+        ndt_free(bytes);
+        ndt_context_del(&ctx);
+        return -1;
+    }
+    ndt_context_reset(&ctx);
+    count++;
+
+    ndt_context_set_limits(&ctx, NULL);
+    u = ndt_deserialize(bytes, len, &ctx);
+    ndt_free(bytes);
+    if (u == NULL) {
+        fprintf(stderr, "test_limits: FAIL: unexpected failure in deserialize\n");
+        ndt_context_del(&ctx);
+        return -1;
+    }
+    ndt_decref(u);
+    count++;
+
+    /* The parser and the deserializer agree on the depth of a ref chain. */
+    for (int n = 64; n <= 65; n++) {
+        memset(chain, '&', n);
+        strcpy(chain+n, "int64");
+
+        ndt_context_set_limits(&ctx, NULL);
+        t = ndt_from_string(chain, &ctx);
+        if (t == NULL) {
+            fprintf(stderr, "test_limits: FAIL: unexpected failure in from_string\n");
+            ndt_context_del(&ctx);
+            return -1;
+        }
+
+        len = ndt_serialize(&bytes, t, &ctx);
+        ndt_decref(t);
+        if (len < 0) {
+            fprintf(stderr, "test_limits: FAIL: unexpected failure in serialize\n");
+            ndt_context_del(&ctx);
+            return -1;
+        }
+
+        ndt_context_set_limits(&ctx, &refs);
+        t = ndt_from_string(chain, &ctx);
+        ndt_context_reset(&ctx);
+        u = ndt_deserialize(bytes, len, &ctx);
+        ndt_context_reset(&ctx);
+        ndt_free(bytes);
+
+        if ((t == NULL) != (n > 64) || (u == NULL) != (n > 64)) {
+            fprintf(stderr, "test_limits: FAIL: unexpected result for a chain of %d refs\n", n);
+            ndt_decref(t);
+            ndt_decref(u);
+            return -1;
+        }
+        ndt_decref(t);
+        ndt_decref(u);
+        count++;
+    }
+
+    fprintf(stderr, "test_limits (%d test cases)\n", count);
+
+    return 0;
+}
+
+static int
+test_static_context(void)
+{
+    const char **c;
+    NDT_STATIC_CONTEXT(ctx);
+    const ndt_t *t;
+    char *s;
+    int count = 0;
+
+    for (c = parse_tests; *c != NULL; c++) {
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(&ctx);
+
+            ndt_set_alloc_fail();
+            t = ndt_from_string(*c, &ctx);
+            ndt_set_alloc();
+
+            if (ctx.err != NDT_MemoryError) {
+                break;
+            }
+
+            if (t != NULL) {
+                ndt_decref(t);
+                fprintf(stderr, "test_static_context: FAIL: t != NULL after MemoryError\n");
+                fprintf(stderr, "test_static_context: FAIL: %s\n", *c);
+                return -1;
+            }
+        }
+        if (t == NULL) {
+            fprintf(stderr, "test_static_context: FAIL: expected success: \"%s\"\n", *c);
+            fprintf(stderr, "test_static_context: FAIL: got: %s: %s\n\n",
+                    ndt_err_as_string(ctx.err),
+                    ndt_context_msg(&ctx));
+            ndt_context_del(&ctx);
+            return -1;
+        }
+
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(&ctx);
+
+            ndt_set_alloc_fail();
+            s = ndt_as_string(t, &ctx);
+            ndt_set_alloc();
+
+            if (ctx.err != NDT_MemoryError) {
+                break;
+            }
+
+            if (s != NULL) {
+                ndt_free(s);
+                ndt_decref(t);
+                fprintf(stderr, "test_static_context: FAIL: s != NULL after MemoryError\n");
+                fprintf(stderr, "test_static_context: FAIL: %s\n", *c);
+                ndt_context_del(&ctx);
+                return -1;
+            }
+        }
+        if (s == NULL) {
+            fprintf(stderr, "test_static_context: FAIL: expected success: \"%s\"\n", *c);
+            fprintf(stderr, "test_static_context: FAIL: got: %s: %s\n\n",
+                    ndt_err_as_string(ctx.err),
+                    ndt_context_msg(&ctx));
+            ndt_decref(t);
+            ndt_context_del(&ctx);
+            return -1;
+        }
+
+        ndt_free(s);
+        ndt_decref(t);
+        count++;
+    }
+
+    s = "2 * 1000000000000000000000000000 * complex128";
+    t = ndt_from_string(s, &ctx);
+    if (s == NULL) {
+        fprintf(stderr, "test_static_context: FAIL: expected failure: \"%s\"\n", s);
+        ndt_decref(t);
+        ndt_context_del(&ctx);
+        return -1;
+    }
+    count++;
+
+    ndt_context_del(&ctx);
+    fprintf(stderr, "test_static_context (%d test cases)\n", count);
+
+    return 0;
+}
+
+typedef struct {
+    const char *str;
+    ndt_ssize_t hash;
+} hash_testcase_t;
+
+static int
+cmp_hash_testcase(const void *x, const void *y)
+{
+    const hash_testcase_t *p = (const hash_testcase_t *)x;
+    const hash_testcase_t *q = (const hash_testcase_t *)y;
+
+    if (p->hash < q->hash) {
+        return -1;
+    }
+    else if (p->hash == q->hash) {
+        return 0;
+    }
+
+    return 1;
+}
+
+static int
+test_hash(void)
+{
+    NDT_STATIC_CONTEXT(ctx);
+    hash_testcase_t buf[1000];
+    ptrdiff_t n = 1;
+    const char **c;
+    const ndt_t *t;
+    hash_testcase_t x;
+    int i;
+
+    for (c = parse_roundtrip_tests; *c != NULL; c++) {
+        n = c - parse_roundtrip_tests;
+        if (n >= 1000) {
+            break;
+        }
+
+        ndt_err_clear(&ctx);
+
+        t = ndt_from_string(*c, &ctx);
+        if (t == NULL) {
+            fprintf(stderr, "test_hash: FAIL: expected success: \"%s\"\n", *c);
+            fprintf(stderr, "test_hash: FAIL: got: %s: %s\n\n",
+                    ndt_err_as_string(ctx.err),
+                    ndt_context_msg(&ctx));
+            ndt_context_del(&ctx);
+            return -1;
+        }
+
+        x.hash = ndt_hash(t, &ctx);
+        x.str = *c;
+        ndt_decref(t);
+
+        if (x.hash == -1) {
+            fprintf(stderr, "test_hash: FAIL: hash==-1\n\n");
+            ndt_context_del(&ctx);
+            return -1;
+        }
+
+        buf[n] = x;
+    }
+
+    qsort(buf, n, sizeof *buf, cmp_hash_testcase);
+    for (i = 0; i < n-1; i++) {
+        if (buf[i].hash == buf[i+1].hash) {
+            fprintf(stderr,
+                "test_hash: duplicate hash for %s: %" PRI_ndt_ssize "\n\n",
+                buf[i].str, buf[i].hash);
+        }
+    }
+
+    t = ndt_from_string("var * {a: float64, b: string}", &ctx);
+    if (t == NULL) {
+        fprintf(stderr, "test_hash: FAIL: expected success\n\n");
+        ndt_context_del(&ctx);
+        return -1;
+    }
+
+    alloc_fail = 1;
+    ndt_set_alloc_fail();
+    x.hash = ndt_hash(t, &ctx);
+    ndt_set_alloc();
+
+    ndt_decref(t);
+
+    if (x.hash != -1 || ctx.err != NDT_MemoryError) {
+        fprintf(stderr, "test_hash: FAIL: expected failure, got %" PRI_ndt_ssize "\n\n", x.hash);
+        ndt_context_del(&ctx);
+        return -1;
+    }
+
+    ndt_context_del(&ctx);
+    fprintf(stderr, "test_hash (%d test cases)\n", (int)n);
+
+    return 0;
+}
+
+static int
+test_copy(void)
+{
+    NDT_STATIC_CONTEXT(ctx);
+    const char **c;
+    const ndt_t *t, *u;
+    int count = 0;
+
+    for (c = parse_tests; *c != NULL; c++) {
+        t = ndt_from_string(*c, &ctx);
+        if (t == NULL) {
+            fprintf(stderr, "test_copy: FAIL: from_string: \"%s\"\n", *c);
+            fprintf(stderr, "test_copy: FAIL: got: %s: %s\n\n",
+                    ndt_err_as_string(ctx.err),
+                    ndt_context_msg(&ctx));
+            ndt_context_del(&ctx);
+            return -1;
+        }
+
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(&ctx);
+
+            ndt_set_alloc_fail();
+            u = ndt_copy(t, &ctx);
+            ndt_set_alloc();
+
+            if (ctx.err != NDT_MemoryError) {
+                break;
+            }
+
+            if (u != NULL) {
+                fprintf(stderr, "test_copy: FAIL: unexpected success: \"%s\"\n", *c);
+                ndt_decref(u);
+                ndt_decref(t);
+                ndt_context_del(&ctx);
+                return -1;
+            }
+        }
+        if (u == NULL) {
+            fprintf(stderr, "test_copy: FAIL: copying failed: \"%s\"\n", *c);
+            fprintf(stderr, "test_copy: FAIL: got: %s: %s\n\n",
+                    ndt_err_as_string(ctx.err),
+                    ndt_context_msg(&ctx));
+            ndt_decref(t);
+            ndt_context_del(&ctx);
+            return -1;
+        }
+
+        if (!ndt_equal(t, u)) {
+            fprintf(stderr, "test_copy: FAIL: copy: not equal\n\n");
+            ndt_decref(t);
+            ndt_decref(u);
+            ndt_context_del(&ctx);
+            return -1;
+        }
+
+        ndt_decref(u);
+        ndt_decref(t);
+        count++;
+    }
+
+    ndt_context_del(&ctx);
+    fprintf(stderr, "test_copy (%d test cases)\n", count);
+
+    return 0;
+}
+
+static int
+test_buffer(void)
+{
+    const char **c;
+    ndt_context_t *ctx;
+    const ndt_t *t;
+    int count = 0;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (c = buffer_tests; *c != NULL; c++) {
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            ndt_set_alloc_fail();
+            t = ndt_from_bpformat(*c, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (t != NULL) {
+                ndt_decref(t);
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_buffer: convert: FAIL: t != NULL after MemoryError\n");
+                fprintf(stderr, "test_buffer: convert: FAIL: %s\n", *c);
+                return -1;
+            }
+        }
+        if (t == NULL) {
+            fprintf(stderr, "test_buffer: convert: FAIL: expected success: \"%s\"\n", *c);
+            fprintf(stderr, "test_buffer: convert: FAIL: got: %s: %s\n\n",
+                    ndt_err_as_string(ctx->err),
+                    ndt_context_msg(ctx));
+            ndt_context_del(ctx);
+            return -1;
+        }
+
+        ndt_decref(t);
+        count++;
+    }
+    fprintf(stderr, "test_buffer (%d test cases)\n", count);
+
+    ndt_context_del(ctx);
+    return 0;
+}
+
+static int
+test_buffer_roundtrip(void)
+{
+    const char **c;
+    ndt_context_t *ctx;
+    const ndt_t *t;
+    char *s;
+    int count = 0;
+    int ret;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (c = buffer_roundtrip_tests; *c != NULL; c++) {
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            ndt_set_alloc_fail();
+            t = ndt_from_bpformat(*c, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (t != NULL) {
+                ndt_decref(t);
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_buffer: convert: FAIL: t != NULL after MemoryError\n");
+                fprintf(stderr, "test_buffer: convert: FAIL: %s\n", *c);
+                return -1;
+            }
+        }
+        if (t == NULL) {
+            fprintf(stderr, "test_buffer: convert: FAIL: expected success: \"%s\"\n", *c);
+            fprintf(stderr, "test_buffer: convert: FAIL: got: %s: %s\n\n",
+                    ndt_err_as_string(ctx->err),
+                    ndt_context_msg(ctx));
+            ndt_context_del(ctx);
+            return -1;
+        }
+
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            ndt_set_alloc_fail();
+            s = ndt_to_bpformat(t, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (s != NULL) {
+                ndt_free(s);
+                ndt_decref(t);
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_buffer_roundtrip: convert: FAIL: s != NULL after MemoryError\n");
+                fprintf(stderr, "test_buffer_roundtrip: convert: FAIL: %s\n", *c);
+                return -1;
+            }
+        }
+        if (s == NULL) {
+            fprintf(stderr, "test_buffer_roundtrip: convert: FAIL: expected success: \"%s\"\n", *c);
+            fprintf(stderr, "test_buffer_roundtrip: convert: FAIL: got: %s: %s\n\n",
+                    ndt_err_as_string(ctx->err),
+                    ndt_context_msg(ctx));
+            ndt_decref(t);
+            ndt_context_del(ctx);
+            return -1;
+        }
+
+        ret = strcmp(s, *c);
+        ndt_decref(t);
+
+        if (ret != 0) {
+            fprintf(stderr, "test_buffer_roundtrip: convert: FAIL: input: \"%s\" output: \"%s\"\n", *c, s);
+            ndt_free(s);
+            ndt_context_del(ctx);
+            return -1;
+        }
+
+        ndt_free(s);
+        count++;
+    }
+    fprintf(stderr, "test_buffer_roundtrip (%d test cases)\n", count);
+
+    ndt_context_del(ctx);
+    return 0;
+}
+
+static int
+test_buffer_error(void)
+{
+    const char **c;
+    ndt_context_t *ctx;
+    const ndt_t *t;
+    int count = 0;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (c = buffer_error_tests; *c != NULL; c++) {
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            ndt_set_alloc_fail();
+            t = ndt_from_bpformat(*c, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (t != NULL) {
+                ndt_decref(t);
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_buffer_error: FAIL: t != NULL after MemoryError\n");
+                fprintf(stderr, "test_buffer_error: FAIL: input: %s\n", *c);
+                return -1;
+            }
+        }
+        if (t != NULL) {
+            fprintf(stderr, "test_buffer_error: FAIL: unexpected success: \"%s\"\n", *c);
+            fprintf(stderr, "test_buffer_error: FAIL: t != NULL after %s: %s\n",
+                    ndt_err_as_string(ctx->err),
+                    ndt_context_msg(ctx));
+            ndt_decref(t);
+            ndt_context_del(ctx);
+            return -1;
+        }
+        count++;
+    }
+    fprintf(stderr, "test_buffer_error (%d test cases)\n", count);
+
+    ndt_context_del(ctx);
+    return 0;
+}
+
+static int
+test_serialize(void)
+{
+    const char **c;
+    ndt_context_t *ctx;
+    const ndt_t *t, *u;
+    int count = 0;
+    char *bytes;
+    int64_t len;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (c = parse_tests; *c != NULL; c++) {
+        t = ndt_from_string(*c, ctx);
+        if (t == NULL) {
+            ndt_context_del(ctx);
+            fprintf(stderr,
+                "test_serialize: FAIL: unexpected failure in from_string");
+            return -1;
+        }
+
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+            bytes = NULL;
+
+            ndt_set_alloc_fail();
+            len = ndt_serialize(&bytes, t, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (len >= 0 || bytes != NULL) {
+                ndt_decref(t);
+                ndt_free(bytes);
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_serialize: FAIL: invalid len or bytes after MemoryError\n");
+                fprintf(stderr, "test_serialize: FAIL: %s\n", *c);
+                return -1;
+            }
+        }
+
+        if (len < 0 || bytes == NULL) {
+            ndt_decref(t);
+            ndt_free(bytes);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_serialize: FAIL: invalid len or bytes (expected success)\n");
+            fprintf(stderr, "test_serialize: FAIL: %s\n", *c);
+            return -1;
+        }
+
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            ndt_set_alloc_fail();
+            u = ndt_deserialize(bytes, len, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (u != NULL) {
+                ndt_decref(t);
+                ndt_decref(u);
+                ndt_free(bytes);
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_serialize: FAIL: u != NULL after MemoryError\n");
+                fprintf(stderr, "test_serialize: FAIL: %s\n", *c);
+                return -1;
+            }
+        }
+
+        if (u == NULL) {
+            fprintf(stderr, "test_serialize: FAIL: expected success: \"%s\"\n", *c);
+            fprintf(stderr, "test_serialize: FAIL: got: %s: %s\n\n",
+                    ndt_err_as_string(ctx->err),
+                    ndt_context_msg(ctx));
+            ndt_decref(t);
+            ndt_free(bytes);
+            ndt_context_del(ctx);
+            return -1;
+        }
+
+        ndt_free(bytes);
+
+        if (!ndt_equal(u, t)) {
+            fprintf(stderr, "test_serialize: FAIL: u != v in %s\n", *c);
+            ndt_decref(t);
             ndt_decref(u);
-            ndt_context_del(&ctx);
+            ndt_context_del(ctx);
             return -1;
         }
 
-        ndt_decref(u);
         ndt_decref(t);
+        ndt_decref(u);
+
         count++;
     }
+    fprintf(stderr, "test_serialize (%d test cases)\n", count);
 
-    ndt_context_del(&ctx);
-    fprintf(stderr, "test_copy (%d test cases)\n", count);
-
+    ndt_context_del(ctx);
     return 0;
 }
 
 static int
-test_buffer(void)
+test_typedef_bundle(void)
 {
-    const char **c;
+    const char *names[2] = {"bundle_a_t", "bundle_b_t"};
+    const char *types[2] = {"{a: size_t, b: ref(string)}", "2 * defined_t"};
+    const ndt_t *t[2] = {NULL, NULL};
+    const ndt_typedef_t *d;
     ndt_context_t *ctx;
-    const ndt_t *t;
+    char *bytes = NULL;
+    int64_t len = -1;
     int count = 0;
+    int ret = -1;
+    int i;
 
     ctx = ndt_context_new();
     if (ctx == NULL) {
@@ -1348,53 +4073,543 @@ test_buffer(void)
         return -1;
     }
 
-    for (c = buffer_tests; *c != NULL; c++) {
-        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
-            ndt_err_clear(ctx);
+    for (i = 0; i < 2; i++) {
+        t[i] = ndt_from_string(types[i], ctx);
+        if (t[i] == NULL) {
+            fprintf(stderr,
+                "test_typedef_bundle: FAIL: unexpected failure in from_string\n");
+            goto out;
+        }
+    }
+
+    for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+        ndt_err_clear(ctx);
+
+        ndt_set_alloc_fail();
+        len = ndt_serialize_typedefs(&bytes, names, t, 2, ctx);
+        ndt_set_alloc();
+
+        if (ctx->err != NDT_MemoryError) {
+            break;
+        }
+
+        if (len >= 0 || bytes != NULL) {
+            fprintf(stderr,
+                "test_typedef_bundle: FAIL: invalid len or bytes after MemoryError\n");
+            goto out;
+        }
+    }
+
+    if (len < 0 || bytes == NULL) {
+        fprintf(stderr,
+            "test_typedef_bundle: FAIL: invalid len or bytes (expected success)\n");
+        goto out;
+    }
+    count++;
+
+    /* Truncated bundle */
+    ndt_err_clear(ctx);
+    if (ndt_typedef_bundle_load(bytes, len-1, ctx) == 0 ||
+        ctx->err != NDT_ValueError) {
+        fprintf(stderr,
+            "test_typedef_bundle: FAIL: expected ValueError for truncated bundle\n");
+        goto out;
+    }
+    count++;
+
+    /* Version mismatch */
+    bytes[4] ^= 0x7f;
+    ndt_err_clear(ctx);
+    if (ndt_typedef_bundle_load(bytes, len, ctx) == 0 ||
+        ctx->err != NDT_ValueError) {
+        fprintf(stderr,
+            "test_typedef_bundle: FAIL: expected ValueError for wrong version\n");
+        goto out;
+    }
+    bytes[4] ^= 0x7f;
+    count++;
+
+    ndt_err_clear(ctx);
+    if (ndt_typedef_bundle_load(bytes, len, ctx) < 0) {
+        fprintf(stderr, "test_typedef_bundle: FAIL: got: %s: %s\n",
+                ndt_err_as_string(ctx->err), ndt_context_msg(ctx));
+        goto out;
+    }
+
+    for (i = 0; i < 2; i++) {
+        d = ndt_typedef_find(names[i], ctx);
+        if (d == NULL || !ndt_equal(d->type, t[i])) {
+            fprintf(stderr,
+                "test_typedef_bundle: FAIL: missing or different typedef: %s\n",
+                names[i]);
+            goto out;
+        }
+        count++;
+    }
+
+    /* Loading the same bundle twice must fail with duplicate typedefs. */
+    ndt_err_clear(ctx);
+    if (ndt_typedef_bundle_load(bytes, len, ctx) == 0 ||
+        ctx->err != NDT_ValueError) {
+        fprintf(stderr,
+            "test_typedef_bundle: FAIL: expected ValueError for duplicates\n");
+        goto out;
+    }
+    count++;
+
+    /* A failing entry removes the entries that precede it. */
+    ndt_free(bytes);
+    names[0] = "bundle_c_t";
+    names[1] = "bundle_a_t";
+    len = ndt_serialize_typedefs(&bytes, names, t, 2, ctx);
+    if (len < 0) {
+        fprintf(stderr,
+            "test_typedef_bundle: FAIL: unexpected failure in serialize_typedefs\n");
+        goto out;
+    }
+
+    ndt_err_clear(ctx);
+    if (ndt_typedef_bundle_load(bytes, len, ctx) == 0 ||
+        ctx->err != NDT_ValueError) {
+        fprintf(stderr,
+            "test_typedef_bundle: FAIL: expected ValueError for duplicates\n");
+        goto out;
+    }
+
+    ndt_err_clear(ctx);
+    if (ndt_typedef_find("bundle_c_t", ctx) != NULL) {
+        fprintf(stderr,
+            "test_typedef_bundle: FAIL: failed load left a typedef behind\n");
+        goto out;
+    }
+    ndt_err_clear(ctx);
+    count++;
+
+    fprintf(stderr, "test_typedef_bundle (%d test cases)\n", count);
+    ret = 0;
+
+out:
+    ndt_free(bytes);
+    ndt_decref(t[0]);
+    ndt_decref(t[1]);
+    ndt_context_del(ctx);
+    return ret;
+}
+
+static int
+test_offsets_intern(void)
+{
+    const char *s = "var(offsets=[0,2]) * var(offsets=[0,3,5]) * int64";
+    const ndt_t *t = NULL, *u = NULL, *v = NULL;
+    ndt_offsets_t *offsets;
+    ndt_context_t *ctx;
+    char *bytes = NULL;
+    int64_t len;
+    int count = 0;
+    int ret = -1;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    if (ndt_offsets_intern_enable(ctx) < 0) {
+        fprintf(stderr, "test_offsets_intern: FAIL: could not enable interning\n");
+        ndt_context_del(ctx);
+        return -1;
+    }
+
+    for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+        ndt_err_clear(ctx);
+
+        ndt_set_alloc_fail();
+        t = ndt_from_string(s, ctx);
+        ndt_set_alloc();
+
+        if (ctx->err != NDT_MemoryError) {
+            break;
+        }
+
+        if (t != NULL || ndt_offsets_intern_size() != 0) {
+            fprintf(stderr, "test_offsets_intern: FAIL: leftover entries after MemoryError\n");
+            goto out;
+        }
+    }
+
+    if (t == NULL) {
+        fprintf(stderr, "test_offsets_intern: FAIL: unexpected failure in from_string\n");
+        goto out;
+    }
+
+    u = ndt_from_string(s, ctx);
+    if (u == NULL) {
+        fprintf(stderr, "test_offsets_intern: FAIL: unexpected failure in from_string\n");
+        goto out;
+    }
+
+    if (ndt_offsets_intern_size() != 2 ||
+        t->Concrete.VarDim.offsets != u->Concrete.VarDim.offsets ||
+        t->VarDim.type->Concrete.VarDim.offsets != u->VarDim.type->Concrete.VarDim.offsets) {
+        fprintf(stderr, "test_offsets_intern: FAIL: offsets are not shared after parsing\n");
+        goto out;
+    }
+    count++;
+
+    /* Interned offsets keep atomic reference counts. */
+    ndt_set_owned_offsets(t->Concrete.VarDim.offsets, true);
+    if (t->Concrete.VarDim.offsets->owned) {
+        fprintf(stderr, "test_offsets_intern: FAIL: interned offsets in owned mode\n");
+        goto out;
+    }
+    count++;
+
+    /* Offsets in owned mode are not shared. */
+    offsets = ndt_offsets_new(2, ctx);
+    if (offsets == NULL) {
+        fprintf(stderr, "test_offsets_intern: FAIL: unexpected failure in ndt_offsets_new\n");
+        goto out;
+    }
+    ndt_set_owned_offsets(offsets, true);
+    ((int32_t *)offsets->v)[1] = 2;
+    if (ndt_offsets_intern(offsets) != offsets || ndt_offsets_intern_size() != 2) {
+        fprintf(stderr, "test_offsets_intern: FAIL: owned offsets were interned\n");
+        ndt_decref_offsets(offsets);
+        goto out;
+    }
+    ndt_decref_offsets(offsets);
+    count++;
+
+    len = ndt_serialize(&bytes, t, ctx);
+    if (len < 0) {
+        fprintf(stderr, "test_offsets_intern: FAIL: unexpected failure in serialize\n");
+        goto out;
+    }
+
+    v = ndt_deserialize(bytes, len, ctx);
+    if (v == NULL ||
+        v->Concrete.VarDim.offsets != t->Concrete.VarDim.offsets ||
+        v->VarDim.type->Concrete.VarDim.offsets != t->VarDim.type->Concrete.VarDim.offsets) {
+        fprintf(stderr, "test_offsets_intern: FAIL: offsets are not shared after deserializing\n");
+        goto out;
+    }
+    count++;
+
+    ndt_decref(t); t = NULL;
+    ndt_decref(u); u = NULL;
+    ndt_decref(v); v = NULL;
+
+    if (ndt_offsets_intern_size() != 0) {
+        fprintf(stderr, "test_offsets_intern: FAIL: entries not removed after decref\n");
+        goto out;
+    }
+    count++;
+
+    fprintf(stderr, "test_offsets_intern (%d test cases)\n", count);
+    ret = 0;
+
+out:
+    ndt_offsets_intern_disable();
+    ndt_free(bytes);
+    ndt_decref(t);
+    ndt_decref(u);
+    ndt_decref(v);
+    ndt_context_del(ctx);
+    return ret;
+}
+
+static int external_released = 0;
+
+static void
+release_external(void *owner)
+{
+    (*(int *)owner)++;
+}
+
+static int
+test_offsets_external(void)
+{
+    static const int32_t buf[4] = {0, 2, 3, 7};
+    static const ndt_limits_t limits = {.offsets=3};
+    const ndt_t *t = NULL;
+    ndt_offsets_t *offsets = NULL;
+    ndt_context_t *ctx;
+    int count = 0;
+    int ret = -1;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+        ndt_err_clear(ctx);
+        external_released = 0;
+
+        ndt_set_alloc_fail();
+        offsets = ndt_offsets_from_external(buf, 4, &external_released,
+                                            release_external, ctx);
+        ndt_set_alloc();
+
+        if (ctx->err != NDT_MemoryError) {
+            break;
+        }
+
+        if (offsets != NULL || external_released != 1) {
+            fprintf(stderr, "test_offsets_external: FAIL: owner not released after MemoryError\n");
+            goto out;
+        }
+    }
+    count++;
+
+    if (offsets == NULL || offsets->v != buf) {
+        fprintf(stderr, "test_offsets_external: FAIL: external buffer was copied\n");
+        goto out;
+    }
+
+    t = ndt_var_dim(ndt_primitive(Float64, 0, ctx), offsets, 0, NULL, false, ctx);
+    if (t == NULL) {
+        fprintf(stderr, "test_offsets_external: FAIL: unexpected failure in var_dim\n");
+        goto out;
+    }
+
+    ndt_decref_offsets(offsets);
+    offsets = NULL;
+    if (external_released != 0 || t->datasize != 7 * 8) {
+        fprintf(stderr, "test_offsets_external: FAIL: buffer released while in use\n");
+        goto out;
+    }
+    count++;
+
+    ndt_decref(t);
+    t = NULL;
+    if (external_released != 1) {
+        fprintf(stderr, "test_offsets_external: FAIL: release not called exactly once\n");
+        goto out;
+    }
+    count++;
+
+    /* Invalid arguments release the owner. */
+    offsets = ndt_offsets_from_external(buf, -1, &external_released,
+                                        release_external, ctx);
+    if (offsets != NULL || ctx->err != NDT_ValueError || external_released != 2) {
+        fprintf(stderr, "test_offsets_external: FAIL: expected ValueError for size\n");
+        goto out;
+    }
+    ndt_err_clear(ctx);
+    count++;
+
+    offsets = ndt_offsets_from_external(NULL, 4, &external_released,
+                                        release_external, ctx);
+    if (offsets != NULL || ctx->err != NDT_ValueError || external_released != 3) {
+        fprintf(stderr, "test_offsets_external: FAIL: expected ValueError for NULL\n");
+        goto out;
+    }
+    ndt_err_clear(ctx);
+    count++;
+
+    /* External offsets count against the limits. */
+    ndt_context_set_limits(ctx, &limits);
+    ndt_limits_begin(ctx);
+    offsets = ndt_offsets_from_external(buf, 4, &external_released,
+                                        release_external, ctx);
+    ndt_limits_end(ctx);
+    ndt_context_set_limits(ctx, NULL);
+    if (offsets != NULL || ctx->err != NDT_ValueError || external_released != 4) {
+        fprintf(stderr, "test_offsets_external: FAIL: expected limit error\n");
+        goto out;
+    }
+    ndt_err_clear(ctx);
+    count++;
+
+    /* Uninitialized allocation */
+    offsets = ndt_offsets_new_uninit(3, ctx);
+    if (offsets == NULL || offsets->n != 3 || offsets->v == NULL) {
+        fprintf(stderr, "test_offsets_external: FAIL: unexpected failure in new_uninit\n");
+        goto out;
+    }
+    count++;
+
+    fprintf(stderr, "test_offsets_external (%d test cases)\n", count);
+    ret = 0;
+
+out:
+    ndt_decref_offsets(offsets);
+    ndt_decref(t);
+    ndt_context_del(ctx);
+    return ret;
+}
+
+typedef struct {
+    int64_t nalloc;
+    int64_t nfree;
+} class_counter_t;
+
+static void *
+counting_alloc(size_t size, void *arg)
+{
+    ((class_counter_t *)arg)->nalloc++;
+    return malloc(size);
+}
+
+static void *
+counting_realloc(void *ptr, size_t size, void *arg)
+{
+    if (ptr == NULL) {
+        ((class_counter_t *)arg)->nalloc++;
+    }
+    return realloc(ptr, size);
+}
+
+static void
+counting_free(void *ptr, void *arg)
+{
+    ((class_counter_t *)arg)->nfree++;
+    free(ptr);
+}
+
+static int
+test_alloc_class(void)
+{
+    static const char *s = "var(offsets=[0,2]) * var(offsets=[0,3,5]) * {a: int64, b: string}";
+    class_counter_t counter[NDT_ALLOC_NCLASSES];
+    ndt_alloc_hooks_t hooks;
+    ndt_alloc_stats_t stats;
+    const ndt_t *t = NULL;
+    const ndt_t *u = NULL;
+    char *bytes = NULL;
+    int64_t len;
+    ndt_context_t *ctx;
+    int count = 0;
+    int ret = -1;
+    int i;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (i = 0; i < NDT_ALLOC_NCLASSES; i++) {
+        counter[i].nalloc = counter[i].nfree = 0;
+        hooks.alloc = counting_alloc;
+        hooks.realloc = counting_realloc;
+        hooks.free = counting_free;
+        hooks.arg = &counter[i];
+        if (ndt_set_alloc_hooks(i, &hooks, ctx) < 0) {
+            fprintf(stderr, "test_alloc_class: FAIL: could not set hooks\n");
+            goto out;
+        }
+    }
+    ndt_alloc_stats_reset();
+
+    t = ndt_from_string(s, ctx);
+    if (t == NULL) {
+        fprintf(stderr, "test_alloc_class: FAIL: unexpected failure in from_string\n");
+        goto out;
+    }
+
+    len = ndt_serialize(&bytes, t, ctx);
+    if (len < 0) {
+        fprintf(stderr, "test_alloc_class: FAIL: unexpected failure in serialize\n");
+        goto out;
+    }
+
+    u = ndt_deserialize(bytes, len, ctx);
+    if (u == NULL) {
+        fprintf(stderr, "test_alloc_class: FAIL: unexpected failure in deserialize\n");
+        goto out;
+    }
 
-            ndt_set_alloc_fail();
-            t = ndt_from_bpformat(*c, ctx);
-            ndt_set_alloc();
+    /* Two offset arrays each for the parser and the deserializer. */
+    if (counter[NDT_ALLOC_NODE].nalloc == 0 ||
+        counter[NDT_ALLOC_OFFSETS].nalloc != 4 ||
+        counter[NDT_ALLOC_SCRATCH].nalloc == 0) {
+        fprintf(stderr, "test_alloc_class: FAIL: hooks were not used\n");
+        goto out;
+    }
+    count++;
 
-            if (ctx->err != NDT_MemoryError) {
-                break;
-            }
+    ndt_decref(t); t = NULL;
+    ndt_decref(u); u = NULL;
 
-            if (t != NULL) {
-                ndt_decref(t);
-                ndt_context_del(ctx);
-                fprintf(stderr, "test_buffer: convert: FAIL: t != NULL after MemoryError\n");
-                fprintf(stderr, "test_buffer: convert: FAIL: %s\n", *c);
-                return -1;
-            }
-        }
-        if (t == NULL) {
-            fprintf(stderr, "test_buffer: convert: FAIL: expected success: \"%s\"\n", *c);
-            fprintf(stderr, "test_buffer: convert: FAIL: got: %s: %s\n\n",
-                    ndt_err_as_string(ctx->err),
-                    ndt_context_msg(ctx));
-            ndt_context_del(ctx);
-            return -1;
+    for (i = 0; i < NDT_ALLOC_NCLASSES; i++) {
+        ndt_alloc_stats(&stats, i);
+        if (counter[i].nalloc != counter[i].nfree ||
+            stats.nalloc != counter[i].nalloc || stats.nfree != counter[i].nfree ||
+            (stats.nalloc > 0 && stats.nbytes == 0)) {
+            fprintf(stderr, "test_alloc_class: FAIL: unbalanced class %d\n", i);
+            goto out;
         }
-
-        ndt_decref(t);
         count++;
     }
-    fprintf(stderr, "test_buffer (%d test cases)\n", count);
 
+    /* Disabled statistics are not updated. */
+    ndt_alloc_stats_enable(false);
+    ndt_alloc_stats_reset();
+    t = ndt_from_string(s, ctx);
+    ndt_decref(t); t = NULL;
+    ndt_alloc_stats_enable(true);
+    ndt_alloc_stats(&stats, NDT_ALLOC_NODE);
+    if (stats.nalloc != 0 || stats.nfree != 0 || stats.nbytes != 0) {
+        fprintf(stderr, "test_alloc_class: FAIL: disabled statistics were updated\n");
+        goto out;
+    }
+    count++;
+
+    hooks.free = NULL;
+    if (ndt_set_alloc_hooks(NDT_ALLOC_NODE, &hooks, ctx) != -1 ||
+        ctx->err != NDT_ValueError) {
+        fprintf(stderr, "test_alloc_class: FAIL: expected ValueError\n");
+        goto out;
+    }
+    ndt_err_clear(ctx);
+    count++;
+
+    fprintf(stderr, "test_alloc_class (%d test cases)\n", count);
+    ret = 0;
+
+out:
+    ndt_decref(t);
+    ndt_decref(u);
+    ndt_free(bytes);
+    for (i = 0; i < NDT_ALLOC_NCLASSES; i++) {
+        (void)ndt_set_alloc_hooks(i, NULL, ctx);
+    }
     ndt_context_del(ctx);
-    return 0;
+    return ret;
 }
 
 static int
-test_buffer_roundtrip(void)
+test_swap_plan(void)
 {
-    const char **c;
+    /* 'F' is replaced by the foreign byte order mark. */
+    static const struct {
+        const char *type;
+        const char *native;
+        int64_t nruns;
+        ndt_swap_run_t runs[4];
+    } tests[] = {
+      { "10 * Fint64", "10 * int64", 1, {{0, 8, 10, 8}} },
+      { "3 * 2 * Fcomplex64", "3 * 2 * complex64", 1, {{0, 4, 12, 4}} },
+      { "{a: Fint32, b: Fint32, c: int8}", "{a: int32, b: int32, c: int8}",
+        1, {{0, 4, 2, 4}} },
+      { "2 * {a: Fint32, b: Fint32, c: int8, d: Ffloat64}",
+        "2 * {a: int32, b: int32, c: int8, d: float64}",
+        3, {{0, 4, 2, 24}, {4, 4, 2, 24}, {16, 8, 2, 24}} },
+      { "var(offsets=[0,2]) * var(offsets=[0,3,5]) * (int8, Fuint16)",
+        "var(offsets=[0,2]) * var(offsets=[0,3,5]) * (int8, uint16)",
+        1, {{2, 2, 5, 4}} },
+      { "10 * 2 * int16", "10 * 2 * int16", 0, {{0}} },
+    };
+    const char foreign = NDT_SYS_BIG_ENDIAN ? '<' : '>';
+    ndt_swap_plan_t plan = {0, NULL};
+    const ndt_t *t = NULL, *u = NULL, *v = NULL;
     ndt_context_t *ctx;
-    const ndt_t *t;
-    char *s;
+    char buf[256];
     int count = 0;
-    int ret;
+    int ret = -1;
 
     ctx = ndt_context_new();
     if (ctx == NULL) {
@@ -1402,91 +4617,137 @@ test_buffer_roundtrip(void)
         return -1;
     }
 
-    for (c = buffer_roundtrip_tests; *c != NULL; c++) {
+    for (size_t i = 0; i < sizeof tests / sizeof tests[0]; i++) {
+        snprintf(buf, sizeof buf, "%s", tests[i].type);
+        for (char *cp = buf; *cp != '\0'; cp++) {
+            if (*cp == 'F') *cp = foreign;
+        }
+
+        t = ndt_from_string(buf, ctx);
+        u = ndt_from_string(tests[i].native, ctx);
+        if (t == NULL || u == NULL) {
+            fprintf(stderr, "test_swap_plan: FAIL: unexpected failure in from_string\n");
+            goto out;
+        }
+
         for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
             ndt_err_clear(ctx);
 
             ndt_set_alloc_fail();
-            t = ndt_from_bpformat(*c, ctx);
+            v = ndt_native_endian(t, ctx);
             ndt_set_alloc();
 
             if (ctx->err != NDT_MemoryError) {
                 break;
             }
 
-            if (t != NULL) {
-                ndt_decref(t);
-                ndt_context_del(ctx);
-                fprintf(stderr, "test_buffer: convert: FAIL: t != NULL after MemoryError\n");
-                fprintf(stderr, "test_buffer: convert: FAIL: %s\n", *c);
-                return -1;
+            if (v != NULL) {
+                fprintf(stderr, "test_swap_plan: FAIL: v != NULL after MemoryError\n");
+                goto out;
             }
         }
-        if (t == NULL) {
-            fprintf(stderr, "test_buffer: convert: FAIL: expected success: \"%s\"\n", *c);
-            fprintf(stderr, "test_buffer: convert: FAIL: got: %s: %s\n\n",
-                    ndt_err_as_string(ctx->err),
-                    ndt_context_msg(ctx));
-            ndt_context_del(ctx);
-            return -1;
+
+        if (v == NULL || !ndt_equal(u, v) || v->datasize != t->datasize) {
+            fprintf(stderr, "test_swap_plan: FAIL: native type mismatch: %s\n", buf);
+            goto out;
         }
 
         for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
             ndt_err_clear(ctx);
 
             ndt_set_alloc_fail();
-            s = ndt_to_bpformat(t, ctx);
+            (void)ndt_swap_plan(&plan, t, ctx);
             ndt_set_alloc();
 
             if (ctx->err != NDT_MemoryError) {
                 break;
             }
 
-            if (s != NULL) {
-                ndt_free(s);
-                ndt_decref(t);
-                ndt_context_del(ctx);
-                fprintf(stderr, "test_buffer_roundtrip: convert: FAIL: s != NULL after MemoryError\n");
-                fprintf(stderr, "test_buffer_roundtrip: convert: FAIL: %s\n", *c);
-                return -1;
+            if (plan.nruns != 0 || plan.runs != NULL) {
+                fprintf(stderr, "test_swap_plan: FAIL: plan not cleared after MemoryError\n");
+                goto out;
             }
         }
-        if (s == NULL) {
-            fprintf(stderr, "test_buffer_roundtrip: convert: FAIL: expected success: \"%s\"\n", *c);
-            fprintf(stderr, "test_buffer_roundtrip: convert: FAIL: got: %s: %s\n\n",
-                    ndt_err_as_string(ctx->err),
-                    ndt_context_msg(ctx));
-            ndt_decref(t);
-            ndt_context_del(ctx);
-            return -1;
-        }
-
-        ret = strcmp(s, *c);
-        ndt_decref(t);
 
-        if (ret != 0) {
-            fprintf(stderr, "test_buffer_roundtrip: convert: FAIL: input: \"%s\" output: \"%s\"\n", *c, s);
-            ndt_free(s);
-            ndt_context_del(ctx);
-            return -1;
+        if (ctx->err != NDT_Success || plan.nruns != tests[i].nruns ||
+            (plan.nruns > 0 && memcmp(plan.runs, tests[i].runs,
+                                      plan.nruns * sizeof *plan.runs) != 0)) {
+            fprintf(stderr, "test_swap_plan: FAIL: unexpected plan: %s\n", buf);
+            goto out;
         }
 
-        ndt_free(s);
+        ndt_swap_plan_clear(&plan);
+        ndt_decref(t); t = NULL;
+        ndt_decref(u); u = NULL;
+        ndt_decref(v); v = NULL;
         count++;
     }
-    fprintf(stderr, "test_buffer_roundtrip (%d test cases)\n", count);
 
+    /* Indexed var dimensions keep the index. */
+    snprintf(buf, sizeof buf, "var(offsets=[0,2]) * var(offsets=[0,3,5]) * %cint32",
+             foreign);
+    u = ndt_from_string(buf, ctx);
+    if (u == NULL) {
+        fprintf(stderr, "test_swap_plan: FAIL: unexpected failure in from_string\n");
+        goto out;
+    }
+
+    t = ndt_convert_to_var_elem(u, u->VarDim.type, 1, ctx);
+    ndt_decref(u); u = NULL;
+    if (t == NULL) {
+        fprintf(stderr, "test_swap_plan: FAIL: unexpected failure in convert_to_var_elem\n");
+        goto out;
+    }
+
+    v = ndt_native_endian(t, ctx);
+    if (v == NULL || v->tag != VarDimElem || v->VarDimElem.index != 1 ||
+        ndt_endian_is_set(ndt_dtype(v)) ||
+        v->Concrete.VarDim.nelem != t->Concrete.VarDim.nelem) {
+        fprintf(stderr, "test_swap_plan: FAIL: unexpected native var elem\n");
+        goto out;
+    }
+    ndt_decref(t); t = NULL;
+    ndt_decref(v); v = NULL;
+    count++;
+
+    fprintf(stderr, "test_swap_plan (%d test cases)\n", count);
+    ret = 0;
+
+out:
+    ndt_swap_plan_clear(&plan);
+    ndt_decref(t);
+    ndt_decref(u);
+    ndt_decref(v);
     ndt_context_del(ctx);
-    return 0;
+    return ret;
 }
 
 static int
-test_buffer_error(void)
+test_fingerprint(void)
 {
-    const char **c;
+    static const struct {
+        const char *t;
+        const char *u;
+        int same_structure;
+        int same_concrete;
+    } tests[] = {
+      { "10 * {a: int64, b: float32}", "10 * {a: int64, b: float32}", 1, 1 },
+      { "10 * {a: int64, b: float32}", "10 * {a: int64, c: float32}", 0, 0 },
+      { "10 * {a: int64, b: float32}", "10 * {a: int64, b: ?float32}", 0, 0 },
+      { "var(offsets=[0,2]) * int64", "var(offsets=[0,3]) * int64", 1, 0 },
+      { "2 * 3 * int64", "!2 * 3 * int64", 1, 0 },
+      { "{a: int8, b: int64}", "{a: int8, b: int64, pack=1}", 1, 0 },
+      { "<int32", ">int32", 0, 0 },
+      { "... * N * float64 -> ... * N * float64", "... * M * float64 -> ... * M * float64", 0, 0 },
+    };
+    ndt_fingerprint_t x, y;
+    ndt_apply_spec_t spec = ndt_apply_spec_empty;
+    ndt_apply_spec_t other = ndt_apply_spec_empty;
+    const ndt_t *t = NULL, *u = NULL;
+    const ndt_t *a = NULL, *b = NULL, *c = NULL;
     ndt_context_t *ctx;
-    const ndt_t *t;
     int count = 0;
+    int ret = -1;
 
     ctx = ndt_context_new();
     if (ctx == NULL) {
@@ -1494,52 +4755,130 @@ test_buffer_error(void)
         return -1;
     }
 
-    for (c = buffer_error_tests; *c != NULL; c++) {
-        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
-            ndt_err_clear(ctx);
-
-            ndt_set_alloc_fail();
-            t = ndt_from_bpformat(*c, ctx);
-            ndt_set_alloc();
+    for (size_t i = 0; i < sizeof tests / sizeof tests[0]; i++) {
+        t = ndt_from_string(tests[i].t, ctx);
+        u = ndt_from_string(tests[i].u, ctx);
+        if (t == NULL || u == NULL) {
+            fprintf(stderr, "test_fingerprint: FAIL: unexpected failure in from_string\n");
+            goto out;
+        }
 
-            if (ctx->err != NDT_MemoryError) {
-                break;
-            }
+        if (ndt_fingerprint(&x, t, 0, ctx) < 0 || ndt_fingerprint(&y, u, 0, ctx) < 0) {
+            fprintf(stderr, "test_fingerprint: FAIL: unexpected failure\n");
+            goto out;
+        }
+        if ((x.hi == y.hi && x.lo == y.lo) != tests[i].same_structure) {
+            fprintf(stderr, "test_fingerprint: FAIL: structure: %s, %s\n",
+                    tests[i].t, tests[i].u);
+            goto out;
+        }
 
-            if (t != NULL) {
-                ndt_decref(t);
-                ndt_context_del(ctx);
-                fprintf(stderr, "test_buffer_error: FAIL: t != NULL after MemoryError\n");
-                fprintf(stderr, "test_buffer_error: FAIL: input: %s\n", *c);
-                return -1;
-            }
+        if (ndt_fingerprint(&x, t, NDT_FP_CONCRETE, ctx) < 0 ||
+            ndt_fingerprint(&y, u, NDT_FP_CONCRETE, ctx) < 0) {
+            fprintf(stderr, "test_fingerprint: FAIL: unexpected failure\n");
+            goto out;
         }
-        if (t != NULL) {
-            fprintf(stderr, "test_buffer_error: FAIL: unexpected success: \"%s\"\n", *c);
-            fprintf(stderr, "test_buffer_error: FAIL: t != NULL after %s: %s\n",
-                    ndt_err_as_string(ctx->err),
-                    ndt_context_msg(ctx));
-            ndt_decref(t);
-            ndt_context_del(ctx);
-            return -1;
+        if ((x.hi == y.hi && x.lo == y.lo) != tests[i].same_concrete) {
+            fprintf(stderr, "test_fingerprint: FAIL: concrete: %s, %s\n",
+                    tests[i].t, tests[i].u);
+            goto out;
         }
+
+        ndt_decref(t); t = NULL;
+        ndt_decref(u); u = NULL;
         count++;
     }
-    fprintf(stderr, "test_buffer_error (%d test cases)\n", count);
 
+    /* Fingerprints are stable across hosts and releases. */
+    t = ndt_from_string("10 * {a: int64, b: float32}", ctx);
+    if (t == NULL || ndt_fingerprint(&x, t, NDT_FP_CONCRETE, ctx) < 0 ||
+        x.hi != UINT64_C(0x9a13077a815dac82) || x.lo != UINT64_C(0x707cb832a5a9b385)) {
+        fprintf(stderr, "test_fingerprint: FAIL: fingerprint is not stable\n");
+        goto out;
+    }
+    ndt_decref(t); t = NULL;
+    count++;
+
+    /* Kernel keys ignore shapes, but not dtypes or kernel flags. */
+    a = ndt_from_string("10 * 2 * float64", ctx);
+    b = ndt_from_string("20 * 5 * float64", ctx);
+    c = ndt_from_string("10 * 2 * float32", ctx);
+    if (a == NULL || b == NULL || c == NULL) {
+        fprintf(stderr, "test_fingerprint: FAIL: unexpected failure in from_string\n");
+        goto out;
+    }
+
+    spec.flags = other.flags = NDT_INNER_C;
+    spec.outer_dims = other.outer_dims = 1;
+    spec.nin = other.nin = 1;
+    spec.nout = other.nout = 1;
+    spec.nargs = other.nargs = 2;
+    spec.types[0] = spec.types[1] = a;
+    other.types[0] = other.types[1] = b;
+
+    if (ndt_kernel_key(&x, &spec, ctx) < 0 || ndt_kernel_key(&y, &other, ctx) < 0 ||
+        x.hi != y.hi || x.lo != y.lo) {
+        fprintf(stderr, "test_fingerprint: FAIL: kernel keys differ for equal kernels\n");
+        goto out;
+    }
+    count++;
+
+    other.types[1] = c;
+    if (ndt_kernel_key(&y, &other, ctx) < 0 || (x.hi == y.hi && x.lo == y.lo)) {
+        fprintf(stderr, "test_fingerprint: FAIL: kernel keys equal for different dtypes\n");
+        goto out;
+    }
+    count++;
+
+    other.types[1] = b;
+    other.flags = NDT_INNER_STRIDED;
+    if (ndt_kernel_key(&y, &other, ctx) < 0 || (x.hi == y.hi && x.lo == y.lo)) {
+        fprintf(stderr, "test_fingerprint: FAIL: kernel keys equal for different flags\n");
+        goto out;
+    }
+    count++;
+
+    fprintf(stderr, "test_fingerprint (%d test cases)\n", count);
+    ret = 0;
+
+out:
+    ndt_decref(t);
+    ndt_decref(u);
+    ndt_decref(a);
+    ndt_decref(b);
+    ndt_decref(c);
     ndt_context_del(ctx);
-    return 0;
+    return ret;
 }
 
 static int
-test_serialize(void)
+test_record_project(void)
 {
-    const char **c;
+    static const struct {
+        const char *type;
+        const char *names[2];
+        int64_t n;
+        enum ndt_project mode;
+        const char *expected;
+    } tests[] = {
+      { "10 * {a: int8, b: int64, c: int16, d: float64}", {"b", "d"}, 2,
+        ProjectPacked, "10 * {b: int64, d: float64}" },
+      { "10 * {a: int8, b: int64, c: int16, d: float64}", {"d", "b"}, 2,
+        ProjectPacked, "10 * {b: int64, d: float64}" },
+      { "{a: int8, b: int64}", {"a", NULL}, 1,
+        ProjectPacked, "{a: int8}" },
+      { "var(offsets=[0,2]) * var(offsets=[0,1,3]) * {a: int8, b: int32}", {"b", NULL}, 1,
+        ProjectPacked, "var(offsets=[0,2]) * var(offsets=[0,1,3]) * {b: int32}" },
+      { "10 * {a: int8, b: int64, c: int16, d: float64}", {"b", "d"}, 2,
+        ProjectView, NULL },
+      { "var(offsets=[0,2]) * var(offsets=[0,1,3]) * {a: int8, b: int32}", {"b", NULL}, 1,
+        ProjectView, NULL },
+    };
+    const ndt_t *t = NULL, *u = NULL, *v = NULL;
+    const int64_t index = 1;
     ndt_context_t *ctx;
-    const ndt_t *t, *u;
     int count = 0;
-    char *bytes;
-    int64_t len;
+    int ret = -1;
 
     ctx = ndt_context_new();
     if (ctx == NULL) {
@@ -1547,98 +4886,147 @@ test_serialize(void)
         return -1;
     }
 
-    for (c = parse_tests; *c != NULL; c++) {
-        t = ndt_from_string(*c, ctx);
+    for (size_t i = 0; i < sizeof tests / sizeof tests[0]; i++) {
+        t = ndt_from_string(tests[i].type, ctx);
         if (t == NULL) {
-            ndt_context_del(ctx);
-            fprintf(stderr,
-                "test_serialize: FAIL: unexpected failure in from_string");
-            return -1;
+            fprintf(stderr, "test_record_project: FAIL: unexpected failure in from_string\n");
+            goto out;
         }
 
         for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
             ndt_err_clear(ctx);
-            bytes = NULL;
 
             ndt_set_alloc_fail();
-            len = ndt_serialize(&bytes, t, ctx);
+            u = ndt_record_project(t, tests[i].names, tests[i].n, tests[i].mode, ctx);
             ndt_set_alloc();
 
             if (ctx->err != NDT_MemoryError) {
                 break;
             }
 
-            if (len >= 0 || bytes != NULL) {
-                ndt_decref(t);
-                ndt_free(bytes);
-                ndt_context_del(ctx);
-                fprintf(stderr, "test_serialize: FAIL: invalid len or bytes after MemoryError\n");
-                fprintf(stderr, "test_serialize: FAIL: %s\n", *c);
-                return -1;
+            if (u != NULL) {
+                fprintf(stderr, "test_record_project: FAIL: u != NULL after MemoryError\n");
+                goto out;
             }
         }
 
-        if (len < 0 || bytes == NULL) {
-            ndt_decref(t);
-            ndt_free(bytes);
-            ndt_context_del(ctx);
-            fprintf(stderr, "test_serialize: FAIL: invalid len or bytes (expected success)\n");
-            fprintf(stderr, "test_serialize: FAIL: %s\n", *c);
-            return -1;
+        if (u == NULL) {
+            fprintf(stderr, "test_record_project: FAIL: unexpected failure: %s: %s\n",
+                    ndt_err_as_string(ctx->err), ndt_context_msg(ctx));
+            goto out;
         }
 
-        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
-            ndt_err_clear(ctx);
-
-            ndt_set_alloc_fail();
-            u = ndt_deserialize(bytes, len, ctx);
-            ndt_set_alloc();
-
-            if (ctx->err != NDT_MemoryError) {
-                break;
+        if (tests[i].mode == ProjectPacked) {
+            v = ndt_from_string(tests[i].expected, ctx);
+            if (v == NULL || !ndt_equal(u, v)) {
+                fprintf(stderr, "test_record_project: FAIL: unexpected result for %s\n",
+                        tests[i].type);
+                goto out;
+            }
+        }
+        else {
+            const ndt_t *dt = ndt_dtype(t);
+            const ndt_t *du = ndt_dtype(u);
+
+            if (u->datasize != t->datasize || du->datasize != dt->datasize ||
+                du->align != dt->align || du->Record.shape != tests[i].n) {
+                fprintf(stderr, "test_record_project: FAIL: view layout differs for %s\n",
+                        tests[i].type);
+                goto out;
             }
 
-            if (u != NULL) {
-                ndt_decref(t);
-                ndt_decref(u);
-                ndt_free(bytes);
-                ndt_context_del(ctx);
-                fprintf(stderr, "test_serialize: FAIL: u != NULL after MemoryError\n");
-                fprintf(stderr, "test_serialize: FAIL: %s\n", *c);
-                return -1;
+            for (int64_t k = 0; k < du->Record.shape; k++) {
+                int64_t j;
+                for (j = 0; j < dt->Record.shape; j++) {
+                    if (strcmp(dt->Record.names[j], du->Record.names[k]) == 0) {
+                        break;
+                    }
+                }
+                if (j == dt->Record.shape ||
+                    du->Concrete.Record.offset[k] != dt->Concrete.Record.offset[j]) {
+                    fprintf(stderr, "test_record_project: FAIL: view offset differs for %s\n",
+                            tests[i].type);
+                    goto out;
+                }
             }
         }
 
-        if (u == NULL) {
-            fprintf(stderr, "test_serialize: FAIL: expected success: \"%s\"\n", *c);
-            fprintf(stderr, "test_serialize: FAIL: got: %s: %s\n\n",
-                    ndt_err_as_string(ctx->err),
-                    ndt_context_msg(ctx));
-            ndt_decref(t);
-            ndt_free(bytes);
-            ndt_context_del(ctx);
-            return -1;
-        }
+        ndt_decref(t); t = NULL;
+        ndt_decref(u); u = NULL;
+        ndt_decref(v); v = NULL;
+        count++;
+    }
 
-        ndt_free(bytes);
+    /* Tuple projection by index */
+    t = ndt_from_string("2 * (int8, int64)", ctx);
+    v = ndt_from_string("2 * (int64)", ctx);
+    if (t == NULL || v == NULL) {
+        fprintf(stderr, "test_record_project: FAIL: unexpected failure in from_string\n");
+        goto out;
+    }
 
-        if (!ndt_equal(u, t)) {
-            fprintf(stderr, "test_serialize: FAIL: u != v in %s\n", *c);
-            ndt_decref(t);
-            ndt_decref(u);
-            ndt_context_del(ctx);
-            return -1;
-        }
+    u = ndt_record_project_index(t, &index, 1, ProjectPacked, ctx);
+    if (u == NULL || !ndt_equal(u, v)) {
+        fprintf(stderr, "test_record_project: FAIL: unexpected tuple projection\n");
+        goto out;
+    }
+    ndt_decref(u); u = NULL;
+    count++;
 
-        ndt_decref(t);
-        ndt_decref(u);
+    /* Invalid arguments */
+    {
+        const int64_t dup[2] = {1, 1};
+        const char *missing[1] = {"x"};
+
+        u = ndt_record_project_index(t, dup, 2, ProjectView, ctx);
+        if (u != NULL || ctx->err != NDT_ValueError) {
+            fprintf(stderr, "test_record_project: FAIL: expected ValueError for duplicates\n");
+            goto out;
+        }
+        ndt_err_clear(ctx);
 
+        u = ndt_record_project(t, missing, 1, ProjectView, ctx);
+        if (u != NULL || ctx->err != NDT_TypeError) {
+            fprintf(stderr, "test_record_project: FAIL: expected TypeError for tuple\n");
+            goto out;
+        }
+        ndt_err_clear(ctx);
         count++;
     }
-    fprintf(stderr, "test_serialize (%d test cases)\n", count);
+    ndt_decref(t); t = NULL;
+    ndt_decref(v); v = NULL;
+
+    /* Indexed var dimensions keep the index. */
+    v = ndt_from_string("var(offsets=[0,2]) * var(offsets=[0,3,5]) * (int8, int64)", ctx);
+    if (v == NULL) {
+        fprintf(stderr, "test_record_project: FAIL: unexpected failure in from_string\n");
+        goto out;
+    }
+
+    t = ndt_convert_to_var_elem(v, v->VarDim.type, 1, ctx);
+    ndt_decref(v); v = NULL;
+    if (t == NULL) {
+        fprintf(stderr, "test_record_project: FAIL: unexpected failure in convert_to_var_elem\n");
+        goto out;
+    }
+
+    u = ndt_record_project_index(t, &index, 1, ProjectPacked, ctx);
+    if (u == NULL || u->tag != VarDimElem || u->VarDimElem.index != 1 ||
+        ndt_dtype(u)->tag != Tuple || ndt_dtype(u)->Tuple.shape != 1) {
+        fprintf(stderr, "test_record_project: FAIL: unexpected var elem projection\n");
+        goto out;
+    }
+    count++;
+
+    fprintf(stderr, "test_record_project (%d test cases)\n", count);
+    ret = 0;
 
+out:
+    ndt_decref(t);
+    ndt_decref(u);
+    ndt_decref(v);
     ndt_context_del(ctx);
-    return 0;
+    return ret;
 }
 
 #if defined(__linux__)
@@ -1719,6 +5107,30 @@ static int (*tests[])(void) = {
   test_buffer_roundtrip,
   test_buffer_error,
   test_serialize,
+  test_typedef_bundle,
+  test_offsets_intern,
+  test_offsets_external,
+  test_alloc_class,
+  test_swap_plan,
+  test_record_project,
+  test_fingerprint,
+  test_nb_signature,
+  test_graph_typecheck,
+  test_tiled,
+  test_all_valid,
+  test_symbol_intern,
+  test_match_batch,
+  test_typecheck_specialize,
+  test_context_default,
+  test_typecheck_ndarray,
+  test_copy_contiguous_at,
+  test_typecheck_reduce,
+  test_utf8,
+  test_nelem,
+  test_owned_refcnt,
+  test_parse_scratch,
+  test_parse_scalar,
+  test_limits,
 #ifdef __linux__
   test_serialize_fuzz,
 #endif
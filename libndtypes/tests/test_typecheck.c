@@ -824,5 +824,64 @@ const typecheck_testcase_t typecheck_tests[] = {
     .nargs=3,
     .types={ "array * array * float64", "array * uint8", "array * array * int64" } },
 
+  { .loc = loc(),
+    .success=true,
+
+    .signature="N * {x: T, y: T} -> N * T",
+    .args={"3 * {x: float64, y: float64}"},
+    .kwargs={NULL},
+
+    .outer_dims=0,
+    .nin=1,
+    .nout=1,
+    .nargs=2,
+    .types={ "3 * {x: float64, y: float64}", "3 * float64" } },
+
+  { .loc = loc(),
+    .success=false,
+
+    .signature="N * {x: T, y: T} -> N * T",
+    .args={"3 * {x: float64, y: int64}"},
+    .kwargs={NULL} },
+
+  { .loc = loc(),
+    .success=true,
+
+    .signature="... * T, ... * T -> ... * {min: T, max: T}",
+    .args={"2 * 10 * int32", "2 * 10 * int32"},
+    .kwargs={NULL},
+
+    .outer_dims=2,
+    .nin=2,
+    .nout=1,
+    .nargs=3,
+    .types={ "2 * 10 * int32", "2 * 10 * int32", "2 * 10 * {min: int32, max: int32}" } },
+
+  { .loc = loc(),
+    .success=true,
+
+    .signature="N * (T, U) -> N * (U, T, {a: U})",
+    .args={"5 * (int8, float64)"},
+    .kwargs={NULL},
+
+    .outer_dims=0,
+    .nin=1,
+    .nout=1,
+    .nargs=2,
+    .types={ "5 * (int8, float64)", "5 * (float64, int8, {a: float64})" } },
+
+  { .loc = loc(),
+    .success=true,
+
+    .signature="N * [A of T | B of U] -> N * [B of U | A of T]",
+    .args={"5 * [A of int16 | B of string]"},
+    .kwargs={NULL},
+
+    .outer_dims=0,
+    .nin=1,
+    .nout=1,
+    .nargs=2,
+    .types={ "5 * [A of int16 | B of string]", "5 * [B of string | A of int16]" } },
+
   { .loc=NULL, .success=false, .signature= NULL, .args={NULL}, .kwargs={NULL} }
 };
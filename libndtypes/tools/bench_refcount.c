@@ -0,0 +1,196 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2017-2018, plures
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * Reference counting benchmark.  Each thread repeatedly increments and
+ * decrements the reference count of a type:
+ *
+ *   shared:  all threads use the same type (contended atomic updates)
+ *   private: each thread uses its own type (uncontended atomic updates)
+ *   owned:   each thread uses its own type in owned mode (non-atomic updates)
+ *
+ * Usage: bench_refcount [nthreads] [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include "ndtypes.h"
+
+
+#define MAX_THREADS 64
+
+typedef struct {
+    const ndt_t *t;
+    int64_t iterations;
+} job_t;
+
+static void *
+worker(void *arg)
+{
+    job_t *job = arg;
+
+    for (int64_t i = 0; i < job->iterations; i++) {
+        ndt_incref(job->t);
+        ndt_decref(job->t);
+    }
+
+    return NULL;
+}
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int
+run(const char *name, const ndt_t *types[], int nthreads, int64_t iterations)
+{
+    pthread_t threads[MAX_THREADS];
+    job_t jobs[MAX_THREADS];
+    double start, elapsed;
+    int i;
+
+    start = now();
+
+    for (i = 0; i < nthreads; i++) {
+        jobs[i].t = types[i];
+        jobs[i].iterations = iterations;
+        if (pthread_create(&threads[i], NULL, worker, &jobs[i]) != 0) {
+            fprintf(stderr, "pthread_create failed\n");
+            return -1;
+        }
+    }
+
+    for (i = 0; i < nthreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    elapsed = now() - start;
+    printf("%-8s threads=%-3d %8.2f ns per incref/decref pair\n", name, nthreads,
+           elapsed * 1e9 / (double)iterations);
+
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    const char *s = "10 * {a: int64, b: var * float64}";
+    const ndt_t *shared[MAX_THREADS];
+    const ndt_t *private[MAX_THREADS];
+    const ndt_t *t;
+    ndt_context_t *ctx;
+    int nthreads = 4;
+    int64_t iterations = 10000000;
+    int ret = 1;
+    int i;
+
+    if (argc > 1) {
+        nthreads = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        iterations = atoll(argv[2]);
+    }
+    if (nthreads < 1 || nthreads > MAX_THREADS || iterations < 1) {
+        fprintf(stderr, "usage: bench_refcount [nthreads (1-%d)] [iterations]\n",
+                MAX_THREADS);
+        return 1;
+    }
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    if (ndt_init(ctx) < 0) {
+        ndt_err_fprint(stderr, ctx);
+        ndt_context_del(ctx);
+        return 1;
+    }
+
+    t = ndt_from_string(s, ctx);
+    if (t == NULL) {
+        ndt_err_fprint(stderr, ctx);
+        goto out;
+    }
+
+    for (i = 0; i < nthreads; i++) {
+        shared[i] = t;
+        private[i] = NULL;
+    }
+
+    for (i = 0; i < nthreads; i++) {
+        private[i] = ndt_from_string(s, ctx);
+        if (private[i] == NULL) {
+            ndt_err_fprint(stderr, ctx);
+            goto out;
+        }
+    }
+
+    if (run("shared", shared, nthreads, iterations) < 0 ||
+        run("private", private, nthreads, iterations) < 0) {
+        goto out;
+    }
+
+    for (i = 0; i < nthreads; i++) {
+        ndt_set_owned(private[i], true);
+    }
+
+    if (run("owned", private, nthreads, iterations) < 0) {
+        goto out;
+    }
+
+    for (i = 0; i < nthreads; i++) {
+        ndt_set_owned(private[i], false);
+    }
+
+    ret = 0;
+
+out:
+    for (i = 0; i < nthreads; i++) {
+        ndt_decref(private[i]);
+    }
+    ndt_decref(t);
+    ndt_context_del(ctx);
+    ndt_finalize();
+
+    return ret;
+}
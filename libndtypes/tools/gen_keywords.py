@@ -0,0 +1,93 @@
+#
+# Generate keywords.h from the scalar type rules in lexer.l.
+#
+# Usage: python3 tools/gen_keywords.py lexer.l > keywords.h
+#
+# The table is a perfect hash of the scalar type names that are handled by
+# the fast path of ndt_from_string() in parser.c.  The multipliers of the
+# hash function are found by search such that all names have distinct slots.
+#
+
+import re
+import sys
+
+
+# Tokens that scalar_from_string() in parser.c knows how to construct.
+SCALARS = [
+  "BOOL",
+  "INT8", "INT16", "INT32", "INT64",
+  "UINT8", "UINT16", "UINT32", "UINT64",
+  "BFLOAT16", "FLOAT16", "FLOAT32", "FLOAT64",
+  "BCOMPLEX32", "COMPLEX32", "COMPLEX64", "COMPLEX128",
+  "INTPTR", "UINTPTR", "SIZE",
+  "STRING",
+]
+
+SLOTS = 128
+
+RULE = re.compile(r'^"([a-zA-Z_][a-zA-Z0-9_]*)"\s+\{ return ([A-Z0-9_]+); \}$')
+
+
+def read_keywords(path):
+    names = {}
+    with open(path) as f:
+        for line in f:
+            m = RULE.match(line.strip())
+            if m and m.group(2) in SCALARS:
+                names[m.group(2)] = m.group(1)
+
+    missing = [tok for tok in SCALARS if tok not in names]
+    if missing:
+        sys.exit("gen_keywords.py: no rule in %s for: %s" % (path, ", ".join(missing)))
+
+    return [(names[tok], tok) for tok in SCALARS]
+
+
+def slot(name, a, b, c):
+    s = [ord(x) for x in name]
+    return (a * s[0] + b * s[-1] + c * s[-2]) & (SLOTS-1)
+
+
+def find_hash(keywords):
+    for a in range(1, 16):
+        for b in range(1, 16):
+            for c in range(1, 16):
+                slots = {slot(name, a, b, c) for name, _ in keywords}
+                if len(slots) == len(keywords):
+                    return a, b, c
+    sys.exit("gen_keywords.py: no perfect hash found")
+
+
+def main(path):
+    keywords = read_keywords(path)
+    a, b, c = find_hash(keywords)
+    table = sorted((slot(name, a, b, c), name, tok) for name, tok in keywords)
+
+    def coeff(n):
+        return "" if n == 1 else "%d * " % n
+
+    print("/* Generated from lexer.l by tools/gen_keywords.py.  Do not edit. */")
+    print()
+    print("#define KEYWORD_SLOTS %d" % SLOTS)
+    lines = ["#define KEYWORD_HASH(s, n)",
+             "    ((%s(unsigned char)(s)[0] +" % coeff(a),
+             "      %s(unsigned char)(s)[(n)-1] +" % coeff(b)]
+    width = max(len(line) for line in lines) + 1
+    for line in lines:
+        print(line.ljust(width) + "\\")
+    print("      %s(unsigned char)(s)[(n)-2]) & (KEYWORD_SLOTS-1))" % coeff(c))
+    print()
+    print("static const struct {")
+    print("    const char *name;")
+    print("    size_t len;")
+    print("    int token;")
+    print("} keywords[KEYWORD_SLOTS] = {")
+    for i, name, tok in table:
+        print('  [%d] = {"%s", %d, %s},' % (i, name, len(name), tok))
+    print("};")
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 2:
+        sys.exit("usage: python3 tools/gen_keywords.py lexer.l")
+    main(sys.argv[1])
@@ -87,17 +87,23 @@ unification_error(const char *msg, ndt_context_t *ctx)
 static const ndt_t *
 unify_common(ndt_t *w, const ndt_t *t, const ndt_t *u, ndt_context_t *ctx)
 {
-    if ((t->flags & ~(NDT_OPTION|NDT_SUBTREE_OPTION|NDT_POINTER)) !=
-        (u->flags & ~(NDT_OPTION|NDT_SUBTREE_OPTION|NDT_POINTER))) {
+    const uint32_t ignore = NDT_OPTION|NDT_SUBTREE_OPTION|NDT_POINTER|NDT_ALL_VALID;
+    uint32_t flags;
+
+    if ((t->flags & ~ignore) != (u->flags & ~ignore)) {
         ndt_decref(w);
         return unification_error("flags differ", ctx);
     }
 
+    /* The unified type is only known to be valid if both types are. */
+    flags = (t->flags | u->flags) & ~NDT_ALL_VALID;
+    flags |= t->flags & u->flags & NDT_ALL_VALID;
+
     if (ndt_is_static(w)) {
-        return ndt_primitive(w->tag, t->flags | u->flags, ctx);
+        return ndt_primitive(w->tag, flags, ctx);
     }
 
-    w->flags = t->flags | u->flags;
+    w->flags = flags;
     return w;
 }
 
@@ -165,7 +171,6 @@ unify_record(const ndt_t *t, const ndt_t *u, bool replace_any, ndt_context_t *ct
     ndt_field_seq_t *seq;
     ndt_field_t *field;
     const ndt_t *tmp, *w;
-    char *name;
     int64_t shape;
     int64_t i;
 
@@ -180,18 +185,13 @@ unify_record(const ndt_t *t, const ndt_t *u, bool replace_any, ndt_context_t *ct
         return mk_record(t->Record.flag, NULL, NULL, opt, ctx);
     }
 
-    name = ndt_strdup(t->Record.names[0], ctx);
-    if (name == NULL) {
-        return NULL;
-    }
-
     tmp = unify(t->Record.types[0], u->Record.types[0], replace_any, ctx);
     if (tmp == NULL) {
-        ndt_free(name);
         return NULL;
     }
 
-    field = mk_field(name, tmp, NULL, ctx); 
+    /* The names of 't' outlive the sequence. */
+    field = mk_field(t->Record.names[0], tmp, NULL, ctx);
     if (field == NULL) {
         return NULL;
     }
@@ -202,20 +202,13 @@ unify_record(const ndt_t *t, const ndt_t *u, bool replace_any, ndt_context_t *ct
     }
 
     for (i = 1; i < shape; i++) {
-        name = ndt_strdup(t->Record.names[i], ctx);
-        if (name == NULL) {
-            ndt_field_seq_del(seq);
-            return NULL;
-        }
-
         tmp = unify(t->Record.types[i], u->Record.types[i], replace_any, ctx);
         if (tmp == NULL) {
-            ndt_free(name);
             ndt_field_seq_del(seq);
             return NULL;
         }
 
-        field = mk_field(name, tmp, NULL, ctx); 
+        field = mk_field(t->Record.names[i], tmp, NULL, ctx);
         if (field == NULL) {
             ndt_field_seq_del(seq);
             return NULL;
@@ -242,7 +235,6 @@ unify_union(const ndt_t *t, const ndt_t *u, bool replace_any, ndt_context_t *ctx
     ndt_field_seq_t *seq;
     ndt_field_t *field;
     const ndt_t *tmp, *w;
-    char *name;
     int64_t ntags;
     int64_t i;
 
@@ -255,18 +247,13 @@ unify_union(const ndt_t *t, const ndt_t *u, bool replace_any, ndt_context_t *ctx
         }
     }
 
-    name = ndt_strdup(t->Union.tags[0], ctx);
-    if (name == NULL) {
-        return NULL;
-    }
-
     tmp = unify(t->Union.types[0], u->Union.types[0], replace_any, ctx);
     if (tmp == NULL) {
-        ndt_free(name);
         return NULL;
     }
 
-    field = mk_field(name, tmp, NULL, ctx); 
+    /* The names of 't' outlive the sequence. */
+    field = mk_field(t->Union.tags[0], tmp, NULL, ctx);
     if (field == NULL) {
         return NULL;
     }
@@ -277,20 +264,13 @@ unify_union(const ndt_t *t, const ndt_t *u, bool replace_any, ndt_context_t *ctx
     }
 
     for (i = 1; i < ntags; i++) {
-        name = ndt_strdup(t->Union.tags[i], ctx);
-        if (name == NULL) {
-            ndt_field_seq_del(seq);
-            return NULL;
-        }
-
         tmp = unify(t->Union.types[i], u->Union.types[i], replace_any, ctx);
         if (tmp == NULL) {
-            ndt_free(name);
             ndt_field_seq_del(seq);
             return NULL;
         }
 
-        field = mk_field(name, tmp, NULL, ctx); 
+        field = mk_field(t->Union.tags[i], tmp, NULL, ctx);
         if (field == NULL) {
             ndt_field_seq_del(seq);
             return NULL;
@@ -367,7 +347,9 @@ unify(const ndt_t *t, const ndt_t *u, bool replace_any, ndt_context_t *ctx)
             return NULL;
         }
 
-        w = ndt_fixed_dim(type, t->FixedDim.shape, t->Concrete.FixedDim.step, ctx);
+        w = ndt_fixed_dim_tiled(type, t->FixedDim.shape, t->Concrete.FixedDim.step,
+                                t->Concrete.FixedDim.tile,
+                                t->Concrete.FixedDim.tile_step, ctx);
         ndt_decref(type);
         if (w == NULL) {
             return NULL;
@@ -395,7 +377,8 @@ unify(const ndt_t *t, const ndt_t *u, bool replace_any, ndt_context_t *ctx)
             return unification_error("offset mismatch in var dimension", ctx);
         }
 
-        if (memcmp(t->Concrete.VarDim.offsets->v, u->Concrete.VarDim.offsets->v,
+        if (t->Concrete.VarDim.offsets != u->Concrete.VarDim.offsets &&
+            memcmp(t->Concrete.VarDim.offsets->v, u->Concrete.VarDim.offsets->v,
                    noffsets * (sizeof *t->Concrete.VarDim.offsets->v))) {
             return unification_error("shape mismatch in var dimension", ctx);
         }
@@ -693,11 +676,23 @@ unify(const ndt_t *t, const ndt_t *u, bool replace_any, ndt_context_t *ctx)
 const ndt_t *
 ndt_unify(const ndt_t *t, const ndt_t *u, ndt_context_t *ctx)
 {
-    return unify(t, u, false, ctx);
+    const ndt_t *w;
+
+    ndt_scratch_enter();
+    w = unify(t, u, false, ctx);
+    ndt_scratch_leave();
+
+    return w;
 }
 
 const ndt_t *
 ndt_unify_replace_any(const ndt_t *t, const ndt_t *u, ndt_context_t *ctx)
 {
-    return unify(t, u, true, ctx);
+    const ndt_t *w;
+
+    ndt_scratch_enter();
+    w = unify(t, u, true, ctx);
+    ndt_scratch_leave();
+
+    return w;
 }
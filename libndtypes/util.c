@@ -47,6 +47,10 @@ ndt_strdup(const char *s, ndt_context_t *ctx)
     size_t len = strlen(s);
     char *cp;
 
+    if (ndt_limit_string(ctx, (int64_t)len) < 0) {
+        return NULL;
+    }
+
     cp = ndt_alloc_size(len+1);
     if (cp == NULL) {
         return ndt_memory_error(ctx);
@@ -95,22 +99,82 @@ ndt_asprintf(ndt_context_t *ctx, const char *fmt, ...)
 /*                       Type functions (unstable API)                       */
 /*****************************************************************************/
 
-/* Number of elements, currently only for ndarrays. Return -1 on error. */
+/*
+ * Number of elements of a concrete type.  For var dimensions this is the
+ * number of dtype elements.  The value is cached in the type.  Return -1
+ * for sliced or indexed var dimensions.
+ */
 int64_t
 ndt_nelem(const ndt_t *t)
 {
-    NDT_STATIC_CONTEXT(ctx);
-    ndt_ndarray_t x;
-    int64_t n;
+    if (ndt_is_abstract(t)) {
+        return -1;
+    }
+
+    if (t->ndim == 0) {
+        return 1;
+    }
+
+    switch (t->tag) {
+    case FixedDim:
+        return t->Concrete.FixedDim.nelem;
+    case VarDim:
+        return t->Concrete.VarDim.nelem;
+    default:
+        return -1;
+    }
+}
+
+/*
+ * Number of dtype elements in the data of a concrete type.  For var
+ * dimensions this is the final offset of the innermost dimension, which
+ * includes the elements that are hidden by slices.
+ */
+int64_t
+ndt_var_total_nelem(const ndt_t *t)
+{
+    if (ndt_is_abstract(t)) {
+        return -1;
+    }
+
+    switch (t->tag) {
+    case VarDim: case VarDimElem:
+        return t->Concrete.VarDim.total;
+    default:
+        return ndt_nelem(t);
+    }
+}
+
+/*
+ * Write the logical shape of a concrete type to 'shape' and return the
+ * number of logical dimensions.  Var dimensions have the shape -1.  Return
+ * -1 for abstract types.
+ */
+int
+ndt_logical_shape(int64_t shape[NDT_MAX_DIM], const ndt_t *t)
+{
+    int n = 0;
 
-    if (ndt_as_ndarray(&x, t, &ctx) < 0) {
-        ndt_err_clear(&ctx);
+    if (ndt_is_abstract(t)) {
         return -1;
     }
 
-    n = 1;
-    for (int i = 0; i < x.ndim; i++) {
-        n *= x.shape[i];
+    while (t->ndim > 0) {
+        switch (t->tag) {
+        case FixedDim:
+            shape[n++] = t->FixedDim.shape;
+            t = t->FixedDim.type;
+            break;
+        case VarDim:
+            shape[n++] = -1;
+            t = t->VarDim.type;
+            break;
+        case VarDimElem:
+            t = t->VarDimElem.type;
+            break;
+        default:
+            return -1;
+        }
     }
 
     return n;
@@ -246,9 +310,17 @@ ndt_copy_contiguous_at(const ndt_t *t, int n, const ndt_t *dtype, ndt_context_t
 {
     const ndt_t *u;
 
+    if (t->tag == VarDim || t->tag == VarDimElem) {
+        if (dtype == NULL) {
+            dtype = ndt_dtype(t);
+        }
+        return ndt_var_copy_contiguous_at(t, n, dtype, ctx);
+    }
+
     if (!ndt_is_ndarray(t)) {
         ndt_err_format(ctx, NDT_NotImplementedError,
-            "partial copies are currently restricted to fixed dimensions");
+            "partial copies are currently restricted to fixed and var "
+            "dimensions");
         return NULL;
     }
 
@@ -475,6 +547,8 @@ ndt_apply_spec_del(ndt_apply_spec_t *spec)
 }
 
 #define X (NDT_INNER_XND)
+#define T (NDT_INNER_TILED)
+#define V (NDT_INNER_VALID)
 #define S (NDT_INNER_STRIDED)
 #define C (NDT_INNER_C)
 #define F (NDT_INNER_F)
@@ -491,6 +565,25 @@ ndt_apply_flags_as_string(const ndt_apply_spec_t *spec)
     switch (spec->flags) {
     case 0: return "None";
     case X: return "Xnd";
+    case T|X: return "Tiled|Xnd";
+    case V|X: return "Valid|Xnd";
+    case V|T|X: return "Valid|Tiled|Xnd";
+
+    case V|S|X: return "Valid|Strided|Xnd";
+    case V|C|S|X: return "Valid|C|Strided|Xnd";
+    case V|F|S|X: return "Valid|Fortran|Strided|Xnd";
+    case V|C|F|S|X: return "Valid|C|Fortran|Strided|Xnd";
+
+    case V|ES|S|X: return "Valid|OptS|Strided|Xnd";
+    case V|ES|C|S|X: return "Valid|OptS|C|Strided|Xnd";
+    case V|ES|F|S|X: return "Valid|OptS|Fortran|Strided|Xnd";
+    case V|ES|C|F|S|X: return "Valid|OptS|C|Fortran|Strided|Xnd";
+    case V|EC|ES|C|S|X: return "Valid|OptC|OptS|C|Strided|Xnd";
+    case V|EC|ES|C|F|S|X: return "Valid|OptC|OptS|C|Fortran|Strided|Xnd";
+    case V|EZ|EC|ES|C|F|S|X: return "Valid|OptZ|OptC|OptS|C|Fortran|Strided|Xnd";
+    case V|EZ|EC|ES|C|S|X: return "Valid|OptZ|OptC|OptS|C|Strided|Xnd";
+    case V|EZ|ES|C|S|X: return "Valid|OptZ|OptS|C|Strided|Xnd";
+    case V|EZ|ES|C|F|S|X: return "Valid|OptZ|OptS|C|Fortran|Strided|Xnd";
 
     case S|X: return "Strided|Xnd";
     case C|S|X: return "C|Strided|Xnd";
@@ -516,6 +609,8 @@ ndt_apply_flags_as_string(const ndt_apply_spec_t *spec)
         if (spec->flags & NDT_INNER_F) fprintf(stderr, "F ");
         if (spec->flags & NDT_INNER_STRIDED) fprintf(stderr, "S ");
         if (spec->flags & NDT_INNER_XND) fprintf(stderr, "X ");
+        if (spec->flags & NDT_INNER_TILED) fprintf(stderr, "T ");
+        if (spec->flags & NDT_INNER_VALID) fprintf(stderr, "V ");
         fprintf(stderr, "\n");
 
         return "unknown flags";
@@ -642,20 +737,56 @@ check_var(uint32_t flags, const ndt_t *t, int outer)
     return flags & NDT_INNER_XND;
 }
 
+/*
+ * Blocked kernels can be used if all tiled dimensions are inner dimensions.
+ * The outer loop then iterates over regular fixed dimensions.  Other fixed
+ * arguments are accessed through their strides.
+ */
 static uint32_t
-select_flags(const ndt_t *types[], int n, int outer, ndt_context_t *ctx)
+check_tiled(uint32_t flags, const ndt_t *t, int outer)
+{
+    for (int i = 0; i < outer; i++, t=t->FixedDim.type) {
+        if (t->Concrete.FixedDim.tile != 0) {
+            return flags & NDT_INNER_XND;
+        }
+    }
+
+    return flags & (NDT_INNER_TILED|NDT_INNER_XND);
+}
+
+static uint32_t
+select_flags(const ndt_t *types[], int nin, int n, int outer, ndt_context_t *ctx)
 {
     uint32_t flags = NDT_SPEC_FLAGS_ALL;
+    bool tiled = false;
+    bool optional = false;
+    bool valid = true;
     ndt_ndarray_t x;
 
     for (int i = 0; i < n; i++) {
         const ndt_t *t = types[i];
 
-        if (ndt_as_ndarray(&x, t, ctx) < 0) { /* var dimension */
+        /* Outputs are written by the kernel, only the inputs are read. */
+        if (i < nin && (t->flags & (NDT_OPTION|NDT_SUBTREE_OPTION))) {
+            optional = true;
+            valid &= ndt_is_all_valid(t) != 0;
+        }
+
+        if (ndt_as_ndarray(&x, t, ctx) < 0) { /* var or tiled dimension */
             ndt_err_clear(ctx);
             if (t->tag == VarDim || t->tag == VarDimElem) {
                 flags = check_var(flags, t, outer);
             }
+            else if (t->tag == FixedDim && (t->flags & NDT_TILED)) {
+                if (outer > t->ndim) {
+                    ndt_err_format(ctx, NDT_RuntimeError,
+                                   "number of outer dimensions greater than ndim");
+                    return UINT32_MAX;
+                }
+
+                flags = check_tiled(flags, t, outer);
+                tiled = true;
+            }
         }
         else {
             if (outer > t->ndim) {
@@ -670,13 +801,52 @@ select_flags(const ndt_t *types[], int n, int outer, ndt_context_t *ctx)
         }
     }
 
+    if (!tiled) {
+        flags &= ~NDT_INNER_TILED;
+    }
+
+    /* Kernels can skip the validity checks of optional inputs. */
+    flags &= ~NDT_INNER_VALID;
+    if (optional && valid) {
+        flags |= NDT_INNER_VALID;
+    }
+
     return flags;
 }
 
 int
 ndt_select_kernel_strategy(ndt_apply_spec_t *spec, ndt_context_t *ctx)
 {
-    spec->flags = select_flags(spec->types, spec->nargs, spec->outer_dims, ctx);
+    spec->flags = select_flags(spec->types, spec->nin, spec->nargs, spec->outer_dims, ctx);
 
     return spec->flags == UINT32_MAX ? -1 : 0;
 }
+
+/*
+ * Select the strategy for arguments that are described by ndarrays.  The
+ * caller is responsible for NDT_INNER_VALID, which depends on the types.
+ */
+int
+ndt_select_kernel_strategy_ndarray(ndt_ndarray_spec_t *spec, ndt_context_t *ctx)
+{
+    const int outer = spec->outer_dims;
+    uint32_t flags = NDT_SPEC_FLAGS_ALL;
+
+    for (int i = 0; i < spec->nargs; i++) {
+        ndt_ndarray_t *x = &spec->args[i];
+
+        if (outer > x->ndim) {
+            ndt_err_format(ctx, NDT_RuntimeError,
+                           "number of outer dimensions greater than ndim");
+            return -1;
+        }
+
+        flags = check_strided(flags, outer);
+        flags = check_c(flags, x, outer);
+        flags = check_f(flags, x, outer);
+    }
+
+    spec->flags = flags & ~(NDT_INNER_TILED|NDT_INNER_VALID);
+
+    return 0;
+}
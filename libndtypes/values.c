@@ -56,7 +56,7 @@ ndt_value_del(ndt_value_t *mem)
 }
 
 void
-ndt_value_array_del(const ndt_value_t *mem, int64_t ntypes)
+ndt_value_array_clear(const ndt_value_t *mem, int64_t ntypes)
 {
     int64_t i;
 
@@ -69,7 +69,12 @@ ndt_value_array_del(const ndt_value_t *mem, int64_t ntypes)
             ndt_free(mem[i].ValString);
         }
     }
+}
 
+void
+ndt_value_array_del(const ndt_value_t *mem, int64_t ntypes)
+{
+    ndt_value_array_clear(mem, ntypes);
     ndt_free((void *)mem);
 }
 
@@ -124,13 +129,17 @@ ndt_value_from_string(char *v, ndt_context_t *ctx)
 {
     ndt_value_t *mem;
 
+    if (ndt_utf8_check(v, -1, ctx) < 0) {
+        ndt_free(v);
+        return NULL;
+    }
+
     mem = ndt_alloc_size(sizeof *mem);
     if (mem == NULL) {
         ndt_free(v);
         return ndt_memory_error(ctx);
     }
 
-    /* XXX: check utf8 */
     mem->tag = ValString;
     mem->ValString = v;
 